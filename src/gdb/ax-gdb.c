@@ -1812,6 +1812,45 @@ gen_trace_for_expr (CORE_ADDR scope, struct expression *expr)
   return ax;
 }
 
+/* Given a GDB expression EXPR, return bytecode that computes its
+   value and leaves it on the stack, for an agent to evaluate as a
+   breakpoint condition at SCOPE.  Signal an error if the expression
+   can't be compiled, or its value isn't something an agent can test
+   for truth.  */
+struct agent_expr *
+gen_eval_for_expr (CORE_ADDR scope, struct expression *expr)
+{
+  struct cleanup *old_chain = 0;
+  struct agent_expr *ax = new_agent_expr (scope);
+  union exp_element *pc;
+  struct axs_value value;
+
+  old_chain = make_cleanup_free_agent_expr (ax);
+
+  pc = expr->elts;
+  trace_kludge = 0;
+  gen_expr (&pc, ax, &value);
+
+  /* Agents have no floating point, and can't test an aggregate.  */
+  switch (TYPE_CODE (check_typedef (value.type)))
+    {
+    case TYPE_CODE_FLT:
+    case TYPE_CODE_STRUCT:
+    case TYPE_CODE_UNION:
+    case TYPE_CODE_ARRAY:
+      error (_("Can't evaluate a value of this type in an agent expression."));
+    default:
+      break;
+    }
+
+  require_rvalue (ax, &value);
+
+  ax_simple (ax, aop_end);
+
+  discard_cleanups (old_chain);
+  return ax;
+}
+
 static void
 agent_command (char *exp, int from_tty)
 {
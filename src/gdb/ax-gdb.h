@@ -110,4 +110,9 @@ extern struct agent_expr *expr_to_address_and_size (struct expression *EXPR);
    function to discover which registers the expression uses.  */
 extern struct agent_expr *gen_trace_for_expr (CORE_ADDR, struct expression *);
 
+/* Given a GDB expression EXPR, return bytecode that leaves its value
+   on the stack, so an agent can evaluate it as a breakpoint condition
+   at the given scope.  */
+extern struct agent_expr *gen_eval_for_expr (CORE_ADDR, struct expression *);
+
 #endif /* AX_GDB_H */
@@ -25,8 +25,6 @@
 #include "symfile.h"
 #include "gdb_obstack.h"
 #include "cp-support.h"
-/* APPLE LOCAL cache lookup values for improved performance  */
-#include "inferior.h"
 
 /* This is used by struct block to store namespace-related info for
    C++ files, namely using declarations and the current namespace in
@@ -213,9 +211,47 @@ block_contains_pc (const struct block *bl, CORE_ADDR pc)
    PINDEX is a pointer to the index value of the block.  If PINDEX
    is NULL, we don't pass this information back to the caller.  */
 
+/* APPLE LOCAL begin cache lookup values for improved performance  */
+static struct blockvector *blockvector_for_pc_sect_1 (CORE_ADDR,
+						      struct bfd_section *,
+						      int *, struct symtab *);
+
 struct blockvector *
 blockvector_for_pc_sect (CORE_ADDR pc, struct bfd_section *section,
 			 int *pindex, struct symtab *symtab)
+{
+  struct pc_lookup_entry *e;
+  struct blockvector *bl;
+  int index;
+
+  /* Only the caller knows what a given SYMTAB means, so only cache
+     lookups that search all the symtabs.  */
+  if (symtab != NULL)
+    return blockvector_for_pc_sect_1 (pc, section, pindex, symtab);
+
+  e = pc_lookup_cache_find (pc, section, PC_LOOKUP_BLOCKVECTOR);
+  if (e != NULL)
+    {
+      bl = e->blockvector;
+      index = e->blockvector_index;
+    }
+  else
+    {
+      bl = blockvector_for_pc_sect_1 (pc, section, &index, NULL);
+      e = pc_lookup_cache_add (pc, section, PC_LOOKUP_BLOCKVECTOR);
+      e->blockvector = bl;
+      e->blockvector_index = index;
+    }
+
+  if (pindex)
+    *pindex = index;
+  return bl;
+}
+/* APPLE LOCAL end cache lookup values for improved performance  */
+
+static struct blockvector *
+blockvector_for_pc_sect_1 (CORE_ADDR pc, struct bfd_section *section,
+			   int *pindex, struct symtab *symtab)
 {
   struct block *b;
   struct block *static_block;
@@ -225,31 +261,12 @@ blockvector_for_pc_sect (CORE_ADDR pc, struct bfd_section *section,
   if (pindex)
     *pindex = 0;
 
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-  if (pc == last_blockvector_lookup_pc
-	   && pc == last_mapped_section_lookup_pc
-	   && section == cached_mapped_section
-	   && cached_blockvector)
-    {
-      *pindex = cached_blockvector_index;
-      return cached_blockvector;
-    }
-
-  last_blockvector_lookup_pc = pc;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
-
   if (symtab == 0)		/* if no symtab specified by caller */
     {
       /* First search all symtabs for one whose file contains our pc */
       symtab = find_pc_sect_symtab (pc, section);
       if (symtab == 0)
-	/* APPLE LOCAL begin cache lookup values for improved performance  */
-	{
-	  cached_blockvector_index = -1;
-	  cached_blockvector = NULL;
-	  return 0;
-	}
-        /* APPLE LOCAL end cache lookup values for improved performance  */
+	return 0;
     }
 
   bl = BLOCKVECTOR (symtab);
@@ -302,32 +319,17 @@ blockvector_for_pc_sect (CORE_ADDR pc, struct bfd_section *section,
          highest/lowest addresses are lower than PC.  */
       if (BLOCK_SUPERBLOCK (b) == static_block 
           && BLOCK_LOWEST_PC (b) < pc && BLOCK_HIGHEST_PC (b) < pc)
-	/* APPLE LOCAL begin cache lookup values for improved performance  */
-	{
-	  cached_blockvector_index = -1;
-	  cached_blockvector = NULL;
-	  return 0;
-	}
-        /* APPLE LOCAL end cache lookup values for improved performance  */
+	return 0;
 
       if (block_contains_pc (b, pc))
       /* APPLE LOCAL end address ranges  */
 	{
 	  if (pindex)
 	    *pindex = bot;
-	  /* APPLE LOCAL begom cache lookup values for improved 
-	     performance  */	
-	  cached_blockvector_index = bot;
-	  cached_blockvector = bl;
-	  /* APPLE LOCAL end cache lookup values for improved performance  */
 	  return bl;
 	}
       bot--;
     }
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-  cached_blockvector_index = -1;
-  cached_blockvector = NULL;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
   return 0;
 }
 
@@ -351,24 +353,10 @@ block_for_pc_sect (CORE_ADDR pc, struct bfd_section *section)
   struct blockvector *bl;
   int index;
 
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-  if (pc == last_block_lookup_pc
-	   && pc == last_mapped_section_lookup_pc
-	   && section == cached_mapped_section
-	   && cached_block)
-    return cached_block;
-
-  last_block_lookup_pc = pc;
-
   bl = blockvector_for_pc_sect (pc, section, &index, NULL);
   if (bl)
-    {
-      cached_block = BLOCKVECTOR_BLOCK (bl, index);
-      return BLOCKVECTOR_BLOCK (bl, index);
-    }
-  cached_block = NULL;
+    return BLOCKVECTOR_BLOCK (bl, index);
   return 0;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
 }
 
 /* Return the innermost lexical block containing the specified pc value,
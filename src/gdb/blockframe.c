@@ -278,19 +278,16 @@ find_pc_sect_function (CORE_ADDR pc, struct bfd_section *section)
   struct block *b;
   /* APPLE LOCAL inlined function symbols & blocks  */
   struct symbol *func_sym;
+  struct pc_lookup_entry *e;
 
-  if (pc == last_function_lookup_pc
-      && pc == last_mapped_section_lookup_pc
-      && section == cached_mapped_section
-      && cached_pc_function)
-    return cached_pc_function;
-  
-  last_function_lookup_pc = pc;
+  e = pc_lookup_cache_find (pc, section, PC_LOOKUP_FUNCTION);
+  if (e != NULL)
+    return e->function;
 
   b = block_for_pc_sect (pc, section);
   if (b == 0)
     {
-      cached_pc_function = NULL;
+      pc_lookup_cache_add (pc, section, PC_LOOKUP_FUNCTION)->function = NULL;
       return 0;
     }
 
@@ -305,7 +302,7 @@ find_pc_sect_function (CORE_ADDR pc, struct bfd_section *section)
   if (!func_sym)
     func_sym = block_function (b);
 
-  cached_pc_function = func_sym;
+  pc_lookup_cache_add (pc, section, PC_LOOKUP_FUNCTION)->function = func_sym;
   return func_sym;
   /* APPLE LOCAL end inlined function symbols & blocks  */
   /* APPLE LOCAL end cache lookup values for improved performance  */
@@ -59,6 +59,8 @@
 #include "solist.h"
 #include "observer.h"
 #include "exceptions.h"
+#include "ax.h"
+#include "ax-gdb.h"
 /* APPLE LOCAL: for exception catching regex */
 #include "gdb_regex.h"
 
@@ -389,6 +391,16 @@ static int overlay_events_enabled;
 	     B ? (TMP=B->next, 1): 0;	\
 	     B = TMP)
 
+/* APPLE LOCAL begin breakpoint location index  */
+/* Walk through the locations at address ADDR, in the order of the
+   chain.  */
+
+#define ALL_BP_LOCATIONS_AT(B,ADDR)		\
+	for (B = bp_location_index_first (ADDR);	\
+	     B;					\
+	     B = bp_location_index_next (B))
+/* APPLE LOCAL end breakpoint location index  */
+
 /* True if breakpoint hit counts should be displayed in breakpoint info.  */
 
 int show_breakpoint_hit_counts = 1;
@@ -399,6 +411,183 @@ struct breakpoint *breakpoint_chain;
 
 struct bp_location *bp_location_chain;
 
+/* APPLE LOCAL begin breakpoint location index  */
+/* All the locations in bp_location_chain, hashed by address, so that
+   we can find the breakpoints at a given pc without looking at all
+   of them.  Each bucket is kept in chain order.  */
+
+static struct
+{
+  struct bp_location **buckets;
+
+  /* The number of buckets; always a power of two.  */
+  unsigned int size;
+
+  /* The number of locations in the index.  */
+  unsigned int count;
+
+  /* How many of those are watchpoints or catchpoints, which don't
+     match a stop by their address, and how many of those are
+     hardware watchpoints.  */
+  unsigned int unaddressed;
+  unsigned int hardware_watchpoints;
+
+  /* How many locations have an unstripped_address.  */
+  unsigned int unstripped;
+}
+bp_location_index;
+
+#define BP_LOCATION_INDEX_INITIAL_SIZE 64
+
+/* The serial number of the last location allocated.  */
+
+static unsigned int bp_location_serial;
+
+static unsigned int
+bp_location_hash (CORE_ADDR address)
+{
+  ULONGEST a = address;
+
+  /* Instructions are usually aligned, so fold in some higher bits.  */
+  return (unsigned int) (a ^ (a >> 7) ^ (a >> 17));
+}
+
+/* Link LOC into BUCKETS, which has SIZE entries, keeping the bucket in
+   serial order.  */
+
+static void
+bp_location_index_link (struct bp_location **buckets, unsigned int size,
+			struct bp_location *loc)
+{
+  struct bp_location **locp;
+
+  locp = &buckets[bp_location_hash (loc->address) & (size - 1)];
+  while (*locp != NULL && (*locp)->serial < loc->serial)
+    locp = &(*locp)->next_in_bucket;
+  loc->next_in_bucket = *locp;
+  *locp = loc;
+}
+
+static void
+bp_location_index_grow (void)
+{
+  unsigned int new_size, i;
+  struct bp_location **new_buckets;
+
+  if (bp_location_index.size == 0)
+    new_size = BP_LOCATION_INDEX_INITIAL_SIZE;
+  else
+    new_size = bp_location_index.size * 2;
+  new_buckets = xcalloc (new_size, sizeof (struct bp_location *));
+
+  for (i = 0; i < bp_location_index.size; i++)
+    {
+      struct bp_location *loc, *next;
+
+      for (loc = bp_location_index.buckets[i]; loc != NULL; loc = next)
+	{
+	  next = loc->next_in_bucket;
+	  bp_location_index_link (new_buckets, new_size, loc);
+	}
+    }
+
+  xfree (bp_location_index.buckets);
+  bp_location_index.buckets = new_buckets;
+  bp_location_index.size = new_size;
+}
+
+static void
+bp_location_index_add (struct bp_location *loc)
+{
+  if (bp_location_index.count >= bp_location_index.size * 2)
+    bp_location_index_grow ();
+
+  bp_location_index_link (bp_location_index.buckets,
+			  bp_location_index.size, loc);
+  bp_location_index.count++;
+  if (loc->loc_type == bp_loc_other
+      || loc->loc_type == bp_loc_hardware_watchpoint)
+    bp_location_index.unaddressed++;
+  if (loc->loc_type == bp_loc_hardware_watchpoint)
+    bp_location_index.hardware_watchpoints++;
+  if (loc->unstripped_address)
+    bp_location_index.unstripped++;
+}
+
+static void
+bp_location_index_remove (struct bp_location *loc)
+{
+  struct bp_location **locp;
+
+  locp = &bp_location_index.buckets[bp_location_hash (loc->address)
+				    & (bp_location_index.size - 1)];
+  while (*locp != loc)
+    {
+      gdb_assert (*locp != NULL);
+      locp = &(*locp)->next_in_bucket;
+    }
+  *locp = loc->next_in_bucket;
+  loc->next_in_bucket = NULL;
+
+  bp_location_index.count--;
+  if (loc->loc_type == bp_loc_other
+      || loc->loc_type == bp_loc_hardware_watchpoint)
+    bp_location_index.unaddressed--;
+  if (loc->loc_type == bp_loc_hardware_watchpoint)
+    bp_location_index.hardware_watchpoints--;
+  if (loc->unstripped_address)
+    bp_location_index.unstripped--;
+}
+
+/* Return the first location at ADDRESS, or NULL if there is none.  */
+
+static struct bp_location *
+bp_location_index_first (CORE_ADDR address)
+{
+  struct bp_location *loc;
+
+  if (bp_location_index.count == 0)
+    return NULL;
+
+  for (loc = bp_location_index.buckets[bp_location_hash (address)
+				       & (bp_location_index.size - 1)];
+       loc != NULL;
+       loc = loc->next_in_bucket)
+    if (loc->address == address)
+      return loc;
+
+  return NULL;
+}
+
+/* Return the next location after LOC at the same address.  */
+
+static struct bp_location *
+bp_location_index_next (struct bp_location *loc)
+{
+  CORE_ADDR address = loc->address;
+
+  for (loc = loc->next_in_bucket; loc != NULL; loc = loc->next_in_bucket)
+    if (loc->address == address)
+      return loc;
+
+  return NULL;
+}
+
+/* Set the address of LOC, keeping the index up to date.  All changes
+   to a location's address should go through here.  */
+
+static void
+bp_location_set_address (struct bp_location *loc, CORE_ADDR address)
+{
+  bp_location_index_remove (loc);
+  loc->address = address;
+  loc->unstripped_address
+    = gdbarch_addr_bits_remove (current_gdbarch, address) != address;
+  bp_location_index_add (loc);
+}
+
+/* APPLE LOCAL end breakpoint location index  */
+
 /* Number of last breakpoint made.  */
 
 int breakpoint_count;
@@ -850,6 +1039,55 @@ breakpoint_print_commands (struct ui_out *uiout, struct breakpoint *b)
 /* APPLE LOCAL end breakpoint MI */
 
 
+/* APPLE LOCAL begin breakpoint location index  */
+/* Return 1 if B is an inserted software breakpoint that overlaps the
+   LEN bytes at MEMADDR, and set *BP_ADDRP and *BP_SIZEP to the part
+   of memory it covers.  */
+
+static int
+software_bp_location_overlaps (struct bp_location *b, CORE_ADDR memaddr,
+			       unsigned len, CORE_ADDR *bp_addrp,
+			       int *bp_sizep)
+{
+  CORE_ADDR bp_addr;
+  int bp_size;
+
+  if (b->owner->type == bp_none)
+    warning (_("reading through apparently deleted breakpoint #%d?"),
+	     b->owner->number);
+
+  if (b->loc_type != bp_loc_software_breakpoint)
+    return 0;
+  if (!b->inserted)
+    return 0;
+  /* Addresses and length of the part of the breakpoint that
+     we need to copy.  */
+  /* XXXX The m68k, sh and h8300 have different local and remote
+     breakpoint values.  BREAKPOINT_FROM_PC still manages to
+     correctly determine the breakpoints memory address and size
+     for these targets. */
+  bp_addr = b->address;
+  bp_size = 0;
+  if (BREAKPOINT_FROM_PC (&bp_addr, &bp_size) == NULL)
+    return 0;
+  if (bp_size == 0)
+    /* bp isn't valid */
+    return 0;
+  if (bp_addr + bp_size <= memaddr)
+    /* The breakpoint is entirely before the chunk of memory we
+       are reading.  */
+    return 0;
+  if (bp_addr >= memaddr + len)
+    /* The breakpoint is entirely after the chunk of memory we are
+       reading. */
+    return 0;
+
+  *bp_addrp = bp_addr;
+  *bp_sizep = bp_size;
+  return 1;
+}
+/* APPLE LOCAL end breakpoint location index  */
+
 /* Like target_read_memory() but if breakpoints are inserted, return
    the shadow contents instead of the breakpoints themselves.
 
@@ -864,6 +1102,8 @@ deprecated_read_memory_nobpt (CORE_ADDR memaddr, gdb_byte *myaddr,
 {
   int status;
   struct bp_location *b;
+  /* APPLE LOCAL breakpoint location index  */
+  struct bp_location *found = NULL;
   CORE_ADDR bp_addr = 0;
   int bp_size = 0;
 
@@ -871,37 +1111,37 @@ deprecated_read_memory_nobpt (CORE_ADDR memaddr, gdb_byte *myaddr,
     /* No breakpoints on this machine. */
     return target_read_memory (memaddr, myaddr, len);
 
-  ALL_BP_LOCATIONS (b)
-  {
-    if (b->owner->type == bp_none)
-      warning (_("reading through apparently deleted breakpoint #%d?"),
-              b->owner->number);
+  /* APPLE LOCAL begin breakpoint location index  */
+  /* For a short read it is cheaper to look up each address a
+     breakpoint covering it could be at than to look at every
+     breakpoint.  BREAKPOINT_FROM_PC may move a breakpoint from its
+     address, but never by as much as BREAKPOINT_MAX.  */
+  if (len + 2 * BREAKPOINT_MAX < bp_location_index.count)
+    {
+      CORE_ADDR addr, end;
+
+      addr = memaddr < BREAKPOINT_MAX ? 0 : memaddr - BREAKPOINT_MAX;
+      end = memaddr + len + BREAKPOINT_MAX;
+      for (; addr != end && found == NULL; addr++)
+	ALL_BP_LOCATIONS_AT (b, addr)
+	  if (software_bp_location_overlaps (b, memaddr, len,
+					     &bp_addr, &bp_size))
+	    {
+	      found = b;
+	      break;
+	    }
+    }
+  else
+    ALL_BP_LOCATIONS (b)
+      if (software_bp_location_overlaps (b, memaddr, len,
+					 &bp_addr, &bp_size))
+	{
+	  found = b;
+	  break;
+	}
 
-    if (b->loc_type != bp_loc_software_breakpoint)
-      continue;
-    if (!b->inserted)
-      continue;
-    /* Addresses and length of the part of the breakpoint that
-       we need to copy.  */
-    /* XXXX The m68k, sh and h8300 have different local and remote
-       breakpoint values.  BREAKPOINT_FROM_PC still manages to
-       correctly determine the breakpoints memory address and size
-       for these targets. */
-    bp_addr = b->address;
-    bp_size = 0;
-    if (BREAKPOINT_FROM_PC (&bp_addr, &bp_size) == NULL)
-      continue;
-    if (bp_size == 0)
-      /* bp isn't valid */
-      continue;
-    if (bp_addr + bp_size <= memaddr)
-      /* The breakpoint is entirely before the chunk of memory we
-         are reading.  */
-      continue;
-    if (bp_addr >= memaddr + len)
-      /* The breakpoint is entirely after the chunk of memory we are
-         reading. */
-      continue;
+  if (found != NULL)
+  /* APPLE LOCAL end breakpoint location index  */
     /* Copy the breakpoint from the shadow contents, and recurse for
        the things before and after.  */
     {
@@ -923,7 +1163,7 @@ deprecated_read_memory_nobpt (CORE_ADDR memaddr, gdb_byte *myaddr,
 	}
 
       memcpy (myaddr + bp_addr - memaddr,
-	      b->shadow_contents + bptoffset, bp_size);
+	      found->shadow_contents + bptoffset, bp_size);
 
       if (bp_addr > memaddr)
 	{
@@ -944,7 +1184,7 @@ deprecated_read_memory_nobpt (CORE_ADDR memaddr, gdb_byte *myaddr,
 	}
       return 0;
     }
-  }
+
   /* Nothing overlaps.  Just call read_memory_noerr.  */
   return target_read_memory (memaddr, myaddr, len);
 }
@@ -1625,7 +1865,8 @@ update_breakpoints_after_exec (void)
 	(b->type == bp_catch_vfork) ||
 	(b->type == bp_catch_fork))
       {
-	b->loc->address = (CORE_ADDR) 0;
+	/* APPLE LOCAL breakpoint location index  */
+	bp_location_set_address (b->loc, (CORE_ADDR) 0);
 	continue;
       }
 
@@ -1678,7 +1919,8 @@ update_breakpoints_after_exec (void)
        unnecessary.  A call to breakpoint_re_set_one always recomputes
        the breakpoint's address from scratch, or deletes it if it can't.
        So I think this assignment could be deleted without effect.  */
-    b->loc->address = (CORE_ADDR) 0;
+    /* APPLE LOCAL breakpoint location index  */
+    bp_location_set_address (b->loc, (CORE_ADDR) 0);
   }
   /* FIXME what about longjmp breakpoints?  Re-create them here?  */
   create_overlay_event_breakpoint ("_ovly_debug_event");
@@ -1991,7 +2233,8 @@ breakpoint_here_p (CORE_ADDR pc)
   struct bp_location *bpt;
   int any_breakpoint_here = 0;
 
-  ALL_BP_LOCATIONS (bpt)
+  /* APPLE LOCAL breakpoint location index  */
+  ALL_BP_LOCATIONS_AT (bpt, pc)
     {
       if (bpt->loc_type != bp_loc_software_breakpoint
 	  && bpt->loc_type != bp_loc_hardware_breakpoint)
@@ -2025,7 +2268,8 @@ breakpoint_inserted_here_p (CORE_ADDR pc)
 {
   struct bp_location *bpt;
 
-  ALL_BP_LOCATIONS (bpt)
+  /* APPLE LOCAL breakpoint location index  */
+  ALL_BP_LOCATIONS_AT (bpt, pc)
     {
       if (bpt->loc_type != bp_loc_software_breakpoint
 	  && bpt->loc_type != bp_loc_hardware_breakpoint)
@@ -2055,7 +2299,8 @@ software_breakpoint_inserted_here_p (CORE_ADDR pc)
   struct bp_location *bpt;
   /* APPLE LOCAL remove unused local var */
 
-  ALL_BP_LOCATIONS (bpt)
+  /* APPLE LOCAL breakpoint location index  */
+  ALL_BP_LOCATIONS_AT (bpt, pc)
     {
       if (bpt->loc_type != bp_loc_software_breakpoint)
 	continue;
@@ -2077,6 +2322,84 @@ software_breakpoint_inserted_here_p (CORE_ADDR pc)
   return 0;
 }
 
+/* Compile the conditions of the enabled breakpoints at PC into agent
+   expressions, so that a target which can evaluate them itself only
+   needs to report the hits that GDB would actually stop for.  Store a
+   newly allocated array of the expressions in *CONDS and return how
+   many there are; the caller frees them with free_agent_expr and then
+   frees the array.  Return -1 if any breakpoint at PC has to be
+   reported unconditionally: one with no condition, a thread-specific
+   or internal breakpoint, or one whose condition can't be expressed
+   as agent bytecode.
+
+   GDB still evaluates every condition itself when a hit is reported,
+   so a target that ignores these, or evaluates them too generously,
+   never causes a wrong stop.  */
+
+int
+breakpoint_conditions_at (CORE_ADDR pc, struct agent_expr ***conds)
+{
+  struct breakpoint *b;
+  /* APPLE LOCAL breakpoint location index  */
+  struct bp_location *loc;
+  struct agent_expr **result = NULL;
+  int count = 0;
+  int allocated = 0;
+  int i;
+
+  *conds = NULL;
+
+  /* APPLE LOCAL breakpoint location index  */
+  ALL_BP_LOCATIONS_AT (loc, pc)
+    {
+      volatile struct gdb_exception e;
+      struct agent_expr *aexpr = NULL;
+      struct agent_reqs reqs;
+
+      b = loc->owner;
+      if (!breakpoint_enabled (b)
+	  || b->loc->loc_type != bp_loc_software_breakpoint
+	  || b->loc->address != pc)
+	continue;
+
+      if (b->type != bp_breakpoint
+	  || b->cond == NULL
+	  || b->thread != -1)
+	goto unconditional;
+
+      TRY_CATCH (e, RETURN_MASK_ERROR)
+	{
+	  aexpr = gen_eval_for_expr (pc, b->cond);
+	}
+      if (e.reason < 0)
+	goto unconditional;
+
+      ax_reqs (aexpr, &reqs);
+      xfree (reqs.reg_mask);
+      if (reqs.flaw != agent_flaw_none || reqs.min_height < 0)
+	{
+	  free_agent_expr (aexpr);
+	  goto unconditional;
+	}
+
+      if (count == allocated)
+	{
+	  allocated = allocated ? 2 * allocated : 4;
+	  result = xrealloc (result, allocated * sizeof (*result));
+	}
+      result[count++] = aexpr;
+    }
+
+  *conds = result;
+  return count;
+
+ unconditional:
+  for (i = 0; i < count; i++)
+    free_agent_expr (result[i]);
+  xfree (result);
+  return -1;
+}
+
 /* breakpoint_thread_match (PC, PTID) returns true if the breakpoint at
    PC is valid for process/thread PTID.  */
 
@@ -2088,7 +2411,8 @@ breakpoint_thread_match (CORE_ADDR pc, ptid_t ptid)
 
   thread = pid_to_thread_id (ptid);
 
-  ALL_BP_LOCATIONS (bpt)
+  /* APPLE LOCAL breakpoint location index  */
+  ALL_BP_LOCATIONS_AT (bpt, pc)
     {
       if (bpt->loc_type != bp_loc_software_breakpoint
 	  && bpt->loc_type != bp_loc_hardware_breakpoint)
@@ -3021,6 +3345,43 @@ which its expression is valid.\n");
    target thinks we stopped due to a hardware watchpoint, 0 if we
    know we did not trigger a hardware watchpoint, and -1 if we do not know.  */
 
+/* APPLE LOCAL begin breakpoint location index  */
+/* If the index can tell which breakpoint bpstat_stop_status needs to
+   look at for a stop at BP_ADDR, set *ONLY to it, or to NULL if there
+   isn't one, and return 1.  Return 0 if more than one breakpoint is
+   enabled there, or if some breakpoint might match the stop other than
+   by its address, so that the whole breakpoint chain has to be
+   walked.  */
+
+static int
+bp_location_index_stop_candidate (CORE_ADDR bp_addr,
+				  int stopped_by_watchpoint,
+				  struct breakpoint **only)
+{
+  struct bp_location *loc;
+
+  *only = NULL;
+
+  if (bp_location_index.unstripped > 0)
+    return 0;
+  if (bp_location_index.unaddressed
+      > (stopped_by_watchpoint ? 0 : bp_location_index.hardware_watchpoints))
+    return 0;
+
+  ALL_BP_LOCATIONS_AT (loc, bp_addr)
+    {
+      if (!breakpoint_enabled (loc->owner)
+	  && loc->owner->enable_state != bp_permanent)
+	continue;
+      if (*only != NULL)
+	return 0;
+      *only = loc->owner;
+    }
+
+  return 1;
+}
+/* APPLE LOCAL end breakpoint location index  */
+
 /* Determine whether we stopped at a breakpoint, etc, or whether we
    don't understand this stop.  Result is a chain of bpstat's such that:
 
@@ -3046,8 +3407,18 @@ bpstat_stop_status (CORE_ADDR bp_addr, ptid_t ptid, int stopped_by_watchpoint)
   /* Pointer to the last thing in the chain currently.  */
   bpstat bs = root_bs;
   int thread_id = pid_to_thread_id (ptid);
-
-  ALL_BREAKPOINTS_SAFE (b, temp)
+  /* APPLE LOCAL breakpoint location index  */
+  int use_index;
+
+  /* APPLE LOCAL begin breakpoint location index  */
+  /* Usually the location index can tell us the only breakpoint that
+     could explain this stop; otherwise look at all of them.  */
+  use_index = bp_location_index_stop_candidate (bp_addr,
+						stopped_by_watchpoint, &b);
+  if (!use_index)
+    b = breakpoint_chain;
+  for (; b ? (temp = use_index ? NULL : b->next, 1) : 0; b = temp)
+  /* APPLE LOCAL end breakpoint location index  */
   {
     if (!breakpoint_enabled (b) && b->enable_state != bp_permanent)
       continue;
@@ -3799,6 +4170,11 @@ int
 bpstat_have_active_hw_watchpoints (void)
 {
   struct bp_location *bpt;
+
+  /* APPLE LOCAL breakpoint location index  */
+  if (bp_location_index.hardware_watchpoints == 0)
+    return 0;
+
   ALL_BP_LOCATIONS (bpt)
     if (breakpoint_enabled (bpt->owner)
 	&& bpt->inserted
@@ -4527,7 +4903,8 @@ check_duplicates (struct breakpoint *bpt)
   if (! breakpoint_address_is_meaningful (bpt))
     return;
 
-  ALL_BP_LOCATIONS (b)
+  /* APPLE LOCAL breakpoint location index  */
+  ALL_BP_LOCATIONS_AT (b, address)
     if (b->owner->enable_state != bp_disabled
 	&& b->owner->enable_state != bp_shlib_disabled
 	&& !b->owner->pending
@@ -4563,7 +4940,8 @@ check_duplicates (struct breakpoint *bpt)
 			_("allegedly permanent breakpoint is not "
 			"actually inserted"));
 
-      ALL_BP_LOCATIONS (b)
+      /* APPLE LOCAL breakpoint location index  */
+      ALL_BP_LOCATIONS_AT (b, address)
 	if (b != perm_bp)
 	  {
 	    if (b->owner->enable_state != bp_disabled
@@ -4718,6 +5096,11 @@ allocate_bp_location (struct breakpoint *bpt, enum bptype bp_type)
       loc_p->next = loc;
     }
 
+  /* APPLE LOCAL begin breakpoint location index  */
+  loc->serial = ++bp_location_serial;
+  bp_location_index_add (loc);
+  /* APPLE LOCAL end breakpoint location index  */
+
   return loc;
 }
 
@@ -4777,8 +5160,10 @@ set_raw_breakpoint (struct symtab_and_line sal, enum bptype bptype, int pending_
   memset (b, 0, sizeof (*b));
   b->loc = allocate_bp_location (b, bptype);
   b->loc->requested_address = sal.pc;
-  b->loc->address = adjust_breakpoint_address (b->loc->requested_address,
-                                               bptype);
+  /* APPLE LOCAL breakpoint location index  */
+  bp_location_set_address (b->loc,
+			   adjust_breakpoint_address (b->loc->requested_address,
+						      bptype));
   if (sal.symtab == NULL)
     b->source_file = NULL;
   else
@@ -5488,8 +5873,10 @@ set_longjmp_resume_breakpoint (CORE_ADDR pc, struct frame_id frame_id)
     if (b->type == bp_longjmp_resume)
     {
       b->loc->requested_address = pc;
-      b->loc->address = adjust_breakpoint_address (b->loc->requested_address,
-                                                   b->type);
+      /* APPLE LOCAL breakpoint location index  */
+      bp_location_set_address (b->loc,
+			       adjust_breakpoint_address (b->loc->requested_address,
+							  b->type));
       b->enable_state = bp_enabled;
       b->frame_id = frame_id;
       check_duplicates (b);
@@ -9061,6 +9448,9 @@ delete_breakpoint (struct breakpoint *bpt)
 	break;
       }
 
+  /* APPLE LOCAL breakpoint location index  */
+  bp_location_index_remove (bpt->loc);
+
   check_duplicates (bpt);
   /* If this breakpoint was inserted, and there is another breakpoint
      at the same address, we need to insert the other breakpoint.  */
@@ -10731,7 +11121,9 @@ breakpoints_relocate (struct objfile *objfile, struct section_offsets *delta)
   {
     if (b->bp_objfile == objfile)
       {
-	b->loc->address += ANOFFSET (delta, SECT_OFF_TEXT (objfile));
+	/* APPLE LOCAL breakpoint location index  */
+	bp_location_set_address (b->loc, b->loc->address
+				 + ANOFFSET (delta, SECT_OFF_TEXT (objfile)));
 	b->loc->requested_address += ANOFFSET (delta, SECT_OFF_TEXT (objfile));
       }
   }
@@ -30,6 +30,7 @@
 
 struct value;
 struct block;
+struct agent_expr;
 
 /* This is the maximum number of bytes a breakpoint instruction can take.
    Feel free to increase it.  It's just used in a few places to size
@@ -270,6 +271,20 @@ struct bp_location
      which to place the breakpoint in order to comply with a
      processor's architectual constraints.  */
   CORE_ADDR requested_address;
+
+  /* APPLE LOCAL begin breakpoint location index  */
+  /* Next location in the same bucket of the address index.  */
+  struct bp_location *next_in_bucket;
+
+  /* The order in which this location was allocated.  Locations are
+     only ever added at the end of the chain, so this is also the
+     order of the chain.  */
+  unsigned int serial;
+
+  /* Nonzero if the architecture strips some bits off ADDRESS when
+     comparing it with the pc.  */
+  char unstripped_address;
+  /* APPLE LOCAL end breakpoint location index  */
 };
 
 /* This structure is a collection of function pointers that, if available,
@@ -687,6 +702,8 @@ extern int breakpoint_inserted_here_p (CORE_ADDR);
 
 extern int software_breakpoint_inserted_here_p (CORE_ADDR);
 
+extern int breakpoint_conditions_at (CORE_ADDR, struct agent_expr ***);
+
 /* APPLE LOCAL begin breakpoint MI */
 extern struct breakpoint *find_breakpoint (int);
 extern void breakpoint_print_commands (struct ui_out *, struct breakpoint *);
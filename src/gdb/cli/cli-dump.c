@@ -32,6 +32,15 @@
 #include <ctype.h>
 #include "target.h"
 #include "readline/readline.h"
+/* APPLE LOCAL begin streaming dump and restore */
+#include "gdbcore.h"
+#include <sys/time.h>
+#include <errno.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <signal.h>
+#endif
+/* APPLE LOCAL end streaming dump and restore */
 
 #define XMALLOC(TYPE) ((TYPE*) xmalloc (sizeof (TYPE)))
 
@@ -228,6 +237,307 @@ dump_bfd_file (const char *filename, const char *mode,
   bfd_set_section_contents (obfd, osection, buf, 0, len);
 }
 
+/* APPLE LOCAL begin streaming dump and restore */
+/* Memory is dumped and restored in chunks of this many bytes, so that
+   neither needs a buffer as big as the whole range.  */
+#define DUMP_CHUNK_SIZE (1024 * 1024)
+
+/* A read or write of one chunk of a file.  Where threads are
+   available it runs on a thread of its own, so that it overlaps the
+   transfer of the next chunk from the target, or of the previous one
+   to it.  The thread only calls fread or fwrite: no xmalloc, no
+   error.  */
+
+struct file_chunk_io
+{
+  FILE *file;
+  int writing;
+  gdb_byte *buf;
+  size_t len;
+
+  /* The number of bytes transferred, and errno if that falls short.  */
+  size_t done;
+  int err;
+
+  /* Set while a thread is doing the transfer.  */
+  int running;
+#ifdef HAVE_PTHREAD_H
+  pthread_t thread;
+#endif
+};
+
+static void *
+file_chunk_io_run (void *arg)
+{
+  struct file_chunk_io *io = arg;
+
+  errno = 0;
+  if (io->writing)
+    io->done = fwrite (io->buf, 1, io->len, io->file);
+  else
+    io->done = fread (io->buf, 1, io->len, io->file);
+  io->err = errno;
+  return NULL;
+}
+
+/* Start transferring the LEN bytes at BUF to or from IO's file.  */
+
+static void
+file_chunk_io_start (struct file_chunk_io *io, gdb_byte *buf, size_t len)
+{
+  gdb_assert (!io->running);
+
+  io->buf = buf;
+  io->len = len;
+#ifdef HAVE_PTHREAD_H
+  {
+    sigset_t all_signals, old_signals;
+    int ret;
+
+    /* The thread inherits the signal mask.  Start it with every signal
+       blocked, so that SIGINT, SIGCHLD and the rest still go to GDB's
+       own thread and its handlers.  */
+    sigfillset (&all_signals);
+    pthread_sigmask (SIG_SETMASK, &all_signals, &old_signals);
+    ret = pthread_create (&io->thread, NULL, file_chunk_io_run, io);
+    pthread_sigmask (SIG_SETMASK, &old_signals, NULL);
+    if (ret == 0)
+      {
+	io->running = 1;
+	return;
+      }
+  }
+#endif
+  file_chunk_io_run (io);
+}
+
+/* Wait for the transfer IO is doing to finish.  */
+
+static void
+file_chunk_io_join (struct file_chunk_io *io)
+{
+#ifdef HAVE_PTHREAD_H
+  if (io->running)
+    pthread_join (io->thread, NULL);
+#endif
+  io->running = 0;
+}
+
+/* Wait for the transfer IO is doing, and report an error against
+   FILENAME if it fell short.  */
+
+static void
+file_chunk_io_finish (struct file_chunk_io *io, const char *filename)
+{
+  file_chunk_io_join (io);
+  if (io->done != io->len)
+    {
+      if (io->err == 0)
+	error (_("Unexpected end of file %s."), filename);
+      errno = io->err;
+      perror_with_name (filename);
+    }
+}
+
+/* A cleanup which waits for any transfer still under way, so that its
+   buffer and file outlive it.  It must run before they are freed.  */
+
+static void
+file_chunk_io_cleanup (void *arg)
+{
+  file_chunk_io_join (arg);
+}
+
+/* Progress through a dump or restore, which moves one or more parts
+   (the range dumped, or each section restored) a chunk at a time.  */
+
+struct dump_progress
+{
+  const char *verb;
+
+  /* The size of the current part, and how much of it is done.  */
+  ULONGEST part_total;
+  ULONGEST part_done;
+  int last_tenth;
+
+  /* Totals for all the parts, for print_transfer_performance.  */
+  ULONGEST done;
+  unsigned long chunks;
+  struct timeval start_time;
+};
+
+static void
+dump_progress_start (struct dump_progress *progress, const char *verb)
+{
+  memset (progress, 0, sizeof (*progress));
+  progress->verb = verb;
+  gettimeofday (&progress->start_time, NULL);
+}
+
+/* Start a part of TOTAL bytes.  */
+
+static void
+dump_progress_part (struct dump_progress *progress, ULONGEST total)
+{
+  progress->part_total = total;
+  progress->part_done = 0;
+  progress->last_tenth = 0;
+}
+
+/* Count LEN more bytes done.  When a part takes more than one chunk,
+   say how far along it is every tenth of the way.  */
+
+static void
+dump_progress_update (struct dump_progress *progress, ULONGEST len)
+{
+  int tenth;
+
+  progress->part_done += len;
+  progress->done += len;
+  progress->chunks++;
+
+  if (progress->part_total <= DUMP_CHUNK_SIZE)
+    return;
+
+  tenth = (progress->part_done / (double) progress->part_total) * 10;
+  if (tenth > progress->last_tenth)
+    {
+      progress->last_tenth = tenth;
+      printf_filtered (_("%s 0x%s of 0x%s bytes (%d%%).\n"),
+		       progress->verb, paddr_nz (progress->part_done),
+		       paddr_nz (progress->part_total), tenth * 10);
+      gdb_flush (gdb_stdout);
+    }
+}
+
+static void
+dump_progress_finish (struct dump_progress *progress)
+{
+  struct timeval end_time;
+
+  gettimeofday (&end_time, NULL);
+  print_transfer_performance (gdb_stdout, progress->done, progress->chunks,
+			      &progress->start_time, &end_time);
+}
+
+/* Read the SIZE bytes of target memory at ADDR into BUF, or report a
+   memory error.  */
+
+static void
+dump_read_memory (CORE_ADDR addr, gdb_byte *buf, size_t size)
+{
+  int status = target_read_memory (addr, buf, size);
+
+  if (status != 0)
+    memory_error (status, addr);
+}
+
+/* Write the COUNT bytes of target memory at LO to FILENAME as raw
+   binary, a chunk at a time.  While one chunk is written to the file,
+   the next is read from the target.  */
+
+static void
+dump_memory_to_binary_file (const char *filename, const char *mode,
+			    CORE_ADDR lo, ULONGEST count)
+{
+  struct cleanup *old_cleanups = make_cleanup (null_cleanup, NULL);
+  struct file_chunk_io io;
+  struct dump_progress progress;
+  gdb_byte *bufs[2];
+  size_t chunk = min (count, (ULONGEST) DUMP_CHUNK_SIZE);
+  size_t len;
+  ULONGEST offset;
+  int cur = 0;
+
+  memset (&io, 0, sizeof (io));
+  io.file = fopen_with_cleanup (filename, mode);
+  io.writing = 1;
+  bufs[0] = xmalloc (chunk);
+  make_cleanup (xfree, bufs[0]);
+  bufs[1] = xmalloc (chunk);
+  make_cleanup (xfree, bufs[1]);
+  make_cleanup (file_chunk_io_cleanup, &io);
+
+  dump_progress_start (&progress, "Dumped");
+  dump_progress_part (&progress, count);
+
+  offset = 0;
+  len = chunk;
+  dump_read_memory (lo, bufs[cur], len);
+  while (len > 0)
+    {
+      ULONGEST next_offset = offset + len;
+      size_t next_len = min (count - next_offset, (ULONGEST) chunk);
+
+      file_chunk_io_start (&io, bufs[cur], len);
+      if (next_len > 0)
+	dump_read_memory (lo + next_offset, bufs[!cur], next_len);
+      file_chunk_io_finish (&io, filename);
+
+      dump_progress_update (&progress, len);
+      QUIT;
+
+      offset = next_offset;
+      len = next_len;
+      cur = !cur;
+    }
+
+  do_cleanups (old_cleanups);
+  dump_progress_finish (&progress);
+}
+
+/* Write the COUNT bytes of target memory at LO to FILENAME as a
+   one-section bfd in FILE_FORMAT, handing them to bfd a chunk at a
+   time.  */
+
+static void
+dump_memory_to_bfd_file (const char *filename, const char *mode,
+			 const char *file_format, CORE_ADDR lo,
+			 ULONGEST count)
+{
+  struct cleanup *old_cleanups = make_cleanup (null_cleanup, NULL);
+  struct dump_progress progress;
+  bfd *obfd;
+  asection *osection;
+  gdb_byte *buf;
+  size_t chunk = min (count, (ULONGEST) DUMP_CHUNK_SIZE);
+  ULONGEST offset;
+
+  obfd = bfd_openw_with_cleanup (filename, file_format, mode);
+  osection = bfd_make_section_anyway (obfd, ".newsec");
+  bfd_set_section_size (obfd, osection, count);
+  bfd_set_section_vma (obfd, osection, lo);
+  bfd_set_section_alignment (obfd, osection, 0);
+  bfd_set_section_flags (obfd, osection, (SEC_HAS_CONTENTS
+					  | SEC_ALLOC
+					  | SEC_LOAD));
+  osection->entsize = 0;
+
+  buf = xmalloc (chunk);
+  make_cleanup (xfree, buf);
+
+  dump_progress_start (&progress, "Dumped");
+  dump_progress_part (&progress, count);
+
+  for (offset = 0; offset < count; offset += chunk)
+    {
+      size_t len = min (count - offset, (ULONGEST) chunk);
+
+      dump_read_memory (lo + offset, buf, len);
+      if (!bfd_set_section_contents (obfd, osection, buf, offset, len))
+	error (_("Failed to write %s: %s."), filename,
+	       bfd_errmsg (bfd_get_error ()));
+
+      dump_progress_update (&progress, len);
+      QUIT;
+    }
+
+  /* This closes the bfd, and so writes the file.  */
+  do_cleanups (old_cleanups);
+  dump_progress_finish (&progress);
+}
+/* APPLE LOCAL end streaming dump and restore */
+
 static void
 dump_memory_to_file (char *cmd, char *mode, char *file_format)
 {
@@ -236,7 +546,6 @@ dump_memory_to_file (char *cmd, char *mode, char *file_format)
   CORE_ADDR hi;
   ULONGEST count;
   char *filename;
-  void *buf;
   char *lo_exp;
   char *hi_exp;
 
@@ -259,21 +568,13 @@ dump_memory_to_file (char *cmd, char *mode, char *file_format)
     error (_("Invalid memory address range (start >= end)."));
   count = hi - lo;
 
-  /* FIXME: Should use read_memory_partial() and a magic blocking
-     value.  */
-  buf = xmalloc (count);
-  make_cleanup (xfree, buf);
-  target_read_memory (lo, buf, count);
-  
-  /* Have everything.  Open/write the data.  */
+  /* APPLE LOCAL begin streaming dump and restore */
+  /* Open the file and copy the memory to it a chunk at a time.  */
   if (file_format == NULL || strcmp (file_format, "binary") == 0)
-    {
-      dump_binary_file (filename, mode, buf, count);
-    }
+    dump_memory_to_binary_file (filename, mode, lo, count);
   else
-    {
-      dump_bfd_file (filename, mode, file_format, lo, buf, count);
-    }
+    dump_memory_to_bfd_file (filename, mode, file_format, lo, count);
+  /* APPLE LOCAL end streaming dump and restore */
 
   do_cleanups (old_cleanups);
 }
@@ -448,8 +749,23 @@ struct callback_data {
   unsigned long load_offset;
   CORE_ADDR load_start;
   CORE_ADDR load_end;
+  /* APPLE LOCAL streaming dump and restore */
+  struct dump_progress progress;
 };
 
+/* APPLE LOCAL begin streaming dump and restore */
+/* The size of the chunks restore reads and writes.  */
+
+static size_t
+restore_chunk_size (void)
+{
+  if (g_max_binary_file_chunk > 0
+      && g_max_binary_file_chunk < DUMP_CHUNK_SIZE)
+    return g_max_binary_file_chunk;
+  return DUMP_CHUNK_SIZE;
+}
+/* APPLE LOCAL end streaming dump and restore */
+
 /* Function: restore_section_callback.
 
    Callback function for bfd_map_over_sections.
@@ -467,6 +783,11 @@ restore_section_callback (bfd *ibfd, asection *isec, void *args)
   struct cleanup *old_chain;
   gdb_byte *buf;
   int ret;
+  /* APPLE LOCAL begin streaming dump and restore */
+  bfd_size_type chunk;
+  bfd_size_type done;
+  CORE_ADDR addr;
+  /* APPLE LOCAL end streaming dump and restore */
 
   /* Ignore non-loadable sections, eg. from elf files. */
   if (!(bfd_get_section_flags (ibfd, isec) & SEC_LOAD))
@@ -492,12 +813,12 @@ restore_section_callback (bfd *ibfd, asection *isec, void *args)
   if (data->load_end > 0 && sec_end > data->load_end)
     sec_load_count -= sec_end - data->load_end;
 
-  /* Get the data.  */
-  buf = xmalloc (size);
+  /* APPLE LOCAL begin streaming dump and restore */
+  /* Only a chunk of the data is held at a time.  */
+  chunk = min (sec_load_count, (bfd_size_type) restore_chunk_size ());
+  buf = xmalloc (chunk);
   old_chain = make_cleanup (xfree, buf);
-  if (!bfd_get_section_contents (ibfd, isec, buf, 0, size))
-    error (_("Failed to read bfd file %s: '%s'."), bfd_get_filename (ibfd), 
-	   bfd_errmsg (bfd_get_error ()));
+  /* APPLE LOCAL end streaming dump and restore */
 
   printf_filtered ("Restoring section %s (0x%lx to 0x%lx)",
 		   bfd_section_name (ibfd, isec), 
@@ -513,24 +834,71 @@ restore_section_callback (bfd *ibfd, asection *isec, void *args)
   else
     puts_filtered ("\n");
 
-  /* Write the data.  */
-  ret = target_write_memory (sec_start + sec_offset + data->load_offset, 
-			     buf + sec_offset, sec_load_count);
-  if (ret != 0)
-    warning (_("restore: memory write failed (%s)."), safe_strerror (ret));
+  /* APPLE LOCAL begin streaming dump and restore */
+  /* Copy the data a chunk at a time.  */
+  dump_progress_part (&data->progress, sec_load_count);
+  addr = sec_start + sec_offset + data->load_offset;
+  for (done = 0; done < sec_load_count; done += chunk)
+    {
+      bfd_size_type len = min (sec_load_count - done, chunk);
+
+      if (!bfd_get_section_contents (ibfd, isec, buf, sec_offset + done, len))
+	error (_("Failed to read bfd file %s: '%s'."),
+	       bfd_get_filename (ibfd), bfd_errmsg (bfd_get_error ()));
+
+      ret = target_write_memory (addr + done, buf, len);
+      if (ret != 0)
+	{
+	  warning (_("restore: memory write failed (%s)."),
+		   safe_strerror (ret));
+	  break;
+	}
+
+      dump_progress_update (&data->progress, len);
+      QUIT;
+    }
+  /* APPLE LOCAL end streaming dump and restore */
   do_cleanups (old_chain);
   return;
 }
 
 /* APPLE LOCAL BEGIN: segment binary file downloads  */
 
+/* Write the LEN bytes at BUF to the target at ADDR, trying again once
+   if the write fails.  */
+
+static void
+restore_binary_chunk (CORE_ADDR addr, gdb_byte *buf, size_t len)
+{
+  int max_errors = 2;
+
+  while (max_errors > 0)
+    {
+      if (target_write_memory (addr, buf, len) == 0)
+	return;
+      warning ("restore: memory write failed - retrying.");
+      max_errors--;
+    }
+  error ("restore: memory write failed.");
+}
+
+/* APPLE LOCAL: Restore the binary file a chunk at a time, reading the
+   next chunk from the file while the current one is written to the
+   target.  */
+
 static void
 restore_binary_file (char *filename, struct callback_data *data)
 {
   FILE *file = fopen_with_cleanup (filename, FOPEN_RB);
-  gdb_byte *buf;
-  int len, total_file_bytes;
-  int bytes_to_read_from_file;
+  struct cleanup *old_cleanups;
+  struct file_chunk_io io;
+  gdb_byte *bufs[2];
+  long total_file_bytes;
+  long bytes_to_read_from_file;
+  size_t chunk;
+  size_t len;
+  CORE_ADDR addrp;
+  int cur = 0;
 
   /* Get the file size for reading.  */
   if (fseek (file, 0, SEEK_END) == 0) 
@@ -561,50 +929,48 @@ restore_binary_file (char *filename, struct callback_data *data)
   if (fseek (file, data->load_start, SEEK_SET) != 0)
     perror_with_name (filename);
 
-  if (bytes_to_read_from_file > g_max_binary_file_chunk)
-    len = g_max_binary_file_chunk;
-  else
-    len = bytes_to_read_from_file;
+  chunk = min (bytes_to_read_from_file, (long) restore_chunk_size ());
 
-  buf = xmalloc (len);
-  make_cleanup (xfree, buf);
+  memset (&io, 0, sizeof (io));
+  io.file = file;
+  io.writing = 0;
+  bufs[0] = xmalloc (chunk);
+  old_cleanups = make_cleanup (xfree, bufs[0]);
+  bufs[1] = xmalloc (chunk);
+  make_cleanup (xfree, bufs[1]);
+  make_cleanup (file_chunk_io_cleanup, &io);
+
+  dump_progress_part (&data->progress, bytes_to_read_from_file);
+
+  addrp = data->load_start + data->load_offset;
+  len = chunk;
+  file_chunk_io_start (&io, bufs[cur], len);
+  file_chunk_io_finish (&io, filename);
 
-  CORE_ADDR addrp = data->load_start + data->load_offset;
   /* BYTES_TO_READ_FROM_FILE decreases each time through this loop;
-     we read g_max_binary_file_chunk or less bytes at each iteration.  */
-  while (bytes_to_read_from_file > 0)
+     we read CHUNK or fewer bytes at each iteration.  */
+  while (len > 0)
     {
-      /* The last chunk we'll be reading -- at this point our LEN buffer
-         is larger than the remaining number of bytes to be read; cap it
-         so we don't read off the end of the file. */
-      if (len > bytes_to_read_from_file)
-        len = bytes_to_read_from_file;
-
-      if (fread (buf, 1, len, file) != len)
-	perror_with_name (filename);
-    
-      int max_errors = 2;
-      while (max_errors > 0)
-        {
-           printf_unfiltered ("Writing 0x%s bytes to 0x%s\n", paddr_nz (len),
-			      paddr_nz (addrp));
-           gdb_flush (gdb_stdout);
-           if (target_write_memory (addrp, buf, len) == 0)
-             {
-               addrp += len;
-               break;
-             }
-           else
-             {
-	       warning ("restore: memory write failed - retrying.");
-               max_errors--;
-             }
-        }
-      if (max_errors == 0)
-        error ("restore: memory write failed.");
+      size_t next_len;
 
       bytes_to_read_from_file -= len;
+      next_len = min (bytes_to_read_from_file, (long) chunk);
+
+      if (next_len > 0)
+	file_chunk_io_start (&io, bufs[!cur], next_len);
+      restore_binary_chunk (addrp, bufs[cur], len);
+      if (next_len > 0)
+	file_chunk_io_finish (&io, filename);
+
+      addrp += len;
+      dump_progress_update (&data->progress, len);
+      QUIT;
+
+      len = next_len;
+      cur = !cur;
     }
+
+  do_cleanups (old_cleanups);
 }
 
 /* APPLE LOCAL END: segment binary file downloads  */
@@ -623,6 +989,8 @@ restore_command (char *args, int from_tty)
   data.load_offset = 0;
   data.load_start  = 0;
   data.load_end    = 0;
+  /* APPLE LOCAL streaming dump and restore */
+  dump_progress_start (&data.progress, "Restored");
 
   /* Parse the input arguments.  First is filename (required). */
   filename = scan_filename_with_cleanup (&args, NULL);
@@ -674,6 +1042,8 @@ restore_command (char *args, int from_tty)
       /* Process the sections. */
       bfd_map_over_sections (ibfd, restore_section_callback, &data);
     }
+  /* APPLE LOCAL streaming dump and restore */
+  dump_progress_finish (&data.progress);
   return;
 }
 
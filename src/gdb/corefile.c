@@ -221,7 +221,7 @@ reopen_exec_file (void)
       /* APPLE LOCAL begin hooks */
       tell_breakpoints_objfile_changed (NULL);
       /* APPLE LOOCAL cache lookup values for improved performance  */
-      symtab_clear_cached_lookup_values ();
+      objfile_generation++;
       tell_objc_msgsend_cacher_objfile_changed (NULL);
       /* APPLE LOCAL end hooks */
     }
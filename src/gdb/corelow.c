@@ -47,6 +47,13 @@
 #include "gdb_assert.h"
 #include "exceptions.h"
 #include "solib.h"
+#include "gcore.h"
+#include "gdb_stat.h"
+
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+
 /* APPLE LOCAL - subroutine inlining  */
 #include "inlining."
 
@@ -216,6 +223,8 @@ core_close (int quitting)
 #endif
 
       name = bfd_get_filename (core_bfd);
+      /* APPLE LOCAL section index */
+      section_table_unmap_bfd (core_bfd);
       if (!bfd_close (core_bfd))
 	warning (_("cannot close \"%s\": %s"),
 		 name, bfd_errmsg (bfd_get_error ()));
@@ -278,6 +287,249 @@ add_to_thread_list (bfd *abfd, asection *asect, void *reg_sect_arg)
     inferior_ptid = pid_to_ptid (thread_id);	/* Yes, make it current */
 }
 
+/* APPLE LOCAL begin compressed core files */
+#ifdef HAVE_ZLIB_H
+/* An open compressed core file, as written by "gcore -z".  We keep
+   the most recently used chunk decompressed.  */
+
+struct compressed_core
+{
+  int fd;
+  unsigned int chunk_size;
+  ULONGEST size;
+  ULONGEST nchunks;
+
+  /* File offsets of the chunks, and of the end of the last one.  */
+  ULONGEST *offsets;
+
+  /* The decompressed chunk, and its number, or -1 if none.  */
+  gdb_byte *chunk;
+  LONGEST chunk_number;
+};
+
+/* Return the LEN-byte little-endian number at BUF.  */
+
+static ULONGEST
+compressed_core_get (const gdb_byte *buf, int len)
+{
+  ULONGEST val = 0;
+
+  while (len-- > 0)
+    val = (val << 8) | buf[len];
+  return val;
+}
+
+/* Read LEN bytes at OFFSET in FD into BUF.  Return zero on
+   failure.  */
+
+static int
+compressed_core_read (int fd, ULONGEST offset, void *buf, size_t len)
+{
+  return (lseek (fd, (off_t) offset, SEEK_SET) != (off_t) -1
+	  && read (fd, buf, len) == len);
+}
+
+static void
+compressed_core_free (struct compressed_core *cc)
+{
+  close (cc->fd);
+  xfree (cc->offsets);
+  xfree (cc->chunk);
+  xfree (cc);
+}
+
+/* Open FILENAME and read its header and index.  Return NULL if it
+   isn't a compressed core file.  */
+
+static struct compressed_core *
+compressed_core_open (const char *filename)
+{
+  struct compressed_core *cc;
+  gdb_byte header[GCORE_Z_HEADER_SIZE];
+  gdb_byte *index;
+  ULONGEST index_offset;
+  ULONGEST i;
+  struct stat st;
+  int fd;
+
+  fd = open (filename, O_RDONLY | O_BINARY | O_LARGEFILE, 0);
+  if (fd < 0)
+    return NULL;
+  if (!compressed_core_read (fd, 0, header, sizeof (header))
+      || memcmp (header, GCORE_Z_MAGIC, GCORE_Z_MAGIC_SIZE) != 0)
+    {
+      close (fd);
+      return NULL;
+    }
+  if (compressed_core_get (header + 8, 4) != GCORE_Z_VERSION)
+    {
+      close (fd);
+      error (_("\"%s\" is a compressed core file of an unknown version."),
+	     filename);
+    }
+
+  cc = XZALLOC (struct compressed_core);
+  cc->fd = fd;
+  cc->chunk_size = compressed_core_get (header + 12, 4);
+  cc->size = compressed_core_get (header + 16, 8);
+  index_offset = compressed_core_get (header + 24, 8);
+  cc->chunk_number = -1;
+
+  /* Check the header against the length of the file before trusting
+     it with any allocation: the index, which comes last, must fit
+     between INDEX_OFFSET and the end of the file, and every chunk
+     must lie between the header and the index.  */
+  if (fstat (fd, &st) != 0
+      || cc->chunk_size == 0
+      || cc->chunk_size > GCORE_Z_MAX_CHUNK_SIZE
+      || index_offset < GCORE_Z_HEADER_SIZE
+      || index_offset > (ULONGEST) st.st_size)
+    goto invalid;
+  cc->nchunks = (cc->size / cc->chunk_size
+		 + (cc->size % cc->chunk_size != 0));
+  if (cc->nchunks >= ((ULONGEST) st.st_size - index_offset) / 8)
+    goto invalid;
+
+  index = xmalloc ((cc->nchunks + 1) * 8);
+  if (!compressed_core_read (fd, index_offset, index, (cc->nchunks + 1) * 8))
+    {
+      xfree (index);
+      goto invalid;
+    }
+  cc->offsets = xmalloc ((cc->nchunks + 1) * sizeof (ULONGEST));
+  for (i = 0; i <= cc->nchunks; i++)
+    {
+      cc->offsets[i] = compressed_core_get (index + i * 8, 8);
+      if (cc->offsets[i] < (i == 0 ? GCORE_Z_HEADER_SIZE : cc->offsets[i - 1])
+	  || cc->offsets[i] > index_offset)
+	{
+	  xfree (index);
+	  goto invalid;
+	}
+    }
+  xfree (index);
+  cc->chunk = xmalloc (cc->chunk_size);
+
+  return cc;
+
+ invalid:
+  compressed_core_free (cc);
+  error (_("\"%s\" is not a valid compressed core file."), filename);
+}
+
+/* Decompress chunk NUMBER of CC into CC->chunk, unless it's already
+   there.  Return zero on failure.  */
+
+static int
+compressed_core_load_chunk (struct compressed_core *cc, ULONGEST number)
+{
+  ULONGEST zsize = cc->offsets[number + 1] - cc->offsets[number];
+  uLongf len = cc->chunk_size;
+  gdb_byte *zbuf;
+  int ok;
+
+  if (cc->chunk_number == (LONGEST) number)
+    return 1;
+  cc->chunk_number = -1;
+
+  /* A chunk of zeros is stored as nothing.  */
+  if (zsize == 0)
+    {
+      memset (cc->chunk, 0, cc->chunk_size);
+      cc->chunk_number = number;
+      return 1;
+    }
+
+  zbuf = xmalloc (zsize);
+  ok = (compressed_core_read (cc->fd, cc->offsets[number], zbuf, zsize)
+	&& uncompress (cc->chunk, &len, zbuf, zsize) == Z_OK);
+  xfree (zbuf);
+  if (ok)
+    cc->chunk_number = number;
+  return ok;
+}
+
+/* The BFD iovec methods for a compressed core file.  */
+
+static void *
+compressed_core_bfd_open (struct bfd *abfd, void *closure)
+{
+  return closure;
+}
+
+static file_ptr
+compressed_core_bfd_pread (struct bfd *abfd, void *stream, void *buf,
+			   file_ptr nbytes, file_ptr offset)
+{
+  struct compressed_core *cc = stream;
+  file_ptr done = 0;
+
+  while (done < nbytes && (ULONGEST) (offset + done) < cc->size)
+    {
+      ULONGEST pos = offset + done;
+      ULONGEST number = pos / cc->chunk_size;
+      ULONGEST start = pos - number * cc->chunk_size;
+      ULONGEST len = cc->chunk_size - start;
+
+      if (len > nbytes - done)
+	len = nbytes - done;
+      if (len > cc->size - pos)
+	len = cc->size - pos;
+
+      if (!compressed_core_load_chunk (cc, number))
+	{
+	  bfd_set_error (bfd_error_system_call);
+	  return -1;
+	}
+      memcpy ((gdb_byte *) buf + done, cc->chunk + start, len);
+      done += len;
+    }
+
+  return done;
+}
+
+static int
+compressed_core_bfd_close (struct bfd *abfd, void *stream)
+{
+  compressed_core_free (stream);
+  return 0;
+}
+#endif /* HAVE_ZLIB_H */
+
+/* If FILENAME is a compressed core file, return a BFD that reads it,
+   decompressing only the chunks that are asked for.  Otherwise return
+   NULL.  */
+
+static bfd *
+compressed_core_bfd (const char *filename)
+{
+#ifdef HAVE_ZLIB_H
+  struct compressed_core *cc;
+  bfd *abfd;
+
+  cc = compressed_core_open (filename);
+  if (cc == NULL)
+    return NULL;
+  if (write_files)
+    {
+      compressed_core_free (cc);
+      error (_("\"%s\" is a compressed core file, which can't be written."),
+	     filename);
+    }
+
+  abfd = bfd_openr_iovec (filename, gnutarget,
+			  compressed_core_bfd_open, cc,
+			  compressed_core_bfd_pread,
+			  compressed_core_bfd_close);
+  if (abfd == NULL)
+    compressed_core_free (cc);
+  return abfd;
+#else
+  return NULL;
+#endif
+}
+/* APPLE LOCAL end compressed core files */
+
 /* This routine opens and sets up the core file bfd.  */
 
 static void
@@ -291,6 +543,8 @@ core_open (char *filename, int from_tty)
   int ontop;
   int scratch_chan;
   int flags;
+  /* APPLE LOCAL compressed core files */
+  int compressed;
 
   target_preopen (from_tty);
   if (!filename)
@@ -311,20 +565,26 @@ core_open (char *filename, int from_tty)
 
   old_chain = make_cleanup (xfree, filename);
 
-  flags = O_BINARY | O_LARGEFILE;
-  if (write_files)
-    flags |= O_RDWR;
-  else
-    flags |= O_RDONLY;
-  scratch_chan = open (filename, flags, 0);
-  if (scratch_chan < 0)
-    perror_with_name (filename);
-
-  temp_bfd = bfd_fopen (filename, gnutarget, 
-			write_files ? FOPEN_RUB : FOPEN_RB,
-			scratch_chan);
+  /* APPLE LOCAL: Read "gcore -z" files through the decompressor.  */
+  temp_bfd = compressed_core_bfd (filename);
+  compressed = (temp_bfd != NULL);
   if (temp_bfd == NULL)
-    perror_with_name (filename);
+    {
+      flags = O_BINARY | O_LARGEFILE;
+      if (write_files)
+	flags |= O_RDWR;
+      else
+	flags |= O_RDONLY;
+      scratch_chan = open (filename, flags, 0);
+      if (scratch_chan < 0)
+	perror_with_name (filename);
+
+      temp_bfd = bfd_fopen (filename, gnutarget, 
+			    write_files ? FOPEN_RUB : FOPEN_RB,
+			    scratch_chan);
+      if (temp_bfd == NULL)
+	perror_with_name (filename);
+    }
 
   if (!bfd_check_format (temp_bfd, bfd_core) &&
       !gdb_check_format (temp_bfd))
@@ -364,6 +624,11 @@ core_open (char *filename, int from_tty)
     error (_("\"%s\": Can't find sections: %s"),
 	   bfd_get_filename (core_bfd), bfd_errmsg (bfd_get_error ()));
 
+  /* APPLE LOCAL: Serve memory reads straight from a mapping of the
+     core file, unless it has to be decompressed or written.  */
+  if (!compressed && !write_files)
+    section_table_map_bfd (core_bfd);
+
   /* If we have no exec file, try to set the architecture from the
      core file.  We don't do this unconditionally since an exec file
      typically contains more information that helps us determine the
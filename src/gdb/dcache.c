@@ -94,9 +94,9 @@
    region defined for the .data segment. */
 
 /* This value regulates the number of cache blocks stored.
-   Smaller values reduce the time spent searching for a cache
-   line, and reduce memory requirements, but increase the risk
-   of a line not being in memory */
+   Smaller values reduce memory requirements, but increase the risk
+   of a line not being in memory.  It is the default for the
+   "dcache-size" setting.  */
 
 #define DCACHE_SIZE 64
 
@@ -110,6 +110,10 @@
 #define LINE_SIZE_POWER (6)
 #define LINE_SIZE (1 << LINE_SIZE_POWER)
 
+/* Default number of lines read ahead of a sequential scan.  */
+
+#define DCACHE_READAHEAD 4
+
 /* APPLE LOCAL: The size of the cache used to be fixed by the LINE_SIZE define.
    We made it settable.  The set variable is the line power, since this wants
    the cache to be a power of 2.  The setter function will take care of setting
@@ -118,6 +122,16 @@
 static int g_line_power = LINE_SIZE_POWER;
 static int g_line_size = LINE_SIZE;
 
+/* The number of lines in each cache, and the number of extra lines
+   to read when a miss continues a sequential scan.  */
+
+static int g_num_lines = DCACHE_SIZE;
+static int g_readahead_lines = DCACHE_READAHEAD;
+
+/* The "dcache-size" setting; copied to g_num_lines once validated.  */
+
+static int g_num_lines_setting = DCACHE_SIZE;
+
 /* Each cache block holds g_line_size bytes of data
    starting at a multiple-of-g_line_size address.  */
 
@@ -132,7 +146,11 @@ static int g_line_size = LINE_SIZE;
 
 struct dcache_block
   {
-    struct dcache_block *p;	/* next in list */
+    /* Neighbours in the LRU list, or the next free block (NEWER).  */
+    struct dcache_block *newer;
+    struct dcache_block *older;
+    /* Next block in the same hash bucket.  */
+    struct dcache_block *hash_next;
     CORE_ADDR addr;		/* Address for which data is recorded.  */
     /* APPLE LOCAL: data and state used to be fixed size.  */
     gdb_byte *data;
@@ -145,35 +163,49 @@ struct dcache_block
   };
 
 
-/* FIXME: dcache_struct used to have a cache_has_stuff field that was
-   used to record whether the cache had been accessed.  This was used
-   to invalidate the cache whenever caching was (re-)enabled (if the
-   cache was disabled and later re-enabled, it could contain stale
-   data).  This was not needed because the cache is write through and
-   the code that enables, disables, and deletes memory region all
-   invalidate the cache.
+/* Lines are found through a hash table indexed by line number, and
+   are kept on a list in least-recently-used order; when the cache is
+   full the least recently used line is written back if necessary and
+   reused.
 
-   This is overkill, since it also invalidates cache lines from
-   unrelated regions.  One way this could be addressed by adding a
-   new function that takes an address and a length and invalidates
-   only those cache lines that match. */
+   The cache is write through and the code that enables, disables, and
+   deletes memory regions invalidates the affected range, so the cache
+   never holds stale data for a region whose caching was turned back
+   on.  */
 
 struct dcache_struct
   {
-    /* free list */
+    /* free list, linked through NEWER */
     struct dcache_block *free_head;
-    struct dcache_block *free_tail;
 
-    /* in use list */
-    struct dcache_block *valid_head;
-    struct dcache_block *valid_tail;
+    /* in use list, from the least to the most recently used line */
+    struct dcache_block *oldest;
+    struct dcache_block *newest;
+
+    /* Valid lines hashed by line number.  HASH_SIZE is a power of 2.  */
+    struct dcache_block **hash;
+    int hash_size;
 
     /* The cache itself. */
     struct dcache_block *the_cache;
     gdb_byte *data_block;
     unsigned char *state_block;
+
+    /* The line following the last one read from the target; a miss
+       there means we are scanning memory sequentially.  */
+    CORE_ADDR next_seq_addr;
+
+    /* Statistics for "info dcache".  */
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    unsigned long target_reads;
+    unsigned long readahead_lines;
   };
 
+#define DCACHE_HASH(dcache, addr) \
+  (((addr) >> g_line_power) & ((dcache)->hash_size - 1))
+
 static struct dcache_block *dcache_hit (DCACHE *dcache, CORE_ADDR addr);
 
 static int dcache_write_line (DCACHE *dcache, struct dcache_block *db);
@@ -211,49 +243,162 @@ void
 dcache_invalidate (DCACHE *dcache)
 {
   int i;
-  dcache->valid_head = 0;
-  dcache->valid_tail = 0;
 
-  dcache->free_head = 0;
-  dcache->free_tail = 0;
+  dcache->oldest = NULL;
+  dcache->newest = NULL;
+  dcache->free_head = NULL;
+  memset (dcache->hash, 0, dcache->hash_size * sizeof (dcache->hash[0]));
 
-  for (i = 0; i < DCACHE_SIZE; i++)
+  for (i = g_num_lines - 1; i >= 0; i--)
     {
       struct dcache_block *db = dcache->the_cache + i;
 
-      if (!dcache->free_head)
-	dcache->free_head = db;
-      else
-	dcache->free_tail->p = db;
-      dcache->free_tail = db;
-      db->p = 0;
+      db->newer = dcache->free_head;
+      db->older = NULL;
+      db->hash_next = NULL;
+      dcache->free_head = db;
     }
 
-  return;
+  dcache->next_seq_addr = 0;
 }
 
-/* If addr is present in the dcache, return the address of the block
-   containing it. */
+/* Unlink DB from the LRU list of DCACHE.  */
+
+static void
+dcache_unlink (DCACHE *dcache, struct dcache_block *db)
+{
+  if (db->older)
+    db->older->newer = db->newer;
+  else
+    dcache->oldest = db->newer;
+
+  if (db->newer)
+    db->newer->older = db->older;
+  else
+    dcache->newest = db->older;
+
+  db->newer = db->older = NULL;
+}
+
+/* Append DB to the LRU list of DCACHE as the most recently used
+   line.  */
+
+static void
+dcache_link_newest (DCACHE *dcache, struct dcache_block *db)
+{
+  db->older = dcache->newest;
+  db->newer = NULL;
+  if (dcache->newest)
+    dcache->newest->newer = db;
+  else
+    dcache->oldest = db;
+  dcache->newest = db;
+}
+
+/* Remove DB from the hash table of DCACHE.  */
+
+static void
+dcache_unhash (DCACHE *dcache, struct dcache_block *db)
+{
+  struct dcache_block **slot = &dcache->hash[DCACHE_HASH (dcache, db->addr)];
+
+  while (*slot != db)
+    slot = &(*slot)->hash_next;
+  *slot = db->hash_next;
+  db->hash_next = NULL;
+}
+
+/* Return the line holding ADDR, or NULL, without touching the LRU
+   order or the statistics.  */
 
 static struct dcache_block *
-dcache_hit (DCACHE *dcache, CORE_ADDR addr)
+dcache_lookup (DCACHE *dcache, CORE_ADDR addr)
 {
   struct dcache_block *db;
 
-  /* Search all cache blocks for one that is at this address.  */
-  db = dcache->valid_head;
+  for (db = dcache->hash[DCACHE_HASH (dcache, addr)]; db; db = db->hash_next)
+    if (db->addr == MASK (addr))
+      return db;
+
+  return NULL;
+}
+
+/* Discard the cached contents of LEN bytes starting at ADDR.  Pending
+   writes in the range are dropped too, but since the cache is write
+   through there never are any between transfers.  */
+
+void
+dcache_invalidate_range (DCACHE *dcache, CORE_ADDR addr, ULONGEST len)
+{
+  struct dcache_block *db, *next;
+  CORE_ADDR first, last;
+
+  if (len == 0)
+    return;
+
+  first = MASK (addr);
+  last = MASK (addr + len - 1);
 
-  while (db)
+  /* For small ranges, probe the hash table for each line; otherwise
+     go over all the valid lines.  */
+  if (last >= first && (last - first) >> g_line_power < g_num_lines)
     {
-      if (MASK (addr) == db->addr)
+      CORE_ADDR a = first;
+
+      while (1)
 	{
-	  db->refs++;
-	  return db;
+	  db = dcache_lookup (dcache, a);
+	  if (db != NULL)
+	    {
+	      dcache_unhash (dcache, db);
+	      dcache_unlink (dcache, db);
+	      db->newer = dcache->free_head;
+	      dcache->free_head = db;
+	    }
+	  if (a == last)
+	    break;
+	  a += g_line_size;
 	}
-      db = db->p;
+      return;
     }
 
-  return NULL;
+  for (db = dcache->oldest; db; db = next)
+    {
+      next = db->newer;
+      if (last >= first
+	  ? (db->addr >= first && db->addr <= last)
+	  : (db->addr >= first || db->addr <= last))
+	{
+	  dcache_unhash (dcache, db);
+	  dcache_unlink (dcache, db);
+	  db->newer = dcache->free_head;
+	  dcache->free_head = db;
+	}
+    }
+}
+
+/* If addr is present in the dcache, return the address of the block
+   containing it, and make it the most recently used line. */
+
+static struct dcache_block *
+dcache_hit (DCACHE *dcache, CORE_ADDR addr)
+{
+  struct dcache_block *db = dcache_lookup (dcache, addr);
+
+  if (db == NULL)
+    {
+      dcache->misses++;
+      return NULL;
+    }
+
+  dcache->hits++;
+  db->refs++;
+  if (db != dcache->newest)
+    {
+      dcache_unlink (dcache, db);
+      dcache_link_newest (dcache, db);
+    }
+  return db;
 }
 
 /* Make sure that anything in this line which needs to
@@ -374,6 +519,7 @@ dcache_read_line (DCACHE *dcache, struct dcache_block *db)
 	  continue;
 	}
       
+      dcache->target_reads++;
       res = target_read (&current_target, TARGET_OBJECT_RAW_MEMORY,
 			 NULL, myaddr, memaddr, reg_len);
       if (res < reg_len)
@@ -386,12 +532,14 @@ dcache_read_line (DCACHE *dcache, struct dcache_block *db)
 
   memset (db->state, ENTRY_OK, g_line_size * sizeof (unsigned char));
   db->anydirty = 0;
+  dcache->next_seq_addr = db->addr + g_line_size;
   
   return 1;
 }
 
-/* Get a free cache block, put or keep it on the valid list,
-   and return its address.  */
+/* Get a free cache block, evicting the least recently used line if
+   there is none, make it the most recently used line, and return its
+   address.  */
 
 static struct dcache_block *
 dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
@@ -402,17 +550,20 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
   db = dcache->free_head;
   if (db)
     {
-      dcache->free_head = db->p;
+      dcache->free_head = db->newer;
     }
   else
     {
-      /* Nothing left on free list, so grab one from the valid list */
-      db = dcache->valid_head;
+      /* Nothing left on free list, so grab the least recently used
+	 line.  */
+      db = dcache->oldest;
 
       if (!dcache_write_line (dcache, db))
 	return NULL;
       
-      dcache->valid_head = db->p;
+      dcache_unhash (dcache, db);
+      dcache_unlink (dcache, db);
+      dcache->evictions++;
     }
 
   db->addr = MASK(addr);
@@ -420,13 +571,9 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
   db->anydirty = 0;
   memset (db->state, ENTRY_BAD, g_line_size * sizeof (unsigned char));
 
-  /* append this line to end of valid list */
-  if (!dcache->valid_head)
-    dcache->valid_head = db;
-  else
-    dcache->valid_tail->p = db;
-  dcache->valid_tail = db;
-  db->p = 0;
+  db->hash_next = dcache->hash[DCACHE_HASH (dcache, db->addr)];
+  dcache->hash[DCACHE_HASH (dcache, db->addr)] = db;
+  dcache_link_newest (dcache, db);
 
   return db;
 }
@@ -437,25 +584,118 @@ dcache_writeback (DCACHE *dcache)
 {
   struct dcache_block *db;
 
-  db = dcache->valid_head;
-
-  while (db)
+  for (db = dcache->oldest; db; db = db->newer)
     {
       if (!dcache_write_line (dcache, db))
 	return 0;
-      db = db->p;
     }
   return 1;
 }
 
+/* Read the NLINES uncached lines starting at the line holding ADDR
+   with a single target transfer, and enter the ones we could read
+   into DCACHE.  The lines must lie in a single cacheable region.  */
+
+static void
+dcache_read_lines (DCACHE *dcache, CORE_ADDR addr, int nlines)
+{
+  struct mem_region *region;
+  struct cleanup *old_chain;
+  gdb_byte *buf;
+  LONGEST res;
+  int i;
+
+  region = lookup_mem_region (addr);
+  if (region->attrib.cache != 1 || region->attrib.mode == MEM_WO)
+    return;
+  if (region->hi != 0
+      && (region->hi - addr) >> g_line_power < nlines)
+    nlines = (region->hi - addr) >> g_line_power;
+  if (nlines > g_num_lines)
+    nlines = g_num_lines;
+  if (nlines <= 1)
+    return;
+
+  buf = xmalloc (nlines * g_line_size);
+  old_chain = make_cleanup (xfree, buf);
+
+  dcache->target_reads++;
+  res = target_read (&current_target, TARGET_OBJECT_RAW_MEMORY,
+		     NULL, buf, addr, nlines * g_line_size);
+
+  for (i = 0; i < res >> g_line_power; i++)
+    {
+      struct dcache_block *db;
+
+      db = dcache_alloc (dcache, addr + i * g_line_size);
+      if (db == NULL)
+	break;
+      memcpy (db->data, buf + i * g_line_size, g_line_size);
+      memset (db->state, ENTRY_OK, g_line_size * sizeof (unsigned char));
+    }
+  if (i > 0)
+    dcache->next_seq_addr = addr + i * g_line_size;
+
+  do_cleanups (old_chain);
+}
 
-/* Using the data cache DCACHE return the contents of the byte at
-   address ADDR in the remote machine.  
+/* Before reading LEN bytes at MEMADDR, fetch each run of uncached
+   lines the request covers with one target read rather than one per
+   line.  If the request continues a sequential scan, also read up to
+   g_readahead_lines lines past its end.  */
+
+static void
+dcache_prefetch (DCACHE *dcache, CORE_ADDR memaddr, int len)
+{
+  CORE_ADDR addr = MASK (memaddr);
+  CORE_ADDR last = MASK (memaddr + len - 1);
+  int remaining = ((last - addr) >> g_line_power) + 1;
+
+  while (remaining > 0)
+    {
+      CORE_ADDR start;
+      int nlines = 0;
+
+      if (dcache_lookup (dcache, addr) != NULL)
+	{
+	  addr += g_line_size;
+	  remaining--;
+	  continue;
+	}
+
+      start = addr;
+      while (remaining > 0 && dcache_lookup (dcache, addr) == NULL)
+	{
+	  addr += g_line_size;
+	  nlines++;
+	  remaining--;
+	}
+
+      if (remaining == 0 && start == dcache->next_seq_addr)
+	{
+	  int i;
+
+	  for (i = 0; i < g_readahead_lines; i++)
+	    {
+	      if (addr == 0 || dcache_lookup (dcache, addr) != NULL)
+		break;
+	      addr += g_line_size;
+	    }
+	  dcache->readahead_lines += i;
+	  nlines += i;
+	}
+
+      dcache_read_lines (dcache, start, nlines);
+    }
+}
+
+/* Using the data cache DCACHE, read the LEN bytes at address ADDR in
+   the remote machine into PTR.  The bytes must all lie in one line.
 
    Returns 0 on error. */
 
 static int
-dcache_peek_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
+dcache_peek (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr, int len)
 {
   struct dcache_block *db = dcache_hit (dcache, addr);
 
@@ -466,23 +706,24 @@ dcache_peek_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
 	return 0;
     }
   
-  if (db->state[XFORM (addr)] == ENTRY_BAD)
+  if (memchr (db->state + XFORM (addr), ENTRY_BAD, len) != NULL)
     {
       if (!dcache_read_line(dcache, db))
          return 0;
     }
 
-  *ptr = db->data[XFORM (addr)];
+  memcpy (ptr, db->data + XFORM (addr), len);
   return 1;
 }
 
 
-/* Write the byte at PTR into ADDR in the data cache.
+/* Write the LEN bytes at PTR into ADDR in the data cache.  The bytes
+   must all lie in one line.
    Return zero on write error.
  */
 
 static int
-dcache_poke_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
+dcache_poke (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr, int len)
 {
   struct dcache_block *db = dcache_hit (dcache, addr);
 
@@ -493,8 +734,8 @@ dcache_poke_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
 	return 0;
     }
 
-  db->data[XFORM (addr)] = *ptr;
-  db->state[XFORM (addr)] = ENTRY_DIRTY;
+  memcpy (db->data + XFORM (addr), ptr, len);
+  memset (db->state + XFORM (addr), ENTRY_DIRTY, len);
   db->anydirty = 1;
   return 1;
 }
@@ -505,21 +746,28 @@ dcache_set_data (DCACHE *dcache)
 
   int i;
 
-  dcache->data_block = xmalloc (g_line_size * DCACHE_SIZE * sizeof (gdb_byte));
-  dcache->state_block = xmalloc (g_line_size * DCACHE_SIZE * sizeof (unsigned char));
+  dcache->the_cache = xcalloc (g_num_lines, sizeof (struct dcache_block));
+  dcache->data_block = xmalloc (g_line_size * g_num_lines * sizeof (gdb_byte));
+  dcache->state_block = xmalloc (g_line_size * g_num_lines * sizeof (unsigned char));
   
-  for (i = 0; i < DCACHE_SIZE; i++)
+  for (i = 0; i < g_num_lines; i++)
     {
       dcache->the_cache[i].data = dcache->data_block + (i * g_line_size);
       dcache->the_cache[i].state = dcache->state_block + (i * g_line_size);
     }
+
+  for (dcache->hash_size = 1; dcache->hash_size < g_num_lines; )
+    dcache->hash_size <<= 1;
+  dcache->hash = xcalloc (dcache->hash_size, sizeof (dcache->hash[0]));
 }
 
 static void
 dcache_resize (DCACHE *dcache)
 {
+  xfree (dcache->the_cache);
   xfree (dcache->data_block);
   xfree (dcache->state_block);
+  xfree (dcache->hash);
   dcache_set_data (dcache);
 }
 
@@ -527,13 +775,10 @@ dcache_resize (DCACHE *dcache)
 DCACHE *
 dcache_init (void)
 {
-  int csize = sizeof (struct dcache_block) * DCACHE_SIZE;
   DCACHE *dcache;
 
   dcache = (DCACHE *) xmalloc (sizeof (*dcache));
-
-  dcache->the_cache = (struct dcache_block *) xmalloc (csize);
-  memset (dcache->the_cache, 0, csize);
+  memset (dcache, 0, sizeof (*dcache));
 
   dcache_set_data (dcache);
 
@@ -570,6 +815,7 @@ dcache_free (DCACHE *dcache)
   xfree (dcache->the_cache);
   xfree (dcache->data_block);
   xfree (dcache->state_block);
+  xfree (dcache->hash);
   xfree (dcache);
 }
 
@@ -586,13 +832,22 @@ dcache_xfer_memory (DCACHE *dcache, CORE_ADDR memaddr, gdb_byte *myaddr,
 		    int len, int should_write)
 {
   int i;
-  int (*xfunc) (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr);
-  xfunc = should_write ? dcache_poke_byte : dcache_peek_byte;
+  int (*xfunc) (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr, int len);
+  xfunc = should_write ? dcache_poke : dcache_peek;
 
-  for (i = 0; i < len; i++)
+  if (!should_write && len > 0)
+    dcache_prefetch (dcache, memaddr, len);
+
+  /* Transfer a line (or what is left of one) at a time.  */
+  for (i = 0; i < len; )
     {
-      if (!xfunc (dcache, memaddr + i, myaddr + i))
+      int chunk = g_line_size - XFORM (memaddr + i);
+
+      if (chunk > len - i)
+	chunk = len - i;
+      if (!xfunc (dcache, memaddr + i, myaddr + i, chunk))
 	return 0;
+      i += chunk;
     }
 
   /* FIXME: There may be some benefit from moving the cache writeback
@@ -616,14 +871,22 @@ dcache_info (char *exp, int tty)
   struct dcache_block *p;
   int i;
 
-  printf_filtered (_("Dcache line width %d, depth %d\n"),
-		   g_line_size, DCACHE_SIZE);
+  printf_filtered (_("Dcache line width %d, depth %d, readahead %d lines\n"),
+		   g_line_size, g_num_lines, g_readahead_lines);
 
   for (i = 0; i < g_num_caches; i++)
     {
+      DCACHE *dcache = g_cache_array[i];
+
+      printf_filtered (_("Cache statistics:\n"));
+      printf_filtered (_("  %lu hits, %lu misses, %lu evictions\n"),
+		       dcache->hits, dcache->misses, dcache->evictions);
+      printf_filtered (_("  %lu target reads, %lu lines read ahead\n"),
+		       dcache->target_reads, dcache->readahead_lines);
+
       printf_filtered (_("Cache state:\n"));
 
-      for (p = g_cache_array[i]->valid_head; p; p = p->p)
+      for (p = dcache->oldest; p; p = p->newer)
 	{
 	  int j;
 	  printf_filtered (_("Line at %s, referenced %d times\n"),
@@ -659,6 +922,36 @@ set_cache_line_power (char *args, int from_tty, struct cmd_list_element *c)
     }
 }
 
+static void
+set_cache_size (char *args, int from_tty, struct cmd_list_element *c)
+{
+  int i;
+
+  if (g_num_lines_setting < 1)
+    {
+      g_num_lines_setting = g_num_lines;
+      error (_("The dcache must have at least one line."));
+    }
+
+  g_num_lines = g_num_lines_setting;
+
+  for (i = 0; i < g_num_caches; i++)
+    {
+      dcache_resize (g_cache_array[i]);
+      dcache_invalidate (g_cache_array[i]);
+    }
+}
+
+static void
+set_cache_readahead (char *args, int from_tty, struct cmd_list_element *c)
+{
+  if (g_readahead_lines < 0)
+    {
+      g_readahead_lines = 0;
+      error (_("The dcache readahead can not be negative."));
+    }
+}
+
 void
 _initialize_dcache (void)
 {
@@ -686,4 +979,23 @@ volatile registers are in use.  By default, this option is off."),
                          set_cache_line_power,
                          NULL,
                          &setlist, &showlist);
+
+  add_setshow_zinteger_cmd ("dcache-size", class_support,
+			    &g_num_lines_setting, _("\
+Set the number of lines in the dcache."), _("\
+Show the number of lines in the dcache."), _("\
+Changing the size discards the current contents of the cache."),
+			    set_cache_size,
+			    NULL,
+			    &setlist, &showlist);
+
+  add_setshow_zinteger_cmd ("dcache-readahead", class_support,
+			    &g_readahead_lines, _("\
+Set the number of dcache lines read ahead of a sequential scan."), _("\
+Show the number of dcache lines read ahead of a sequential scan."), _("\
+When a read misses the line following the last one fetched from the\n\
+target, this many additional lines are fetched in the same request."),
+			    set_cache_readahead,
+			    NULL,
+			    &setlist, &showlist);
 }
@@ -29,6 +29,9 @@ typedef struct dcache_struct DCACHE;
 /* Invalidate DCACHE. */
 void dcache_invalidate (DCACHE *dcache);
 
+/* Invalidate the LEN bytes of DCACHE starting at ADDR.  */
+void dcache_invalidate_range (DCACHE *dcache, CORE_ADDR addr, ULONGEST len);
+
 /* Initialize DCACHE. */
 DCACHE *dcache_init (void);
 
@@ -37,6 +37,7 @@
 
 #include "gdb_assert.h"
 #include "gdb_string.h"
+#include "hashtab.h"
 
 #include "complaints.h"
 #include "dwarf2-frame.h"
@@ -79,8 +80,6 @@ struct dwarf2_cie
 
   /* The version recorded in the CIE.  */
   unsigned char version;
-
-  struct dwarf2_cie *next;
 };
 
 /* Frame Description Entry (FDE).  */
@@ -103,10 +102,35 @@ struct dwarf2_fde
   /* True if this FDE is read from a .eh_frame instead of a .debug_frame
      section.  */
   unsigned char eh_frame_p;
+};
+
+/* The FDEs of a single objfile.  The entries are collected in
+   section order while the frame sections are decoded, and sorted by
+   initial_location the first time we have to unwind through the
+   objfile, so that lookups can use a binary search.  */
+
+struct dwarf2_fde_table
+{
+  /* Number of entries in ENTRIES.  */
+  int num_entries;
+
+  /* Non-zero once ENTRIES has been sorted.  */
+  int sorted;
 
-  struct dwarf2_fde *next;
+  /* The largest address_range of any entry, which bounds how far
+     back from a PC an FDE covering it can start.  */
+  CORE_ADDR max_range;
+
+  /* The FDEs, allocated on the objfile's obstack.  */
+  struct dwarf2_fde **entries;
 };
 
+/* Counters reported by "maint print statistics".  */
+
+static unsigned long dwarf2_frame_fde_lookups;
+static unsigned long dwarf2_frame_fde_probes;
+static long dwarf2_frame_fde_sort_time;
+
 static struct dwarf2_fde *dwarf2_frame_find_fde (CORE_ADDR *pc);
 
 
@@ -1289,8 +1313,14 @@ struct comp_unit
 
   struct objfile *objfile;
 
-  /* Linked list of CIEs for this object.  */
-  struct dwarf2_cie *cie;
+  /* CIEs for this section, hashed on their cie_pointer.  */
+  htab_t cie_table;
+
+  /* FDEs decoded so far; copied to the objfile's FDE table once all
+     the frame sections have been read.  */
+  struct dwarf2_fde **fdes;
+  int num_fdes;
+  int fdes_allocated;
 
   /* Pointer to the .debug_frame section loaded into memory.  */
   gdb_byte *dwarf_frame_buffer;
@@ -1555,30 +1585,99 @@ read_encoded_value (struct comp_unit *unit, gdb_byte encoding,
 }
 
 
-/* GCC uses a single CIE for all FDEs in a .debug_frame section.
-   That's why we use a simple linked list here.  */
+/* CIEs are looked up by their offset into the frame section, once
+   for every FDE; keep them in a hash table keyed on that offset.  */
+
+static hashval_t
+hash_cie (const void *item)
+{
+  const struct dwarf2_cie *cie = item;
+
+  return (hashval_t) cie->cie_pointer;
+}
+
+static int
+eq_cie (const void *item_lhs, const void *item_rhs)
+{
+  const struct dwarf2_cie *lhs = item_lhs;
+  const struct dwarf2_cie *rhs = item_rhs;
+
+  return lhs->cie_pointer == rhs->cie_pointer;
+}
 
 static struct dwarf2_cie *
 find_cie (struct comp_unit *unit, ULONGEST cie_pointer)
 {
-  struct dwarf2_cie *cie = unit->cie;
+  struct dwarf2_cie cie;
 
-  while (cie)
-    {
-      if (cie->cie_pointer == cie_pointer)
-	return cie;
+  cie.cie_pointer = cie_pointer;
+  return htab_find (unit->cie_table, &cie);
+}
 
-      cie = cie->next;
-    }
+static void
+add_cie (struct comp_unit *unit, struct dwarf2_cie *cie)
+{
+  void **slot;
 
-  return NULL;
+  slot = htab_find_slot (unit->cie_table, cie, INSERT);
+  gdb_assert (*slot == NULL);
+  *slot = cie;
 }
 
+/* Sort order for the FDE table: by initial location, with .debug_frame
+   entries before .eh_frame entries starting at the same address (the
+   former have always been searched first, so they take precedence),
+   and then by address range.  */
+
+static int
+qsort_fde_cmp (const void *a, const void *b)
+{
+  struct dwarf2_fde *aa = *(struct dwarf2_fde **) a;
+  struct dwarf2_fde *bb = *(struct dwarf2_fde **) b;
+
+  if (aa->initial_location != bb->initial_location)
+    return aa->initial_location < bb->initial_location ? -1 : 1;
+  if (aa->eh_frame_p != bb->eh_frame_p)
+    return aa->eh_frame_p < bb->eh_frame_p ? -1 : 1;
+  if (aa->address_range != bb->address_range)
+    return aa->address_range < bb->address_range ? -1 : 1;
+
+  /* Keep the sort stable.  */
+  return aa < bb ? -1 : aa > bb;
+}
+
+/* Sort the entries of TABLE and drop the ones that can never be found:
+   zero-length FDEs, and duplicates of an FDE we already have for the
+   same initial location.  */
+
 static void
-add_cie (struct comp_unit *unit, struct dwarf2_cie *cie)
+sort_fde_table (struct dwarf2_fde_table *table)
 {
-  cie->next = unit->cie;
-  unit->cie = cie;
+  long start_time = get_run_time ();
+  int i, j;
+
+  qsort (table->entries, table->num_entries, sizeof (table->entries[0]),
+	 qsort_fde_cmp);
+
+  table->max_range = 0;
+  for (i = 0, j = 0; i < table->num_entries; i++)
+    {
+      struct dwarf2_fde *fde = table->entries[i];
+
+      if (fde->address_range == 0)
+	continue;
+      if (j > 0
+	  && table->entries[j - 1]->initial_location == fde->initial_location)
+	continue;
+      if (fde->address_range > table->max_range)
+	table->max_range = fde->address_range;
+      table->entries[j++] = fde;
+    }
+
+  table->num_entries = j;
+  table->sorted = 1;
+
+  dwarf2_frame_fde_sort_time += get_run_time () - start_time;
 }
 
 /* Find the FDE for *PC.  Return a pointer to the FDE, and store the
@@ -1589,28 +1688,60 @@ dwarf2_frame_find_fde (CORE_ADDR *pc)
 {
   struct objfile *objfile;
 
+  dwarf2_frame_fde_lookups++;
+
   ALL_OBJFILES (objfile)
     {
-      struct dwarf2_fde *fde;
+      struct dwarf2_fde_table *table;
       CORE_ADDR offset;
+      CORE_ADDR seek_pc;
+      int low, high;
+
+      table = objfile_data (objfile, dwarf2_frame_objfile_data);
+      if (table == NULL)
+	continue;
 
-      fde = objfile_data (objfile, dwarf2_frame_objfile_data);
-      if (fde == NULL)
+      if (!table->sorted)
+	sort_fde_table (table);
+      if (table->num_entries == 0)
 	continue;
 
       gdb_assert (objfile->section_offsets);
       offset = objfile_text_section_offset (objfile);
 
-      while (fde)
+      if (*pc < table->entries[0]->initial_location + offset)
+	continue;
+      seek_pc = *pc - offset;
+
+      /* Find the last FDE starting at or before SEEK_PC.  */
+      low = 0;
+      high = table->num_entries;
+      while (high - low > 1)
 	{
-	  if (*pc >= fde->initial_location + offset
-	      && *pc < fde->initial_location + offset + fde->address_range)
+	  int mid = low + (high - low) / 2;
+
+	  dwarf2_frame_fde_probes++;
+	  if (table->entries[mid]->initial_location <= seek_pc)
+	    low = mid;
+	  else
+	    high = mid;
+	}
+
+      /* That FDE need not cover SEEK_PC when FDEs nest or overlap, so
+	 go on back through any earlier ones that are close enough to
+	 SEEK_PC to cover it.  */
+      for (; low >= 0; low--)
+	{
+	  struct dwarf2_fde *fde = table->entries[low];
+
+	  if (seek_pc - fde->initial_location >= table->max_range)
+	    break;
+	  dwarf2_frame_fde_probes++;
+	  if (seek_pc - fde->initial_location < fde->address_range)
 	    {
 	      *pc = fde->initial_location + offset;
 	      return fde;
 	    }
-
-	  fde = fde->next;
 	}
     }
 
@@ -1620,8 +1751,48 @@ dwarf2_frame_find_fde (CORE_ADDR *pc)
 static void
 add_fde (struct comp_unit *unit, struct dwarf2_fde *fde)
 {
-  fde->next = objfile_data (unit->objfile, dwarf2_frame_objfile_data);
-  set_objfile_data (unit->objfile, dwarf2_frame_objfile_data, fde);
+  if (unit->num_fdes == unit->fdes_allocated)
+    {
+      unit->fdes_allocated = unit->fdes_allocated ? 2 * unit->fdes_allocated
+						  : 256;
+      unit->fdes = xrealloc (unit->fdes,
+			     unit->fdes_allocated * sizeof (unit->fdes[0]));
+    }
+  unit->fdes[unit->num_fdes++] = fde;
+}
+
+/* Print the FDE lookup statistics.  */
+
+void
+dwarf2_frame_print_statistics (void)
+{
+  struct objfile *objfile;
+  int tables = 0, sorted = 0;
+  long entries = 0;
+
+  ALL_OBJFILES (objfile)
+    {
+      struct dwarf2_fde_table *table;
+
+      table = objfile_data (objfile, dwarf2_frame_objfile_data);
+      if (table != NULL)
+	{
+	  tables++;
+	  sorted += table->sorted;
+	  entries += table->num_entries;
+	}
+    }
+
+  printf_filtered (_("DWARF CFI statistics:\n"));
+  printf_filtered (_("  Objfiles with FDE tables: %d (%d sorted)\n"),
+		   tables, sorted);
+  printf_filtered (_("  Total FDE table entries: %ld\n"), entries);
+  printf_filtered (_("  FDE lookups: %lu\n"), dwarf2_frame_fde_lookups);
+  printf_filtered (_("  FDE binary search probes: %lu\n"),
+		   dwarf2_frame_fde_probes);
+  printf_filtered (_("  Time spent sorting FDE tables: %ld.%06ld sec\n"),
+		   dwarf2_frame_fde_sort_time / 1000000,
+		   dwarf2_frame_fde_sort_time % 1000000);
 }
 
 #ifdef CC_HAS_LONG_LONG
@@ -1986,18 +2157,42 @@ decode_frame_entry (struct comp_unit *unit, gdb_byte *start, int eh_frame_p)
 extern asection *dwarf_frame_section;
 extern asection *dwarf_eh_frame_section;
 
+/* Delete the CIE table *ARG points to, if there is one.  Used as a
+   cleanup, so that the table goes if decoding the frame section
+   throws.  */
+
+static void
+delete_cie_table (void *arg)
+{
+  htab_t *tablep = arg;
+
+  if (*tablep != NULL)
+    {
+      htab_delete (*tablep);
+      *tablep = NULL;
+    }
+}
+
 /* Imported from dwarf2read.c.  */
 void
 dwarf2_build_frame_info (struct objfile *objfile)
 {
   struct comp_unit unit;
+  struct dwarf2_fde_table *table, *old_table;
   gdb_byte *frame_ptr;
+  struct cleanup *old_chain;
 
   /* Build a minimal decoding of the DWARF2 compilation unit.  */
   unit.abfd = objfile->obfd;
   unit.objfile = objfile;
   unit.dbase = 0;
   unit.tbase = 0;
+  unit.fdes = NULL;
+  unit.num_fdes = 0;
+  unit.fdes_allocated = 0;
+  unit.cie_table = NULL;
+  old_chain = make_cleanup (free_current_contents, &unit.fdes);
+  make_cleanup (delete_cie_table, &unit.cie_table);
 
   /* First add the information from the .eh_frame section.  That way,
      the FDEs from that section are searched last.  */
@@ -2005,7 +2200,8 @@ dwarf2_build_frame_info (struct objfile *objfile)
     {
       asection *got, *txt;
 
-      unit.cie = NULL;
+      unit.cie_table = htab_create_alloc (64, hash_cie, eq_cie, NULL,
+					  xcalloc, xfree);
       unit.dwarf_frame_buffer = dwarf2_read_section (objfile,  objfile->obfd,
 						     dwarf_eh_frame_section);
 
@@ -2029,11 +2225,13 @@ dwarf2_build_frame_info (struct objfile *objfile)
       frame_ptr = unit.dwarf_frame_buffer;
       while (frame_ptr < unit.dwarf_frame_buffer + unit.dwarf_frame_size)
 	frame_ptr = decode_frame_entry (&unit, frame_ptr, 1);
+      delete_cie_table (&unit.cie_table);
     }
 
   if (dwarf_frame_section)
     {
-      unit.cie = NULL;
+      unit.cie_table = htab_create_alloc (64, hash_cie, eq_cie, NULL,
+					  xcalloc, xfree);
       unit.dwarf_frame_buffer = dwarf2_read_section (objfile,  objfile->obfd,
 						     dwarf_frame_section);
       unit.dwarf_frame_size = bfd_get_section_size (dwarf_frame_section);
@@ -2042,7 +2240,34 @@ dwarf2_build_frame_info (struct objfile *objfile)
       frame_ptr = unit.dwarf_frame_buffer;
       while (frame_ptr < unit.dwarf_frame_buffer + unit.dwarf_frame_size)
 	frame_ptr = decode_frame_entry (&unit, frame_ptr, 0);
+      delete_cie_table (&unit.cie_table);
+    }
+
+  if (unit.num_fdes == 0)
+    {
+      do_cleanups (old_chain);
+      return;
     }
+
+  /* Copy the FDEs into the objfile's table, after any we already
+     have.  The table is sorted when it is first used.  */
+  old_table = objfile_data (objfile, dwarf2_frame_objfile_data);
+  table = obstack_alloc (&objfile->objfile_obstack, sizeof (*table));
+  table->num_entries = unit.num_fdes;
+  if (old_table != NULL)
+    table->num_entries += old_table->num_entries;
+  table->entries = obstack_alloc (&objfile->objfile_obstack,
+				  table->num_entries
+				  * sizeof (table->entries[0]));
+  if (old_table != NULL)
+    memcpy (table->entries, old_table->entries,
+	    old_table->num_entries * sizeof (table->entries[0]));
+  memcpy (table->entries + table->num_entries - unit.num_fdes, unit.fdes,
+	  unit.num_fdes * sizeof (table->entries[0]));
+  table->sorted = 0;
+  do_cleanups (old_chain);
+
+  set_objfile_data (objfile, dwarf2_frame_objfile_data, table);
 }
 
 /* Provide a prototype to silence -Wmissing-prototypes.  */
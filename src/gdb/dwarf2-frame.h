@@ -113,4 +113,8 @@ extern const struct frame_base *
 
 void dwarf2_frame_build_info (struct objfile *objfile);
 
+/* Print FDE lookup statistics for "maint print statistics".  */
+
+extern void dwarf2_frame_print_statistics (void);
+
 #endif /* dwarf2-frame.h */
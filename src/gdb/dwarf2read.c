@@ -69,6 +69,16 @@
 #include <ctype.h>
 /* APPLE LOCAL objc_invalidate_objc_class */
 #include "objc-lang.h"
+#include "gdb_stat.h"
+#include "gdb_dirent.h"
+#include "mach-o.h"
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
 
 /* A note on memory usage for this file.
    
@@ -425,7 +435,14 @@ struct dwarf2_cu
      should logically be moved to the dwarf2_cu structure.  */
   struct comp_unit_head header;
 
-  struct function_range *first_fn, *last_fn, *cached_fn;
+  struct function_range *first_fn, *last_fn;
+
+  /* The function_ranges above, sorted by LOWPC, and for each, the
+     highest HIGHPC of it and all the ones before it.  Built by
+     check_cu_functions when it is first needed.  */
+  struct function_range **sorted_fns;
+  CORE_ADDR *sorted_fns_max_highpc;
+  int num_fns;
 
   /* The language we are debugging.  */
   enum language language;
@@ -525,6 +542,19 @@ struct dwarf2_cu
   struct oso_to_final_addr_map *addr_map;
 };
 
+/* APPLE LOCAL: One sequence of a compilation unit's line number
+   program.  */
+
+struct line_sequence
+{
+  /* The offset of the sequence's first opcode in .debug_line.  */
+  unsigned int offset;
+
+  /* The lowest and highest addresses of the rows in the sequence, as
+     they appear in the line number program.  */
+  CORE_ADDR lowpc, highpc;
+};
+
 /* Persistent data held for a compilation unit, even when not
    processing it.  We put a pointer to this structure in the
    read_symtab_private field of the psymtab.  If we encounter
@@ -554,6 +584,20 @@ struct dwarf2_per_cu_data
 
   /* The partial symbol table associated with this compilation unit.  */
   struct partial_symtab *psymtab;
+
+  /* Set if the CU has no namespace debug info, so its C++ psymbols
+     were scanned for possible namespace names.  Saved in the
+     psymtab cache so that loading from it can do the same.  */
+  unsigned int psym_check_namespaces : 1;
+
+  /* APPLE LOCAL: The sequences of this CU's line number program, in
+     the order they appear, found while building the partial symtab,
+     so that reading the full symtab can go straight to the ones it
+     wants.  Only saved for a CU with a debug map.  NULL if the
+     program hasn't been scanned, or if it defines files with
+     DW_LNE_define_file.  */
+  struct line_sequence *line_sequences;
+  int num_line_sequences;
 };
 
 /* APPLE LOCAL begin psym equivalences */
@@ -899,6 +943,20 @@ show_debug_debugmap (struct ui_file *file, int from_tty,
   fprintf_filtered (file, _("DWARF debugmap debugging is %s.\n"), value);
 }
 
+/* APPLE LOCAL: When non-zero, only decode the sequences of a CU's line
+   number program whose code made it into the final image; see
+   dwarf_line_sequence_wanted.  */
+static int dwarf2_skip_dead_line_sequences = 1;
+static void
+show_dwarf2_skip_dead_line_sequences (struct ui_file *file, int from_tty,
+				      struct cmd_list_element *c,
+				      const char *value)
+{
+  fprintf_filtered (file, _("\
+Skipping line number sequences for discarded code is %s.\n"),
+		    value);
+}
+
 
 /* Various complaints about symbol reading that don't abort the process */
 
@@ -969,6 +1027,12 @@ static void dwarf2_build_include_psymtabs (struct dwarf2_cu *,
 
 static void dwarf2_build_psymtabs_hard (struct objfile *, int);
 
+static int psymtab_cache_load (struct objfile *);
+
+static void psymtab_cache_save (struct objfile *);
+
+static void add_equiv_psym (struct equiv_psym_list **, char *);
+
 /* APPLE LOCAL begin psym equivalences  */
 static void scan_partial_symbols (struct partial_die_info *,
 				  CORE_ADDR *, CORE_ADDR *,
@@ -1537,8 +1601,15 @@ dwarf2_build_psymtabs (struct objfile *objfile, int mainline)
 #endif
     /* only test this case for now */
     {
-      /* In this case we have to work a bit harder */
-      dwarf2_build_psymtabs_hard (objfile, mainline);
+      /* Use the partial symtabs saved by an earlier session if we
+	 can; otherwise build them and save them for the next one.  */
+      create_all_comp_units (objfile);
+      if (!psymtab_cache_load (objfile))
+	{
+	  /* In this case we have to work a bit harder */
+	  dwarf2_build_psymtabs_hard (objfile, mainline);
+	  psymtab_cache_save (objfile);
+	}
     }
 }
 
@@ -2348,7 +2419,8 @@ dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline)
      read_in_chain.  Make sure to free them when we're done.  */
   back_to = make_cleanup (free_cached_comp_units, NULL);
 
-  create_all_comp_units (objfile);
+  if (dwarf2_per_objfile->all_comp_units == NULL)
+    create_all_comp_units (objfile);
 
   /* Since the objects we're extracting from .debug_info vary in
      length, only the individual functions to extract them (like
@@ -2395,6 +2467,7 @@ dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline)
       make_cleanup (dwarf2_free_abbrev_table, &cu);
 
       this_cu = dwarf2_find_comp_unit (cu.header.offset, objfile);
+      this_cu->psym_check_namespaces = !cu.has_namespace_info;
 
       /* Read the compilation unit die */
       /* APPLE LOCAL Add cast to avoid type mismatch in arg2 warning.  */
@@ -2518,6 +2591,785 @@ dwarf2_build_psymtabs_hard (struct objfile *objfile, int mainline)
 
 }
 
+/* The partial symbol table cache.
+
+   Building the partial symbol tables means reading every DIE at the
+   top level of every compilation unit, which dominates the time it
+   takes to load a large program with DWARF debug info.  When
+   psymtab_cache_directory is set, we save the partial symtabs we
+   build for an objfile to a file there, keyed by the objfile's UUID
+   (or, failing that, its inode, modification time, size and a
+   checksum of its DWARF sections), and later sessions replay that
+   file instead of scanning .debug_info.
+
+   The file is written in host byte order and is only ever read by
+   the host that wrote it; the header records enough to reject a file
+   written by a different host, a different version of this code, or
+   for a different build of the objfile.  We map the file and read
+   the records in place; the symbol names are copied into the objfile
+   by add_psymbol_to_list as usual.
+
+   Layout, after the header:
+
+   for each compilation unit, in the order they were read:
+     u32 offset of the CU in .debug_info
+     u32 flags (PSC_CU_*)
+     u64 textlow, texthigh
+     string filename, dirname
+     u32 number of global psymbols, u32 number of static psymbols
+     for each psymbol: string name, u8 domain, u8 class, u8 language,
+       u8 flags (PSC_SYM_*), u64 address
+     u32 number of equivalence names, followed by the strings
+     u32 number of include files, followed by the strings  */
+
+/* Directory holding the cache files.  NULL or empty disables the
+   cache.  */
+static char *psymtab_cache_directory = NULL;
+
+/* Upper bound, in megabytes, on the total size of the files in
+   psymtab_cache_directory.  Zero means no limit.  */
+static unsigned int psymtab_cache_size = 256;
+
+#define PSYMTAB_CACHE_MAGIC "GDBPSYMC"
+#define PSYMTAB_CACHE_VERSION 2
+#define PSYMTAB_CACHE_BYTE_ORDER 0x01020304
+#define PSYMTAB_CACHE_SUFFIX ".psymc"
+
+/* The CU's partial symbols were checked for namespace information,
+   because the CU had none of its own.  */
+#define PSC_CU_CHECK_NAMESPACES 0x1
+/* The CU has a DW_AT_comp_dir.  */
+#define PSC_CU_HAS_DIRNAME 0x2
+
+/* The symbol is a Thumb function.  */
+#define PSC_SYM_THUMB 0x1
+
+/* What identifies the build of an objfile a cache file belongs to.  */
+
+struct psymtab_cache_key
+{
+  unsigned char uuid[16];
+  ULONGEST inode;
+  ULONGEST mtime;
+  ULONGEST size;
+  ULONGEST info_size;
+  unsigned int n_comp_units;
+  /* A CRC of the DWARF sections, for objfiles without a UUID: a
+     rebuild can keep the inode, size and (within a second)
+     modification time of the file it replaces.  */
+  unsigned int checksum;
+};
+
+/* A cursor over a mapped cache file.  */
+
+struct psymtab_cache_reader
+{
+  const char *ptr;
+  const char *end;
+  int error;
+};
+
+static void
+show_psymtab_cache_directory (struct ui_file *file, int from_tty,
+			      struct cmd_list_element *c, const char *value)
+{
+  if (value == NULL || *value == '\0')
+    fprintf_filtered (file, _("The partial symbol table cache is disabled.\n"));
+  else
+    fprintf_filtered (file, _("\
+The directory for the partial symbol table cache is \"%s\".\n"),
+		      value);
+}
+
+static void
+show_psymtab_cache_size (struct ui_file *file, int from_tty,
+			 struct cmd_list_element *c, const char *value)
+{
+  if (psymtab_cache_size == UINT_MAX)
+    fprintf_filtered (file, _("\
+The size limit of the partial symbol table cache is unlimited.\n"));
+  else
+    fprintf_filtered (file, _("\
+The size limit of the partial symbol table cache is %s megabytes.\n"),
+		      value);
+}
+
+/* Return a CRC of the DWARF sections of the current objfile that
+   partial symtabs are built from.  */
+
+static unsigned int
+psymtab_cache_checksum (void)
+{
+  unsigned long crc = 0;
+
+  crc = gnu_debuglink_crc32 (crc,
+			     (unsigned char *) dwarf2_per_objfile->info_buffer,
+			     dwarf2_per_objfile->info_size);
+  crc = gnu_debuglink_crc32 (crc,
+			     (unsigned char *) dwarf2_per_objfile->abbrev_buffer,
+			     dwarf2_per_objfile->abbrev_size);
+  if (dwarf2_per_objfile->line_buffer != NULL)
+    crc = gnu_debuglink_crc32 (crc,
+			       (unsigned char *) dwarf2_per_objfile->line_buffer,
+			       dwarf2_per_objfile->line_size);
+  if (dwarf2_per_objfile->str_buffer != NULL)
+    crc = gnu_debuglink_crc32 (crc,
+			       (unsigned char *) dwarf2_per_objfile->str_buffer,
+			       dwarf2_per_objfile->str_size);
+  return crc;
+}
+
+/* Fill in KEY for OBJFILE, and its file name in the cache directory
+   in *PATH (malloc'd).  Return 0 if OBJFILE can't be cached.  */
+
+static int
+psymtab_cache_key (struct objfile *objfile, struct psymtab_cache_key *key,
+		   char **path)
+{
+  bfd *abfd = objfile->obfd;
+  struct stat st;
+  char *name;
+  int i;
+
+  if (psymtab_cache_directory == NULL || *psymtab_cache_directory == '\0')
+    return 0;
+
+  /* Only plain files on disk; not archive members, and not images
+     read from memory.  */
+  if (abfd == NULL || abfd->my_archive != NULL
+      || bfd_get_filename (abfd) == NULL
+      || stat (bfd_get_filename (abfd), &st) != 0)
+    return 0;
+
+  memset (key, 0, sizeof (*key));
+  key->info_size = dwarf2_per_objfile->info_size;
+  key->n_comp_units = dwarf2_per_objfile->n_comp_units;
+
+  if (bfd_mach_o_get_uuid (abfd, key->uuid, sizeof (key->uuid)))
+    {
+      /* The same build under another name, or touched since, is
+	 still the same build.  */
+      name = xmalloc (2 * sizeof (key->uuid) + 1);
+      for (i = 0; i < sizeof (key->uuid); i++)
+	sprintf (name + 2 * i, "%02x", key->uuid[i]);
+    }
+  else
+    {
+      key->inode = st.st_ino;
+      key->mtime = st.st_mtime;
+      key->size = st.st_size;
+      key->checksum = psymtab_cache_checksum ();
+      name = xstrprintf ("%08lx%08lx%08x",
+			 (unsigned long) htab_hash_string (bfd_get_filename (abfd)),
+			 (unsigned long) (key->inode ^ key->mtime ^ key->size),
+			 key->checksum);
+    }
+
+  *path = xstrprintf ("%s/%s-%s%s", psymtab_cache_directory,
+		      lbasename (bfd_get_filename (abfd)), name,
+		      PSYMTAB_CACHE_SUFFIX);
+  xfree (name);
+  return 1;
+}
+
+static void
+psymtab_cache_put (struct obstack *ob, const void *data, int len)
+{
+  obstack_grow (ob, data, len);
+}
+
+static void
+psymtab_cache_put_u32 (struct obstack *ob, unsigned int val)
+{
+  psymtab_cache_put (ob, &val, sizeof (val));
+}
+
+static void
+psymtab_cache_put_u64 (struct obstack *ob, ULONGEST val)
+{
+  psymtab_cache_put (ob, &val, sizeof (val));
+}
+
+static void
+psymtab_cache_put_string (struct obstack *ob, const char *str)
+{
+  obstack_grow0 (ob, str, strlen (str));
+}
+
+static void
+psymtab_cache_get (struct psymtab_cache_reader *r, void *data, int len)
+{
+  if (r->error || r->end - r->ptr < len)
+    {
+      r->error = 1;
+      memset (data, 0, len);
+      return;
+    }
+  memcpy (data, r->ptr, len);
+  r->ptr += len;
+}
+
+static unsigned int
+psymtab_cache_get_u32 (struct psymtab_cache_reader *r)
+{
+  unsigned int val;
+
+  psymtab_cache_get (r, &val, sizeof (val));
+  return val;
+}
+
+static ULONGEST
+psymtab_cache_get_u64 (struct psymtab_cache_reader *r)
+{
+  ULONGEST val;
+
+  psymtab_cache_get (r, &val, sizeof (val));
+  return val;
+}
+
+static unsigned char
+psymtab_cache_get_u8 (struct psymtab_cache_reader *r)
+{
+  unsigned char val;
+
+  psymtab_cache_get (r, &val, sizeof (val));
+  return val;
+}
+
+/* Return the string at R, which points into the mapped file.  */
+
+static char *
+psymtab_cache_get_string (struct psymtab_cache_reader *r)
+{
+  const char *str = r->ptr;
+  const char *nul;
+
+  if (r->error)
+    return "";
+
+  nul = memchr (r->ptr, '\0', r->end - r->ptr);
+  if (nul == NULL)
+    {
+      r->error = 1;
+      return "";
+    }
+  r->ptr = nul + 1;
+  return (char *) str;
+}
+
+static void
+psymtab_cache_put_header (struct obstack *ob, struct psymtab_cache_key *key,
+			  CORE_ADDR baseaddr, unsigned int n_records)
+{
+  psymtab_cache_put (ob, PSYMTAB_CACHE_MAGIC, 8);
+  psymtab_cache_put_u32 (ob, PSYMTAB_CACHE_VERSION);
+  psymtab_cache_put_u32 (ob, PSYMTAB_CACHE_BYTE_ORDER);
+  psymtab_cache_put (ob, key->uuid, sizeof (key->uuid));
+  psymtab_cache_put_u64 (ob, key->inode);
+  psymtab_cache_put_u64 (ob, key->mtime);
+  psymtab_cache_put_u64 (ob, key->size);
+  psymtab_cache_put_u64 (ob, key->info_size);
+  psymtab_cache_put_u32 (ob, key->n_comp_units);
+  psymtab_cache_put_u32 (ob, key->checksum);
+  psymtab_cache_put_u64 (ob, baseaddr);
+  psymtab_cache_put_u32 (ob, n_records);
+}
+
+/* Write the psymbols of one of PST's lists, SYMS[0..COUNT-1].  */
+
+static void
+psymtab_cache_put_psymbols (struct obstack *ob, struct objfile *objfile,
+			    struct partial_symbol **syms, int count)
+{
+  int i;
+
+  psymtab_cache_put_u32 (ob, count);
+  for (i = 0; i < count; i++)
+    {
+      struct partial_symbol *psym = syms[i];
+      unsigned char bytes[4];
+
+      bytes[0] = PSYMBOL_DOMAIN (psym);
+      bytes[1] = PSYMBOL_CLASS (psym);
+      bytes[2] = SYMBOL_LANGUAGE (psym);
+      bytes[3] = (partial_symbol_special_info (objfile, psym) != NULL
+		  ? PSC_SYM_THUMB : 0);
+
+      psymtab_cache_put_string (ob, SYMBOL_LINKAGE_NAME (psym));
+      psymtab_cache_put (ob, bytes, sizeof (bytes));
+      psymtab_cache_put_u64 (ob, SYMBOL_VALUE_ADDRESS (psym));
+    }
+}
+
+/* Remove the oldest files in the cache directory until they take up
+   no more than psymtab_cache_size megabytes.  */
+
+static void
+psymtab_cache_trim (void)
+{
+  struct cache_file
+  {
+    char *name;
+    time_t mtime;
+    off_t size;
+  } *files = NULL;
+  int n_files = 0, n_allocated = 0;
+  unsigned long long total = 0;
+  unsigned long long limit;
+  DIR *dir;
+  struct dirent *ent;
+  int i, j;
+
+  if (psymtab_cache_size == 0 || psymtab_cache_size == UINT_MAX)
+    return;
+  limit = (unsigned long long) psymtab_cache_size * 1024 * 1024;
+
+  dir = opendir (psymtab_cache_directory);
+  if (dir == NULL)
+    return;
+
+  while ((ent = readdir (dir)) != NULL)
+    {
+      size_t len = strlen (ent->d_name);
+      size_t suffix_len = strlen (PSYMTAB_CACHE_SUFFIX);
+      struct stat st;
+      char *name;
+
+      if (len <= suffix_len
+	  || strcmp (ent->d_name + len - suffix_len,
+		     PSYMTAB_CACHE_SUFFIX) != 0)
+	continue;
+
+      name = concat (psymtab_cache_directory, "/", ent->d_name, (char *) NULL);
+      if (stat (name, &st) != 0)
+	{
+	  xfree (name);
+	  continue;
+	}
+
+      if (n_files == n_allocated)
+	{
+	  n_allocated = n_allocated ? 2 * n_allocated : 16;
+	  files = xrealloc (files, n_allocated * sizeof (*files));
+	}
+      files[n_files].name = name;
+      files[n_files].mtime = st.st_mtime;
+      files[n_files].size = st.st_size;
+      n_files++;
+      total += st.st_size;
+    }
+  closedir (dir);
+
+  /* Oldest first.  The directory is small, so a simple insertion
+     sort will do.  */
+  for (i = 1; i < n_files; i++)
+    {
+      struct cache_file tmp = files[i];
+
+      for (j = i; j > 0 && files[j - 1].mtime > tmp.mtime; j--)
+	files[j] = files[j - 1];
+      files[j] = tmp;
+    }
+
+  for (i = 0; i < n_files && total > limit; i++)
+    if (unlink (files[i].name) == 0)
+      total -= files[i].size;
+
+  for (i = 0; i < n_files; i++)
+    xfree (files[i].name);
+  xfree (files);
+}
+
+/* Save the partial symtabs just built for OBJFILE in the cache.  */
+
+static void
+psymtab_cache_save (struct objfile *objfile)
+{
+  struct psymtab_cache_key key;
+  struct partial_symtab **psts;
+  struct partial_symtab *pst;
+  struct obstack ob;
+  CORE_ADDR baseaddr;
+  char *path, *tmp_path;
+  int n_psts, n_records, i, j;
+  FILE *file;
+  char *data;
+  int size;
+  int ok;
+
+  if (!psymtab_cache_key (objfile, &key, &path))
+    return;
+
+  /* Everything on the psymtab list must be ours: a CU psymtab, or one
+     of its include psymtabs.  */
+  n_psts = 0;
+  n_records = 0;
+  for (pst = objfile->psymtabs; pst != NULL; pst = pst->next)
+    {
+      if (pst->read_symtab != dwarf2_psymtab_to_symtab)
+	{
+	  xfree (path);
+	  return;
+	}
+      if (pst->read_symtab_private != NULL)
+	n_records++;
+      n_psts++;
+    }
+  if (n_records == 0)
+    {
+      xfree (path);
+      return;
+    }
+
+  /* The list is newest first; we want to replay it oldest first.  */
+  psts = xmalloc (n_psts * sizeof (*psts));
+  for (pst = objfile->psymtabs, i = n_psts - 1; pst != NULL;
+       pst = pst->next, i--)
+    psts[i] = pst;
+
+  baseaddr = objfile_text_section_offset (objfile);
+
+  obstack_init (&ob);
+  psymtab_cache_put_header (&ob, &key, baseaddr, n_records);
+
+  for (i = 0; i < n_psts; i++)
+    {
+      struct dwarf2_per_cu_data *per_cu;
+      unsigned int flags = 0;
+      int n_includes;
+
+      pst = psts[i];
+      if (pst->read_symtab_private == NULL)
+	continue;
+      per_cu = (struct dwarf2_per_cu_data *) pst->read_symtab_private;
+
+      if (per_cu->psym_check_namespaces)
+	flags |= PSC_CU_CHECK_NAMESPACES;
+      if (pst->dirname != NULL)
+	flags |= PSC_CU_HAS_DIRNAME;
+
+      psymtab_cache_put_u32 (&ob, per_cu->offset);
+      psymtab_cache_put_u32 (&ob, flags);
+      psymtab_cache_put_u64 (&ob, pst->textlow);
+      psymtab_cache_put_u64 (&ob, pst->texthigh);
+      psymtab_cache_put_string (&ob, pst->filename);
+      psymtab_cache_put_string (&ob, pst->dirname ? pst->dirname : "");
+
+      psymtab_cache_put_psymbols
+	(&ob, objfile, objfile->global_psymbols.list + pst->globals_offset,
+	 pst->n_global_syms);
+      psymtab_cache_put_psymbols
+	(&ob, objfile, objfile->static_psymbols.list + pst->statics_offset,
+	 pst->n_static_syms);
+
+      if (pst->equiv_psyms != NULL)
+	{
+	  psymtab_cache_put_u32 (&ob, pst->equiv_psyms->num_syms);
+	  for (j = 0; j < pst->equiv_psyms->num_syms; j++)
+	    psymtab_cache_put_string (&ob, pst->equiv_psyms->sym_list[j]);
+	}
+      else
+	psymtab_cache_put_u32 (&ob, 0);
+
+      /* The include psymtabs made for this CU follow it.  */
+      for (n_includes = 0; i + 1 + n_includes < n_psts; n_includes++)
+	{
+	  struct partial_symtab *inc = psts[i + 1 + n_includes];
+
+	  if (inc->read_symtab_private != NULL
+	      || inc->number_of_dependencies != 1
+	      || inc->dependencies[0] != pst)
+	    break;
+	}
+      psymtab_cache_put_u32 (&ob, n_includes);
+      for (j = 0; j < n_includes; j++)
+	psymtab_cache_put_string (&ob, psts[i + 1 + j]->filename);
+    }
+  xfree (psts);
+
+  size = obstack_object_size (&ob);
+  data = obstack_finish (&ob);
+
+  /* Write a temporary file and rename it into place, so a concurrent
+     session never sees a partial file.  */
+  mkdir (psymtab_cache_directory, 0777);
+  tmp_path = xstrprintf ("%s.%d", path, (int) getpid ());
+  file = fopen (tmp_path, FOPEN_WB);
+  ok = 0;
+  if (file != NULL)
+    {
+      ok = (fwrite (data, 1, size, file) == size);
+      ok &= (fclose (file) == 0);
+      if (ok)
+	ok = (rename (tmp_path, path) == 0);
+      if (!ok)
+	unlink (tmp_path);
+    }
+
+  if (ok && info_verbose)
+    printf_filtered (_("Saved partial symbol tables for %s in %s.\n"),
+		     objfile->name, path);
+
+  obstack_free (&ob, NULL);
+  xfree (tmp_path);
+  xfree (path);
+
+  if (ok)
+    psymtab_cache_trim ();
+}
+
+/* Read the psymbols of one list from R, adding them to LIST of
+   OBJFILE if APPLY.  */
+
+static void
+psymtab_cache_read_psymbols (struct psymtab_cache_reader *r,
+			     struct objfile *objfile,
+			     struct psymbol_allocation_list *list,
+			     CORE_ADDR delta, int check_namespaces,
+			     int apply)
+{
+  unsigned int count, i;
+
+  count = psymtab_cache_get_u32 (r);
+  for (i = 0; i < count && !r->error; i++)
+    {
+      char *name = psymtab_cache_get_string (r);
+      domain_enum domain = psymtab_cache_get_u8 (r);
+      enum address_class class = psymtab_cache_get_u8 (r);
+      enum language language = psymtab_cache_get_u8 (r);
+      unsigned char flags = psymtab_cache_get_u8 (r);
+      CORE_ADDR addr = psymtab_cache_get_u64 (r);
+      const struct partial_symbol *psym;
+
+      if (r->error || !apply)
+	continue;
+
+      /* Only code and static data move with the objfile; see
+	 add_partial_symbol.  */
+      if (class == LOC_BLOCK || class == LOC_STATIC)
+	addr += delta;
+
+      psym = add_psymbol_to_list (name, strlen (name), domain, class,
+				  list, 0, addr, language, objfile);
+
+      if (flags & PSC_SYM_THUMB)
+	objfile_add_special_psym (objfile, (struct partial_symbol *) psym,
+				  DW_ISA_ARM_thumb);
+
+      if (check_namespaces
+	  && language == language_cplus
+	  && psym != NULL
+	  && SYMBOL_CPLUS_DEMANGLED_NAME (psym) != NULL)
+	cp_check_possible_namespace_symbols (SYMBOL_CPLUS_DEMANGLED_NAME (psym),
+					     objfile);
+    }
+}
+
+/* Walk the records of the cache file at R.  If APPLY, build the
+   partial symtabs they describe for OBJFILE; otherwise just check
+   that the file is well-formed.  Return 0 if it isn't.  */
+
+static int
+psymtab_cache_read (struct psymtab_cache_reader *r, struct objfile *objfile,
+		    struct psymtab_cache_key *key, int apply)
+{
+  struct psymtab_cache_key file_key;
+  char magic[8];
+  CORE_ADDR delta;
+  unsigned int n_records, i, j, count;
+
+  psymtab_cache_get (r, magic, sizeof (magic));
+  if (r->error || memcmp (magic, PSYMTAB_CACHE_MAGIC, sizeof (magic)) != 0
+      || psymtab_cache_get_u32 (r) != PSYMTAB_CACHE_VERSION
+      || psymtab_cache_get_u32 (r) != PSYMTAB_CACHE_BYTE_ORDER)
+    return 0;
+
+  psymtab_cache_get (r, file_key.uuid, sizeof (file_key.uuid));
+  file_key.inode = psymtab_cache_get_u64 (r);
+  file_key.mtime = psymtab_cache_get_u64 (r);
+  file_key.size = psymtab_cache_get_u64 (r);
+  file_key.info_size = psymtab_cache_get_u64 (r);
+  file_key.n_comp_units = psymtab_cache_get_u32 (r);
+  file_key.checksum = psymtab_cache_get_u32 (r);
+  if (r->error
+      || memcmp (file_key.uuid, key->uuid, sizeof (key->uuid)) != 0
+      || file_key.inode != key->inode
+      || file_key.mtime != key->mtime
+      || file_key.size != key->size
+      || file_key.info_size != key->info_size
+      || file_key.n_comp_units != key->n_comp_units
+      || file_key.checksum != key->checksum)
+    return 0;
+
+  delta = objfile_text_section_offset (objfile) - psymtab_cache_get_u64 (r);
+  n_records = psymtab_cache_get_u32 (r);
+
+  for (i = 0; i < n_records && !r->error; i++)
+    {
+      unsigned int offset = psymtab_cache_get_u32 (r);
+      unsigned int flags = psymtab_cache_get_u32 (r);
+      CORE_ADDR textlow = psymtab_cache_get_u64 (r);
+      CORE_ADDR texthigh = psymtab_cache_get_u64 (r);
+      char *filename = psymtab_cache_get_string (r);
+      char *dirname = psymtab_cache_get_string (r);
+      int check_namespaces = (flags & PSC_CU_CHECK_NAMESPACES) != 0;
+      struct dwarf2_per_cu_data *per_cu = NULL;
+      struct partial_symtab *pst = NULL;
+
+      if (r->error)
+	break;
+
+      if (!apply)
+	{
+	  /* The CU must exist in this objfile.  */
+	  struct dwarf2_per_cu_data *cu;
+
+	  if (offset >= dwarf2_per_objfile->info_size)
+	    return 0;
+	  cu = dwarf2_find_containing_comp_unit (offset, objfile);
+	  if (cu->offset != offset)
+	    return 0;
+	}
+      else
+	{
+	  per_cu = dwarf2_find_comp_unit (offset, objfile);
+
+	  pst = start_psymtab_common (objfile, objfile->section_offsets,
+				      filename, textlow + delta,
+				      objfile->global_psymbols.next,
+				      objfile->static_psymbols.next);
+	  if (flags & PSC_CU_HAS_DIRNAME)
+	    pst->dirname = obsavestring (dirname, strlen (dirname),
+					 &objfile->objfile_obstack);
+	  pst->read_symtab_private = (char *) per_cu;
+	  pst->read_symtab = dwarf2_psymtab_to_symtab;
+	  pst->texthigh = texthigh + delta;
+	  per_cu->psymtab = pst;
+	  per_cu->psym_check_namespaces = check_namespaces;
+	}
+
+      psymtab_cache_read_psymbols (r, objfile, &objfile->global_psymbols,
+				   delta, check_namespaces, apply);
+      psymtab_cache_read_psymbols (r, objfile, &objfile->static_psymbols,
+				   delta, check_namespaces, apply);
+
+      if (apply)
+	{
+	  pst->n_global_syms = objfile->global_psymbols.next -
+	    (objfile->global_psymbols.list + pst->globals_offset);
+	  pst->n_static_syms = objfile->static_psymbols.next -
+	    (objfile->static_psymbols.list + pst->statics_offset);
+	  sort_pst_symbols (pst);
+	}
+
+      count = psymtab_cache_get_u32 (r);
+      for (j = 0; j < count && !r->error; j++)
+	{
+	  char *name = psymtab_cache_get_string (r);
+
+	  if (apply && !r->error)
+	    {
+	      add_equiv_psym (&pst->equiv_psyms,
+			      obsavestring (name, strlen (name),
+					    &objfile->objfile_obstack));
+	      psym_equivalences = 1;
+	    }
+	}
+
+      count = psymtab_cache_get_u32 (r);
+      for (j = 0; j < count && !r->error; j++)
+	{
+	  char *name = psymtab_cache_get_string (r);
+
+	  if (apply && !r->error)
+	    dwarf2_create_include_psymtab (name, pst, objfile);
+	}
+    }
+
+  return !r->error && r->ptr == r->end;
+}
+
+/* Try to build OBJFILE's partial symtabs from the cache.  Return
+   non-zero if we did.  */
+
+static int
+psymtab_cache_load (struct objfile *objfile)
+{
+  struct psymtab_cache_key key;
+  struct psymtab_cache_reader r;
+  struct stat st;
+  char *path;
+  char *data = NULL;
+  int mapped = 0;
+  int fd;
+  int ok = 0;
+
+  /* Only when we are starting from nothing.  */
+  if (objfile->psymtabs != NULL
+      || objfile->global_psymbols.next != objfile->global_psymbols.list
+      || objfile->static_psymbols.next != objfile->static_psymbols.list)
+    return 0;
+
+  if (!psymtab_cache_key (objfile, &key, &path))
+    return 0;
+
+  fd = open (path, O_RDONLY | O_BINARY);
+  xfree (path);
+  if (fd < 0)
+    return 0;
+
+  if (fstat (fd, &st) != 0 || st.st_size == 0)
+    {
+      close (fd);
+      return 0;
+    }
+
+#ifdef HAVE_MMAP
+  data = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == (char *) MAP_FAILED)
+    data = NULL;
+  else
+    mapped = 1;
+#endif
+  if (data == NULL)
+    {
+      data = xmalloc (st.st_size);
+      if (read (fd, data, st.st_size) != st.st_size)
+	{
+	  xfree (data);
+	  close (fd);
+	  return 0;
+	}
+    }
+  close (fd);
+
+  /* Check the whole file before touching the objfile, so that a
+     stale or damaged file just means we read .debug_info instead.  */
+  r.ptr = data;
+  r.end = data + st.st_size;
+  r.error = 0;
+  if (psymtab_cache_read (&r, objfile, &key, 0))
+    {
+      r.ptr = data;
+      r.error = 0;
+      ok = psymtab_cache_read (&r, objfile, &key, 1);
+      if (ok)
+	sort_objfile_thumb_psyms (objfile);
+      if (ok && info_verbose)
+	printf_filtered (_("Read partial symbol tables for %s from the cache.\n"),
+			 objfile->name);
+    }
+
+#ifdef HAVE_MMAP
+  if (mapped)
+    munmap (data, st.st_size);
+  else
+#endif
+    xfree (data);
+
+  return ok;
+}
+
 /* Load the DIEs for a secondary CU into memory.  */
 
 static void
@@ -4320,6 +5172,8 @@ dwarf2_kext_psymtab_to_symtab (struct partial_symtab *pst)
   this_cu->cu = NULL;
   this_cu->psymtab = pst;
   this_cu->type_hash = NULL;
+  this_cu->line_sequences = NULL;
+  this_cu->num_line_sequences = 0;
 
   load_full_comp_unit (this_cu, addr_map);
 
@@ -4427,6 +5281,8 @@ dwarf2_debug_map_psymtab_to_symtab (struct partial_symtab *pst)
   this_cu->cu = NULL;
   this_cu->psymtab = pst;
   this_cu->type_hash = NULL;
+  this_cu->line_sequences = NULL;
+  this_cu->num_line_sequences = 0;
 
   load_full_comp_unit (this_cu, addr_map);
 
@@ -5014,7 +5870,9 @@ process_die (struct die_info *die, struct dwarf2_cu *cu)
 static void
 initialize_cu_func_list (struct dwarf2_cu *cu)
 {
-  cu->first_fn = cu->last_fn = cu->cached_fn = NULL;
+  cu->first_fn = cu->last_fn = NULL;
+  cu->sorted_fns = NULL;
+  cu->num_fns = 0;
 }
 
 static void
@@ -5180,6 +6038,10 @@ add_to_cu_func_list (const char *name, CORE_ADDR lowpc, CORE_ADDR highpc,
       cu->last_fn->next = thisfn;
 
   cu->last_fn = thisfn;
+
+  /* Make check_cu_functions sort the list again.  */
+  cu->sorted_fns = NULL;
+  cu->num_fns++;
 }
 
 /* APPLE LOCAL begin subroutine inlining  */
@@ -9395,31 +10257,84 @@ dwarf_decode_line_header (unsigned int offset, bfd *abfd,
    to the beginning of the function if necessary, and is called on
    addresses passed to record_line.  */
 
+static int
+compare_function_ranges (const void *a, const void *b)
+{
+  const struct function_range *fa = *(const struct function_range **) a;
+  const struct function_range *fb = *(const struct function_range **) b;
+
+  if (fa->lowpc < fb->lowpc)
+    return -1;
+  if (fa->lowpc > fb->lowpc)
+    return 1;
+  return 0;
+}
+
+/* APPLE LOCAL: Sort CU's function_ranges for check_cu_functions, which
+   is called for every line table row.  Searching the list linearly
+   made CUs with thousands of functions and a big line table take
+   time proportional to the product of the two.  */
+
+static void
+sort_cu_functions (struct dwarf2_cu *cu)
+{
+  struct function_range *fn;
+  int i;
+
+  cu->sorted_fns = (struct function_range **)
+    obstack_alloc (&cu->comp_unit_obstack,
+		   cu->num_fns * sizeof (struct function_range *));
+  cu->sorted_fns_max_highpc = (CORE_ADDR *)
+    obstack_alloc (&cu->comp_unit_obstack, cu->num_fns * sizeof (CORE_ADDR));
+
+  for (fn = cu->first_fn, i = 0; fn; fn = fn->next, i++)
+    cu->sorted_fns[i] = fn;
+  qsort (cu->sorted_fns, cu->num_fns, sizeof (struct function_range *),
+	 compare_function_ranges);
+
+  for (i = 0; i < cu->num_fns; i++)
+    {
+      cu->sorted_fns_max_highpc[i] = cu->sorted_fns[i]->highpc;
+      if (i > 0 && cu->sorted_fns_max_highpc[i - 1] > cu->sorted_fns[i]->highpc)
+	cu->sorted_fns_max_highpc[i] = cu->sorted_fns_max_highpc[i - 1];
+    }
+}
+
 static CORE_ADDR
 check_cu_functions (CORE_ADDR address, struct dwarf2_cu *cu)
 {
   struct function_range *fn;
+  int bot, top;
 
   /* Find the function_range containing address.  */
   if (!cu->first_fn)
     return address;
 
-  if (!cu->cached_fn)
-    cu->cached_fn = cu->first_fn;
+  if (cu->sorted_fns == NULL)
+    sort_cu_functions (cu);
 
-  fn = cu->cached_fn;
-  while (fn)
-    if (fn->lowpc <= address && fn->highpc > address)
-      goto found;
-    else
-      fn = fn->next;
+  /* Find the last function starting at or before ADDRESS, then walk
+     back as long as an earlier function could still contain it.  */
+  bot = 0;
+  top = cu->num_fns;
+  while (bot < top)
+    {
+      int mid = (bot + top) / 2;
 
-  fn = cu->first_fn;
-  while (fn && fn != cu->cached_fn)
-    if (fn->lowpc <= address && fn->highpc > address)
-      goto found;
-    else
-      fn = fn->next;
+      if (cu->sorted_fns[mid]->lowpc <= address)
+	bot = mid + 1;
+      else
+	top = mid;
+    }
+
+  for (top = bot - 1; top >= 0; top--)
+    {
+      if (cu->sorted_fns_max_highpc[top] <= address)
+	return address;
+      fn = cu->sorted_fns[top];
+      if (fn->highpc > address)
+	goto found;
+    }
 
   return address;
 
@@ -10031,6 +10946,294 @@ dwarf2_record_line (struct line_header *lh, char *comp_dir, struct dwarf2_cu *cu
 
 
 
+/* APPLE LOCAL: How dwarf_decode_line_sequence should treat the rows
+   of a sequence.  */
+
+enum line_decode_mode
+{
+  /* Only find the sequence's address range and where it ends.  */
+  LINE_DECODE_SCAN,
+
+  /* Note which files the sequence refers to, for the partial symtab.  */
+  LINE_DECODE_PSYMTAB,
+
+  /* Record the rows in the line tables of the current subfiles.  */
+  LINE_DECODE_FULL
+};
+
+/* Decode the sequence of the Line Number Program for LH and CU that
+   starts at LINE_PTR, as MODE says.  If SEQ is non-NULL, set its
+   address range, and set *DEFINES_FILE if the sequence uses
+   DW_LNE_define_file.  Returns a pointer to the end of the sequence,
+   or NULL if the program is mangled.  */
+
+static char *
+dwarf_decode_line_sequence (struct line_header *lh, char *comp_dir,
+			    bfd *abfd, struct dwarf2_cu *cu,
+			    char *line_ptr, enum line_decode_mode mode,
+			    struct line_sequence *seq, int *defines_file)
+{
+  char *line_end = lh->statement_program_end;
+  unsigned int bytes_read;
+  unsigned char op_code, extended_op, adj_opcode;
+  CORE_ADDR baseaddr = objfile_text_section_offset (cu->objfile);
+  const int record_p = (mode == LINE_DECODE_FULL);
+
+  /* state machine registers  */
+  CORE_ADDR address = 0;
+  unsigned int file = 1;
+  unsigned int line = 1;
+  unsigned int column = 0;
+  int is_stmt = lh->default_is_stmt;
+  int basic_block = 0;
+  int end_sequence = 0;
+
+  if (seq != NULL)
+    {
+      seq->offset = line_ptr - dwarf2_per_objfile->line_buffer;
+      seq->lowpc = (CORE_ADDR) -1;
+      seq->highpc = 0;
+    }
+
+  if (record_p && lh->num_file_names >= file)
+    {
+      /* Start a subfile for the current file of the state machine.  */
+      /* lh->include_dirs and lh->file_names are 0-based, but the
+	 directory and file name numbers in the statement program
+	 are 1-based.  */
+      struct file_entry *fe = &lh->file_names[file - 1];
+      char *dir;
+
+      if (fe->dir_index)
+	dir = lh->include_dirs[fe->dir_index - 1];
+      else
+	dir = comp_dir;
+      /* APPLE LOCAL: Pass in the compilation directory of this CU.  */
+      dwarf2_start_subfile (fe->name, dir, cu->comp_dir);
+    }
+
+  /* Decode the table.  */
+  while (!end_sequence)
+    {
+      int row_p = 0;
+
+      /* APPLE LOCAL: Check for missing DW_LNE_end_sequence
+	 at the end of the line table. */
+      if (line_ptr >= line_end)
+	{
+	  complaint (&symfile_complaints,
+		     _("Missing end sequence in DWARF2 line table."));
+	  op_code = DW_LNS_extended_op;
+	}
+      else
+	{
+	  op_code = read_1_byte (abfd, line_ptr);
+	  line_ptr += 1;
+	}
+
+      if (op_code >= lh->opcode_base)
+	{		
+	  /* Special operand.  */
+	  adj_opcode = op_code - lh->opcode_base;
+	  address += (adj_opcode / lh->line_range)
+	    * lh->minimum_instruction_length;
+	  line += lh->line_base + (adj_opcode % lh->line_range);
+	  row_p = 1;
+	  basic_block = 1;
+	}
+      else switch (op_code)
+	{
+	case DW_LNS_extended_op:
+	  /* APPLE LOCAL: Check for missing DW_LNE_end_sequence at 
+	     the end of the line table. */
+	  if (line_ptr >= line_end)
+	    {
+	      extended_op = DW_LNE_end_sequence;
+	    }
+	  else
+	    {
+	      read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
+	      line_ptr += bytes_read;
+	      extended_op = read_1_byte (abfd, line_ptr);
+	      line_ptr += 1;
+	    }
+
+	  switch (extended_op)
+	    {
+	    case DW_LNE_end_sequence:
+	      end_sequence = 1;
+	      row_p = 1;
+	      break;
+	    case DW_LNE_set_address:
+	      /* APPLE LOCAL Add cast to avoid type mismatch in arg4 warn.*/
+	      address = read_address (abfd, line_ptr, cu, 
+				      (int *) &bytes_read);
+	      line_ptr += bytes_read;
+	      break;
+	    case DW_LNE_define_file:
+	      {
+		char *cur_file;
+		unsigned int dir_index, mod_time, length;
+
+		cur_file = read_string (abfd, line_ptr, &bytes_read);
+		line_ptr += bytes_read;
+		dir_index =
+		  read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
+		line_ptr += bytes_read;
+		mod_time =
+		  read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
+		line_ptr += bytes_read;
+		length =
+		  read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
+		line_ptr += bytes_read;
+		/* When only scanning, leave the file table alone, since
+		   the sequence will be decoded again if it is wanted.  */
+		if (mode != LINE_DECODE_SCAN)
+		  add_file_name (lh, cur_file, dir_index, mod_time, length);
+		if (defines_file != NULL)
+		  *defines_file = 1;
+	      }
+	      break;
+	    default:
+	      complaint (&symfile_complaints,
+			 _("mangled .debug_line section"));
+	      return NULL;
+	    }
+	  break;
+	case DW_LNS_copy:
+	  row_p = 1;
+	  basic_block = 0;
+	  break;
+	case DW_LNS_advance_pc:
+	  address += lh->minimum_instruction_length
+	    * read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
+	  line_ptr += bytes_read;
+	  break;
+	case DW_LNS_advance_line:
+	  line += read_signed_leb128 (abfd, line_ptr, &bytes_read);
+	  line_ptr += bytes_read;
+	  break;
+	case DW_LNS_set_file:
+	  file = read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
+	  line_ptr += bytes_read;
+	  if (record_p)
+	    {
+	      /* The arrays lh->include_dirs and lh->file_names are
+		 0-based, but the directory and file name numbers in
+		 the statement program are 1-based.  */
+	      struct file_entry *fe;
+	      char *dir;
+
+	      fe = &lh->file_names[file - 1];
+	      if (fe->dir_index)
+		dir = lh->include_dirs[fe->dir_index - 1];
+	      else
+		dir = comp_dir;
+	      /* APPLE LOCAL: Pass in the compilation dir of this CU.  */
+	      dwarf2_start_subfile (fe->name, dir, cu->comp_dir);
+	    }
+	  break;
+	case DW_LNS_set_column:
+	  column = read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
+	  line_ptr += bytes_read;
+	  break;
+	case DW_LNS_negate_stmt:
+	  is_stmt = (!is_stmt);
+	  break;
+	case DW_LNS_set_basic_block:
+	  basic_block = 1;
+	  break;
+	/* Add to the address register of the state machine the
+	   address increment value corresponding to special opcode
+	   255.  I.e., this value is scaled by the minimum
+	   instruction length since special opcode 255 would have
+	   scaled the the increment.  */
+	case DW_LNS_const_add_pc:
+	  address += (lh->minimum_instruction_length
+		      * ((255 - lh->opcode_base) / lh->line_range));
+	  break;
+	case DW_LNS_fixed_advance_pc:
+	  address += read_2_bytes (abfd, line_ptr);
+	  line_ptr += 2;
+	  break;
+	default:
+	  {
+	    /* Unknown standard opcode, ignore it.  */
+	    int i;
+
+	    for (i = 0; i < lh->standard_opcode_lengths[op_code]; i++)
+	      {
+		(void) read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
+		line_ptr += bytes_read;
+	      }
+	  }
+	}
+
+      if (row_p)
+	{
+	  if (seq != NULL)
+	    {
+	      if (address < seq->lowpc)
+		seq->lowpc = address;
+	      if (address > seq->highpc)
+		seq->highpc = address;
+	    }
+	  /* The file table may not have been extended yet when we are
+	     only scanning.  */
+	  if (mode != LINE_DECODE_SCAN)
+	    lh->file_names[file - 1].included_p = 1;
+	  if (record_p)
+	    dwarf2_record_line (lh, comp_dir, cu, address, baseaddr, file, 
+				line, end_sequence);
+	}
+    }
+
+  return line_ptr;
+}
+
+/* APPLE LOCAL: Return non-zero if the rows of SEQ, a sequence of CU's
+   line number program, are worth recording.  The ones that aren't
+   describe code the linker discarded: the CU has a debug map and none
+   of the functions the sequence covers made it into the final
+   executable.  Decoding those only to have the debug map throw every
+   row away can be most of the work of reading a CU's line table.  */
+
+static int
+dwarf_line_sequence_wanted (struct line_sequence *seq, struct dwarf2_cu *cu)
+{
+  struct oso_to_final_addr_map *map = cu->addr_map;
+
+  if (map != NULL && map->tuples != NULL)
+    {
+      int bot = 0;
+      int top = map->entries;
+
+      /* Find the first function that doesn't end before the
+	 sequence starts, and see if any function from there on that
+	 starts before the sequence ends was kept.  */
+      while (bot < top)
+	{
+	  int mid = (bot + top) / 2;
+
+	  if (map->tuples[mid].oso_high_addr < seq->lowpc)
+	    bot = mid + 1;
+	  else
+	    top = mid;
+	}
+
+      for (; bot < map->entries; bot++)
+	{
+	  if (map->tuples[bot].oso_low_addr > seq->highpc)
+	    break;
+	  if (map->tuples[bot].present_in_final)
+	    return 1;
+	}
+      return 0;
+    }
+
+  return 1;
+}
+
 /* Decode the Line Number Program (LNP) for the given line_header
    structure and CU.  The actual information extracted and the type
    of structures created from the LNP depends on the value of PST.
@@ -10047,7 +11250,14 @@ dwarf2_record_line (struct line_header *lh, char *comp_dir, struct dwarf2_cu *cu
       is not used to compute the full name of the symtab, and therefore
       omitting it when building the partial symtab does not introduce
       the potential for inconsistency - a partial symtab and its associated
-      symbtab having a different fullname -).  */
+      symbtab having a different fullname -).
+
+   APPLE LOCAL: In the second case, if the CU has a debug map, the
+   boundaries of the program's sequences are saved in the CU's
+   dwarf2_per_cu_data.  In the first,
+   sequences for code that didn't make it into the final image are
+   skipped; the saved boundaries let us skip them without decoding
+   them at all.  */
 
 static void
 dwarf_decode_lines (struct line_header *lh, char *comp_dir, bfd *abfd,
@@ -10055,204 +11265,132 @@ dwarf_decode_lines (struct line_header *lh, char *comp_dir, bfd *abfd,
 {
   char *line_ptr;
   char *line_end;
-  unsigned int bytes_read;
-  unsigned char op_code, extended_op, adj_opcode;
-  CORE_ADDR baseaddr;
   struct objfile *objfile = cu->objfile;
   const int decode_for_pst_p = (pst != NULL);
-
-  baseaddr = objfile_text_section_offset (objfile);
+  struct dwarf2_per_cu_data *per_cu = cu->per_cu;
+  int defines_file = 0;
 
   line_ptr = lh->statement_program_start;
   line_end = lh->statement_program_end;
 
-  /* Read the statement sequences until there's nothing left.  */
-  while (line_ptr < line_end)
-    {
-      /* state machine registers  */
-      CORE_ADDR address = 0;
-      unsigned int file = 1;
-      unsigned int line = 1;
-      unsigned int column = 0;
-      int is_stmt = lh->default_is_stmt;
-      int basic_block = 0;
-      int end_sequence = 0;
-
-      if (!decode_for_pst_p && lh->num_file_names >= file)
-	{
-          /* Start a subfile for the current file of the state machine.  */
-	  /* lh->include_dirs and lh->file_names are 0-based, but the
-	     directory and file name numbers in the statement program
-	     are 1-based.  */
-          struct file_entry *fe = &lh->file_names[file - 1];
-          char *dir;
-
-          if (fe->dir_index)
-            dir = lh->include_dirs[fe->dir_index - 1];
-          else
-            dir = comp_dir;
-          /* APPLE LOCAL: Pass in the compilation directory of this CU.  */
-	  dwarf2_start_subfile (fe->name, dir, cu->comp_dir);
-	}
-
-      /* Decode the table.  */
-      while (!end_sequence)
+  if (decode_for_pst_p)
+    {
+      struct line_sequence *seqs = NULL;
+      int num_seqs = 0, max_seqs = 0;
+      struct cleanup *back_to = make_cleanup (free_current_contents, &seqs);
+      /* The boundaries are only any use for skipping dead sequences,
+	 which only a debug map can tell us about.  */
+      const int save_seqs_p = (per_cu != NULL
+			       && cu->addr_map != NULL
+			       && cu->addr_map->tuples != NULL);
+
+      /* Read the statement sequences until there's nothing left.  */
+      while (line_ptr < line_end)
 	{
-	  /* APPLE LOCAL: Check for missing DW_LNE_end_sequence
-	     at the end of the line table. */
-	  if (line_ptr >= line_end)
+	  if (!save_seqs_p)
 	    {
-	      complaint (&symfile_complaints,
-			 _("Missing end sequence in DWARF2 line table."));
-	      op_code = DW_LNS_extended_op;
+	      line_ptr = dwarf_decode_line_sequence (lh, comp_dir, abfd, cu,
+						     line_ptr,
+						     LINE_DECODE_PSYMTAB,
+						     NULL, NULL);
+	      if (line_ptr == NULL)
+		{
+		  do_cleanups (back_to);
+		  return;
+		}
+	      continue;
 	    }
-	  else
+
+	  if (num_seqs == max_seqs)
 	    {
-	      op_code = read_1_byte (abfd, line_ptr);
-	      line_ptr += 1;
+	      max_seqs = max_seqs ? max_seqs * 2 : 16;
+	      seqs = xrealloc (seqs, max_seqs * sizeof (struct line_sequence));
 	    }
-
-	  if (op_code >= lh->opcode_base)
-	    {		
-	      /* Special operand.  */
-	      adj_opcode = op_code - lh->opcode_base;
-	      address += (adj_opcode / lh->line_range)
-		* lh->minimum_instruction_length;
-	      line += lh->line_base + (adj_opcode % lh->line_range);
-              lh->file_names[file - 1].included_p = 1;
-              if (!decode_for_pst_p)
-		dwarf2_record_line (lh, comp_dir, cu, address, baseaddr, file, 
-				    line, end_sequence);
-	      basic_block = 1;
+	  line_ptr = dwarf_decode_line_sequence (lh, comp_dir, abfd, cu,
+						 line_ptr, LINE_DECODE_PSYMTAB,
+						 &seqs[num_seqs],
+						 &defines_file);
+	  if (line_ptr == NULL)
+	    {
+	      do_cleanups (back_to);
+	      return;
 	    }
-	  else switch (op_code)
+	  num_seqs++;
+	}
+
+      if (save_seqs_p && !defines_file && num_seqs > 0)
+	{
+	  per_cu->line_sequences = (struct line_sequence *)
+	    obstack_alloc (&objfile->objfile_obstack,
+			   num_seqs * sizeof (struct line_sequence));
+	  memcpy (per_cu->line_sequences, seqs,
+		  num_seqs * sizeof (struct line_sequence));
+	  per_cu->num_line_sequences = num_seqs;
+	}
+      do_cleanups (back_to);
+    }
+  else
+    {
+      struct line_sequence *seqs = NULL;
+      int num_seqs = 0;
+      int i = 0;
+
+      if (per_cu != NULL && per_cu->line_sequences != NULL)
+	{
+	  seqs = per_cu->line_sequences;
+	  num_seqs = per_cu->num_line_sequences;
+	}
+
+      /* Read the statement sequences until there's nothing left.  */
+      while (line_ptr < line_end)
+	{
+	  /* Only a debug map can say a sequence is dead; without one,
+	     finding the boundaries would just decode everything twice.  */
+	  if (dwarf2_skip_dead_line_sequences
+	      && cu->addr_map != NULL && cu->addr_map->tuples != NULL)
 	    {
-	    case DW_LNS_extended_op:
-	      /* APPLE LOCAL: Check for missing DW_LNE_end_sequence at 
-	         the end of the line table. */
-	      if (line_ptr >= line_end)
+	      struct line_sequence seq;
+	      char *seq_end;
+
+	      /* Use the saved boundaries as long as they agree with
+		 what we find; otherwise scan the sequence to find out
+		 where it goes.  */
+	      if (seqs != NULL && i < num_seqs
+		  && (line_ptr - dwarf2_per_objfile->line_buffer
+		      == seqs[i].offset))
 		{
-		  extended_op = DW_LNE_end_sequence;
+		  seq = seqs[i];
+		  if (i + 1 < num_seqs)
+		    seq_end = dwarf2_per_objfile->line_buffer
+		      + seqs[i + 1].offset;
+		  else
+		    seq_end = line_end;
 		}
 	      else
 		{
-		  read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
-		  line_ptr += bytes_read;
-		  extended_op = read_1_byte (abfd, line_ptr);
-		  line_ptr += 1;
+		  seqs = NULL;
+		  defines_file = 0;
+		  seq_end = dwarf_decode_line_sequence (lh, comp_dir, abfd, cu,
+							line_ptr,
+							LINE_DECODE_SCAN,
+							&seq, &defines_file);
+		  if (seq_end == NULL)
+		    return;
 		}
+	      i++;
 
-	      switch (extended_op)
+	      if (!defines_file && !dwarf_line_sequence_wanted (&seq, cu))
 		{
-		case DW_LNE_end_sequence:
-		  end_sequence = 1;
-                  lh->file_names[file - 1].included_p = 1;
-		  if (!decode_for_pst_p)
-		    dwarf2_record_line (lh, comp_dir, cu, address, baseaddr, 
-					file, line, end_sequence);
-		  break;
-		case DW_LNE_set_address:
-                  /* APPLE LOCAL Add cast to avoid type mismatch in arg4 warn.*/
-		  address = read_address (abfd, line_ptr, cu, 
-					  (int *) &bytes_read);
-		  line_ptr += bytes_read;
-		  break;
-		case DW_LNE_define_file:
-                  {
-                    char *cur_file;
-                    unsigned int dir_index, mod_time, length;
-                    
-                    cur_file = read_string (abfd, line_ptr, &bytes_read);
-                    line_ptr += bytes_read;
-                    dir_index =
-                      read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
-                    line_ptr += bytes_read;
-                    mod_time =
-                      read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
-                    line_ptr += bytes_read;
-                    length =
-                      read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
-                    line_ptr += bytes_read;
-                    add_file_name (lh, cur_file, dir_index, mod_time, length);
-                  }
-		  break;
-		default:
-		  complaint (&symfile_complaints,
-			     _("mangled .debug_line section"));
-		  return;
+		  line_ptr = seq_end;
+		  continue;
 		}
-	      break;
-	    case DW_LNS_copy:
-              lh->file_names[file - 1].included_p = 1;
-              if (!decode_for_pst_p)
-		dwarf2_record_line (lh, comp_dir, cu, address, baseaddr, file, 
-				    line, end_sequence);
-	      basic_block = 0;
-	      break;
-	    case DW_LNS_advance_pc:
-	      address += lh->minimum_instruction_length
-		* read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
-	      line_ptr += bytes_read;
-	      break;
-	    case DW_LNS_advance_line:
-	      line += read_signed_leb128 (abfd, line_ptr, &bytes_read);
-	      line_ptr += bytes_read;
-	      break;
-	    case DW_LNS_set_file:
-              {
-                /* The arrays lh->include_dirs and lh->file_names are
-                   0-based, but the directory and file name numbers in
-                   the statement program are 1-based.  */
-                struct file_entry *fe;
-                char *dir;
-
-                file = read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
-                line_ptr += bytes_read;
-                fe = &lh->file_names[file - 1];
-                if (fe->dir_index)
-                  dir = lh->include_dirs[fe->dir_index - 1];
-                else
-                  dir = comp_dir;
-                /* APPLE LOCAL: Pass in the compilation dir of this CU.  */
-                if (!decode_for_pst_p)
-                  dwarf2_start_subfile (fe->name, dir, cu->comp_dir);
-              }
-	      break;
-	    case DW_LNS_set_column:
-	      column = read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
-	      line_ptr += bytes_read;
-	      break;
-	    case DW_LNS_negate_stmt:
-	      is_stmt = (!is_stmt);
-	      break;
-	    case DW_LNS_set_basic_block:
-	      basic_block = 1;
-	      break;
-	    /* Add to the address register of the state machine the
-	       address increment value corresponding to special opcode
-	       255.  I.e., this value is scaled by the minimum
-	       instruction length since special opcode 255 would have
-	       scaled the the increment.  */
-	    case DW_LNS_const_add_pc:
-	      address += (lh->minimum_instruction_length
-			  * ((255 - lh->opcode_base) / lh->line_range));
-	      break;
-	    case DW_LNS_fixed_advance_pc:
-	      address += read_2_bytes (abfd, line_ptr);
-	      line_ptr += 2;
-	      break;
-	    default:
-	      {
-		/* Unknown standard opcode, ignore it.  */
-		int i;
-
-		for (i = 0; i < lh->standard_opcode_lengths[op_code]; i++)
-		  {
-		    (void) read_unsigned_leb128 (abfd, line_ptr, &bytes_read);
-		    line_ptr += bytes_read;
-		  }
-	      }
 	    }
+
+	  line_ptr = dwarf_decode_line_sequence (lh, comp_dir, abfd, cu,
+						 line_ptr, LINE_DECODE_FULL,
+						 NULL, NULL);
+	  if (line_ptr == NULL)
+	    return;
 	}
     }
 
@@ -13593,6 +14731,19 @@ caching, which can slow down startup."),
 			    &set_dwarf2_cmdlist,
 			    &show_dwarf2_cmdlist);
 
+  /* APPLE LOCAL */
+  add_setshow_boolean_cmd ("skip-dead-line-sequences", class_maintenance,
+			   &dwarf2_skip_dead_line_sequences, _("\
+Set whether to skip line number sequences for discarded code."), _("\
+Show whether to skip line number sequences for discarded code."), _("\
+When on, reading a compilation unit's line table skips the sequences\n\
+of its line number program that a debug map says cover only code the\n\
+linker discarded, instead of decoding them and throwing the rows away."),
+			   NULL,
+			   show_dwarf2_skip_dead_line_sequences,
+			   &set_dwarf2_cmdlist,
+			   &show_dwarf2_cmdlist);
+
   /* APPLE LOCAL begin subroutine inlining  */
   add_setshow_boolean_cmd ("inlined-stepping", class_support, 
 			   &dwarf2_allow_inlined_stepping,
@@ -13614,6 +14765,27 @@ caching, which can slow down startup."),
 			   _("Show gdb informing you when you are debugging optimized code."),
 			   NULL, NULL, NULL, &setlist, &showlist);
   /* APPLE LOCAL end Inform users about debugging optimized code  */
+
+  add_setshow_filename_cmd ("psymtab-cache-directory", class_support,
+			    &psymtab_cache_directory, _("\
+Set the directory of the partial symbol table cache."), _("\
+Show the directory of the partial symbol table cache."), _("\
+When set, the partial symbol tables read from DWARF debug info are saved\n\
+in this directory, and later sessions load them from there instead of\n\
+reading the debug info again.  An empty directory disables the cache."),
+			    NULL,
+			    show_psymtab_cache_directory,
+			    &setlist, &showlist);
+
+  add_setshow_uinteger_cmd ("psymtab-cache-size", class_support,
+			    &psymtab_cache_size, _("\
+Set the size limit of the partial symbol table cache, in megabytes."), _("\
+Show the size limit of the partial symbol table cache, in megabytes."), _("\
+When the cache grows past this size, the least recently written files\n\
+are removed from it.  Zero means no limit."),
+			    NULL,
+			    show_psymtab_cache_size,
+			    &setlist, &showlist);
 }
 
 /* APPLE LOCAL begin dwarf repository  */
@@ -213,6 +213,30 @@ static struct
   }
 timer_list;
 
+/* APPLE LOCAL begin idle handlers */
+/* Structure associated with an idle handler.  PROC is called whenever
+   the event loop finds nothing else to do, until it returns zero.  */
+struct gdb_idle_handler
+  {
+    int idle_id;
+    struct gdb_idle_handler *next;
+    idle_handler_func *proc;	/* Function to call to do the work */
+    gdb_client_data client_data;	/* Argument to idle_handler_func */
+  };
+
+/* List of currently active idle handlers.  They are run one at a
+   time, round robin, from the head of the list.  */
+static struct
+  {
+    /* Pointer to first in idle handler list. */
+    struct gdb_idle_handler *first_handler;
+
+    /* Id of the last idle handler created. */
+    int num_handlers;
+  }
+idle_list;
+/* APPLE LOCAL end idle handlers */
+
 /* All the async_signal_handlers gdb is interested in are kept onto
    this list. */
 static struct
@@ -247,6 +271,8 @@ static int process_event (void);
 /* APPLE LOCAL async */
 static void handle_timer_event (void *dummy);
 static void poll_timers (void);
+/* APPLE LOCAL idle handlers */
+static int invoke_idle_handler (void);
 
 /* APPLE LOCAL begin async */
 void
@@ -453,6 +479,18 @@ gdb_do_one_event (void *data)
   /* Are any timers that are ready? If so, put an event on the queue. */
   poll_timers ();
 
+  /* APPLE LOCAL begin idle handlers */
+  /* If there is idle work pending, just check for new events instead
+     of blocking in gdb_wait_for_event.  */
+  if (idle_list.first_handler != NULL)
+    {
+      gdb_notifier.poll_timeout = 0;
+      gdb_notifier.select_timeout.tv_sec = 0;
+      gdb_notifier.select_timeout.tv_usec = 0;
+      gdb_notifier.timeout_valid = 1;
+    }
+  /* APPLE LOCAL end idle handlers */
+
   /* Wait for a new event.  If gdb_wait_for_event returns -1,
      we should get out because this means that there are no
      event sources left. This will make the event loop stop,
@@ -469,6 +507,13 @@ gdb_do_one_event (void *data)
       return 1;
     }
 
+  /* APPLE LOCAL begin idle handlers */
+  /* Nothing happened while we waited, so give the idle handlers a
+     turn.  */
+  if (invoke_idle_handler ())
+    return 1;
+  /* APPLE LOCAL end idle handlers */
+
   /* If gdb_wait_for_event has returned 1, it means that one
      event has been handled. We break out of the loop. */
   return 1;
@@ -1370,3 +1415,118 @@ poll_timers (void)
   else
     gdb_notifier.timeout_valid = 0;
 }
+
+/* APPLE LOCAL begin idle handlers */
+/* Create an idle handler.  PROC will be called with CLIENT_DATA each
+   time the event loop has nothing else to do, until it returns zero
+   or the handler is deleted.  While there are idle handlers the event
+   loop polls for events rather than blocking, so PROC should do a
+   small piece of work and return.  Return a handle to the idle
+   handler.  */
+int
+create_idle_handler (idle_handler_func * proc, gdb_client_data client_data)
+{
+  struct gdb_idle_handler *idle_ptr, *prev_idle;
+
+  idle_ptr = (struct gdb_idle_handler *)
+    xmalloc (sizeof (struct gdb_idle_handler));
+  idle_ptr->proc = proc;
+  idle_ptr->client_data = client_data;
+  idle_ptr->next = NULL;
+  idle_list.num_handlers++;
+  idle_ptr->idle_id = idle_list.num_handlers;
+
+  /* New handlers go to the end of the list, so they wait their turn.  */
+  if (idle_list.first_handler == NULL)
+    idle_list.first_handler = idle_ptr;
+  else
+    {
+      for (prev_idle = idle_list.first_handler;
+	   prev_idle->next != NULL;
+	   prev_idle = prev_idle->next)
+	;
+      prev_idle->next = idle_ptr;
+    }
+
+  return idle_ptr->idle_id;
+}
+
+/* Get rid of the idle handler with handle ID.  It is fine to call
+   this from the handler's own PROC.  */
+void
+delete_idle_handler (int id)
+{
+  struct gdb_idle_handler *idle_ptr, *prev_idle = NULL;
+
+  for (idle_ptr = idle_list.first_handler; idle_ptr != NULL;
+       idle_ptr = idle_ptr->next)
+    {
+      if (idle_ptr->idle_id == id)
+	break;
+      prev_idle = idle_ptr;
+    }
+
+  if (idle_ptr == NULL)
+    return;
+
+  if (prev_idle == NULL)
+    idle_list.first_handler = idle_ptr->next;
+  else
+    prev_idle->next = idle_ptr->next;
+  xfree (idle_ptr);
+}
+
+/* Run the idle handler at the head of the list, then move it to the
+   end so that the others get a turn, or delete it if its procedure
+   says it is done.  Return 1 if there was a handler to run, else 0.  */
+static int
+invoke_idle_handler (void)
+{
+  struct gdb_idle_handler *idle_ptr, *prev_idle;
+  int id;
+  int more;
+
+  idle_ptr = idle_list.first_handler;
+  if (idle_ptr == NULL)
+    return 0;
+
+  /* PROC may delete this handler, or create others, so remember it by
+     its id and look it up again afterwards.  */
+  id = idle_ptr->idle_id;
+  more = (*idle_ptr->proc) (idle_ptr->client_data);
+
+  prev_idle = NULL;
+  for (idle_ptr = idle_list.first_handler; idle_ptr != NULL;
+       idle_ptr = idle_ptr->next)
+    {
+      if (idle_ptr->idle_id == id)
+	break;
+      prev_idle = idle_ptr;
+    }
+
+  if (idle_ptr == NULL)
+    return 1;
+
+  if (!more)
+    {
+      delete_idle_handler (id);
+      return 1;
+    }
+
+  if (idle_ptr->next != NULL)
+    {
+      if (prev_idle == NULL)
+	idle_list.first_handler = idle_ptr->next;
+      else
+	prev_idle->next = idle_ptr->next;
+      for (prev_idle = idle_ptr->next;
+	   prev_idle->next != NULL;
+	   prev_idle = prev_idle->next)
+	;
+      prev_idle->next = idle_ptr;
+      idle_ptr->next = NULL;
+    }
+
+  return 1;
+}
+/* APPLE LOCAL end idle handlers */
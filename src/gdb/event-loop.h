@@ -62,6 +62,8 @@ struct async_signal_handler;
 typedef void (handler_func) (int, gdb_client_data);
 typedef void (sig_handler_func) (gdb_client_data);
 typedef void (timer_handler_func) (gdb_client_data);
+/* APPLE LOCAL idle handlers */
+typedef int (idle_handler_func) (gdb_client_data);
 
 /* Where to add an event onto the event queue, by queue_event. */
 typedef enum
@@ -95,6 +97,10 @@ extern struct async_signal_handler *
 extern void delete_async_signal_handler (struct async_signal_handler **async_handler_ptr);
 extern int create_timer (int milliseconds, timer_handler_func * proc, gdb_client_data client_data);
 extern void delete_timer (int id);
+/* APPLE LOCAL begin idle handlers */
+extern int create_idle_handler (idle_handler_func * proc, gdb_client_data client_data);
+extern void delete_idle_handler (int id);
+/* APPLE LOCAL end idle handlers */
 
 /* APPLE LOCAL async */
 typedef void (event_handler_func) (void *);
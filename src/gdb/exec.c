@@ -49,6 +49,10 @@
 #ifndef O_BINARY
 #define O_BINARY 0
 #endif
+/* APPLE LOCAL section index */
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #include "xcoffsolib.h"
 
@@ -503,6 +507,8 @@ build_section_table (struct bfd *some_bfd, struct section_table **start,
   bfd_map_over_sections (some_bfd, add_to_section_table, (char *) end);
   if (*end > *start + count)
     internal_error (__FILE__, __LINE__, _("failed internal consistency check"));
+  /* APPLE LOCAL section index */
+  target_sections_generation++;
   /* We could realloc the table, but it probably loses for most files.  */
   return 0;
 }
@@ -562,6 +568,272 @@ map_vmap (bfd *abfd, bfd *arch)
   return vp;
 }
 
+/* APPLE LOCAL begin section index */
+/* Core files can have tens of thousands of sections, and scripts that
+   walk a heap in a core file do millions of small reads, so we don't
+   want to scan the section table on each one.  Instead we keep an
+   index of each table sorted by start address.  Section tables can
+   overlap, so alongside the sorted sections we keep the highest end
+   address seen so far; a lookup walks back from the last section
+   starting at or below the address only as long as that is above the
+   address.  */
+
+struct section_index
+{
+  /* The table this indexes, and target_sections_generation when we
+     built the index.  */
+  struct section_table *sections;
+  struct section_table *sections_end;
+  unsigned int generation;
+
+  /* The sections sorted by start address, ties in table order.  */
+  int count;
+  struct section_table **sorted;
+
+  /* MAX_END[I] is the highest end address of SORTED[0] to SORTED[I].  */
+  CORE_ADDR *max_end;
+};
+
+/* There are usually only two interesting tables, the exec file's and
+   the core file's.  */
+
+#define SECTION_INDEX_CACHE_SIZE 4
+
+static struct section_index section_indexes[SECTION_INDEX_CACHE_SIZE];
+static int next_section_index;
+
+/* A file mapped with section_table_map_bfd.  */
+
+struct mapped_bfd
+{
+  bfd *abfd;
+  gdb_byte *base;
+  size_t size;
+  struct mapped_bfd *next;
+};
+
+static struct mapped_bfd *mapped_bfds;
+
+/* Counts reported by "maint print section-lookup-stats".  */
+
+static struct
+{
+  unsigned long index_builds;
+  unsigned long lookups;
+  unsigned long probes;
+  unsigned long mapped_reads;
+  ULONGEST mapped_bytes;
+  unsigned long bfd_reads;
+  ULONGEST bfd_bytes;
+} section_stats;
+
+static int
+compare_section_table_ptrs (const void *a, const void *b)
+{
+  const struct section_table *sa = *(const struct section_table **) a;
+  const struct section_table *sb = *(const struct section_table **) b;
+
+  if (sa->addr != sb->addr)
+    return sa->addr < sb->addr ? -1 : 1;
+  if (sa != sb)
+    return sa < sb ? -1 : 1;
+  return 0;
+}
+
+/* Return an up to date index for TARGET's section table.  */
+
+static struct section_index *
+lookup_section_index (struct target_ops *target)
+{
+  struct section_index *idx;
+  int i;
+
+  for (i = 0; i < SECTION_INDEX_CACHE_SIZE; i++)
+    {
+      idx = &section_indexes[i];
+      if (idx->sections == target->to_sections
+	  && idx->sections_end == target->to_sections_end
+	  && idx->generation == target_sections_generation)
+	return idx;
+    }
+
+  idx = &section_indexes[next_section_index];
+  next_section_index = (next_section_index + 1) % SECTION_INDEX_CACHE_SIZE;
+
+  idx->sections = target->to_sections;
+  idx->sections_end = target->to_sections_end;
+  idx->generation = target_sections_generation;
+  idx->count = target->to_sections_end - target->to_sections;
+  idx->sorted = xrealloc (idx->sorted,
+			  (idx->count + 1) * sizeof (struct section_table *));
+  idx->max_end = xrealloc (idx->max_end, (idx->count + 1) * sizeof (CORE_ADDR));
+
+  for (i = 0; i < idx->count; i++)
+    idx->sorted[i] = &target->to_sections[i];
+  qsort (idx->sorted, idx->count, sizeof (struct section_table *),
+	 compare_section_table_ptrs);
+  for (i = 0; i < idx->count; i++)
+    {
+      idx->max_end[i] = idx->sorted[i]->endaddr;
+      if (i > 0 && idx->max_end[i - 1] > idx->max_end[i])
+	idx->max_end[i] = idx->max_end[i - 1];
+    }
+
+  section_stats.index_builds++;
+  return idx;
+}
+
+struct section_table *
+section_table_lookup (struct target_ops *target, CORE_ADDR addr,
+		      CORE_ADDR *next)
+{
+  struct section_index *idx;
+  struct section_table *found = NULL;
+  int lo, hi, i;
+
+  if (target->to_sections == target->to_sections_end)
+    return NULL;
+
+  idx = lookup_section_index (target);
+  section_stats.lookups++;
+
+  /* Find the first section starting above ADDR.  */
+  lo = 0;
+  hi = idx->count;
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      section_stats.probes++;
+      if (idx->sorted[mid]->addr <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  if (lo < idx->count && next != NULL)
+    *next = idx->sorted[lo]->addr;
+
+  /* Of the sections starting at or below ADDR that contain it, return
+     the one earliest in the table, as a linear scan would.  */
+  for (i = lo - 1; i >= 0 && idx->max_end[i] > addr; i--)
+    {
+      section_stats.probes++;
+      if (idx->sorted[i]->endaddr > addr
+	  && (found == NULL || idx->sorted[i] < found))
+	found = idx->sorted[i];
+    }
+
+  return found;
+}
+
+void
+section_table_map_bfd (bfd *abfd)
+{
+#ifdef HAVE_MMAP
+  struct mapped_bfd *m;
+  struct stat st;
+  gdb_byte *base;
+  int fd;
+
+  if (abfd->my_archive != NULL)
+    return;
+
+  fd = open (bfd_get_filename (abfd), O_RDONLY | O_BINARY, 0);
+  if (fd < 0)
+    return;
+  if (fstat (fd, &st) < 0
+      || st.st_size <= 0
+      || (off_t) (size_t) st.st_size != st.st_size)
+    {
+      close (fd);
+      return;
+    }
+
+  base = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (base == (gdb_byte *) MAP_FAILED)
+    return;
+
+  m = XMALLOC (struct mapped_bfd);
+  m->abfd = abfd;
+  m->base = base;
+  m->size = st.st_size;
+  m->next = mapped_bfds;
+  mapped_bfds = m;
+#endif
+}
+
+void
+section_table_unmap_bfd (bfd *abfd)
+{
+#ifdef HAVE_MMAP
+  struct mapped_bfd **mp;
+
+  for (mp = &mapped_bfds; *mp != NULL; mp = &(*mp)->next)
+    if ((*mp)->abfd == abfd)
+      {
+	struct mapped_bfd *m = *mp;
+
+	*mp = m->next;
+	munmap (m->base, m->size);
+	xfree (m);
+	return;
+      }
+#endif
+}
+
+/* Read LEN bytes at OFFSET in section P into MYADDR, from the mapped
+   file if we have one and otherwise through BFD.  Return non-zero on
+   success.  */
+
+static int
+read_section_contents (struct section_table *p, gdb_byte *myaddr,
+		       CORE_ADDR offset, int len)
+{
+  struct mapped_bfd *m;
+  asection *asect = p->the_bfd_section;
+
+  for (m = mapped_bfds; m != NULL; m = m->next)
+    if (m->abfd == p->bfd)
+      break;
+
+  if (m != NULL
+      && (bfd_get_section_flags (p->bfd, asect) & SEC_HAS_CONTENTS)
+      && asect->filepos >= 0
+      && offset + len <= bfd_section_size (p->bfd, asect)
+      && asect->filepos + offset + len <= m->size)
+    {
+      memcpy (myaddr, m->base + asect->filepos + offset, len);
+      section_stats.mapped_reads++;
+      section_stats.mapped_bytes += len;
+      return 1;
+    }
+
+  section_stats.bfd_reads++;
+  section_stats.bfd_bytes += len;
+  return bfd_get_section_contents (p->bfd, asect, myaddr, offset, len);
+}
+
+static void
+maintenance_print_section_lookup_stats (char *args, int from_tty)
+{
+  printf_filtered (_("Section index builds: %lu\n"),
+		   section_stats.index_builds);
+  printf_filtered (_("Section lookups: %lu\n"), section_stats.lookups);
+  printf_filtered (_("Sections examined: %lu\n"), section_stats.probes);
+  if (section_stats.lookups > 0)
+    printf_filtered (_("Sections examined per lookup: %.2f\n"),
+		     (double) section_stats.probes / section_stats.lookups);
+  printf_filtered (_("Reads from mapped files: %lu (%s bytes)\n"),
+		   section_stats.mapped_reads,
+		   paddr_d (section_stats.mapped_bytes));
+  printf_filtered (_("Reads through BFD: %lu (%s bytes)\n"),
+		   section_stats.bfd_reads,
+		   paddr_d (section_stats.bfd_bytes));
+}
+/* APPLE LOCAL end section index */
+
 /* Read or write the exec file.
 
    Args are address within a BFD file, address within gdb address-space,
@@ -602,6 +874,28 @@ xfer_memory_1 (CORE_ADDR memaddr, gdb_byte *myaddr, int len, int write,
   memend = memaddr + len;
   nextsectaddr = memend;
 
+  /* APPLE LOCAL begin section index */
+  if (!(overlay_debugging && section))
+    {
+      p = section_table_lookup (target, memaddr, &nextsectaddr);
+      if (p == NULL)
+	{
+	  if (nextsectaddr >= memend)
+	    return 0;
+	  return -(nextsectaddr - memaddr);
+	}
+
+      if (memend > p->endaddr)
+	len = p->endaddr - memaddr;
+      if (write)
+	res = bfd_set_section_contents (p->bfd, p->the_bfd_section,
+					myaddr, memaddr - p->addr, len);
+      else
+	res = read_section_contents (p, myaddr, memaddr - p->addr, len);
+      return (res != 0) ? len : 0;
+    }
+  /* APPLE LOCAL end section index */
+
   for (p = target->to_sections; p < target->to_sections_end; p++)
     {
       if (overlay_debugging && section && p->the_bfd_section &&
@@ -822,6 +1116,8 @@ exec_set_section_offsets (bfd_signed_vma text_off, bfd_signed_vma data_off,
 	  sect->endaddr += bss_off;
 	}
     }
+  /* APPLE LOCAL section index */
+  target_sections_generation++;
 }
 
 static void
@@ -852,6 +1148,8 @@ set_section_command (char *args, int from_tty)
 	  offset = secaddr - p->addr;
 	  p->addr += offset;
 	  p->endaddr += offset;
+	  /* APPLE LOCAL section index */
+	  target_sections_generation++;
 	  if (from_tty)
 	    exec_files_info (&exec_ops);
 	  return;
@@ -881,6 +1179,8 @@ exec_set_section_address (const char *filename, int index, CORE_ADDR address)
 	{
 	  p->addr = address;
 	  p->endaddr += address;
+	  /* APPLE LOCAL section index */
+	  target_sections_generation++;
 	}
     }
 }
@@ -981,6 +1281,12 @@ Show writing into executable and core files."), NULL,
 			   &setlist, &showlist);
 
   add_target (&exec_ops);
+
+  /* APPLE LOCAL section index */
+  add_cmd ("section-lookup-stats", class_maintenance,
+	   maintenance_print_section_lookup_stats, _("\
+Print how section table lookups and reads have been served."),
+	   &maintenanceprintlist);
 }
 
 static char *
@@ -39,6 +39,23 @@ extern int build_section_table (struct bfd *, struct section_table **,
 /* Set the loaded address of a section.  */
 extern void exec_set_section_address (const char *, int, CORE_ADDR);
 
+/* APPLE LOCAL begin section index */
+/* Return the first section in TARGET's section table that contains
+   ADDR, or NULL if there is none.  In that case, if NEXT is non-NULL,
+   set *NEXT to the lowest section start address above ADDR, or leave
+   it alone if there is no such section.  */
+extern struct section_table *section_table_lookup (struct target_ops *target,
+						   CORE_ADDR addr,
+						   CORE_ADDR *next);
+
+/* Map all of ABFD's file into memory, so that reads from its sections
+   through the section tables can be served from the mapping instead
+   of through BFD.  This does nothing if the file can't be mapped.
+   Call section_table_unmap_bfd before closing ABFD.  */
+extern void section_table_map_bfd (struct bfd *abfd);
+extern void section_table_unmap_bfd (struct bfd *abfd);
+/* APPLE LOCAL end section index */
+
 extern int only_read_from_live_memory;
 int set_only_read_from_live_memory (int newval);
 void set_only_read_from_live_memory_cleanup (void *new);
@@ -0,0 +1,368 @@
+/* The find command.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#include "defs.h"
+#include <ctype.h>
+#include "gdb_string.h"
+#include "gdb_assert.h"
+#include "gdbcmd.h"
+#include "value.h"
+#include "target.h"
+#include "findcmd.h"
+
+/* Make room for LEN more bytes at the end of PATTERN.  */
+
+static void
+search_pattern_reserve (struct search_pattern *pattern, ULONGEST len)
+{
+  if (pattern->len + len <= pattern->size)
+    return;
+
+  if (pattern->size == 0)
+    pattern->size = 100;
+  while (pattern->len + len > pattern->size)
+    pattern->size *= 2;
+  pattern->buf = xrealloc (pattern->buf, pattern->size);
+}
+
+/* Append the C string literal at *ARGP, without its terminating NUL,
+   to PATTERN.  Strings are parsed here rather than evaluated, since
+   evaluating a string literal copies it into the inferior.  */
+
+static void
+search_pattern_append_string (struct search_pattern *pattern, char **argp)
+{
+  char *s = *argp;
+
+  gdb_assert (*s == '"');
+  s++;
+  while (*s != '"')
+    {
+      int c;
+
+      if (*s == '\0')
+	error (_("Unterminated string in expression."));
+      if (*s == '\\')
+	{
+	  s++;
+	  c = parse_escape (&s);
+	  if (c == -1)
+	    continue;
+	}
+      else
+	c = *s++;
+
+      search_pattern_reserve (pattern, 1);
+      pattern->buf[pattern->len++] = c;
+    }
+
+  *argp = s + 1;
+}
+
+/* See findcmd.h.  */
+
+void
+search_pattern_append (struct search_pattern *pattern, char **argp,
+		       char size)
+{
+  struct value *v;
+  struct type *t;
+  char *s = *argp;
+
+  while (isspace (*s))
+    s++;
+
+  if (*s == '"')
+    {
+      search_pattern_append_string (pattern, &s);
+      while (isspace (*s))
+	s++;
+      if (*s != ',' && *s != '\0')
+	error (_("Junk after string in search pattern."));
+      *argp = s;
+      return;
+    }
+
+  v = parse_to_comma_and_eval (&s);
+  t = check_typedef (value_type (v));
+
+  if (size != 0)
+    {
+      ULONGEST x = value_as_long (v);
+      int len;
+
+      switch (size)
+	{
+	case 'b':
+	  len = 1;
+	  break;
+	case 'h':
+	  len = 2;
+	  break;
+	case 'w':
+	  len = 4;
+	  break;
+	case 'g':
+	  len = 8;
+	  break;
+	default:
+	  gdb_assert (0);
+	}
+
+      search_pattern_reserve (pattern, len);
+      store_unsigned_integer (pattern->buf + pattern->len, len, x);
+      pattern->len += len;
+    }
+  else
+    {
+      search_pattern_reserve (pattern, TYPE_LENGTH (t));
+      memcpy (pattern->buf + pattern->len, value_contents (v),
+	      TYPE_LENGTH (t));
+      pattern->len += TYPE_LENGTH (t);
+    }
+
+  *argp = s;
+}
+
+/* See findcmd.h.  */
+
+ULONGEST
+search_memory_all (CORE_ADDR start_addr, ULONGEST search_space_len,
+		   const struct search_pattern *pattern, ULONGEST max_count,
+		   void (*found_func) (CORE_ADDR, void *), void *data)
+{
+  ULONGEST found_count = 0;
+
+  while (search_space_len >= pattern->len && found_count < max_count)
+    {
+      CORE_ADDR found_addr;
+      ULONGEST next_iter_incr;
+      int found;
+
+      QUIT;
+
+      found = target_search_memory (start_addr, search_space_len,
+				    pattern->buf, pattern->len, &found_addr);
+      if (found <= 0)
+	break;
+
+      found_func (found_addr, data);
+      found_count++;
+
+      /* Begin the next search at the byte after this match, so that
+	 overlapping matches are found too.  */
+      next_iter_incr = (found_addr - start_addr) + 1;
+      search_space_len -= next_iter_incr;
+      start_addr += next_iter_incr;
+    }
+
+  return found_count;
+}
+
+/* Parse the arguments to "find": the optional /SIZE-CHAR and
+   /MAX-COUNT, the range to search and the pattern to search it for.  */
+
+static void
+parse_find_args (char *args, ULONGEST *max_countp,
+		 struct search_pattern *pattern,
+		 CORE_ADDR *start_addrp, ULONGEST *search_space_lenp)
+{
+  char size = 0;
+  ULONGEST max_count = ~(ULONGEST) 0;
+  CORE_ADDR start_addr;
+  ULONGEST search_space_len;
+  struct value *v;
+  char *s = args;
+
+  if (args == NULL)
+    error (_("Missing search parameters."));
+
+  while (*s == '/')
+    {
+      s++;
+      while (*s != '\0' && *s != '/' && !isspace (*s))
+	{
+	  if (isdigit (*s))
+	    {
+	      max_count = strtoul (s, &s, 10);
+	      if (max_count == 0)
+		error (_("Invalid count."));
+	      continue;
+	    }
+
+	  switch (*s)
+	    {
+	    case 'b':
+	    case 'h':
+	    case 'w':
+	    case 'g':
+	      size = *s++;
+	      break;
+	    default:
+	      error (_("Invalid size granularity."));
+	    }
+	}
+
+      while (isspace (*s))
+	s++;
+    }
+
+  /* Get the search range.  */
+
+  v = parse_to_comma_and_eval (&s);
+  start_addr = value_as_address (v);
+
+  if (*s != ',')
+    error (_("Missing search range."));
+  s++;
+  while (isspace (*s))
+    s++;
+
+  if (*s == '+')
+    {
+      LONGEST len;
+
+      s++;
+      v = parse_to_comma_and_eval (&s);
+      len = value_as_long (v);
+      if (len == 0)
+	error (_("Empty search range."));
+      if (len < 0)
+	error (_("Invalid length."));
+      /* Watch for overflows.  */
+      if (start_addr + len - 1 < start_addr)
+	error (_("Overflow in address range computation, choose smaller range."));
+      search_space_len = len;
+    }
+  else
+    {
+      CORE_ADDR end_addr;
+
+      v = parse_to_comma_and_eval (&s);
+      end_addr = value_as_address (v);
+      if (start_addr > end_addr)
+	error (_("Invalid search space, end preceeds start."));
+      search_space_len = end_addr - start_addr + 1;
+      /* We don't support searching all of memory (i.e. len == 0 would
+	 be the whole address space).  */
+      if (search_space_len == 0)
+	error (_("Overflow in address range computation, choose smaller range."));
+    }
+
+  if (*s != ',')
+    error (_("Missing search pattern."));
+  s++;
+
+  /* Fetch the search pattern.  */
+
+  while (*s != '\0')
+    {
+      search_pattern_append (pattern, &s, size);
+
+      while (isspace (*s))
+	s++;
+      if (*s == ',')
+	s++;
+    }
+
+  if (pattern->len == 0)
+    error (_("Missing search pattern."));
+
+  if (search_space_len < pattern->len)
+    error (_("Search space too small to contain pattern."));
+
+  *max_countp = max_count;
+  *start_addrp = start_addr;
+  *search_space_lenp = search_space_len;
+}
+
+/* Print each match "find" finds, and remember the last one.  */
+
+static void
+find_command_print_match (CORE_ADDR found_addr, void *data)
+{
+  CORE_ADDR *last_found_addrp = data;
+
+  print_address (found_addr, gdb_stdout);
+  printf_filtered ("\n");
+  *last_found_addrp = found_addr;
+}
+
+static void
+find_command (char *args, int from_tty)
+{
+  struct search_pattern pattern;
+  ULONGEST max_count;
+  CORE_ADDR start_addr;
+  ULONGEST search_space_len;
+  CORE_ADDR last_found_addr = 0;
+  ULONGEST found_count;
+  struct cleanup *old_cleanups;
+
+  memset (&pattern, 0, sizeof (pattern));
+  old_cleanups = make_cleanup (free_current_contents, &pattern.buf);
+
+  parse_find_args (args, &max_count, &pattern, &start_addr,
+		   &search_space_len);
+
+  found_count = search_memory_all (start_addr, search_space_len, &pattern,
+				   max_count, find_command_print_match,
+				   &last_found_addr);
+
+  /* Record the number found, and the last address found, in
+     convenience variables.  */
+
+  set_internalvar (lookup_internalvar ("numfound"),
+		   value_from_longest (builtin_type_int, found_count));
+  if (found_count > 0)
+    {
+      set_internalvar (lookup_internalvar ("_"),
+		       value_from_pointer (builtin_type_void_data_ptr,
+					   last_found_addr));
+      printf_filtered ("%s pattern%s found.\n", paddr_u (found_count),
+		       found_count > 1 ? "s" : "");
+    }
+  else
+    printf_filtered ("Pattern not found.\n");
+
+  do_cleanups (old_cleanups);
+}
+
+void
+_initialize_mem_search (void)
+{
+  add_cmd ("find", class_vars, find_command, _("\
+Search memory for a sequence of bytes.\n\
+Usage:\n\
+find [/size-char] [/max-count] start-address, end-address, expr1 [, expr2 ...]\n\
+find [/size-char] [/max-count] start-address, +length, expr1 [, expr2 ...]\n\
+size-char is one of b,h,w,g for 8,16,32,64 bit values respectively,\n\
+and if not specified the size is taken from the type of the expression\n\
+in the current language.\n\
+Note that this means for example that in the case of C-like languages\n\
+a search for an untyped 0x42 will search for \"(int) 0x42\"\n\
+which is typically four bytes.\n\
+Strings are searched for without their terminating NUL.\n\
+\n\
+The address of the last match is stored as the value of \"$_\".\n\
+Convenience variable \"$numfound\" is set to the number of matches."),
+	   &cmdlist);
+}
@@ -0,0 +1,54 @@
+/* The find command.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#ifndef FINDCMD_H
+#define FINDCMD_H
+
+/* A byte pattern to search memory for, built up one value at a
+   time.  Zero it before use; BUF is xmalloc'd.  */
+
+struct search_pattern
+{
+  gdb_byte *buf;
+  ULONGEST len;
+  ULONGEST size;
+};
+
+/* Parse the quoted string or expression at *ARGP, up to the next
+   comma, and append its bytes to PATTERN.  SIZE is 'b', 'h', 'w' or
+   'g' to store an expression's value in that many bytes, or 0 to use
+   the size of its type.  Advance *ARGP past what was parsed.  */
+
+extern void search_pattern_append (struct search_pattern *pattern,
+				   char **argp, char size);
+
+/* Search the SEARCH_SPACE_LEN bytes at START_ADDR for PATTERN, calling
+   FOUND_FUNC with each address it occurs at and DATA, until MAX_COUNT
+   matches have been found.  Return the number found.  */
+
+extern ULONGEST search_memory_all (CORE_ADDR start_addr,
+				   ULONGEST search_space_len,
+				   const struct search_pattern *pattern,
+				   ULONGEST max_count,
+				   void (*found_func) (CORE_ADDR, void *),
+				   void *data);
+
+#endif /* FINDCMD_H */
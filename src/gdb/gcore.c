@@ -26,15 +26,39 @@
 #include "gdbcore.h"
 #include "objfiles.h"
 #include "symfile.h"
+#include "gcore.h"
+#include "gdb_string.h"
 
 #include "cli/cli-decode.h"
 
 #include "gdb_assert.h"
 
+#include <ctype.h>
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+
 static char *default_gcore_target (void);
 static enum bfd_architecture default_gcore_arch (void);
 static unsigned long default_gcore_mach (void);
 static int gcore_memory_sections (bfd *);
+static void gcore_compress_file (const char *, const char *);
+#ifdef HAVE_ZLIB_H
+static void unlink_cleanup (void *);
+static void fclose_cleanup (void *);
+#endif
+
+/* Memory is copied into the core file through a buffer of this many
+   bytes, so that saving a large process needs no more than that.  It
+   must be a multiple of GCORE_PAGE_SIZE.  */
+
+#define GCORE_CHUNK_SIZE (1024 * 1024)
+
+/* Bytes of memory saved, and bytes of zeros left as holes, by the
+   current gcore command.  */
+
+static ULONGEST gcore_bytes_written;
+static ULONGEST gcore_bytes_skipped;
 
 /* Generate a core file from the inferior process.  */
 
@@ -42,16 +66,29 @@ static void
 gcore_command (char *args, int from_tty)
 {
   struct cleanup *old_chain;
+  struct cleanup *bfd_close_chain;
   char *corefilename, corefilename_buffer[40];
   asection *note_sec = NULL;
   bfd *obfd;
   void *note_data = NULL;
   int note_size = 0;
+  int compress = 0;
+  char *outfilename;
 
   /* No use generating a corefile without a target process.  */
   if (!target_has_execution)
     noprocess ();
 
+  /* APPLE LOCAL: "-z" asks for a compressed core file.  */
+  if (args && strncmp (args, "-z", 2) == 0
+      && (args[2] == '\0' || isspace (args[2])))
+    {
+      compress = 1;
+      args += 2;
+      while (isspace (*args))
+	args++;
+    }
+
   if (args && *args)
     corefilename = args;
   else
@@ -61,17 +98,35 @@ gcore_command (char *args, int from_tty)
       corefilename = corefilename_buffer;
     }
 
+  /* A compressed core file is made from an ordinary one, which is
+     written next to it and removed afterwards.  */
+  if (compress)
+    {
+#ifdef HAVE_ZLIB_H
+      outfilename = concat (corefilename, ".tmp", (char *) NULL);
+      old_chain = make_cleanup (xfree, outfilename);
+      make_cleanup (unlink_cleanup, outfilename);
+#else
+      error (_("This GDB was built without zlib; can't compress core files."));
+#endif
+    }
+  else
+    {
+      outfilename = corefilename;
+      old_chain = make_cleanup (null_cleanup, NULL);
+    }
+
   if (info_verbose)
     fprintf_filtered (gdb_stdout,
-		      "Opening corefile '%s' for output.\n", corefilename);
+		      "Opening corefile '%s' for output.\n", outfilename);
 
   /* Open the output file.  */
-  obfd = bfd_openw (corefilename, default_gcore_target ());
+  obfd = bfd_openw (outfilename, default_gcore_target ());
   if (!obfd)
-    error (_("Failed to open '%s' for output."), corefilename);
+    error (_("Failed to open '%s' for output."), outfilename);
 
   /* Need a cleanup that will close the file (FIXME: delete it?).  */
-  old_chain = make_cleanup_bfd_close (obfd);
+  bfd_close_chain = make_cleanup_bfd_close (obfd);
 
   bfd_set_format (obfd, bfd_core);
   bfd_set_arch_mach (obfd, default_gcore_arch (), default_gcore_mach ());
@@ -105,14 +160,42 @@ gcore_command (char *args, int from_tty)
 	warning (_("writing note section (%s)"), bfd_errmsg (bfd_get_error ()));
     }
 
+  /* Close the output file, so that all of it is on disk.  */
+  do_cleanups (bfd_close_chain);
+
+  if (compress)
+    gcore_compress_file (outfilename, corefilename);
+
   /* Succeeded.  */
   fprintf_filtered (gdb_stdout, "Saved corefile %s\n", corefilename);
+  if (info_verbose)
+    fprintf_filtered (gdb_stdout,
+		      "%s bytes of memory saved, %s bytes of zeros left out\n",
+		      paddr_d (gcore_bytes_written),
+		      paddr_d (gcore_bytes_skipped));
 
-  /* Clean-ups will close the output file and free malloc memory.  */
+  /* Clean-ups will remove the uncompressed file and free malloc
+     memory.  */
   do_cleanups (old_chain);
   return;
 }
 
+#ifdef HAVE_ZLIB_H
+/* Remove FILENAME, if it exists.  */
+
+static void
+unlink_cleanup (void *filename)
+{
+  unlink ((char *) filename);
+}
+
+static void
+fclose_cleanup (void *file)
+{
+  fclose ((FILE *) file);
+}
+#endif
+
 static unsigned long
 default_gcore_mach (void)
 {
@@ -441,12 +524,34 @@ objfile_find_memory_regions (int (*func) (CORE_ADDR, unsigned long,
   return 0;
 }
 
+/* Return non-zero if the LEN bytes at BUF are all zero.  */
+
+static int
+gcore_zero_p (const gdb_byte *buf, size_t len)
+{
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    if (buf[i] != 0)
+      return 0;
+  return 1;
+}
+
+/* Copy the contents of OSEC from the inferior's memory to the core
+   file, GCORE_CHUNK_SIZE bytes at a time.  Pages that were never
+   touched aren't read at all, and pages of zeros aren't written, so
+   they become holes in the file.  */
+
 static void
 gcore_copy_callback (bfd *obfd, asection *osec, void *ignored)
 {
   bfd_size_type size = bfd_section_size (obfd, osec);
+  CORE_ADDR vma = bfd_section_vma (obfd, osec);
   struct cleanup *old_chain = NULL;
-  void *memhunk;
+  unsigned char untouched[GCORE_CHUNK_SIZE / GCORE_PAGE_SIZE];
+  gdb_byte *memhunk;
+  bfd_size_type offset;
+  int read_failed = 0;
 
   /* Read-only sections are marked; we don't have to copy their contents.  */
   if ((bfd_get_section_flags (obfd, osec) & SEC_LOAD) == 0)
@@ -456,26 +561,206 @@ gcore_copy_callback (bfd *obfd, asection *osec, void *ignored)
   if (strncmp ("load", bfd_section_name (obfd, osec), 4) != 0)
     return;
 
-  memhunk = xmalloc (size);
-  /* ??? This is crap since xmalloc should never return NULL.  */
-  if (memhunk == NULL)
-    error (_("Not enough memory to create corefile."));
+  memhunk = xmalloc (GCORE_CHUNK_SIZE);
   old_chain = make_cleanup (xfree, memhunk);
 
-  if (target_read_memory (bfd_section_vma (obfd, osec),
-			  memhunk, size) != 0)
+  for (offset = 0; offset < size; offset += GCORE_CHUNK_SIZE)
+    {
+      bfd_size_type len = size - offset;
+      unsigned long npages;
+      unsigned long i;
+      unsigned long run;
+
+      if (len > GCORE_CHUNK_SIZE)
+	len = GCORE_CHUNK_SIZE;
+      npages = (len + GCORE_PAGE_SIZE - 1) / GCORE_PAGE_SIZE;
+
+      if (!target_find_untouched_pages (vma + offset, GCORE_PAGE_SIZE,
+					npages, untouched))
+	memset (untouched, 0, npages);
+
+      /* Read each run of pages that may hold something.  */
+      for (i = 0; i < npages; i = run)
+	{
+	  bfd_size_type start = i * GCORE_PAGE_SIZE;
+	  bfd_size_type end;
+
+	  for (run = i + 1; run < npages && untouched[run] == untouched[i]; run++)
+	    ;
+	  end = run * GCORE_PAGE_SIZE;
+	  if (end > len)
+	    end = len;
+
+	  if (untouched[i])
+	    memset (memhunk + start, 0, end - start);
+	  else if (target_read_memory (vma + offset + start, memhunk + start,
+				       end - start) != 0)
+	    {
+	      read_failed = 1;
+	      memset (memhunk + start, 0, end - start);
+	    }
+	}
+
+      /* Write each run of pages that aren't all zeros.  The last page
+	 of the section is always written, so that the file reaches
+	 the end of the section even if the rest is a hole.  */
+      for (i = 0; i < npages; i = run)
+	{
+	  bfd_size_type start = i * GCORE_PAGE_SIZE;
+	  bfd_size_type end;
+	  int zero;
+
+	  for (run = i; run < npages; run++)
+	    {
+	      bfd_size_type page_end = (run + 1) * GCORE_PAGE_SIZE;
+
+	      if (page_end > len)
+		page_end = len;
+	      zero = (gcore_zero_p (memhunk + run * GCORE_PAGE_SIZE,
+				    page_end - run * GCORE_PAGE_SIZE)
+		      && offset + page_end < size);
+	      if (run == i)
+		untouched[i] = zero;
+	      else if (zero != untouched[i])
+		break;
+	    }
+	  end = run * GCORE_PAGE_SIZE;
+	  if (end > len)
+	    end = len;
+
+	  if (untouched[i])
+	    gcore_bytes_skipped += end - start;
+	  else
+	    {
+	      if (!bfd_set_section_contents (obfd, osec, memhunk + start,
+					     offset + start, end - start))
+		error (_("Failed to write corefile contents (%s)."),
+		       bfd_errmsg (bfd_get_error ()));
+	      gcore_bytes_written += end - start;
+	    }
+	}
+
+      QUIT;
+    }
+
+  if (read_failed)
     warning (_("Memory read failed for corefile section, %s bytes at 0x%s."),
-	     paddr_d (size), paddr (bfd_section_vma (obfd, osec)));
-  if (!bfd_set_section_contents (obfd, osec, memhunk, 0, size))
-    warning (_("Failed to write corefile contents (%s)."),
-	     bfd_errmsg (bfd_get_error ()));
+	     paddr_d (size), paddr (vma));
 
   do_cleanups (old_chain);	/* Frees MEMHUNK.  */
 }
 
+#ifdef HAVE_ZLIB_H
+/* Store the LEN-byte little-endian number VAL at BUF.  */
+
+static void
+gcore_z_put (gdb_byte *buf, int len, ULONGEST val)
+{
+  int i;
+
+  for (i = 0; i < len; i++, val >>= 8)
+    buf[i] = val & 0xff;
+}
+#endif
+
+/* Write a compressed copy of the core file FROM to TO, in the format
+   described in gcore.h, reading and compressing one chunk at a
+   time.  */
+
+static void
+gcore_compress_file (const char *from, const char *to)
+{
+#ifdef HAVE_ZLIB_H
+  struct cleanup *old_chain;
+  FILE *in, *out;
+  gdb_byte header[GCORE_Z_HEADER_SIZE];
+  gdb_byte *chunk, *zchunk;
+  uLongf zsize;
+  ULONGEST *offsets = NULL;
+  ULONGEST nchunks = 0, max_chunks = 0;
+  ULONGEST total = 0, pos = GCORE_Z_HEADER_SIZE;
+  size_t len;
+  ULONGEST i;
+
+  in = fopen (from, FOPEN_RB);
+  if (in == NULL)
+    perror_with_name (from);
+  old_chain = make_cleanup (fclose_cleanup, in);
+
+  out = fopen (to, FOPEN_WB);
+  if (out == NULL)
+    perror_with_name (to);
+  make_cleanup (fclose_cleanup, out);
+
+  chunk = xmalloc (GCORE_Z_CHUNK_SIZE);
+  make_cleanup (xfree, chunk);
+  zchunk = xmalloc (compressBound (GCORE_Z_CHUNK_SIZE));
+  make_cleanup (xfree, zchunk);
+  make_cleanup (free_current_contents, &offsets);
+
+  /* Leave room for the header, which we write last.  */
+  memset (header, 0, sizeof (header));
+  if (fwrite (header, 1, sizeof (header), out) != sizeof (header))
+    perror_with_name (to);
+
+  while ((len = fread (chunk, 1, GCORE_Z_CHUNK_SIZE, in)) > 0)
+    {
+      if (nchunks == max_chunks)
+	{
+	  max_chunks = max_chunks ? max_chunks * 2 : 1024;
+	  offsets = xrealloc (offsets, (max_chunks + 1) * sizeof (ULONGEST));
+	}
+      offsets[nchunks++] = pos;
+      total += len;
+
+      if (!gcore_zero_p (chunk, len))
+	{
+	  zsize = compressBound (GCORE_Z_CHUNK_SIZE);
+	  if (compress2 (zchunk, &zsize, chunk, len, Z_BEST_SPEED) != Z_OK)
+	    error (_("Failed to compress core file."));
+	  if (fwrite (zchunk, 1, zsize, out) != zsize)
+	    perror_with_name (to);
+	  pos += zsize;
+	}
+
+      QUIT;
+    }
+  if (ferror (in))
+    perror_with_name (from);
+  if (offsets == NULL)
+    offsets = xmalloc (sizeof (ULONGEST));
+  offsets[nchunks] = pos;
+
+  /* The index.  */
+  for (i = 0; i <= nchunks; i++)
+    {
+      gdb_byte buf[8];
+
+      gcore_z_put (buf, 8, offsets[i]);
+      if (fwrite (buf, 1, 8, out) != 8)
+	perror_with_name (to);
+    }
+
+  memcpy (header, GCORE_Z_MAGIC, GCORE_Z_MAGIC_SIZE);
+  gcore_z_put (header + 8, 4, GCORE_Z_VERSION);
+  gcore_z_put (header + 12, 4, GCORE_Z_CHUNK_SIZE);
+  gcore_z_put (header + 16, 8, total);
+  gcore_z_put (header + 24, 8, pos);
+  if (fseek (out, 0, SEEK_SET) != 0
+      || fwrite (header, 1, sizeof (header), out) != sizeof (header)
+      || fflush (out) != 0)
+    perror_with_name (to);
+
+  do_cleanups (old_chain);
+#endif
+}
+
 static int
 gcore_memory_sections (bfd *obfd)
 {
+  gcore_bytes_written = 0;
+  gcore_bytes_skipped = 0;
+
   if (target_find_memory_regions (gcore_create_callback, obfd) != 0)
     return 0;			/* FIXME: error return/msg?  */
 
@@ -493,7 +778,9 @@ _initialize_gcore (void)
 {
   add_com ("generate-core-file", class_files, gcore_command, _("\
 Save a core file with the current state of the debugged process.\n\
-Argument is optional filename.  Default filename is 'core.<process_id>'."));
+Argument is optional filename.  Default filename is 'core.<process_id>'.\n\
+With \"-z\" before the filename, the core file is compressed; GDB can read\n\
+it back with the \"core-file\" command."));
 
   add_com_alias ("gcore", "generate-core-file", class_files, 1);
   exec_set_find_memory_regions (objfile_find_memory_regions);
@@ -0,0 +1,57 @@
+/* Support for generating core files.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#ifndef GCORE_H
+#define GCORE_H
+
+/* Pages of this size that read as zeros are left out of the core
+   file as holes.  */
+
+#define GCORE_PAGE_SIZE 4096
+
+/* A compressed core file, as written by "gcore -z", holds an ordinary
+   core file cut into chunks of GCORE_Z_CHUNK_SIZE bytes, each
+   compressed separately with zlib so that any part can be read back
+   without decompressing what comes before it.  All numbers are stored
+   little-endian.
+
+     offset  size
+     0       8     GCORE_Z_MAGIC
+     8       4     GCORE_Z_VERSION
+     12      4     the chunk size
+     16      8     the size of the uncompressed core file
+     24      8     the offset of the index
+     32            the compressed chunks
+
+   The index holds one 8-byte file offset for each chunk, and one more
+   for the end of the last chunk.  A chunk that is all zeros is stored
+   with no data at all.  */
+
+#define GCORE_Z_MAGIC "GDBZCORE"
+#define GCORE_Z_MAGIC_SIZE 8
+#define GCORE_Z_VERSION 1
+#define GCORE_Z_HEADER_SIZE 32
+#define GCORE_Z_CHUNK_SIZE (1024 * 1024)
+
+/* The largest chunk size a reader accepts.  */
+#define GCORE_Z_MAX_CHUNK_SIZE (64 * GCORE_Z_CHUNK_SIZE)
+
+#endif /* GCORE_H */
@@ -0,0 +1,447 @@
+/* Agent expression interpreter for the remote server for GDB.
+   Copyright 2006
+   Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+/* This is a small interpreter for the bytecode language described in
+   the "Agent Expressions" appendix of the GDB manual.  GDB compiles
+   breakpoint conditions into it and hands them to us with the Z0
+   packet, so that a breakpoint whose condition is false can be
+   stepped over here instead of costing a full stop, register fetch
+   and host-side evaluation over the link.
+
+   We are always running on the target, so values in registers and
+   memory are already in host byte order.  Operands embedded in the
+   bytecode itself are big-endian.  Floating point and the tracing
+   opcodes are not supported; an expression using them simply fails to
+   evaluate, and the caller reports the stop to GDB as if the
+   condition had been true.  */
+
+#include "server.h"
+#include "ax.h"
+
+/* Same limit the GDB manual suggests for agents.  */
+#define AX_STACK_SIZE 100
+
+/* The most opcodes one evaluation may execute.  Gotos can jump
+   backwards, so without a limit a looping expression would hang the
+   stub.  */
+#define AX_MAX_STEPS 10000
+
+/* The signed 64-bit value with only the sign bit set, LLONG_MIN.  */
+#define AX_MIN_SIGNED (1ULL << 63)
+
+extern int debug_threads;
+
+/* Fetch the big-endian operand of SIZE bytes at BYTES + PC.  */
+
+static unsigned long long
+ax_operand (const unsigned char *bytes, int pc, int size)
+{
+  unsigned long long val = 0;
+  int i;
+
+  for (i = 0; i < size; i++)
+    val = (val << 8) | bytes[pc + i];
+
+  return val;
+}
+
+/* Read an integer of SIZE bytes from the inferior at ADDR into *VAL.
+   Return 0 on success.  */
+
+static int
+ax_ref (CORE_ADDR addr, int size, unsigned long long *val)
+{
+  unsigned char buf[8];
+
+  if (read_inferior_memory (addr, buf, size) != 0)
+    return -1;
+
+  switch (size)
+    {
+    case 1:
+      *val = buf[0];
+      break;
+    case 2:
+      {
+	unsigned short v;
+	memcpy (&v, buf, sizeof v);
+	*val = v;
+      }
+      break;
+    case 4:
+      {
+	unsigned int v;
+	memcpy (&v, buf, sizeof v);
+	*val = v;
+      }
+      break;
+    case 8:
+      {
+	unsigned long long v;
+	memcpy (&v, buf, sizeof v);
+	*val = v;
+      }
+      break;
+    default:
+      return -1;
+    }
+
+  return 0;
+}
+
+/* Fetch register REGNO of the current inferior into *VAL.  Return 0
+   on success.  */
+
+static int
+ax_reg (int regno, unsigned long long *val)
+{
+  unsigned char buf[8];
+  int size;
+
+  if (regno < 0 || regno >= register_count ())
+    return -1;
+
+  size = register_size (regno);
+  if (size != 1 && size != 2 && size != 4 && size != 8)
+    return -1;
+
+  collect_register (regno, buf);
+
+  switch (size)
+    {
+    case 1:
+      *val = buf[0];
+      break;
+    case 2:
+      {
+	unsigned short v;
+	memcpy (&v, buf, sizeof v);
+	*val = v;
+      }
+      break;
+    case 4:
+      {
+	unsigned int v;
+	memcpy (&v, buf, sizeof v);
+	*val = v;
+      }
+      break;
+    case 8:
+      memcpy (val, buf, 8);
+      break;
+    }
+
+  return 0;
+}
+
+/* Sign-extend VAL from its low N bits.  */
+
+static unsigned long long
+ax_sign_extend (unsigned long long val, int n)
+{
+  if (n <= 0 || n >= 64)
+    return val;
+
+  if (val & (1ULL << (n - 1)))
+    return val | (~0ULL << n);
+  else
+    return val & ~(~0ULL << n);
+}
+
+int
+gdb_eval_agent_expr (const unsigned char *bytes, int len, long long *result)
+{
+  unsigned long long stack[AX_STACK_SIZE];
+  int sp = 0;
+  int pc = 0;
+  unsigned long long a, b;
+  int op, n;
+  int steps = 0;
+
+/* Make sure there are at least N values on the stack, and room for
+   M more.  */
+#define NEED(N) \
+  do { if (sp < (N)) goto underflow; } while (0)
+#define ROOM(M) \
+  do { if (sp + (M) > AX_STACK_SIZE) goto overflow; } while (0)
+#define OPERAND(SIZE) \
+  do { if (pc + (SIZE) > len) goto truncated; } while (0)
+
+  while (pc < len)
+    {
+      if (++steps > AX_MAX_STEPS)
+	goto too_long;
+
+      op = bytes[pc++];
+
+      switch (op)
+	{
+	case aop_add:
+	  NEED (2);
+	  sp--;
+	  stack[sp - 1] += stack[sp];
+	  break;
+
+	case aop_sub:
+	  NEED (2);
+	  sp--;
+	  stack[sp - 1] -= stack[sp];
+	  break;
+
+	case aop_mul:
+	  NEED (2);
+	  sp--;
+	  stack[sp - 1] *= stack[sp];
+	  break;
+
+	case aop_div_signed:
+	case aop_div_unsigned:
+	case aop_rem_signed:
+	case aop_rem_unsigned:
+	  NEED (2);
+	  b = stack[--sp];
+	  a = stack[sp - 1];
+	  if (b == 0)
+	    {
+	      if (debug_threads)
+		fprintf (stderr, "Agent expression divides by zero.\n");
+	      return -1;
+	    }
+	  /* LLONG_MIN / -1 overflows, and traps on some hosts.  */
+	  if ((op == aop_div_signed || op == aop_rem_signed)
+	      && a == AX_MIN_SIGNED && b == ~0ULL)
+	    {
+	      if (debug_threads)
+		fprintf (stderr, "Agent expression division overflows.\n");
+	      return -1;
+	    }
+	  if (op == aop_div_signed)
+	    stack[sp - 1] = (long long) a / (long long) b;
+	  else if (op == aop_div_unsigned)
+	    stack[sp - 1] = a / b;
+	  else if (op == aop_rem_signed)
+	    stack[sp - 1] = (long long) a % (long long) b;
+	  else
+	    stack[sp - 1] = a % b;
+	  break;
+
+	/* Shifting by the width of the value or more is undefined in C;
+	   give the result of shifting a bit at a time instead.  */
+	case aop_lsh:
+	  NEED (2);
+	  sp--;
+	  if (stack[sp] >= 64)
+	    stack[sp - 1] = 0;
+	  else
+	    stack[sp - 1] <<= stack[sp];
+	  break;
+
+	case aop_rsh_signed:
+	  NEED (2);
+	  sp--;
+	  if (stack[sp] >= 64)
+	    stack[sp - 1] = (long long) stack[sp - 1] < 0 ? ~0ULL : 0;
+	  else
+	    stack[sp - 1] = (long long) stack[sp - 1] >> stack[sp];
+	  break;
+
+	case aop_rsh_unsigned:
+	  NEED (2);
+	  sp--;
+	  if (stack[sp] >= 64)
+	    stack[sp - 1] = 0;
+	  else
+	    stack[sp - 1] >>= stack[sp];
+	  break;
+
+	case aop_log_not:
+	  NEED (1);
+	  stack[sp - 1] = !stack[sp - 1];
+	  break;
+
+	case aop_bit_and:
+	  NEED (2);
+	  sp--;
+	  stack[sp - 1] &= stack[sp];
+	  break;
+
+	case aop_bit_or:
+	  NEED (2);
+	  sp--;
+	  stack[sp - 1] |= stack[sp];
+	  break;
+
+	case aop_bit_xor:
+	  NEED (2);
+	  sp--;
+	  stack[sp - 1] ^= stack[sp];
+	  break;
+
+	case aop_bit_not:
+	  NEED (1);
+	  stack[sp - 1] = ~stack[sp - 1];
+	  break;
+
+	case aop_equal:
+	  NEED (2);
+	  sp--;
+	  stack[sp - 1] = (stack[sp - 1] == stack[sp]);
+	  break;
+
+	case aop_less_signed:
+	  NEED (2);
+	  sp--;
+	  stack[sp - 1] = ((long long) stack[sp - 1] < (long long) stack[sp]);
+	  break;
+
+	case aop_less_unsigned:
+	  NEED (2);
+	  sp--;
+	  stack[sp - 1] = (stack[sp - 1] < stack[sp]);
+	  break;
+
+	case aop_ext:
+	  OPERAND (1);
+	  NEED (1);
+	  n = bytes[pc++];
+	  stack[sp - 1] = ax_sign_extend (stack[sp - 1], n);
+	  break;
+
+	case aop_zero_ext:
+	  OPERAND (1);
+	  NEED (1);
+	  n = bytes[pc++];
+	  if (n > 0 && n < 64)
+	    stack[sp - 1] &= ~(~0ULL << n);
+	  break;
+
+	case aop_ref8:
+	case aop_ref16:
+	case aop_ref32:
+	case aop_ref64:
+	  NEED (1);
+	  n = 1 << (op - aop_ref8);
+	  if (ax_ref ((CORE_ADDR) stack[sp - 1], n, &stack[sp - 1]) != 0)
+	    {
+	      if (debug_threads)
+		fprintf (stderr, "Agent expression can not read %d bytes "
+			 "at 0x%llx.\n", n, stack[sp - 1]);
+	      return -1;
+	    }
+	  break;
+
+	case aop_if_goto:
+	  OPERAND (2);
+	  NEED (1);
+	  if (stack[--sp] != 0)
+	    pc = ax_operand (bytes, pc, 2);
+	  else
+	    pc += 2;
+	  break;
+
+	case aop_goto:
+	  OPERAND (2);
+	  pc = ax_operand (bytes, pc, 2);
+	  break;
+
+	case aop_const8:
+	case aop_const16:
+	case aop_const32:
+	case aop_const64:
+	  n = 1 << (op - aop_const8);
+	  OPERAND (n);
+	  ROOM (1);
+	  stack[sp++] = ax_operand (bytes, pc, n);
+	  pc += n;
+	  break;
+
+	case aop_reg:
+	  OPERAND (2);
+	  ROOM (1);
+	  n = ax_operand (bytes, pc, 2);
+	  pc += 2;
+	  if (ax_reg (n, &stack[sp]) != 0)
+	    {
+	      if (debug_threads)
+		fprintf (stderr, "Agent expression uses bad register %d.\n",
+			 n);
+	      return -1;
+	    }
+	  sp++;
+	  break;
+
+	case aop_end:
+	  NEED (1);
+	  *result = (long long) stack[sp - 1];
+	  return 0;
+
+	case aop_dup:
+	  NEED (1);
+	  ROOM (1);
+	  stack[sp] = stack[sp - 1];
+	  sp++;
+	  break;
+
+	case aop_pop:
+	  NEED (1);
+	  sp--;
+	  break;
+
+	case aop_swap:
+	  NEED (2);
+	  a = stack[sp - 1];
+	  stack[sp - 1] = stack[sp - 2];
+	  stack[sp - 2] = a;
+	  break;
+
+	default:
+	  if (debug_threads)
+	    fprintf (stderr, "Unsupported agent expression opcode 0x%x.\n",
+		     op);
+	  return -1;
+	}
+    }
+
+truncated:
+  if (debug_threads)
+    fprintf (stderr, "Agent expression ended without an `end' opcode.\n");
+  return -1;
+
+underflow:
+  if (debug_threads)
+    fprintf (stderr, "Agent expression stack underflow.\n");
+  return -1;
+
+overflow:
+  if (debug_threads)
+    fprintf (stderr, "Agent expression stack overflow.\n");
+  return -1;
+
+too_long:
+  if (debug_threads)
+    fprintf (stderr, "Agent expression ran for more than %d steps.\n",
+	     AX_MAX_STEPS);
+  return -1;
+
+#undef NEED
+#undef ROOM
+#undef OPERAND
+}
@@ -0,0 +1,88 @@
+/* Agent expression interpreter for the remote server for GDB.
+   Copyright 2006
+   Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#ifndef AX_H
+#define AX_H
+
+/* Bytecode opcodes.  These must stay in sync with enum agent_op in
+   gdb/ax.h, which is what GDB uses to compile the expressions we
+   are handed.  */
+
+enum agent_op
+  {
+    aop_float = 0x01,
+    aop_add = 0x02,
+    aop_sub = 0x03,
+    aop_mul = 0x04,
+    aop_div_signed = 0x05,
+    aop_div_unsigned = 0x06,
+    aop_rem_signed = 0x07,
+    aop_rem_unsigned = 0x08,
+    aop_lsh = 0x09,
+    aop_rsh_signed = 0x0a,
+    aop_rsh_unsigned = 0x0b,
+    aop_trace = 0x0c,
+    aop_trace_quick = 0x0d,
+    aop_log_not = 0x0e,
+    aop_bit_and = 0x0f,
+    aop_bit_or = 0x10,
+    aop_bit_xor = 0x11,
+    aop_bit_not = 0x12,
+    aop_equal = 0x13,
+    aop_less_signed = 0x14,
+    aop_less_unsigned = 0x15,
+    aop_ext = 0x16,
+    aop_ref8 = 0x17,
+    aop_ref16 = 0x18,
+    aop_ref32 = 0x19,
+    aop_ref64 = 0x1a,
+    aop_ref_float = 0x1b,
+    aop_ref_double = 0x1c,
+    aop_ref_long_double = 0x1d,
+    aop_l_to_d = 0x1e,
+    aop_d_to_l = 0x1f,
+    aop_if_goto = 0x20,
+    aop_goto = 0x21,
+    aop_const8 = 0x22,
+    aop_const16 = 0x23,
+    aop_const32 = 0x24,
+    aop_const64 = 0x25,
+    aop_reg = 0x26,
+    aop_end = 0x27,
+    aop_dup = 0x28,
+    aop_pop = 0x29,
+    aop_zero_ext = 0x2a,
+    aop_swap = 0x2b,
+    aop_trace16 = 0x30,
+    aop_last
+  };
+
+/* Evaluate the LEN bytes of agent bytecode at BYTES in the context
+   of the current inferior, and store the value left on top of the
+   stack in *RESULT.  Return 0 on success, or -1 if the expression
+   could not be evaluated (a bad opcode, a stack overflow or
+   underflow, a division by zero, an unreadable memory reference or
+   an operation we do not implement, such as floating point).  */
+
+int gdb_eval_agent_expr (const unsigned char *bytes, int len,
+			 long long *result);
+
+#endif /* AX_H */
@@ -59,6 +59,7 @@ static void linux_resume_one_process (struct inferior_list_entry *entry,
 static void linux_resume (struct thread_resume *resume_info);
 static void stop_all_processes (void);
 static int linux_wait_for_event (struct thread_info *child);
+static void linux_close_proc_mem (void);
 
 struct pending_signals
 {
@@ -260,6 +261,8 @@ linux_kill (void)
       /* Make sure it died.  The loop is most likely unnecessary.  */
       wstat = linux_wait_for_event (thread);
     } while (WIFSTOPPED (wstat));
+
+  linux_close_proc_mem ();
 }
 
 static void
@@ -275,6 +278,7 @@ static void
 linux_detach (void)
 {
   for_each_inferior (&all_threads, linux_detach_one_process);
+  linux_close_proc_mem ();
 }
 
 /* Return nonzero if the given thread is still alive.  */
@@ -327,8 +331,11 @@ check_removed_breakpoint (struct process_info *event_child)
       return 0;
     }
 
-  /* If the breakpoint is still there, we will report hitting it.  */
-  if ((*the_low_target.breakpoint_at) (stop_pc))
+  /* If the breakpoint is still there, we will report hitting it.
+     Breakpoints GDB inserted with Z0 are hidden from memory reads,
+     so ask about those separately.  */
+  if (gdb_breakpoint_here (stop_pc)
+      || (*the_low_target.breakpoint_at) (stop_pc))
     {
       if (debug_threads)
 	fprintf (stderr, "Ignoring, breakpoint is still present.\n");
@@ -590,7 +597,10 @@ linux_wait_for_event (struct thread_info *child)
       if (debug_threads)
 	fprintf (stderr, "Hit a (non-reinsert) breakpoint.\n");
 
-      if (check_breakpoints (stop_pc) != 0)
+      /* A GDB breakpoint we single-stepped onto has not been hit yet;
+	 leave it for the step to report.  */
+      if (!(event_child->stepping && gdb_breakpoint_here (stop_pc))
+	  && check_breakpoints (stop_pc) != 0)
 	{
 	  /* We hit one of our own breakpoints.  We mark it as a pending
 	     breakpoint, so that check_removed_breakpoint () will do the PC
@@ -655,7 +665,8 @@ linux_wait_for_event (struct thread_info *child)
 	 after the first is reported.  Arguably it would be better to report
 	 multiple threads hitting breakpoints simultaneously, but the current
 	 remote protocol does not allow this.  */
-      if ((*the_low_target.breakpoint_at) (stop_pc))
+      if (gdb_breakpoint_here (stop_pc)
+	  || (*the_low_target.breakpoint_at) (stop_pc))
 	{
 	  event_child->pending_is_breakpoint = 1;
 	  event_child->pending_stop_pc = stop_pc;
@@ -1372,6 +1383,83 @@ linux_store_registers (int regno)
 }
 
 
+/* File descriptor for /proc/PID/mem of the inferior, and the PID it
+   was opened for.  Kept open across transfers; -1 if not open.  */
+
+static int proc_mem_fd = -1;
+static int proc_mem_pid;
+
+static void
+linux_close_proc_mem (void)
+{
+  if (proc_mem_fd != -1)
+    {
+      close (proc_mem_fd);
+      proc_mem_fd = -1;
+    }
+}
+
+/* Transfer LEN bytes at MEMADDR to READBUF or from WRITEBUF through
+   /proc/PID/mem, which moves the whole block in one system call where
+   ptrace needs one per word.  Return non-zero if the whole block was
+   transferred; otherwise the caller should fall back to ptrace.  */
+
+static int
+linux_proc_xfer_memory (CORE_ADDR memaddr, unsigned char *readbuf,
+			const unsigned char *writebuf, int len)
+{
+  int pid = inferior_pid;
+  int ret;
+
+  /* Don't bother for one word.  */
+  if (len < 3 * sizeof (PTRACE_XFER_TYPE))
+    return 0;
+
+  if (proc_mem_fd != -1 && proc_mem_pid != pid)
+    linux_close_proc_mem ();
+
+  if (proc_mem_fd == -1)
+    {
+      char filename[64];
+
+      sprintf (filename, "/proc/%d/mem", pid);
+      proc_mem_fd = open (filename, O_RDWR);
+      if (proc_mem_fd == -1)
+	return 0;
+      proc_mem_pid = pid;
+    }
+
+  /* pread64 and pwrite64 are 64-bit safe even on 32-bit hosts.  */
+  if (readbuf != NULL)
+#ifdef HAVE_PREAD64
+    ret = pread64 (proc_mem_fd, readbuf, len, memaddr);
+#else
+    ret = (lseek (proc_mem_fd, memaddr, SEEK_SET) == -1
+	   ? -1 : read (proc_mem_fd, readbuf, len));
+#endif
+  else
+#ifdef HAVE_PWRITE64
+    ret = pwrite64 (proc_mem_fd, writebuf, len, memaddr);
+#else
+    ret = (lseek (proc_mem_fd, memaddr, SEEK_SET) == -1
+	   ? -1 : write (proc_mem_fd, writebuf, len));
+#endif
+
+  if (ret != len)
+    {
+      /* Let ptrace sort out partial transfers and report the error.
+	 The process may also have gone away under us; reopen the file
+	 next time.  */
+      if (debug_threads)
+	fprintf (stderr, "/proc/%d/mem transfer at %08lx failed\n",
+		 pid, (long) memaddr);
+      linux_close_proc_mem ();
+      return 0;
+    }
+
+  return 1;
+}
+
 /* Copy LEN bytes from inferior's memory starting at MEMADDR
    to debugger memory starting at MYADDR.  */
 
@@ -1386,8 +1474,12 @@ linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
     = (((memaddr + len) - addr) + sizeof (PTRACE_XFER_TYPE) - 1)
       / sizeof (PTRACE_XFER_TYPE);
   /* Allocate buffer of that many longwords.  */
-  register PTRACE_XFER_TYPE *buffer
-    = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
+  register PTRACE_XFER_TYPE *buffer;
+
+  if (linux_proc_xfer_memory (memaddr, myaddr, NULL, len))
+    return 0;
+
+  buffer = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
 
   /* Read all the longwords */
   for (i = 0; i < count; i++, addr += sizeof (PTRACE_XFER_TYPE))
@@ -1419,7 +1511,7 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
   register int count
   = (((memaddr + len) - addr) + sizeof (PTRACE_XFER_TYPE) - 1) / sizeof (PTRACE_XFER_TYPE);
   /* Allocate buffer of that many longwords.  */
-  register PTRACE_XFER_TYPE *buffer = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
+  register PTRACE_XFER_TYPE *buffer;
   extern int errno;
 
   if (debug_threads)
@@ -1427,6 +1519,11 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
       fprintf (stderr, "Writing %02x to %08lx\n", (unsigned)myaddr[0], (long)memaddr);
     }
 
+  if (linux_proc_xfer_memory (memaddr, NULL, myaddr, len))
+    return 0;
+
+  buffer = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
+
   /* Fill start and end extra bytes of buffer with existing memory data.  */
 
   buffer[0] = ptrace (PTRACE_PEEKTEXT, inferior_pid,
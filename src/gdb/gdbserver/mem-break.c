@@ -22,12 +22,25 @@
    Boston, MA 02111-1307, USA.  */
 
 #include "server.h"
+#include "ax.h"
+
+#include <ctype.h>
 
 const unsigned char *breakpoint_data;
 int breakpoint_len;
 
 #define MAX_BREAKPOINT_LEN 8
 
+/* A condition GDB attached to one of its breakpoints, as a string of
+   agent expression bytecode.  */
+
+struct breakpoint_condition
+{
+  struct breakpoint_condition *next;
+  int len;
+  unsigned char *bytes;
+};
+
 struct breakpoint
 {
   struct breakpoint *next;
@@ -42,8 +55,18 @@ struct breakpoint
      in the *next chain somewhere).  */
   struct breakpoint *breakpoint_to_reinsert;
 
-  /* Function to call when we hit this breakpoint.  */
+  /* Function to call when we hit this breakpoint.  NULL for
+     breakpoints only GDB inserted with the Z0 packet.  */
   void (*handler) (CORE_ADDR);
+
+  /* Non-zero if GDB has inserted a breakpoint here with the Z0
+     packet, whose hits we report.  One of our own breakpoints can be
+     a GDB breakpoint too, when GDB wants one at the same address.  */
+  int gdb_breakpoint;
+
+  /* For a GDB breakpoint, the conditions GDB sent along with it.  We
+     report a hit if any of them is true, or if there are none.  */
+  struct breakpoint_condition *conditions;
 };
 
 struct breakpoint *breakpoints;
@@ -71,6 +94,20 @@ set_breakpoint_at (CORE_ADDR where, void (*handler) (CORE_ADDR))
   breakpoints = bp;
 }
 
+static void
+free_breakpoint_conditions (struct breakpoint *bp)
+{
+  struct breakpoint_condition *cond, *next;
+
+  for (cond = bp->conditions; cond != NULL; cond = next)
+    {
+      next = cond->next;
+      free (cond->bytes);
+      free (cond);
+    }
+  bp->conditions = NULL;
+}
+
 static void
 delete_breakpoint (struct breakpoint *bp)
 {
@@ -81,6 +118,7 @@ delete_breakpoint (struct breakpoint *bp)
       breakpoints = bp->next;
       (*the_target->write_memory) (bp->pc, bp->old_data,
 				   breakpoint_len);
+      free_breakpoint_conditions (bp);
       free (bp);
       return;
     }
@@ -92,9 +130,11 @@ delete_breakpoint (struct breakpoint *bp)
 	  cur->next = bp->next;
 	  (*the_target->write_memory) (bp->pc, bp->old_data,
 				       breakpoint_len);
+	  free_breakpoint_conditions (bp);
 	  free (bp);
 	  return;
 	}
+      cur = cur->next;
     }
   warning ("Could not find breakpoint in list.");
 }
@@ -114,6 +154,122 @@ find_breakpoint_at (CORE_ADDR where)
   return NULL;
 }
 
+int
+set_gdb_breakpoint_at (CORE_ADDR where)
+{
+  struct breakpoint *bp;
+
+  if (breakpoint_data == NULL)
+    return 1;
+
+  bp = find_breakpoint_at (where);
+  if (bp != NULL)
+    {
+      /* GDB may insert the same breakpoint again to update its
+	 conditions; it will send them again.  Or this may be one of
+	 our own breakpoints, which becomes GDB's too; its handler
+	 still runs on every hit.  */
+      bp->gdb_breakpoint = 1;
+      free_breakpoint_conditions (bp);
+      return 0;
+    }
+
+  set_breakpoint_at (where, NULL);
+  breakpoints->gdb_breakpoint = 1;
+  return 0;
+}
+
+int
+delete_gdb_breakpoint_at (CORE_ADDR where)
+{
+  struct breakpoint *bp;
+
+  if (breakpoint_data == NULL)
+    return 1;
+
+  bp = find_breakpoint_at (where);
+  if (bp == NULL || !bp->gdb_breakpoint)
+    return -1;
+
+  /* One of our own breakpoints stays where it is.  */
+  if (bp->handler != NULL)
+    {
+      bp->gdb_breakpoint = 0;
+      free_breakpoint_conditions (bp);
+      return 0;
+    }
+
+  delete_breakpoint (bp);
+  return 0;
+}
+
+int
+add_breakpoint_condition (CORE_ADDR where, char *hex)
+{
+  struct breakpoint *bp;
+  struct breakpoint_condition *cond, **tail;
+  char *p;
+  int len, i;
+
+  bp = find_breakpoint_at (where);
+  if (bp == NULL || !bp->gdb_breakpoint)
+    return -1;
+
+  len = strtol (hex, &p, 16);
+  if (*p != ',' || len <= 0)
+    return -1;
+  p++;
+
+  for (i = 0; i < 2 * len; i++)
+    if (!isxdigit (p[i]))
+      return -1;
+
+  cond = malloc (sizeof (struct breakpoint_condition));
+  cond->next = NULL;
+  cond->len = len;
+  cond->bytes = malloc (len);
+  convert_ascii_to_int (p, cond->bytes, len);
+
+  /* Keep them in the order GDB sent them.  */
+  for (tail = &bp->conditions; *tail != NULL; tail = &(*tail)->next)
+    ;
+  *tail = cond;
+  return 0;
+}
+
+int
+gdb_breakpoint_here (CORE_ADDR where)
+{
+  struct breakpoint *bp;
+
+  bp = find_breakpoint_at (where);
+  return (bp != NULL && bp->gdb_breakpoint && !bp->reinserting);
+}
+
+/* Return non-zero if the GDB breakpoint BP should be reported: it has
+   no conditions, or one of them is true, or one of them can not be
+   evaluated and so must be left for GDB to decide.  */
+
+static int
+gdb_condition_true_at_breakpoint (struct breakpoint *bp)
+{
+  struct breakpoint_condition *cond;
+  long long value;
+
+  if (bp->conditions == NULL)
+    return 1;
+
+  for (cond = bp->conditions; cond != NULL; cond = cond->next)
+    {
+      if (gdb_eval_agent_expr (cond->bytes, cond->len, &value) != 0)
+	return 1;
+      if (value != 0)
+	return 1;
+    }
+
+  return 0;
+}
+
 static void
 reinsert_breakpoint_handler (CORE_ADDR stop_pc)
 {
@@ -198,7 +354,20 @@ check_breakpoints (CORE_ADDR stop_pc)
       return 0;
     }
 
-  (*bp->handler) (bp->pc);
+  if (bp->handler != NULL)
+    (*bp->handler) (bp->pc);
+
+  /* A GDB breakpoint whose conditions are all false is stepped over
+     just like one of our own; otherwise it is GDB's to report.
+     Stepping over a breakpoint takes it out while the other threads
+     keep running, though, and they could go past it without stopping
+     where its condition is true.  So with more than one thread every
+     hit goes to GDB, which steps over it with the others stopped.  */
+  if (bp->gdb_breakpoint
+      && (all_threads.head != all_threads.tail
+	  || gdb_condition_true_at_breakpoint (bp)))
+    return 0;
+
   return 1;
 }
 
@@ -32,6 +32,31 @@
 void set_breakpoint_at (CORE_ADDR where,
 			void (*handler) (CORE_ADDR));
 
+/* Insert a breakpoint on behalf of GDB (the Z0 packet) at WHERE.
+   Hits of such a breakpoint are reported to GDB unless it has
+   conditions and all of them are false.  Inserting a breakpoint that
+   already exists clears its conditions; if it is one of our own, it
+   stays ours as well.  Return 0 on success, 1 if breakpoints are not
+   supported, and -1 on error.  */
+
+int set_gdb_breakpoint_at (CORE_ADDR where);
+
+/* Remove the GDB breakpoint at WHERE (the z0 packet).  Return values
+   are as for set_gdb_breakpoint_at.  */
+
+int delete_gdb_breakpoint_at (CORE_ADDR where);
+
+/* Attach a condition to the GDB breakpoint at WHERE.  HEX is the
+   "LEN,BYTES" part of an X condition from the Z0 packet, with the
+   bytecode in hex.  Return 0 on success and -1 on error.  */
+
+int add_breakpoint_condition (CORE_ADDR where, char *hex);
+
+/* Return non-zero if a GDB breakpoint is currently inserted at
+   WHERE.  */
+
+int gdb_breakpoint_here (CORE_ADDR where);
+
 /* Create a reinsertion breakpoint at STOP_AT for the breakpoint
    currently at STOP_PC (and temporarily remove the breakpoint at
    STOP_PC).  */
@@ -47,7 +72,9 @@ void reinsert_breakpoint (CORE_ADDR where);
 void uninsert_breakpoint (CORE_ADDR where);
 
 /* See if any breakpoint claims ownership of STOP_PC.  Call the handler for
-   the breakpoint, if found.  */
+   the breakpoint, if found.  A GDB breakpoint claims STOP_PC only if
+   none of its conditions is true and the inferior has only one
+   thread, in which case the caller should step over it silently.  */
 
 int check_breakpoints (CORE_ADDR stop_pc);
 
@@ -94,6 +94,12 @@ registers_length (void)
   return 2 * register_bytes;
 }
 
+int
+register_count (void)
+{
+  return num_registers;
+}
+
 void *
 new_register_cache (void)
 {
@@ -49,6 +49,10 @@ void registers_from_string (char *buf);
 
 int registers_length (void);
 
+/* Return the number of registers in the current register set.  */
+
+int register_count (void);
+
 /* Return a pointer to the description of register ``n''.  */
 
 struct reg *find_register_by_number (int n);
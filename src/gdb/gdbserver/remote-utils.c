@@ -255,6 +255,89 @@ decode_address (CORE_ADDR *addrp, const char *start, int len)
   *addrp = addr;
 }
 
+/* APPLE LOCAL begin search memory */
+/* Undo the escaping GDB applies to binary data: '}' is followed by
+   the real byte xor 0x20.  Copy the LEN bytes at BUFFER to OUT_BUF,
+   unescaped, writing no more than OUT_MAXLEN bytes.  Return the number
+   of bytes written, or -1 if they don't fit or the escape is
+   incomplete.  */
+
+static int
+remote_unescape_input (const unsigned char *buffer, int len,
+		       unsigned char *out_buf, int out_maxlen)
+{
+  int input_index, output_index;
+  int escaped;
+
+  output_index = 0;
+  escaped = 0;
+  for (input_index = 0; input_index < len; input_index++)
+    {
+      unsigned char b = buffer[input_index];
+
+      if (output_index + 1 > out_maxlen)
+	return -1;
+
+      if (escaped)
+	{
+	  out_buf[output_index++] = b ^ 0x20;
+	  escaped = 0;
+	}
+      else if (b == '}')
+	escaped = 1;
+      else
+	out_buf[output_index++] = b;
+    }
+
+  if (escaped)
+    return -1;
+
+  return output_index;
+}
+
+/* Decode the "ADDR;LENGTH;PATTERN" that follows "qSearch:memory:" in
+   a packet of PACKET_LEN bytes at FROM.  PATTERN is raw, escaped
+   binary, so it can't be found with string functions.  Return 0 on
+   success, -1 if the packet is malformed or the pattern is longer than
+   PATTERN_MAXLEN.  */
+
+int
+decode_search_memory_packet (const char *from, int packet_len,
+			     CORE_ADDR *start_addrp,
+			     CORE_ADDR *search_space_lenp,
+			     unsigned char *pattern,
+			     unsigned int *pattern_lenp,
+			     int pattern_maxlen)
+{
+  const char *end = from + packet_len;
+  const char *p, *q;
+  int n;
+
+  p = from;
+  for (q = p; q < end && *q != ';'; q++)
+    ;
+  if (q == end || q == p)
+    return -1;
+  decode_address (start_addrp, p, q - p);
+
+  p = q + 1;
+  for (q = p; q < end && *q != ';'; q++)
+    ;
+  if (q == end || q == p)
+    return -1;
+  decode_address (search_space_lenp, p, q - p);
+
+  p = q + 1;
+  n = remote_unescape_input ((const unsigned char *) p, end - p,
+			     pattern, pattern_maxlen);
+  if (n < 0)
+    return -1;
+  *pattern_lenp = n;
+
+  return 0;
+}
+/* APPLE LOCAL end search memory */
+
 /* Convert number NIB to a hex digit.  */
 
 static int
@@ -284,6 +367,10 @@ hexify (char *hex, const char *bin, int count)
   return i;
 }
 
+/* Set once GDB has asked, with QStartNoAckMode, that neither side
+   acknowledge packets any more.  */
+int noack_mode;
+
 /* Send a packet to the remote machine, with error checking.
    The data of the packet is in BUF.  Returns >= 0 on success, -1 otherwise. */
 
@@ -331,6 +418,8 @@ putpkt (char *buf)
 #if defined (NO_ACKS)
       break;
 #endif
+      if (noack_mode)
+	break;
 
       if (remote_debug)
 	{
@@ -527,11 +616,30 @@ getpkt (char *buf)
       if (csum == (c1 << 4) + c2)
 	break;
 
+      if (noack_mode)
+	{
+	  /* GDB won't be listening for a NAK; all we can do is use the
+	     packet as it is.  */
+	  fprintf (stderr, "Bad checksum, sentsum=0x%x, csum=0x%x, buf=%s "
+		   "[no-ack mode]\n", (c1 << 4) + c2, csum, buf);
+	  break;
+	}
+
       fprintf (stderr, "Bad checksum, sentsum=0x%x, csum=0x%x, buf=%s\n",
 	       (c1 << 4) + c2, csum, buf);
       write (remote_desc, "-", 1);
     }
 
+  if (noack_mode)
+    {
+      if (remote_debug)
+	{
+	  fprintf (stderr, "getpkt (\"%s\");  [no ack sent] \n", buf);
+	  fflush (stderr);
+	}
+      return bp - buf;
+    }
+
   if (remote_debug)
     {
       fprintf (stderr, "getpkt (\"%s\");  [sending ack] \n", buf);
@@ -648,9 +756,62 @@ dead_thread_notify (int id)
   enable_async_io ();
 }
 
+/* The registers to send in a 'T' stop reply, as requested by GDB with
+   a QExpedite packet.  Until GDB asks, or after it sends an empty
+   list, we send the target's gdbserver_expedite_regs.  */
+
+static int *expedite_regnos;
+static int n_expedite_regnos = -1;
+
+/* Parse LIST, the argument of a QExpedite packet: register numbers in
+   hex separated by ';', or nothing to go back to the default set.
+   Return 0 on success, -1 if the list is malformed or names a register
+   we don't have.  */
+
+int
+set_expedite_registers (char *list)
+{
+  int *regnos;
+  int count = 0;
+  char *p;
+
+  if (*list == '\0')
+    {
+      free (expedite_regnos);
+      expedite_regnos = NULL;
+      n_expedite_regnos = -1;
+      return 0;
+    }
+
+  regnos = malloc ((strlen (list) / 2 + 1) * sizeof (int));
+  if (regnos == NULL)
+    return -1;
+
+  for (p = list; *p != '\0'; )
+    {
+      char *end;
+      unsigned long regno = strtoul (p, &end, 16);
+
+      if (end == p || regno >= register_count ()
+	  || (*end != ';' && *end != '\0'))
+	{
+	  free (regnos);
+	  return -1;
+	}
+      regnos[count++] = regno;
+      p = (*end == ';') ? end + 1 : end;
+    }
+
+  free (expedite_regnos);
+  expedite_regnos = regnos;
+  n_expedite_regnos = count;
+  return 0;
+}
+
 void
 prepare_resume_reply (char *buf, char status, unsigned char signo)
 {
+  char *start = buf;
   int nib, sig;
 
   *buf++ = status;
@@ -687,10 +848,30 @@ prepare_resume_reply (char *buf, char status, unsigned char signo)
 	  *buf++ = ';';
 	}
 
-      while (*regp)
+      if (n_expedite_regnos < 0)
+	{
+	  while (*regp)
+	    {
+	      buf = outreg (find_regno (*regp), buf);
+	      regp ++;
+	    }
+	}
+      else
 	{
-	  buf = outreg (find_regno (*regp), buf);
-	  regp ++;
+	  int i;
+
+	  /* GDB's list may not fit, if it asked for every register;
+	     send what does, leaving room for the thread.  GDB reads the
+	     rest with a 'g' packet.  */
+	  for (i = 0; i < n_expedite_regnos; i++)
+	    {
+	      int regno = expedite_regnos[i];
+
+	      if ((buf - start) + 2 * register_size (regno) + 8 + 32
+		  > PBUFSIZ)
+		break;
+	      buf = outreg (regno, buf);
+	    }
 	}
 
       /* Formerly, if the debugger had not used any thread features we would not
@@ -116,9 +116,212 @@ attach_inferior (int pid, char *statusptr, int *sigptr)
 
 extern int remote_debug;
 
+/* APPLE LOCAL begin search memory */
+/* How much of the inferior's memory to read at a time when searching
+   it.  */
+#define SEARCH_CHUNK_SIZE 16000
+
+/* Return the first place the PATTERN_LEN bytes at PATTERN occur in the
+   BUF_LEN bytes at BUF, or NULL if they don't.  */
+
+static const unsigned char *
+find_pattern_in_buffer (const unsigned char *buf, unsigned int buf_len,
+			const unsigned char *pattern,
+			unsigned int pattern_len)
+{
+  const unsigned char *p = buf;
+  const unsigned char *end = buf + buf_len;
+
+  while (end - p >= pattern_len)
+    {
+      p = memchr (p, pattern[0], end - p - pattern_len + 1);
+      if (p == NULL)
+	return NULL;
+      if (memcmp (p + 1, pattern + 1, pattern_len - 1) == 0)
+	return p;
+      p++;
+    }
+
+  return NULL;
+}
+
+/* Handle "qSearch:memory:ADDR;LENGTH;PATTERN", the PACKET_LEN bytes in
+   OWN_BUF: search the inferior's memory here rather than sending it
+   all to GDB.  Reply "0" if the pattern isn't there, "1,ADDR" with
+   the first place it is, or an error.  */
+
+static void
+handle_search_memory (char *own_buf, int packet_len)
+{
+  const int cmd_name_len = sizeof ("qSearch:memory:") - 1;
+  CORE_ADDR start_addr;
+  CORE_ADDR search_space_len;
+  unsigned char *pattern;
+  unsigned int pattern_len;
+  unsigned char *search_buf;
+  unsigned int search_buf_size;
+  unsigned int chunk_size;
+  const unsigned char *found;
+
+  pattern = malloc (packet_len);
+  if (pattern == NULL
+      || decode_search_memory_packet (own_buf + cmd_name_len,
+				      packet_len - cmd_name_len,
+				      &start_addr, &search_space_len,
+				      pattern, &pattern_len,
+				      packet_len) < 0
+      || pattern_len == 0)
+    {
+      free (pattern);
+      write_enn (own_buf);
+      return;
+    }
+
+  /* Keep PATTERN_LEN - 1 bytes of each chunk to search along with the
+     next one, so that a match straddling the two is found.  */
+  chunk_size = SEARCH_CHUNK_SIZE;
+  search_buf_size = chunk_size + pattern_len - 1;
+  if (search_space_len < search_buf_size)
+    search_buf_size = search_space_len;
+
+  search_buf = malloc (search_buf_size);
+  if (search_buf == NULL
+      || read_inferior_memory (start_addr, search_buf,
+			       search_buf_size) != 0)
+    {
+      free (search_buf);
+      free (pattern);
+      write_enn (own_buf);
+      return;
+    }
+
+  while (search_space_len >= pattern_len)
+    {
+      unsigned int nr_search_bytes = search_buf_size;
+
+      if (search_space_len < nr_search_bytes)
+	nr_search_bytes = search_space_len;
+
+      found = find_pattern_in_buffer (search_buf, nr_search_bytes,
+				      pattern, pattern_len);
+      if (found != NULL)
+	{
+	  CORE_ADDR found_addr = start_addr + (found - search_buf);
+
+	  sprintf (own_buf, "1,%lx", (unsigned long) found_addr);
+	  free (search_buf);
+	  free (pattern);
+	  return;
+	}
+
+      /* Not found in this chunk, skip to the next one.  */
+      if (search_space_len >= chunk_size)
+	search_space_len -= chunk_size;
+      else
+	search_space_len = 0;
+
+      if (search_space_len >= pattern_len)
+	{
+	  unsigned int keep_len = search_buf_size - chunk_size;
+	  CORE_ADDR read_addr = start_addr + chunk_size + keep_len;
+	  unsigned int nr_to_read;
+
+	  /* Copy the trailing part of the previous chunk to the front
+	     of the buffer.  */
+	  memmove (search_buf, search_buf + chunk_size, keep_len);
+
+	  nr_to_read = search_buf_size - keep_len;
+	  if (search_space_len - keep_len < nr_to_read)
+	    nr_to_read = search_space_len - keep_len;
+
+	  if (read_inferior_memory (read_addr, search_buf + keep_len,
+				    nr_to_read) != 0)
+	    {
+	      free (search_buf);
+	      free (pattern);
+	      write_enn (own_buf);
+	      return;
+	    }
+
+	  start_addr += chunk_size;
+	}
+    }
+
+  free (search_buf);
+  free (pattern);
+  strcpy (own_buf, "0");
+}
+/* APPLE LOCAL end search memory */
+
+/* APPLE LOCAL begin qCRC */
+/* Table used by the crc32 function to calculate the checksum.  */
+
+static unsigned int crc32_table[256] =
+{0, 0};
+
+/* Update CRC with the LEN bytes at BUF, the same way GDB's remote.c
+   does.  */
+
+static unsigned int
+crc32 (const unsigned char *buf, int len, unsigned int crc)
+{
+  if (!crc32_table[1])
+    {
+      /* Initialize the CRC table.  */
+      int i, j;
+      unsigned int c;
+
+      for (i = 0; i < 256; i++)
+	{
+	  for (c = i << 24, j = 8; j > 0; --j)
+	    c = c & 0x80000000 ? (c << 1) ^ 0x04c11db7 : (c << 1);
+	  crc32_table[i] = c;
+	}
+    }
+
+  while (len--)
+    {
+      crc = (crc << 8) ^ crc32_table[((crc >> 24) ^ *buf) & 255];
+      buf++;
+    }
+  return crc;
+}
+
+/* Handle "qCRC:ADDR,LENGTH" in OWN_BUF: reply "C" and the CRC of the
+   LENGTH bytes of the inferior's memory at ADDR, so that GDB can tell
+   whether they hold what it has without reading them.  */
+
+static void
+handle_crc (char *own_buf)
+{
+  unsigned char buf[SEARCH_CHUNK_SIZE];
+  CORE_ADDR addr;
+  unsigned int len;
+  unsigned int crc = 0xffffffff;
+
+  decode_m_packet (&own_buf[5], &addr, &len);
+
+  while (len > 0)
+    {
+      unsigned int n = len < sizeof buf ? len : sizeof buf;
+
+      if (read_inferior_memory (addr, buf, n) != 0)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      crc = crc32 (buf, n, crc);
+      addr += n;
+      len -= n;
+    }
+
+  sprintf (own_buf, "C%x", crc);
+}
+/* APPLE LOCAL end qCRC */
+
 /* Handle all of the extended 'q' packets.  */
 void
-handle_query (char *own_buf)
+handle_query (char *own_buf, int packet_len)
 {
   static struct inferior_list_entry *thread_ptr;
 
@@ -174,6 +377,50 @@ handle_query (char *own_buf)
       return;
     }
 
+  /* APPLE LOCAL qCRC */
+  if (strncmp ("qCRC:", own_buf, 5) == 0)
+    {
+      handle_crc (own_buf);
+      return;
+    }
+
+  /* APPLE LOCAL search memory */
+  if (strncmp ("qSearch:memory:", own_buf,
+	       sizeof ("qSearch:memory:") - 1) == 0)
+    {
+      handle_search_memory (own_buf, packet_len);
+      return;
+    }
+
+  /* Otherwise we didn't know what packet it was.  Say we didn't
+     understand it.  */
+  own_buf[0] = 0;
+}
+
+/* Set when we have agreed to stop sending acks, once GDB has acked
+   our reply.  */
+static int start_noack_mode;
+
+/* Handle all of the extended 'Q' packets.  */
+void
+handle_general_set (char *own_buf)
+{
+  if (strcmp ("QStartNoAckMode", own_buf) == 0)
+    {
+      write_ok (own_buf);
+      start_noack_mode = 1;
+      return;
+    }
+
+  if (strncmp ("QExpedite:", own_buf, 10) == 0)
+    {
+      if (set_expedite_registers (own_buf + 10) == 0)
+	write_ok (own_buf);
+      else
+	write_enn (own_buf);
+      return;
+    }
+
   /* Otherwise we didn't know what packet it was.  Say we didn't
      understand it.  */
   own_buf[0] = 0;
@@ -361,6 +608,8 @@ main (int argc, char *argv[])
   int bad_attach;
   int pid;
   char *arg_end;
+  /* APPLE LOCAL search memory */
+  int packet_len;
 
   if (setjmp (toplevel))
     {
@@ -440,7 +689,8 @@ main (int argc, char *argv[])
 
     restart:
       setjmp (toplevel);
-      while (getpkt (own_buf) > 0)
+      /* APPLE LOCAL search memory */
+      while ((packet_len = getpkt (own_buf)) > 0)
 	{
 	  unsigned char sig;
 	  i = 0;
@@ -448,7 +698,11 @@ main (int argc, char *argv[])
 	  switch (ch)
 	    {
 	    case 'q':
-	      handle_query (own_buf);
+	      /* APPLE LOCAL search memory */
+	      handle_query (own_buf, packet_len);
+	      break;
+	    case 'Q':
+	      handle_general_set (own_buf);
 	      break;
 	    case 'd':
 	      /* APPLE LOCAL: Handle all the debug flags here. */
@@ -603,8 +857,39 @@ main (int argc, char *argv[])
 		int len = strtol (lenptr + 1, &dataptr, 16);
 		char type = own_buf[1];
 
-		if (the_target->insert_watchpoint == NULL
-		    || (type < '2' || type > '4'))
+		if (type == '0')
+		  {
+		    /* Software breakpoint, optionally followed by
+		       ";X<len>,<bytecode>" conditions for us to check
+		       before reporting a hit.  */
+		    int res = set_gdb_breakpoint_at (addr);
+
+		    while (res == 0 && *dataptr == ';')
+		      {
+			dataptr++;
+			if (*dataptr != 'X'
+			    || add_breakpoint_condition (addr,
+							 dataptr + 1) != 0)
+			  {
+			    delete_gdb_breakpoint_at (addr);
+			    res = -1;
+			    break;
+			  }
+			dataptr = strchr (dataptr, ';');
+			if (dataptr == NULL)
+			  break;
+		      }
+
+		    if (res == 0)
+		      write_ok (own_buf);
+		    else if (res == 1)
+		      /* Unsupported.  */
+		      own_buf[0] = '\0';
+		    else
+		      write_enn (own_buf);
+		  }
+		else if (the_target->insert_watchpoint == NULL
+			 || (type < '2' || type > '4'))
 		  {
 		    /* No watchpoint support or not a watchpoint command;
 		       unrecognized either way.  */
@@ -633,8 +918,20 @@ main (int argc, char *argv[])
 		int len = strtol (lenptr + 1, &dataptr, 16);
 		char type = own_buf[1];
 
-		if (the_target->remove_watchpoint == NULL
-		    || (type < '2' || type > '4'))
+		if (type == '0')
+		  {
+		    int res = delete_gdb_breakpoint_at (addr);
+
+		    if (res == 0)
+		      write_ok (own_buf);
+		    else if (res == 1)
+		      /* Unsupported.  */
+		      own_buf[0] = '\0';
+		    else
+		      write_enn (own_buf);
+		  }
+		else if (the_target->remove_watchpoint == NULL
+			 || (type < '2' || type > '4'))
 		  {
 		    /* No watchpoint support or not a watchpoint command;
 		       unrecognized either way.  */
@@ -730,6 +1027,14 @@ main (int argc, char *argv[])
 
 	  putpkt (own_buf);
 
+	  /* putpkt waited for GDB to ack the OK, so both sides can now
+	     stop acking.  */
+	  if (start_noack_mode)
+	    {
+	      start_noack_mode = 0;
+	      noack_mode = 1;
+	    }
+
 	  if (status == 'W')
 	    fprintf (stderr,
 		     "\nChild exited with status %d\n", signal);
@@ -134,6 +134,7 @@ extern jmp_buf toplevel;
 
 /* Functions from remote-utils.c */
 
+extern int noack_mode;
 int putpkt (char *buf);
 int getpkt (char *buf);
 void remote_open (char *name);
@@ -149,11 +150,19 @@ void convert_int_to_ascii (unsigned char *from, char *to, int n);
 void new_thread_notify (int id);
 void dead_thread_notify (int id);
 void prepare_resume_reply (char *buf, char status, unsigned char sig);
+int set_expedite_registers (char *list);
 
 void decode_m_packet (char *from, CORE_ADDR * mem_addr_ptr,
 		      unsigned int *len_ptr);
 void decode_M_packet (char *from, CORE_ADDR * mem_addr_ptr,
 		      unsigned int *len_ptr, unsigned char *to);
+/* APPLE LOCAL search memory */
+int decode_search_memory_packet (const char *from, int packet_len,
+				 CORE_ADDR *start_addrp,
+				 CORE_ADDR *search_space_lenp,
+				 unsigned char *pattern,
+				 unsigned int *pattern_lenp,
+				 int pattern_maxlen);
 
 int unhexify (char *bin, const char *hex, int count);
 int hexify (char *hex, const char *bin, int count);
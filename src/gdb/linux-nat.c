@@ -43,6 +43,7 @@
 #include "gdbthread.h"		/* for struct thread_info etc. */
 #include "gdb_stat.h"		/* for struct stat */
 #include <fcntl.h>		/* for O_RDONLY */
+#include "hashtab.h"
 
 #ifndef O_LARGEFILE
 #define O_LARGEFILE 0
@@ -640,6 +641,10 @@ static struct lwp_info *lwp_list;
 /* Number of LWPs in the list.  */
 static int num_lwps;
 
+/* The same LWPs, hashed by LWP id, so that looking one up when
+   waitpid reports an event for it doesn't walk the whole list.  */
+static htab_t lwp_table;
+
 /* Non-zero if we're running in "threaded" mode.  */
 static int threaded;
 
@@ -719,11 +724,53 @@ init_lwp_list (void)
       xfree (lp);
     }
 
+  if (lwp_table != NULL)
+    htab_empty (lwp_table);
+
   lwp_list = NULL;
   num_lwps = 0;
   threaded = 0;
 }
 
+/* Hash and equality functions for LWP_TABLE.  Entries are hashed by
+   LWP id, and looked up with a pointer to an LWP id as the key.  */
+
+static hashval_t
+hash_lwp_id (int lwp)
+{
+  return (hashval_t) lwp;
+}
+
+static hashval_t
+lwp_table_hash (const void *p)
+{
+  const struct lwp_info *lp = p;
+
+  return hash_lwp_id (GET_LWP (lp->ptid));
+}
+
+static int
+lwp_table_eq (const void *p, const void *key)
+{
+  const struct lwp_info *lp = p;
+
+  return GET_LWP (lp->ptid) == *(const int *) key;
+}
+
+/* Return the LWP_TABLE slot for LWP id LWP, creating the table if
+   necessary.  INSERT says whether to make room for a new entry.  */
+
+static void **
+lwp_table_slot (int lwp, enum insert_option insert)
+{
+  if (lwp_table == NULL)
+    lwp_table = htab_create_alloc (64, lwp_table_hash, lwp_table_eq,
+				   NULL, xcalloc, xfree);
+
+  return htab_find_slot_with_hash (lwp_table, &lwp, hash_lwp_id (lwp),
+				   insert);
+}
+
 /* Add the LWP specified by PID to the list.  If this causes the
    number of LWPs to become larger than one, go into "threaded" mode.
    Return a pointer to the structure describing the new LWP.  */
@@ -744,7 +791,10 @@ add_lwp (ptid_t ptid)
   lp->ptid = ptid;
 
   lp->next = lwp_list;
+  if (lwp_list)
+    lwp_list->prev = lp;
   lwp_list = lp;
+  *lwp_table_slot (GET_LWP (ptid), INSERT) = lp;
   if (++num_lwps > 1)
     threaded = 1;
 
@@ -756,25 +806,29 @@ add_lwp (ptid_t ptid)
 static void
 delete_lwp (ptid_t ptid)
 {
-  struct lwp_info *lp, *lpprev;
-
-  lpprev = NULL;
+  struct lwp_info *lp;
+  void **slot;
 
-  for (lp = lwp_list; lp; lpprev = lp, lp = lp->next)
-    if (ptid_equal (lp->ptid, ptid))
-      break;
+  slot = lwp_table_slot (GET_LWP (ptid), NO_INSERT);
+  if (slot == NULL)
+    return;
 
-  if (!lp)
+  lp = *slot;
+  if (!ptid_equal (lp->ptid, ptid))
     return;
 
+  htab_clear_slot (lwp_table, slot);
+
   /* We don't go back to "non-threaded" mode if the number of threads
      becomes less than two.  */
   num_lwps--;
 
-  if (lpprev)
-    lpprev->next = lp->next;
+  if (lp->prev)
+    lp->prev->next = lp->next;
   else
     lwp_list = lp->next;
+  if (lp->next)
+    lp->next->prev = lp->prev;
 
   xfree (lp);
 }
@@ -785,7 +839,7 @@ delete_lwp (ptid_t ptid)
 static struct lwp_info *
 find_lwp_pid (ptid_t ptid)
 {
-  struct lwp_info *lp;
+  void **slot;
   int lwp;
 
   if (is_lwp (ptid))
@@ -793,11 +847,11 @@ find_lwp_pid (ptid_t ptid)
   else
     lwp = GET_PID (ptid);
 
-  for (lp = lwp_list; lp; lp = lp->next)
-    if (lwp == GET_LWP (lp->ptid))
-      return lp;
+  slot = lwp_table_slot (lwp, NO_INSERT);
+  if (slot == NULL)
+    return NULL;
 
-  return NULL;
+  return *slot;
 }
 
 /* Call CALLBACK with its second argument set to DATA for every LWP in
@@ -1176,6 +1230,9 @@ linux_nat_handle_extended (struct lwp_info *lp, int status)
   return 0;
 }
 
+static int wait_lwp_status (struct lwp_info *lp, int status,
+			    int thread_dead);
+
 /* Wait for LP to stop.  Returns the wait status, or 0 if the LWP has
    exited.  */
 
@@ -1220,6 +1277,16 @@ wait_lwp (struct lwp_info *lp)
 	}
     }
 
+  return wait_lwp_status (lp, status, thread_dead);
+}
+
+/* Deal with STATUS, which waitpid has just reported for LP.  If
+   THREAD_DEAD is non-zero, LP has already gone away.  Returns the
+   wait status, or 0 if the LWP has exited.  */
+
+static int
+wait_lwp_status (struct lwp_info *lp, int status, int thread_dead)
+{
   /* Check if the thread has exited.  */
   if (WIFEXITED (status) || WIFSIGNALED (status))
     {
@@ -1292,22 +1359,32 @@ stop_callback (struct lwp_info *lp, void *data)
   return 0;
 }
 
+static int stop_wait_handle_status (struct lwp_info *lp, int status,
+				    void *data);
+
 /* Wait until LP is stopped.  If DATA is non-null it is interpreted as
    a pointer to a set of signals to be flushed immediately.  */
 
 static int
 stop_wait_callback (struct lwp_info *lp, void *data)
 {
-  sigset_t *flush_mask = data;
-
   if (!lp->stopped)
-    {
-      int status;
+    return stop_wait_handle_status (lp, wait_lwp (lp), data);
 
-      status = wait_lwp (lp);
-      if (status == 0)
-	return 0;
+  return 0;
+}
+
+/* Deal with STATUS, the wait status wait_lwp or wait_lwp_status
+   returned for LP while stopping it.  DATA is as for
+   stop_wait_callback.  */
+
+static int
+stop_wait_handle_status (struct lwp_info *lp, int status, void *data)
+{
+  sigset_t *flush_mask = data;
 
+  if (status != 0)
+    {
       /* Ignore any signals in FLUSH_MASK.  */
       if (flush_mask && sigismember (flush_mask, WSTOPSIG (status)))
 	{
@@ -1432,6 +1509,98 @@ stop_wait_callback (struct lwp_info *lp, void *data)
   return 0;
 }
 
+/* Collect whatever events the LWPs being stopped have already
+   reported, without blocking.  FLUSH_MASK is as for
+   stop_wait_callback.  */
+
+static void
+reap_stopped_lwps (sigset_t *flush_mask)
+{
+  static const int wait_options[] = { 0, __WCLONE };
+  int i;
+
+  for (i = 0; i < ARRAY_SIZE (wait_options); i++)
+    for (;;)
+      {
+	struct lwp_info *lp;
+	int status;
+	pid_t pid;
+
+	pid = my_waitpid (-1, &status, wait_options[i] | WNOHANG);
+	if (pid <= 0)
+	  break;
+
+	lp = find_lwp_pid (pid_to_ptid (pid));
+
+	if (debug_linux_nat)
+	  fprintf_unfiltered (gdb_stdlog,
+			      "RSL: waitpid %ld received %s\n",
+			      (long) pid, status_to_str (status));
+
+	/* A process we don't know about yet; see the matching code in
+	   linux_nat_wait.  */
+	if (lp == NULL)
+	  {
+	    if (WIFSTOPPED (status))
+	      linux_record_stopped_pid (pid);
+	    continue;
+	  }
+
+	/* Keep an event for an LWP we already stopped for
+	   linux_nat_wait, unless it has one pending already, in which
+	   case throw the signal back into the queue.  */
+	if (lp->stopped)
+	  {
+	    if (lp->status == 0)
+	      lp->status = status;
+	    else if (WIFSTOPPED (status))
+	      kill_lwp (pid, WSTOPSIG (status));
+	    continue;
+	  }
+
+	stop_wait_handle_status (lp, wait_lwp_status (lp, status, 0),
+				 flush_mask);
+      }
+}
+
+/* Wait until every LWP has stopped.  All of them have been sent a
+   SIGSTOP by stop_callback.  Instead of blocking on each LWP in list
+   order, collect whatever stop events are already pending before
+   each blocking wait, so that with many LWPs most of them are picked
+   up as they arrive.  FLUSH_MASK is as for stop_wait_callback.  */
+
+static void
+stop_wait_all_lwps (sigset_t *flush_mask)
+{
+  struct cleanup *old_chain;
+  struct lwp_info *lp;
+  ptid_t *ptids;
+  int nptids = 0;
+  int i;
+
+  ptids = xmalloc ((num_lwps + 1) * sizeof (ptid_t));
+  old_chain = make_cleanup (xfree, ptids);
+
+  for (lp = lwp_list; lp; lp = lp->next)
+    if (!lp->stopped)
+      ptids[nptids++] = lp->ptid;
+
+  for (i = 0; i < nptids; i++)
+    {
+      reap_stopped_lwps (flush_mask);
+
+      /* The LWP may have exited, or been collected above.  */
+      lp = find_lwp_pid (ptids[i]);
+      if (lp != NULL && !lp->stopped)
+	stop_wait_callback (lp, flush_mask);
+    }
+
+  do_cleanups (old_chain);
+
+  /* Pick up any LWPs that appeared while we were waiting.  */
+  iterate_over_lwps (stop_wait_callback, flush_mask);
+}
+
 /* Check whether PID has any pending signals in FLUSH_MASK.  If so set
    the appropriate bits in PENDING, and return 1 - otherwise return 0.  */
 
@@ -1793,19 +1962,18 @@ child_wait (ptid_t ptid, struct target_waitstatus *ourstatus)
 static int
 stop_and_resume_callback (struct lwp_info *lp, void *data)
 {
-  struct lwp_info *ptr;
-
   if (!lp->stopped && !lp->signalled)
     {
+      ptid_t ptid = lp->ptid;
+
       stop_callback (lp, NULL);
       stop_wait_callback (lp, NULL);
       /* Resume if the lwp still exists.  */
-      for (ptr = lwp_list; ptr; ptr = ptr->next)
-	if (lp == ptr)
-	  {
-	    resume_callback (lp, NULL);
-	    resume_set_callback (lp, NULL);
-	  }
+      if (find_lwp_pid (ptid) == lp)
+	{
+	  resume_callback (lp, NULL);
+	  resume_set_callback (lp, NULL);
+	}
     }
   return 0;
 }
@@ -2193,7 +2361,7 @@ retry:
 
   /* ... and wait until all of them have reported back that they're no
      longer running.  */
-  iterate_over_lwps (stop_wait_callback, &flush_mask);
+  stop_wait_all_lwps (&flush_mask);
   iterate_over_lwps (flush_callback, &flush_mask);
 
   /* If we're not waiting for a specific LWP, choose an event LWP from
@@ -2468,6 +2636,66 @@ read_mapping (FILE *mapfile,
   return (ret != 0 && ret != EOF);
 }
 
+/* The anonymous mappings found by the last call to
+   linux_nat_find_memory_regions.  A page in one of them that the
+   process has never touched reads as zeros.  */
+
+struct anon_mapping
+{
+  CORE_ADDR lo;
+  CORE_ADDR hi;
+};
+
+static struct anon_mapping *anon_mappings;
+static int num_anon_mappings;
+static int max_anon_mappings;
+
+/* The "to_find_untouched_pages" target method: use /proc/PID/pagemap to
+   find the pages of an anonymous mapping that are neither in memory
+   nor swapped out.  */
+
+static int
+linux_nat_find_untouched_pages (CORE_ADDR addr, int page_size,
+				unsigned long npages, unsigned char *untouched)
+{
+  char filename[MAXPATHLEN];
+  unsigned long long *entries;
+  size_t len = npages * sizeof (unsigned long long);
+  unsigned long i;
+  int fd;
+  int ok;
+
+  if (page_size != getpagesize () || addr % page_size != 0)
+    return 0;
+
+  for (i = 0; i < num_anon_mappings; i++)
+    if (addr >= anon_mappings[i].lo
+	&& addr + (CORE_ADDR) npages * page_size <= anon_mappings[i].hi)
+      break;
+  if (i == num_anon_mappings)
+    return 0;
+
+  sprintf (filename, "/proc/%d/pagemap", PIDGET (inferior_ptid));
+  fd = open (filename, O_RDONLY);
+  if (fd < 0)
+    return 0;
+
+  entries = xmalloc (len);
+  ok = (lseek (fd, (off_t) (addr / page_size) * sizeof (unsigned long long),
+		SEEK_SET) != (off_t) -1
+	&& read (fd, entries, len) == len);
+  close (fd);
+
+  /* Bit 63 of an entry is set if the page is present, bit 62 if it
+     is swapped out.  */
+  if (ok)
+    for (i = 0; i < npages; i++)
+      untouched[i] = ((entries[i] >> 62) & 3) == 0;
+
+  xfree (entries);
+  return ok;
+}
+
 /* Fills the "to_find_memory_regions" target vector.  Lists the memory
    regions in the inferior for a corefile.  */
 
@@ -2493,6 +2721,8 @@ linux_nat_find_memory_regions (int (*func) (CORE_ADDR,
     fprintf_filtered (gdb_stdout,
 		      "Reading memory regions from %s\n", mapsfilename);
 
+  num_anon_mappings = 0;
+
   /* Now iterate until end-of-file.  */
   while (read_mapping (mapsfile, &addr, &endaddr, &permissions[0],
 		       &offset, &device[0], &inode, &filename[0]))
@@ -2516,6 +2746,26 @@ linux_nat_find_memory_regions (int (*func) (CORE_ADDR,
 	  fprintf_filtered (gdb_stdout, "\n");
 	}
 
+      /* Remember the private mappings backed by no file, which are
+	 demand-zero.  The brk heap, named [heap], is one of them; the
+	 other pseudo-files such as [vdso], [vsyscall] and [stack] are
+	 not, so skip them.  */
+      if (inode == 0 && permissions[3] == 'p'
+	  && (filename[strspn (filename, " \t")] == '\0'
+	      || strstr (filename, "[heap]") != NULL))
+	{
+	  if (num_anon_mappings == max_anon_mappings)
+	    {
+	      max_anon_mappings = max_anon_mappings ? max_anon_mappings * 2 : 64;
+	      anon_mappings = xrealloc (anon_mappings,
+					max_anon_mappings
+					* sizeof (struct anon_mapping));
+	    }
+	  anon_mappings[num_anon_mappings].lo = addr;
+	  anon_mappings[num_anon_mappings].hi = endaddr;
+	  num_anon_mappings++;
+	}
+
       /* Invoke the callback function to create the corefile
 	 segment.  */
       func (addr, size, read, write, exec, obfd);
@@ -3072,6 +3322,7 @@ _initialize_linux_nat (void)
 
   deprecated_child_ops.to_find_memory_regions = linux_nat_find_memory_regions;
   deprecated_child_ops.to_make_corefile_notes = linux_nat_make_corefile_notes;
+  deprecated_child_ops.to_find_untouched_pages = linux_nat_find_untouched_pages;
 
   add_info ("proc", linux_nat_info_proc_cmd, _("\
 Show /proc process information about any running process.\n\
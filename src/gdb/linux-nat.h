@@ -59,8 +59,9 @@ struct lwp_info
      or to a local variable in lin_lwp_wait.  */
   struct target_waitstatus waitstatus;
 
-  /* Next LWP in list.  */
+  /* Next and previous LWP in list.  */
   struct lwp_info *next;
+  struct lwp_info *prev;
 };
 
 /* Read/write to target memory via the Linux kernel's "proc file
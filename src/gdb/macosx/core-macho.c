@@ -147,6 +147,7 @@ core_close_1 (void *arg)
     }
 
   name = bfd_get_filename (core_bfd);
+  section_table_unmap_bfd (core_bfd);
   if (!bfd_close (core_bfd))
     {
       warning ("Unable to close \"%s\": %s", name,
@@ -239,6 +240,10 @@ core_open (char *filename, int from_tty)
     error ("\"%s\": Can't find sections: %s",
            bfd_get_filename (core_bfd), bfd_errmsg (bfd_get_error ()));
 
+  /* Serve memory reads straight from a mapping of the core file.  */
+  if (!write_files)
+    section_table_map_bfd (core_bfd);
+
   ontop = !push_target (&macho_core_ops);
   discard_cleanups (old_chain);
 
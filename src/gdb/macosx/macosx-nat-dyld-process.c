@@ -1782,11 +1782,29 @@ dyld_load_symfiles (struct dyld_objfile_info *result)
   int i;
   int first = 1;
   struct dyld_objfile_entry *e;
+  /* APPLE LOCAL begin symbol prefetch */
+  struct cleanup *back_to;
+  bfd **bfds;
+  int n_bfds = 0;
+  /* APPLE LOCAL end symbol prefetch */
   CHECK_FATAL (result != NULL);
 
+  /* APPLE LOCAL begin symbol prefetch */
+  /* Let the prefetch threads start reading the libraries we are about
+     to load for the first time.  */
+  bfds = xmalloc ((result->nents + 1) * sizeof (bfd *));
+  back_to = make_cleanup (xfree, bfds);
+  DYLD_ALL_OBJFILE_INFO_ENTRIES (result, e, i)
+    if (!e->loaded_error && e->abfd != NULL && e->objfile == NULL)
+      bfds[n_bfds++] = e->abfd;
+  symbol_prefetch_bfds (bfds, n_bfds);
+  /* APPLE LOCAL end symbol prefetch */
+
   DYLD_ALL_OBJFILE_INFO_ENTRIES (result, e, i)
     {
       char load_char;
+      /* APPLE LOCAL background symbol loading */
+      int background_load_flag = OBJF_SYM_NONE;
 
       if (e->loaded_error)
         continue;
@@ -1815,7 +1833,22 @@ dyld_load_symfiles (struct dyld_objfile_info *result)
           printf_filtered ("Reading symbols for shared libraries ");
           gdb_flush (gdb_stdout);
         }
+      /* APPLE LOCAL begin background symbol loading */
+      /* Read only the external symbols of a new library now, and leave
+         the rest to be read when gdb is idle.  */
+      if (background_symbol_loading
+          && e->objfile == NULL
+          && !(e->reason & dyld_reason_executable_mask)
+          && (e->load_flag & OBJF_SYM_LEVELS_MASK) > OBJF_SYM_EXTERN)
+        {
+          background_load_flag = e->load_flag & OBJF_SYM_LEVELS_MASK;
+          e->load_flag = (e->load_flag & ~OBJF_SYM_LEVELS_MASK)
+            | OBJF_SYM_EXTERN;
+        }
       dyld_load_symfile (e);
+      if (background_load_flag != OBJF_SYM_NONE && e->objfile != NULL)
+        objfile_queue_background_load (e->objfile, background_load_flag);
+      /* APPLE LOCAL end background symbol loading */
       if (!info_verbose && dyld_print_status ())
         {
           printf_filtered ("%c", load_char);
@@ -1828,6 +1861,9 @@ dyld_load_symfiles (struct dyld_objfile_info *result)
       printf_filtered (" done\n");
       gdb_flush (gdb_stdout);
     }
+
+  /* APPLE LOCAL symbol prefetch */
+  do_cleanups (back_to);
 }
 
 /* Look up the objfile for a given shared library entry.  If no
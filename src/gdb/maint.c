@@ -37,6 +37,7 @@
 #include "symfile.h"
 #include "objfiles.h"
 #include "value.h"
+#include "dwarf2-frame.h"
 
 #include "cli/cli-decode.h"
 
@@ -428,6 +429,9 @@ maintenance_print_statistics (char *args, int from_tty)
 {
   print_objfile_statistics ();
   print_symbol_bcache_statistics ();
+  dwarf2_frame_print_statistics ();
+  /* APPLE LOCAL cache lookup values for improved performance  */
+  print_pc_lookup_cache_statistics ();
 }
 
 static void
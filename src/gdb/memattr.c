@@ -84,6 +84,7 @@ create_mem_region (CORE_ADDR lo, CORE_ADDR hi,
 static void
 delete_mem_region (struct mem_region *m)
 {
+  dcache_invalidate_range (target_dcache, m->lo, m->hi - m->lo);
   xfree (m);
 }
 
@@ -353,6 +354,7 @@ mem_enable (int num)
   for (m = mem_region_chain; m; m = m->next)
     if (m->number == num)
       {
+	dcache_invalidate_range (target_dcache, m->lo, m->hi - m->lo);
 	m->enabled_p = 1;
 	return;
       }
@@ -367,10 +369,9 @@ mem_enable_command (char *args, int from_tty)
   int num;
   struct mem_region *m;
 
-  dcache_invalidate (target_dcache);
-
   if (p == 0)
     {
+      dcache_invalidate (target_dcache);
       for (m = mem_region_chain; m; m = m->next)
 	m->enabled_p = 1;
     }
@@ -403,6 +404,7 @@ mem_disable (int num)
   for (m = mem_region_chain; m; m = m->next)
     if (m->number == num)
       {
+	dcache_invalidate_range (target_dcache, m->lo, m->hi - m->lo);
 	m->enabled_p = 0;
 	return;
       }
@@ -417,10 +419,9 @@ mem_disable_command (char *args, int from_tty)
   int num;
   struct mem_region *m;
 
-  dcache_invalidate (target_dcache);
-
   if (p == 0)
     {
+      dcache_invalidate (target_dcache);
       for (m = mem_region_chain; m; m = m->next)
 	m->enabled_p = 0;
     }
@@ -495,10 +496,9 @@ mem_delete_command (char *args, int from_tty)
   char *p1;
   int num;
 
-  dcache_invalidate (target_dcache);
-
   if (p == 0)
     {
+      dcache_invalidate (target_dcache);
       if (query ("Delete all memory regions? "))
 	mem_clear ();
       dont_repeat ();
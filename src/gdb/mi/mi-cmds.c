@@ -47,6 +47,8 @@ struct mi_cmd mi_cmds[] =
   { "break-watch", { NULL, 0 }, 0, mi_cmd_break_watch},
   { "data-disassemble", { NULL, 0 }, 0, mi_cmd_disassemble},
   { "data-evaluate-expression", { NULL, 0 }, 0, mi_cmd_data_evaluate_expression},
+  /* APPLE LOCAL search memory */
+  { "data-find-memory", { NULL, 0 }, 0, mi_cmd_data_find_memory},
   { "data-list-changed-registers", { NULL, 0 }, 0, mi_cmd_data_list_changed_registers},
   { "data-list-register-names", { NULL, 0 }, 0, mi_cmd_data_list_register_names},
   { "data-list-register-values", { NULL, 0 }, 0, mi_cmd_data_list_register_values},
@@ -64,6 +64,8 @@
 #include "objc-lang.h"
 /* APPLE LOCAL Disable breakpoints while updating data formatters.  */
 #include "breakpoint.h"
+/* APPLE LOCAL search memory */
+#include "findcmd.h"
 
 enum
   {
@@ -1689,6 +1691,121 @@ mi_cmd_data_read_memory (char *command, char **argv, int argc)
   return MI_CMD_DONE;
 }
 
+/* APPLE LOCAL begin search memory */
+/* DATA-FIND-MEMORY:
+
+   SIZE-CHAR: optional, preceeded by '-s'.  One of b, h, w or g to
+   store each VALUE in 1, 2, 4 or 8 bytes, as for the "find" command.
+   MAX-COUNT: optional, preceeded by '-m'.  Stop after this many
+   matches.
+   ADDR: the address to start searching at.
+   LENGTH: the number of bytes to search.
+   VALUE...: the expressions or quoted strings making up the pattern.
+
+   Returns:
+   addresses=[ADDR,...],found="N"  */
+
+static void
+mi_cmd_data_find_memory_found (CORE_ADDR found_addr, void *data)
+{
+  ui_out_field_core_addr (uiout, NULL, found_addr);
+}
+
+enum mi_cmd_result
+mi_cmd_data_find_memory (char *command, char **argv, int argc)
+{
+  struct cleanup *cleanups;
+  struct cleanup *cleanup_list;
+  struct search_pattern pattern;
+  CORE_ADDR addr;
+  LONGEST length;
+  ULONGEST max_count = ~(ULONGEST) 0;
+  ULONGEST found_count;
+  char size = 0;
+  int optind = 0;
+  char *optarg;
+  int i;
+  enum opt
+    {
+      SIZE_OPT, MAX_COUNT_OPT
+    };
+  static struct mi_opt opts[] =
+  {
+    {"s", SIZE_OPT, 1},
+    {"m", MAX_COUNT_OPT, 1},
+    {0, 0, 0},
+  };
+
+  while (1)
+    {
+      int opt = mi_getopt ("mi_cmd_data_find_memory", argc, argv, opts,
+			   &optind, &optarg);
+      if (opt < 0)
+	break;
+      switch ((enum opt) opt)
+	{
+	case SIZE_OPT:
+	  size = optarg[0];
+	  if (size == '\0' || strchr ("bhwg", size) == NULL
+	      || optarg[1] != '\0')
+	    {
+	      mi_error_message = xstrprintf ("mi_cmd_data_find_memory: invalid size \"%s\".", optarg);
+	      return MI_CMD_ERROR;
+	    }
+	  break;
+	case MAX_COUNT_OPT:
+	  max_count = strtoul (optarg, NULL, 0);
+	  if (max_count == 0)
+	    {
+	      mi_error_message = xstrprintf ("mi_cmd_data_find_memory: invalid count \"%s\".", optarg);
+	      return MI_CMD_ERROR;
+	    }
+	  break;
+	}
+    }
+  argv += optind;
+  argc -= optind;
+
+  if (argc < 3)
+    {
+      mi_error_message = xstrprintf ("mi_cmd_data_find_memory: Usage: [-s SIZE-CHAR] [-m MAX-COUNT] ADDR LENGTH VALUE...");
+      return MI_CMD_ERROR;
+    }
+
+  addr = parse_and_eval_address (argv[0]);
+  length = value_as_long (parse_and_eval (argv[1]));
+  if (length <= 0)
+    {
+      mi_error_message = xstrprintf ("mi_cmd_data_find_memory: invalid length.");
+      return MI_CMD_ERROR;
+    }
+
+  memset (&pattern, 0, sizeof (pattern));
+  cleanups = make_cleanup (free_current_contents, &pattern.buf);
+
+  for (i = 2; i < argc; i++)
+    {
+      char *p = argv[i];
+
+      search_pattern_append (&pattern, &p, size);
+      if (*p != '\0')
+	error (_("Junk after value in search pattern: %s"), p);
+    }
+
+  if ((ULONGEST) length < pattern.len)
+    error (_("Search space too small to contain pattern."));
+
+  cleanup_list = make_cleanup_ui_out_list_begin_end (uiout, "addresses");
+  found_count = search_memory_all (addr, length, &pattern, max_count,
+				   mi_cmd_data_find_memory_found, NULL);
+  do_cleanups (cleanup_list);
+  ui_out_field_string (uiout, "found", paddr_u (found_count));
+
+  do_cleanups (cleanups);
+  return MI_CMD_DONE;
+}
+/* APPLE LOCAL end search memory */
+
 /* DATA-MEMORY-WRITE:
 
    COLUMN_OFFSET: optional argument. Must be preceeded by '-o'. The
@@ -2216,6 +2333,11 @@ mi_command_completes_while_target_executing (char *command)
 static enum mi_cmd_result
 mi_cmd_execute (struct mi_parse *parse)
 {
+  /* APPLE LOCAL begin read coalescing */
+  struct cleanup *old_chain;
+  enum mi_cmd_result result;
+  /* APPLE LOCAL end read coalescing */
+
   if (parse->cmd->argv_func != NULL
       || parse->cmd->args_func != NULL)
     {
@@ -2234,10 +2356,19 @@ mi_cmd_execute (struct mi_parse *parse)
 	    }
 	}
 
+      /* APPLE LOCAL: Let the command's small memory reads share
+	 transfers.  */
+      old_chain = make_cleanup_coalesce_memory_reads ();
+
       /* FIXME: DELETE THIS! */
       if (parse->cmd->args_func != NULL)
-	return parse->cmd->args_func (parse->args, 0 /*from_tty */ );
-      return parse->cmd->argv_func (parse->command, parse->argv, parse->argc);
+	result = parse->cmd->args_func (parse->args, 0 /*from_tty */ );
+      else
+	result = parse->cmd->argv_func (parse->command, parse->argv,
+					parse->argc);
+
+      do_cleanups (old_chain);
+      return result;
     }
   else if (parse->cmd->cli.cmd != 0)
     {
@@ -51,26 +51,22 @@
 #include "value.h"
 #include "cp-abi.h"
 
-/* Accumulate the minimal symbols for each objfile in bunches of BUNCH_SIZE.
-   At the end, copy them all into one newly allocated location on an objfile's
-   symbol obstack.  */
+/* APPLE LOCAL: Accumulate the minimal symbols for each objfile in one
+   growable array.  At the end, copy them all, sorted, into one newly
+   allocated location on an objfile's symbol obstack.  We used to keep
+   them in a list of small bunches, but a contiguous array is cheaper
+   to fill and to sort when a library has a million symbols.  */
 
-#define BUNCH_SIZE 127
+#define MSYM_VECTOR_INITIAL_SIZE 1024
 
-struct msym_bunch
-  {
-    struct msym_bunch *next;
-    struct minimal_symbol contents[BUNCH_SIZE];
-  };
+/* The minimal symbols recorded so far, in the order they were
+   recorded.  */
 
-/* Bunch currently being filled up.
-   The next field points to chain of filled bunches.  */
+static struct minimal_symbol *msym_vector;
 
-static struct msym_bunch *msym_bunch;
+/* Number of slots allocated in msym_vector.  */
 
-/* Number of slots filled in current bunch.  */
-
-static int msym_bunch_index;
+static int msym_vector_size;
 
 /* Total number of minimal symbols recorded so far for the objfile.  */
 
@@ -106,6 +102,9 @@ msymbol_hash (const char *string)
   return hash;
 }
 
+/* APPLE LOCAL minsym address table  */
+static void build_minimal_symbol_address_table (struct objfile *);
+
 /* Add the minimal symbol SYM to an objfile's minsym hash table, TABLE.  */
 void
 add_minsym_to_hash_table (struct minimal_symbol *sym,
@@ -546,6 +545,8 @@ lookup_minimal_symbol_by_pc_section_from_objfile
   int new;
   struct minimal_symbol *msymbol;
   struct minimal_symbol *best_symbol = NULL;
+  /* APPLE LOCAL minsym address table  */
+  CORE_ADDR *addresses;
 
   /* If this objfile has a minimal symbol table, go search it using
      a binary search.  Note that a minimal symbol table always consists
@@ -572,56 +573,40 @@ lookup_minimal_symbol_by_pc_section_from_objfile
      for instance the use in lookup_minimal_symbol_by_pc_section (which is, in
      fact, at present this function's only use.)  JCI 07/22/2003  */
 
-  if ((msymbol = objfile->msymbols) != NULL)
+  if ((msymbol = objfile->msymbols) != NULL
+      && objfile->minimal_symbol_count > 0)
     {
-      lo = 0;
-      hi = objfile->minimal_symbol_count - 1;
+      /* APPLE LOCAL: Bisect the dense array of addresses rather than
+	 the symbols themselves.  */
+      if (objfile->msymbol_addresses == NULL)
+	build_minimal_symbol_address_table (objfile);
+      addresses = objfile->msymbol_addresses;
 
       /* This code assumes that the minimal symbols are sorted by
-         ascending address values.  If the pc value is greater than or
-         equal to the first symbol's address, then some symbol in this
-         minimal symbol table is a suitable candidate for being the
-         "best" symbol.  This includes the last real symbol, for cases
-         where the pc value is larger than any address in this vector.
-
-         By iterating until the address associated with the current
-         hi index (the endpoint of the test interval) is less than
-         or equal to the desired pc value, we accomplish two things:
-         (1) the case where the pc value is larger than any minimal
-         symbol address is trivially solved, (2) the address associated
-         with the hi index is always the one we want when the iteration
-         terminates.  In essence, we are iterating the test interval
-         down until the pc value is pushed out of it from the high end.
-
-         Warning: this code is trickier than it would appear at first. */
+         ascending address values.  Find the last symbol whose address
+         is less than or equal to PC.  This includes the last real
+         symbol, for cases where the pc value is larger than any
+         address in this vector.
+
+	 If we have multiple symbols at the same address, we want hi
+	 to point to the last one.  That way we can find the right
+	 symbol if it has an index greater than hi.  */
 
       /* Should also require that pc is <= end of objfile.  FIXME! */
-      if (pc >= SYMBOL_VALUE_ADDRESS (&msymbol[lo]))
+      lo = 0;
+      hi = objfile->minimal_symbol_count;
+      while (lo < hi)
 	{
-	  while (SYMBOL_VALUE_ADDRESS (&msymbol[hi]) > pc)
-	    {
-	      /* pc is still strictly less than highest address */
-	      /* Note "new" will always be >= lo */
-	      new = (lo + hi) / 2;
-	      if ((SYMBOL_VALUE_ADDRESS (&msymbol[new]) >= pc) ||
-		  (lo == new))
-		{
-		  hi = new;
-		}
-	      else
-		{
-		  lo = new;
-		}
-	    }
-
-	  /* If we have multiple symbols at the same address, we want
-	     hi to point to the last one.  That way we can find the
-	     right symbol if it has an index greater than hi.  */
-	  while (hi < objfile->minimal_symbol_count - 1
-		 && (SYMBOL_VALUE_ADDRESS (&msymbol[hi])
-		     == SYMBOL_VALUE_ADDRESS (&msymbol[hi + 1])))
-	    hi++;
+	  new = lo + (hi - lo) / 2;
+	  if (addresses[new] <= pc)
+	    lo = new + 1;
+	  else
+	    hi = new;
+	}
+      hi = lo - 1;
 
+      if (hi >= 0)
+	{
 	  /* The minimal symbol indexed by hi now is the best one in this
 	     objfile's minimal symbol table.  See if it is the best one
 	     overall. */
@@ -756,16 +741,15 @@ get_symbol_leading_char (bfd *abfd)
   return 0;
 }
 
-/* Prepare to start collecting minimal symbols.  Note that presetting
-   msym_bunch_index to BUNCH_SIZE causes the first call to save a minimal
-   symbol to allocate the memory for the first bunch. */
+/* Prepare to start collecting minimal symbols.  The first call to save
+   a minimal symbol allocates msym_vector.  */
 
 void
 init_minimal_symbol_collection (void)
 {
   msym_count = 0;
-  msym_bunch = NULL;
-  msym_bunch_index = BUNCH_SIZE;
+  msym_vector = NULL;
+  msym_vector_size = 0;
 }
 
 void
@@ -798,8 +782,9 @@ prim_record_minimal_symbol (const char *name, CORE_ADDR address,
 				       NULL, section, NULL, objfile);
 }
 
-/* Record a minimal symbol in the msym bunches.  Returns the symbol
-   newly created.  */
+/* Record a minimal symbol in msym_vector.  Returns the symbol newly
+   created, which the caller may fill in further; the pointer is only
+   good until the next minimal symbol is recorded.  */
 
 struct minimal_symbol *
 prim_record_minimal_symbol_and_info (const char *name, CORE_ADDR address,
@@ -808,7 +793,6 @@ prim_record_minimal_symbol_and_info (const char *name, CORE_ADDR address,
 				     asection *bfd_section,
 				     struct objfile *objfile)
 {
-  struct msym_bunch *new;
   struct minimal_symbol *msymbol;
 
   /* APPLE LOCAL: Re-factor the mst_file_text check up one level.
@@ -838,14 +822,17 @@ prim_record_minimal_symbol_and_info (const char *name, CORE_ADDR address,
  
   /* END APPLE LOCAL */
 
-  if (msym_bunch_index == BUNCH_SIZE)
+  if (msym_count == msym_vector_size)
     {
-      new = (struct msym_bunch *) xmalloc (sizeof (struct msym_bunch));
-      msym_bunch_index = 0;
-      new->next = msym_bunch;
-      msym_bunch = new;
+      if (msym_vector_size == 0)
+	msym_vector_size = MSYM_VECTOR_INITIAL_SIZE;
+      else
+	msym_vector_size *= 2;
+      msym_vector = (struct minimal_symbol *)
+	xrealloc (msym_vector,
+		  msym_vector_size * sizeof (struct minimal_symbol));
     }
-  msymbol = &msym_bunch->contents[msym_bunch_index];
+  msymbol = &msym_vector[msym_count];
 /* APPLE LOCAL: Initialize the msymbol->filename to NULL.  */
 #if defined(SOFUN_ADDRESS_MAYBE_MISSING) && !defined(TM_NEXTSTEP)
   msymbol->filename = NULL;
@@ -870,7 +857,6 @@ prim_record_minimal_symbol_and_info (const char *name, CORE_ADDR address,
   msymbol->hash_next = NULL;
   msymbol->demangled_hash_next = NULL;
 
-  msym_bunch_index++;
   msym_count++;
   OBJSTAT (objfile, n_minsyms++);
 
@@ -915,27 +901,112 @@ compare_minimal_symbols (const void *fn1p, const void *fn2p)
     }
 }
 
-/* Discard the currently collected minimal symbols, if any.  If we wish
-   to save them for later use, we must have already copied them somewhere
-   else before calling this function.
+/* APPLE LOCAL: The same, for pointers to minimal symbols.  */
 
-   FIXME:  We could allocate the minimal symbol bunches on their own
-   obstack and then simply blow the obstack away when we are done with
-   it.  Is it worth the extra trouble though? */
+static int
+compare_minimal_symbol_ptrs (const void *fn1p, const void *fn2p)
+{
+  return compare_minimal_symbols (*(struct minimal_symbol * const *) fn1p,
+				  *(struct minimal_symbol * const *) fn2p);
+}
+
+/* APPLE LOCAL: Sort the COUNT minimal symbols pointed to by SYMS into
+   the order compare_minimal_symbols defines.  KEYS holds their
+   addresses, and is sorted along with them.
+
+   The addresses are sorted with a least-significant-byte-first radix
+   sort, which unlike qsort takes time linear in COUNT, and we move
+   only pointers rather than whole symbols.  Passes for bytes that all
+   the addresses share, such as the high bytes of 64-bit addresses,
+   are skipped.  The radix sort is stable, so only the runs of symbols
+   at the same address are left to sort by name.  */
 
 static void
-do_discard_minimal_symbols_cleanup (void *arg)
+sort_minimal_symbol_ptrs (struct minimal_symbol **syms, CORE_ADDR *keys,
+			  int count)
 {
-  struct msym_bunch *next;
+  unsigned int counts[sizeof (CORE_ADDR)][256];
+  struct minimal_symbol **tmp_syms, **from_syms, **to_syms, **swap_syms;
+  CORE_ADDR *tmp_keys, *from_keys, *to_keys, *swap_keys;
+  int byte, i, start;
+
+  if (count < 2)
+    return;
+
+  memset (counts, 0, sizeof (counts));
+  for (i = 0; i < count; i++)
+    for (byte = 0; byte < sizeof (CORE_ADDR); byte++)
+      counts[byte][(keys[i] >> (8 * byte)) & 0xff]++;
+
+  tmp_syms = (struct minimal_symbol **)
+    xmalloc (count * sizeof (struct minimal_symbol *));
+  tmp_keys = (CORE_ADDR *) xmalloc (count * sizeof (CORE_ADDR));
+  from_syms = syms;
+  from_keys = keys;
+  to_syms = tmp_syms;
+  to_keys = tmp_keys;
+
+  for (byte = 0; byte < sizeof (CORE_ADDR); byte++)
+    {
+      unsigned int pos[256];
+      unsigned int total = 0;
+      int digit;
+
+      if (counts[byte][(keys[0] >> (8 * byte)) & 0xff] == count)
+	continue;
+
+      for (digit = 0; digit < 256; digit++)
+	{
+	  pos[digit] = total;
+	  total += counts[byte][digit];
+	}
+
+      for (i = 0; i < count; i++)
+	{
+	  unsigned int p = pos[(from_keys[i] >> (8 * byte)) & 0xff]++;
+
+	  to_syms[p] = from_syms[i];
+	  to_keys[p] = from_keys[i];
+	}
+
+      swap_syms = from_syms;
+      from_syms = to_syms;
+      to_syms = swap_syms;
+      swap_keys = from_keys;
+      from_keys = to_keys;
+      to_keys = swap_keys;
+    }
+
+  if (from_syms != syms)
+    {
+      memcpy (syms, from_syms, count * sizeof (struct minimal_symbol *));
+      memcpy (keys, from_keys, count * sizeof (CORE_ADDR));
+    }
+  xfree (tmp_syms);
+  xfree (tmp_keys);
 
-  while (msym_bunch != NULL)
+  for (start = 0; start < count; start = i)
     {
-      next = msym_bunch->next;
-      xfree (msym_bunch);
-      msym_bunch = next;
+      for (i = start + 1; i < count && keys[i] == keys[start]; i++)
+	;
+      if (i - start > 1)
+	qsort (syms + start, i - start, sizeof (struct minimal_symbol *),
+	       compare_minimal_symbol_ptrs);
     }
 }
 
+/* Discard the currently collected minimal symbols, if any.  If we wish
+   to save them for later use, we must have already copied them somewhere
+   else before calling this function.  */
+
+static void
+do_discard_minimal_symbols_cleanup (void *arg)
+{
+  xfree (msym_vector);
+  msym_vector = NULL;
+  msym_vector_size = 0;
+}
+
 struct cleanup *
 make_cleanup_discard_minimal_symbols (void)
 {
@@ -944,12 +1015,10 @@ make_cleanup_discard_minimal_symbols (void)
 
 
 
-/* Compact duplicate entries out of a minimal symbol table by walking
-   through the table and compacting out entries with duplicate addresses
-   and matching names.  Return the number of entries remaining.
-
-   On entry, the table resides between msymbol[0] and msymbol[mcount].
-   On exit, it resides between msymbol[0] and msymbol[result_count].
+/* Copy the COUNT minimal symbols pointed to by SYMS, which are sorted
+   by address, to MSYMBOLS, compacting out entries with duplicate
+   addresses and matching names as we go.  Return the number of
+   entries copied.
 
    When files contain multiple sources of symbol information, it is
    possible for the minimal symbol table to contain many duplicate entries.
@@ -967,50 +1036,79 @@ make_cleanup_discard_minimal_symbols (void)
 
    Note that we are not concerned here about recovering the space that
    is potentially freed up, because the strings themselves are allocated
-
    on the objfile_obstack, and will get automatically freed when the symbol
    table is freed.  The caller can free up the unused minimal symbols at
    the end of the compacted region if their allocation strategy allows it.
 
-   Also note we only go up to the next to last entry within the loop
-   and then copy the last entry explicitly after the loop terminates.
-
    Since the different sources of information for each symbol may
    have different levels of "completeness", we may have duplicates
    that have one entry with type "mst_unknown" and the other with a
-   known type.  So if the one we are leaving alone has type mst_unknown,
-   overwrite its type with the type from the one we are compacting out.  */
+   known type.  Of each run of duplicates we keep the last one, and if
+   it has type mst_unknown, give it the type of the one before it.  */
 
 static int
-compact_minimal_symbols (struct minimal_symbol *msymbol, int mcount,
-			 struct objfile *objfile)
+compact_minimal_symbols (struct minimal_symbol *msymbols,
+			 struct minimal_symbol **syms, int count)
 {
-  struct minimal_symbol *copyfrom;
-  struct minimal_symbol *copyto;
+  int mcount = 0;
+  int i;
 
-  if (mcount > 0)
+  for (i = 0; i < count; i++)
     {
-      copyfrom = copyto = msymbol;
-      while (copyfrom < msymbol + mcount - 1)
+      struct minimal_symbol *prev = mcount > 0 ? &msymbols[mcount - 1] : NULL;
+
+      if (prev != NULL
+	  && SYMBOL_VALUE_ADDRESS (prev) == SYMBOL_VALUE_ADDRESS (syms[i])
+	  && strcmp (SYMBOL_LINKAGE_NAME (prev),
+		     SYMBOL_LINKAGE_NAME (syms[i])) == 0)
 	{
-	  if (SYMBOL_VALUE_ADDRESS (copyfrom)
-	      == SYMBOL_VALUE_ADDRESS ((copyfrom + 1))
-	      && strcmp (SYMBOL_LINKAGE_NAME (copyfrom),
-			 SYMBOL_LINKAGE_NAME ((copyfrom + 1))) == 0)
-	    {
-	      if (MSYMBOL_TYPE ((copyfrom + 1)) == mst_unknown)
-		{
-		  MSYMBOL_TYPE ((copyfrom + 1)) = MSYMBOL_TYPE (copyfrom);
-		}
-	      copyfrom++;
-	    }
-	  else
-	    *copyto++ = *copyfrom++;
+	  enum minimal_symbol_type type = MSYMBOL_TYPE (prev);
+
+	  *prev = *syms[i];
+	  if (MSYMBOL_TYPE (prev) == mst_unknown)
+	    MSYMBOL_TYPE (prev) = type;
 	}
-      *copyto++ = *copyfrom++;
-      mcount = copyto - msymbol;
+      else
+	msymbols[mcount++] = *syms[i];
     }
-  return (mcount);
+
+  return mcount;
+}
+
+/* APPLE LOCAL: Build the table of minimal symbol addresses that
+   lookup_minimal_symbol_by_pc_section_from_objfile bisects.  This is
+   necessary whenever the minimal symbols are sorted or moved, which
+   can happen many times over an objfile's life (every relocation
+   sorts them again), so the table lives in the heap and is reused
+   rather than left behind on the objfile_obstack each time.  */
+
+static void
+build_minimal_symbol_address_table (struct objfile *objfile)
+{
+  int count = objfile->minimal_symbol_count;
+  int i;
+
+  if (objfile->msymbol_addresses == NULL
+      || objfile->msymbol_addresses_size < count + 1)
+    {
+      objfile->msymbol_addresses_size = count + 1;
+      objfile->msymbol_addresses = (CORE_ADDR *)
+	xrealloc (objfile->msymbol_addresses,
+		  objfile->msymbol_addresses_size * sizeof (CORE_ADDR));
+    }
+  for (i = 0; i < count; i++)
+    objfile->msymbol_addresses[i]
+      = SYMBOL_VALUE_ADDRESS (&objfile->msymbols[i]);
+}
+
+/* APPLE LOCAL: Free OBJFILE's table of minimal symbol addresses.  */
+
+void
+free_minimal_symbol_address_table (struct objfile *objfile)
+{
+  xfree (objfile->msymbol_addresses);
+  objfile->msymbol_addresses = NULL;
+  objfile->msymbol_addresses_size = 0;
 }
 
 /* Build (or rebuild) the minimal symbol hash tables.  This is necessary
@@ -1021,7 +1119,10 @@ static void
 build_minimal_symbol_hash_tables (struct objfile *objfile)
 {
   int i;
+  int count = objfile->minimal_symbol_count;
   struct minimal_symbol *msym;
+  unsigned int *buckets;
+  unsigned int *demangled_buckets;
 
   /* Clear the hash tables. */
   for (i = 0; i < MINIMAL_SYMBOL_HASH_SIZE; i++)
@@ -1030,19 +1131,47 @@ build_minimal_symbol_hash_tables (struct objfile *objfile)
       objfile->msymbol_demangled_hash[i] = 0;
     }
 
-  /* Now, (re)insert the actual entries. */
-  for (i = objfile->minimal_symbol_count, msym = objfile->msymbols;
-       i > 0;
-       i--, msym++)
-    {
-      msym->hash_next = 0;
-      add_minsym_to_hash_table (msym, objfile->msymbol_hash);
+  if (count == 0)
+    return;
+
+  /* APPLE LOCAL: Work out every symbol's buckets first, then link the
+     symbols in.  Hashing the names is most of the work; doing it in
+     a pass of its own keeps that pass to reading one symbol at a time,
+     and the linking pass to a tight loop over the bucket numbers.  A
+     demangled bucket of MINIMAL_SYMBOL_HASH_SIZE means the symbol has
+     no demangled name.  */
+  buckets = (unsigned int *) xmalloc (2 * count * sizeof (unsigned int));
+  demangled_buckets = buckets + count;
 
-      msym->demangled_hash_next = 0;
+  for (i = 0, msym = objfile->msymbols; i < count; i++, msym++)
+    {
+      buckets[i]
+	= msymbol_hash (SYMBOL_LINKAGE_NAME (msym)) % MINIMAL_SYMBOL_HASH_SIZE;
       if (SYMBOL_SEARCH_NAME (msym) != SYMBOL_LINKAGE_NAME (msym))
-	add_minsym_to_demangled_hash_table (msym,
-                                            objfile->msymbol_demangled_hash);
+	demangled_buckets[i] = (msymbol_hash_iw (SYMBOL_DEMANGLED_NAME (msym))
+				% MINIMAL_SYMBOL_HASH_SIZE);
+      else
+	demangled_buckets[i] = MINIMAL_SYMBOL_HASH_SIZE;
+    }
+
+  /* Now, (re)insert the actual entries, in the same order
+     add_minsym_to_hash_table would.  */
+  for (i = 0, msym = objfile->msymbols; i < count; i++, msym++)
+    {
+      msym->hash_next = objfile->msymbol_hash[buckets[i]];
+      objfile->msymbol_hash[buckets[i]] = msym;
+
+      if (demangled_buckets[i] != MINIMAL_SYMBOL_HASH_SIZE)
+	{
+	  msym->demangled_hash_next
+	    = objfile->msymbol_demangled_hash[demangled_buckets[i]];
+	  objfile->msymbol_demangled_hash[demangled_buckets[i]] = msym;
+	}
+      else
+	msym->demangled_hash_next = 0;
     }
+
+  xfree (buckets);
 }
 
 /* Add the minimal symbols in the existing bunches to the objfile's official
@@ -1071,57 +1200,47 @@ build_minimal_symbol_hash_tables (struct objfile *objfile)
 void
 install_minimal_symbols (struct objfile *objfile)
 {
-  int bindex;
   int mcount;
-  int cur_bunch_index;
-  struct msym_bunch *bunch;
+  int old_count;
+  int i;
   struct minimal_symbol *msymbols;
+  struct minimal_symbol **syms;
+  CORE_ADDR *keys;
   int alloc_count;
 
   if (msym_count > 0)
     {
-      /* Allocate enough space in the obstack, into which we will gather the
-         bunches of new and existing minimal symbols, sort them, and then
-         compact out the duplicate entries.  Once we have a final table,
-         we will give back the excess space.  */
-
-      alloc_count = msym_count + objfile->minimal_symbol_count + 1;
+      /* APPLE LOCAL: Sort pointers to the existing and new minimal
+	 symbols by address, rather than the symbols themselves.  */
+
+      old_count = objfile->minimal_symbol_count;
+      mcount = old_count + msym_count;
+      syms = (struct minimal_symbol **)
+	xmalloc (mcount * sizeof (struct minimal_symbol *));
+      keys = (CORE_ADDR *) xmalloc (mcount * sizeof (CORE_ADDR));
+      for (i = 0; i < old_count; i++)
+	syms[i] = &objfile->msymbols[i];
+      for (i = 0; i < msym_count; i++)
+	syms[old_count + i] = &msym_vector[i];
+      for (i = 0; i < mcount; i++)
+	keys[i] = SYMBOL_VALUE_ADDRESS (syms[i]);
+
+      sort_minimal_symbol_ptrs (syms, keys, mcount);
+      xfree (keys);
+
+      /* Allocate enough space in the obstack, into which we will copy
+         the sorted symbols, compacting out the duplicate entries.
+         Once we have a final table, we will give back the excess
+         space.  */
+
+      alloc_count = mcount + 1;
       obstack_blank (&objfile->objfile_obstack,
 		     alloc_count * sizeof (struct minimal_symbol));
       msymbols = (struct minimal_symbol *)
 	obstack_base (&objfile->objfile_obstack);
 
-      /* Copy in the existing minimal symbols, if there are any.  */
-
-      if (objfile->minimal_symbol_count)
-	memcpy ((char *) msymbols, (char *) objfile->msymbols,
-	    objfile->minimal_symbol_count * sizeof (struct minimal_symbol));
-
-      /* Walk through the list of minimal symbol bunches, adding each symbol
-         to the new contiguous array of symbols.  Note that we start with the
-         current, possibly partially filled bunch (thus we use the current
-         msym_bunch_index for the first bunch we copy over), and thereafter
-         each bunch is full. */
-
-      mcount = objfile->minimal_symbol_count;
-
-      cur_bunch_index = msym_bunch_index;
-      for (bunch = msym_bunch; bunch != NULL; bunch = bunch->next)
-	{
-	  for (bindex = 0; bindex < cur_bunch_index; bindex++, mcount++)
-	      msymbols[mcount] = bunch->contents[bindex];
-	  cur_bunch_index = BUNCH_SIZE;
-	}
-
-      /* Sort the minimal symbols by address.  */
-
-      qsort (msymbols, mcount, sizeof (struct minimal_symbol),
-	     compare_minimal_symbols);
-
-      /* Compact out any duplicates, and free up whatever space we are
-         no longer using.  */
-
-      mcount = compact_minimal_symbols (msymbols, mcount, objfile);
+      mcount = compact_minimal_symbols (msymbols, syms, mcount);
+      xfree (syms);
 
       obstack_blank (&objfile->objfile_obstack,
 	       (mcount + 1 - alloc_count) * sizeof (struct minimal_symbol));
@@ -1151,6 +1270,8 @@ install_minimal_symbols (struct objfile *objfile)
 
       objfile->minimal_symbol_count = mcount;
       objfile->msymbols = msymbols;
+      /* APPLE LOCAL minsym address table  */
+      build_minimal_symbol_address_table (objfile);
 
       /* Try to guess the appropriate C++ ABI by looking at the names 
 	 of the minimal symbols in the table.  */
@@ -1194,6 +1315,8 @@ msymbols_sort (struct objfile *objfile)
 {
   qsort (objfile->msymbols, objfile->minimal_symbol_count,
 	 sizeof (struct minimal_symbol), compare_minimal_symbols);
+  /* APPLE LOCAL minsym address table  */
+  build_minimal_symbol_address_table (objfile);
   build_minimal_symbol_hash_tables (objfile);
   /* APPLE LOCAL: sorting the msymbols shuffles them around so that
      the pointers inthe equivalence table are no longer valid.  So
@@ -51,9 +51,14 @@
 #include "macosx-nat-inferior.h"  // need to pick up macho_calculate_offsets_for_dsym() in machoread.c
 
 #include "db-access-functions.h"
+/* APPLE LOCAL begin background symbol loading  */
+#include "inferior.h"
+#include "event-loop.h"
+#include "observer.h"
+#include "exceptions.h"
+/* APPLE LOCAL end background symbol loading  */
 
 #ifdef MACOSX_DYLD
-#include "inferior.h"
 #include "macosx-nat-dyld.h"
 #include "mach-o.h"
 #endif
@@ -62,6 +67,8 @@
 
 static void objfile_alloc_data (struct objfile *objfile);
 static void objfile_free_data (struct objfile *objfile);
+/* APPLE LOCAL background symbol loading  */
+static void background_load_dequeue (struct objfile *, int);
 
 struct objfile *create_objfile (bfd *abfd);
 /* APPLE LOCAL: in place objfile rebuilding.  */
@@ -92,6 +99,8 @@ extern struct cmd_list_element *shliblist;
 
 struct objfile *object_files;	/* Linked list of all objfiles */
 struct objfile *current_objfile;	/* For symbol file being read in */
+/* APPLE LOCAL cache lookup values for improved performance  */
+unsigned int objfile_generation = 1;
 struct objfile *symfile_objfile;	/* Main symbol table loaded from */
 struct objfile *rt_common_objfile;	/* For runtime common symbols */
 
@@ -106,16 +115,25 @@ struct objfile *rt_common_objfile;	/* For runtime common symbols */
 /* APPLE LOCAL - with the advent of ZeroLink, it is not uncommon for Mac OS X 
    applications to consist of 500+ shared libraries.  At that point searching
    linearly for address->obj_section becomes very costly, and it is a common
-   operation.  So we maintain an ordered array of obj_sections, and use that
-   to do a binary search for the matching section. 
-
-   N.B. We could just use an array of pointers to the obj_section
-   instead of this struct, but this way the malloc'ed array contains
-   all the elements we need to do the pc->obj_section lookup, so we
-   can do the search only touching a couple of pages of memory, rather
-   than wandering all over the heap.  
-
-   FIXME: We really should merge this array with the to_sections array in
+   operation.  So we maintain a search tree of obj_sections ordered by
+   address, and use that to find the matching section.
+
+   The tree is a treap: a binary search tree on the start address that
+   is also a heap on a pseudo-random priority, which keeps it balanced
+   on average in whatever order the sections arrive.  Each node also
+   records the largest end address in its subtree, so a lookup can
+   skip any subtree that ends below the address it is looking for,
+   even though sections may overlap.  Adding, removing and looking up
+   a section are all O(log n), so loading or unloading a library no
+   longer costs time proportional to the number of sections that are
+   already loaded, the way shifting a sorted array did.
+
+   N.B. The nodes hold copies of the addresses, rather than pointing
+   at the obj_section for them, so the search only touches the nodes
+   and doesn't wander all over the heap.  The nodes are carved out of
+   blocks of ORDERED_SECTIONS_CHUNK_SIZE to keep them close together.
+
+   FIXME: We really should merge this tree with the to_sections array in
    the target, but that doesn't have back-pointers to the obj_section.  I
    am not sure how hard it would be to get that working.  This is simpler 
    for now.  */
@@ -126,34 +144,39 @@ struct ordered_obj_section
   struct bfd_section *the_bfd_section;
   CORE_ADDR addr;
   CORE_ADDR endaddr;
+
+  /* The largest ENDADDR in the subtree rooted at this node.  */
+  CORE_ADDR max_endaddr;
+
+  /* No node has a higher priority than its parent.  */
+  unsigned int priority;
+
+  struct ordered_obj_section *left;
+  struct ordered_obj_section *right;
 };
 
-/* This is the table of ordered_sections.  It is malloc'ed to
-   ORDERED_SECTIONS_CHUNK_SIZE originally, and then realloc'ed if we
-   get more sections. */
+/* This is the root of the tree of ordered_sections.  */
 
 static struct ordered_obj_section *ordered_sections;
 
-/* This is the number of entries currently in the ordered_sections table.  */
+/* This is the number of entries currently in the ordered_sections tree.  */
 static int num_ordered_sections = 0;
 
+/* The ordered_sections nodes, hashed by obj_section, so we can find
+   the node to remove even if the obj_section has moved since it was
+   added.  */
+
+static htab_t ordered_sections_index;
+
 #define ORDERED_SECTIONS_CHUNK_SIZE 3000
 
-static int max_num_ordered_sections = ORDERED_SECTIONS_CHUNK_SIZE;
+/* Unused nodes, chained through their RIGHT fields.  */
 
-static int find_in_ordered_sections_index (CORE_ADDR addr, struct bfd_section *bfd_section);
-static int get_insert_index_in_ordered_sections (struct obj_section *section);
+static struct ordered_obj_section *free_ordered_sections;
 
-/* When we want to add a bunch of obj_sections at a time, we will
-   find all the insert points, make an array of type OJB_SECTION_WITH_INDEX
-   sort that in reverse order, then sweep the ordered_sections list
-   shifting and adding them all.  */
+/* The seed for the node priorities.  */
 
-struct obj_section_with_index
-{
-  int index;
-  struct obj_section *section;
-};
+static unsigned int ordered_sections_seed = 1;
 
 #if 0 /* APPLE LOCAL unused */
 /* Called via bfd_map_over_sections to build up the section table that
@@ -345,6 +368,9 @@ allocate_objfile_internal (struct objfile *objfile,
 
   objfile->not_loaded_kext_filename = NULL;
   
+  /* APPLE LOCAL cache lookup values for improved performance  */
+  objfile_generation++;
+
   return (objfile);
 }
 
@@ -412,211 +438,267 @@ create_objfile_using_objfile (struct objfile *objfile, bfd *abfd)
   return objfile;
 }
 
-/* This is the quicksort compare routine for OBJ_SECTION_WITH_INDEX
-   objects.  It sorts by section start address in decreasing 
-   order.  */
+/* APPLE LOCAL: Oh, hacky, hacky...  The bfd Mach-O reader makes
+   bfd_sections for both the sections & segments (the container of
+   the sections).  This would make pc->bfd_section lookup non-unique.
+   so we just drop the segments from our list.  Return non-zero if S
+   belongs in the ordered_sections tree.  */
 
 static int
-backward_section_compare (const void *left_ptr, 
-		 const void *right_ptr)
+ordered_section_p (struct obj_section *s)
 {
-  
-  struct obj_section_with_index *left 
-    = (struct obj_section_with_index *) left_ptr;
-  struct obj_section_with_index * right 
-    = (struct obj_section_with_index *) right_ptr;
-
-  if (left->section->addr > right->section->addr)
-    return -1;
-  else if (left->section->addr < right->section->addr)
-    return 1;
-  else
-      return 0;
+  return !(s->the_bfd_section && s->the_bfd_section->segment_mark == 1);
 }
 
-/* Simple integer compare for quicksort */
+/* Hash and equality functions for ordered_sections_index.  Entries
+   are nodes, and the key is the obj_section.  */
 
-static int
-forward_int_compare (const void *left_ptr, 
-		 const void *right_ptr)
+static hashval_t
+ordered_section_hash (const void *p)
 {
-  int *left = (int *) left_ptr;
-  int *right = (int *) right_ptr;
+  const struct ordered_obj_section *node = p;
 
-  if (*left < *right)
-    return -1;
-  else if (*left > *right)
-    return 1;
-  else
-      return 0;
+  return htab_hash_pointer (node->obj_section);
 }
 
-/* APPLE LOCAL: The difference between the segment names and the section
-   names is the segment names always only have one dot.  Use this to count
-   the dots quickly...  */
 static int
-number_of_dots (const char *s)
+ordered_section_eq (const void *p, const void *key)
 {
-  int numdots = 0;
-  while (*s != '\0')
+  const struct ordered_obj_section *node = p;
+
+  return node->obj_section == key;
+}
+
+/* Return the ordered_sections_index slot for S.  */
+
+static void **
+ordered_section_slot (struct obj_section *s, enum insert_option insert)
+{
+  if (ordered_sections_index == NULL)
+    ordered_sections_index = htab_create_alloc (ORDERED_SECTIONS_CHUNK_SIZE,
+						ordered_section_hash,
+						ordered_section_eq,
+						NULL, xcalloc, xfree);
+
+  return htab_find_slot_with_hash (ordered_sections_index, s,
+				   htab_hash_pointer (s), insert);
+}
+
+/* Get a new node for S.  */
+
+static struct ordered_obj_section *
+alloc_ordered_section (struct obj_section *s)
+{
+  struct ordered_obj_section *node;
+
+  if (free_ordered_sections == NULL)
     {
-      if (*s == '.')
-	numdots++;
-      s++;
+      int i;
+
+      node = (struct ordered_obj_section *)
+	xmalloc (ORDERED_SECTIONS_CHUNK_SIZE
+		 * sizeof (struct ordered_obj_section));
+      for (i = 0; i < ORDERED_SECTIONS_CHUNK_SIZE; i++)
+	{
+	  node[i].right = free_ordered_sections;
+	  free_ordered_sections = &node[i];
+	}
     }
-  return numdots;
+
+  node = free_ordered_sections;
+  free_ordered_sections = node->right;
+
+  /* A linear congruential generator is plenty random enough for
+     this.  */
+  ordered_sections_seed = ordered_sections_seed * 1664525 + 1013904223;
+
+  node->obj_section = s;
+  node->the_bfd_section = s->the_bfd_section;
+  node->addr = s->addr;
+  node->endaddr = s->endaddr;
+  node->max_endaddr = s->endaddr;
+  node->priority = ordered_sections_seed;
+  node->left = NULL;
+  node->right = NULL;
+
+  return node;
 }
 
-/* Delete all the obj_sections in OBJFILE from the ordered_sections
-   global list.  N.B. this routine uses the addresses in the sections
-   in the objfile to find the entries in the ordered_sections list, 
-   so if you are going to relocate the obj_sections in an objfile,
-   call this BEFORE you relocate, then relocate, then call 
-   objfile_add_to_ordered_sections.  */
+static void
+free_ordered_section (struct ordered_obj_section *node)
+{
+  node->right = free_ordered_sections;
+  free_ordered_sections = node;
+}
 
-#define STATIC_DELETE_LIST_SIZE 256
+/* Recompute NODE's max_endaddr from its own and its children's.  */
 
-void 
-objfile_delete_from_ordered_sections (struct objfile *objfile)
+static void
+update_ordered_section (struct ordered_obj_section *node)
 {
-  int i;
-  int ndeleted;
-  int delete_list_size;
-  int static_delete_list[STATIC_DELETE_LIST_SIZE];
-  int *delete_list = static_delete_list;
-  
-  struct obj_section *s;
-  
-  /* APPLE LOCAL: we need to check if this is a separate debug files and try to 
-     remove the sections to the ordered list if so. The backlink will not be
-     setup when the separate debug objfile is in the process of being created, 
-     so a flag was added to make sure we can tell.  */
-  if (objfile->separate_debug_objfile_backlink || 
-      objfile->flags & OBJF_SEPARATE_DEBUG_FILE)
-	return;	
+  node->max_endaddr = node->endaddr;
+  if (node->left != NULL && node->left->max_endaddr > node->max_endaddr)
+    node->max_endaddr = node->left->max_endaddr;
+  if (node->right != NULL && node->right->max_endaddr > node->max_endaddr)
+    node->max_endaddr = node->right->max_endaddr;
+}
 
-  /* Do deletion of the sections by building up an array of
-     "to be removed" indices, and then block compact the array using
-     these indices.  */
-  
-  delete_list_size = objfile->sections_end - objfile->sections;
-  if (delete_list_size > STATIC_DELETE_LIST_SIZE)
-    delete_list = (int *) xmalloc (delete_list_size * sizeof (int));
+/* Return non-zero if the entry for the obj_section S at ADDR sorts
+   before NODE.  Sections are ordered by start address, and sections
+   that start at the same address by obj_section, so that every entry
+   has a distinct place in the tree.  */
 
-  ndeleted = 0;
+static int
+ordered_section_before (CORE_ADDR addr, struct obj_section *s,
+			struct ordered_obj_section *node)
+{
+  if (addr != node->addr)
+    return addr < node->addr;
+  return (unsigned long) s < (unsigned long) node->obj_section;
+}
 
-  ALL_OBJFILE_OSECTIONS (objfile, s)
-    {
-      int index;
-      /* APPLE LOCAL: Oh, hacky, hacky...  The bfd Mach-O reader makes
-         bfd_sections for both the sections & segments (the container of
-         the sections).  This would make pc->bfd_section lookup non-unique.
-         so we just drop the segments from our list.  */
-      if (s->the_bfd_section && s->the_bfd_section->name &&
-          number_of_dots (s->the_bfd_section->name) == 1)
-        continue;
+/* Insert NODE into the subtree ROOT, and return the new root of the
+   subtree.  */
 
-      index = find_in_ordered_sections_index (s->addr, s->the_bfd_section);
-      if (index == -1)
-	warning ("Trying to remove a section from"
-			" the ordered section list that did not exist"
-			" at 0x%s.", paddr_nz (s->addr));
-      else
+static struct ordered_obj_section *
+ordered_section_insert (struct ordered_obj_section *root,
+			struct ordered_obj_section *node)
+{
+  struct ordered_obj_section *child;
+
+  if (root == NULL)
+    return node;
+
+  if (ordered_section_before (node->addr, node->obj_section, root))
+    {
+      root->left = ordered_section_insert (root->left, node);
+      if (root->left->priority > root->priority)
 	{
-	  delete_list[ndeleted] = index;
-	  ndeleted++;
+	  /* Rotate right.  */
+	  child = root->left;
+	  root->left = child->right;
+	  update_ordered_section (root);
+	  child->right = root;
+	  root = child;
 	}
     }
-  qsort (delete_list, ndeleted, sizeof (int),
-	 forward_int_compare);
+  else
+    {
+      root->right = ordered_section_insert (root->right, node);
+      if (root->right->priority > root->priority)
+	{
+	  /* Rotate left.  */
+	  child = root->right;
+	  root->right = child->left;
+	  update_ordered_section (root);
+	  child->left = root;
+	  root = child;
+	}
+    }
+
+  update_ordered_section (root);
+  return root;
+}
 
-  /* Stick a boundary on the end of the delete list - it makes the block
-     shuffle algorithm easier.  I also have to set the boundary to one
-     past the list end because it is supposed to be the next element
-     deleted, and I don't want to delete the last element.  */
+/* Join the subtrees LEFT and RIGHT, where everything in LEFT sorts
+   before everything in RIGHT, and return the root of the result.  */
 
-  delete_list[ndeleted] = num_ordered_sections;
+static struct ordered_obj_section *
+ordered_section_join (struct ordered_obj_section *left,
+		      struct ordered_obj_section *right)
+{
+  if (left == NULL)
+    return right;
+  if (right == NULL)
+    return left;
 
-  for (i = 0; i < ndeleted; i++)
+  if (left->priority > right->priority)
+    {
+      left->right = ordered_section_join (left->right, right);
+      update_ordered_section (left);
+      return left;
+    }
+  else
     {
-      struct ordered_obj_section *src, *dest;
-      size_t len;
+      right->left = ordered_section_join (left, right->left);
+      update_ordered_section (right);
+      return right;
+    }
+}
 
-      src = &(ordered_sections[delete_list[i] + 1]);
-      dest = &(ordered_sections[delete_list[i] - i]);
-      len = (delete_list[i+1] - delete_list[i] - 1)
-	* sizeof (struct ordered_obj_section);
+/* Remove NODE from the subtree ROOT, and return the new root of the
+   subtree.  */
 
-      bcopy (src, dest, len);
-    }
+static struct ordered_obj_section *
+ordered_section_remove (struct ordered_obj_section *root,
+			struct ordered_obj_section *node)
+{
+  if (root == NULL)
+    return NULL;
 
-  
-  num_ordered_sections -= ndeleted;
-  if (delete_list != static_delete_list)
-    xfree (delete_list);
+  if (root == node)
+    return ordered_section_join (node->left, node->right);
+
+  if (ordered_section_before (node->addr, node->obj_section, root))
+    root->left = ordered_section_remove (root->left, node);
+  else
+    root->right = ordered_section_remove (root->right, node);
+
+  update_ordered_section (root);
+  return root;
 }
 
-/* This returns the index before which the obj_section SECTION
-   should be added in the ordered_sections list.  This only sorts
-   by addr, and pays no attention to endaddr, or the_bfd_section.  */
+/* Delete all the obj_sections in OBJFILE from the ordered_sections
+   global tree.  */
 
-static int
-get_insert_index_in_ordered_sections (struct obj_section *section)
+void 
+objfile_delete_from_ordered_sections (struct objfile *objfile)
 {
-  int insert = -1;
+  struct obj_section *s;
+  
+  /* APPLE LOCAL: we need to check if this is a separate debug files and try to 
+     remove the sections to the ordered list if so. The backlink will not be
+     setup when the separate debug objfile is in the process of being created, 
+     so a flag was added to make sure we can tell.  */
+  if (objfile->separate_debug_objfile_backlink || 
+      objfile->flags & OBJF_SEPARATE_DEBUG_FILE)
+	return;	
 
-  if (num_ordered_sections > 0)
+  ALL_OBJFILE_OSECTIONS (objfile, s)
     {
-      int bot = 0;
-      int top = num_ordered_sections - 1;
+      struct ordered_obj_section *node;
+      void **slot;
 
-      do
+      if (!ordered_section_p (s))
+        continue;
+
+      slot = ordered_section_slot (s, NO_INSERT);
+      if (slot == NULL)
 	{
-	  int mid = (top + bot) / 2;
+	  warning ("Trying to remove a section from"
+		   " the ordered section list that did not exist"
+		   " at 0x%s.", paddr_nz (s->addr));
+	  continue;
+	}
 
-	  if (ordered_sections[mid].addr < section->addr)
-	    {
-	      if ((mid == num_ordered_sections - 1) 
-		  || (ordered_sections[mid + 1].addr >= section->addr))
-		{
-		  insert = mid;
-		  break;
-		}
-	      else if (mid + 1 == num_ordered_sections - 1)
-		{
-		  insert = mid + 1;
-		  break;
-		}
-	      bot = mid + 1;
-	    }
-	  else
-	    {
-	      if (mid == 0 || ordered_sections[mid - 1].addr <= section->addr)
-		{
-		  insert = mid - 1;
-		  break;
-		}
-	      top = mid - 1;
-	    }
-	} while (top > bot);
+      node = *slot;
+      htab_clear_slot (ordered_sections_index, slot);
+      ordered_sections = ordered_section_remove (ordered_sections, node);
+      free_ordered_section (node);
+      num_ordered_sections--;
     }
-
-  return insert + 1;
 }
 
 /* This adds all the obj_sections for OBJFILE to the ordered_sections
-   array */
-
-#define STATIC_INSERT_LIST_SIZE 256
+   tree.  N.B. the entries record the addresses the sections have now,
+   so if you are going to relocate the obj_sections in an objfile,
+   call objfile_delete_from_ordered_sections before you relocate, then
+   relocate, then call this.  */
 
 void
 objfile_add_to_ordered_sections (struct objfile *objfile)
 {
   struct obj_section *s;
-  int i, num_left, total;
-  struct obj_section_with_index static_insert_list[STATIC_INSERT_LIST_SIZE];
-  struct obj_section_with_index *insert_list = static_insert_list;
-  int insert_list_size;
 
   /* APPLE LOCAL: we need to check if this is a separate debug files and not 
      add the sections to the ordered list if so. The backlink will not be setup
@@ -628,183 +710,84 @@ objfile_add_to_ordered_sections (struct objfile *objfile)
 	
   CHECK_FATAL (objfile != NULL);
 
-  /* First find the index for insertion of all the sections in
-     this objfile.  The sort that array in reverse order by address,
-     then go through the ordered list block moving the bits between
-     the insert points, then adding the pieces we need to add.  */
-
-  insert_list_size = objfile->sections_end - objfile->sections;
-  if (insert_list_size > STATIC_INSERT_LIST_SIZE)
-    insert_list = (struct obj_section_with_index *) 
-      xmalloc (insert_list_size * sizeof (struct obj_section_with_index));
-
-  total = 0;
   ALL_OBJFILE_OSECTIONS (objfile, s)
     {
-      /* APPLE LOCAL: Oh, hacky, hacky...  The bfd Mach-O reader makes
-         bfd_sections for both the sections & segments (the container of
-         the sections).  This would make pc->bfd_section lookup non-unique.
-         so we just drop the segments from our list.  */
-      if (s->the_bfd_section && s->the_bfd_section->segment_mark == 1)
-        continue;
-
-      insert_list[total].index = get_insert_index_in_ordered_sections (s);
-      insert_list[total].section = s;
-      total++;
-    }
-
-  qsort (insert_list, total, sizeof (struct obj_section_with_index), 
-	 backward_section_compare);
-
-  /* Grow the array if needed */
-
-  if (ordered_sections == NULL)
-    {
-      max_num_ordered_sections = ORDERED_SECTIONS_CHUNK_SIZE;
-      ordered_sections = (struct ordered_obj_section *)
-	xmalloc (max_num_ordered_sections 
-		 * sizeof (struct ordered_obj_section));
-    }
-  else if (num_ordered_sections + total >= max_num_ordered_sections)
-    {
-      /* TOTAL should be small, but on the off chance that it is not, 
-	 just add it to the allocation as well.  */
-      max_num_ordered_sections += ORDERED_SECTIONS_CHUNK_SIZE + total;
-      ordered_sections = (struct ordered_obj_section *) 
-	xrealloc (ordered_sections, 
-		  max_num_ordered_sections 
-		  * sizeof (struct ordered_obj_section));
-    }
-  
-  num_left = total;
-
-  for (i = 0; i < total; i++)
-    {
-      struct ordered_obj_section *src;
-      struct ordered_obj_section *dest;
-      struct obj_section *s;
-      size_t len;
-      int pos;
+      struct ordered_obj_section *node;
+      void **slot;
 
-      src = &(ordered_sections[insert_list[i].index]);
-      dest = &(ordered_sections[insert_list[i].index + num_left]);
-
-      if (i == 0)
-	len = num_ordered_sections - insert_list[i].index;
-      else
-	len = insert_list[i - 1].index - insert_list[i].index;
-      len *= sizeof (struct ordered_obj_section);
-      bcopy (src, dest, len);
+      if (!ordered_section_p (s))
+        continue;
 
-      /* Now put the new element in place */
-      s = insert_list[i].section;
-      pos = insert_list[i].index + num_left - 1;
-      ordered_sections[pos].addr = s->addr;
-      ordered_sections[pos].endaddr = s->endaddr;
-      ordered_sections[pos].obj_section = s;
-      ordered_sections[pos].the_bfd_section = s->the_bfd_section;
+      /* If S is already in the tree, replace its entry.  */
+      slot = ordered_section_slot (s, INSERT);
+      if (*slot != NULL)
+	{
+	  ordered_sections = ordered_section_remove (ordered_sections, *slot);
+	  free_ordered_section (*slot);
+	  num_ordered_sections--;
+	}
 
-      num_left--;
-      if (num_left == 0)
-	break;
+      node = alloc_ordered_section (s);
+      *slot = node;
+      ordered_sections = ordered_section_insert (ordered_sections, node);
+      num_ordered_sections++;
     }
-
-  num_ordered_sections += total;
-  if (insert_list != static_insert_list)
-    xfree (insert_list);
-
 }
 
-/* This returns the index in the ordered_sections array corresponding
-   to the pair ADDR, BFD_SECTION (can be null), or -1 if not found. */
+/* Return the entry in the subtree ROOT that contains ADDR, and is for
+   BFD_SECTION if that is not NULL, or NULL if there isn't one.  It is
+   possible that the sections overlap.  This will happen in two cases
+   that I know of.  One is when you have not run the app yet, so that
+   a bunch of the sections are still mapped at 0, and haven't been
+   relocated yet.  The other is because on MacOS X we (I think
+   errantly) make sections both for the segment command, and for the
+   sections it contains.  If more than one entry matches, return the
+   one that starts last.  */
 
-static int
-find_in_ordered_sections_index (CORE_ADDR addr, struct bfd_section *bfd_section)
+static struct ordered_obj_section *
+ordered_section_lookup (struct ordered_obj_section *root, CORE_ADDR addr,
+			struct bfd_section *bfd_section)
 {
-  int bot = 0;
-  int top = num_ordered_sections;
-  struct ordered_obj_section *obj_sect_ptr;
-
-  if (num_ordered_sections == 0)
-    return -1;
-
-  do 
+  while (root != NULL && root->max_endaddr > addr)
     {
-      int mid = (top + bot) / 2;
+      struct ordered_obj_section *found;
 
-      obj_sect_ptr = &ordered_sections[mid]; 
-      if (obj_sect_ptr->addr <= addr)
+      if (root->addr > addr)
 	{
-	  if (addr < obj_sect_ptr->endaddr)
-	    {
-	      /* It is possible that the sections overlap.  This will
-		 happen in two cases that I know of.  One is when you
-		 have not run the app yet, so that a bunch of the
-		 sections are still mapped at 0, and haven't been.
-		 relocated yet.  The other is because on MacOS X we (I
-		 think errantly) make sections both for the segment
-		 command, and for the sections it contains.  In the former
-	         case, this becomes a linear search just like the original
-	         algorithm.  In the latter, we should find it in the
-	         near neighborhood pretty soon.  */
-
-	      if ((bfd_section == NULL )
-		  || (bfd_section == obj_sect_ptr->the_bfd_section))
-		return mid;
-	      else
-		{
-		  /* So to find the containing element, we can look
-		     to increasing indices, till the start address
-		     of our element is above the addr, but we have to go
-		     all the way to the left to find the address. */
-
-		  int pos;
-		  for (pos = mid + 1; pos < num_ordered_sections; pos++)
-		    {
-		      if (ordered_sections[pos].addr > addr)
-			break;
-		      else if ((ordered_sections[pos].endaddr > addr)
-			       && (ordered_sections[pos].the_bfd_section == bfd_section))
-			return pos;
-		    }
-		  for (pos = mid - 1; pos >= 0; pos--)
-		    {
-		      if ((ordered_sections[pos].endaddr > addr)
-			  && (ordered_sections[pos].the_bfd_section == bfd_section))
-			return pos;
-		    }
-
-		  /* If we don't find one that matches BOTH the address and the 
-		     section, then return -1.  Callers should be prepared to either
-		     fail in this case, or to look more broadly.  */
-		  return -1;
-		}
-	    }
-	  bot = mid + 1;
+	  root = root->left;
+	  continue;
 	}
-      else
-	{
-	  top = mid - 1;
-	}
-    } while (bot <= top);
 
-  /* If we got here, we didn't find anything, so return -1. */
-  return -1;
+      /* Everything to the right starts at or after ROOT, so look
+	 there first.  */
+      found = ordered_section_lookup (root->right, addr, bfd_section);
+      if (found != NULL)
+	return found;
+
+      if (addr < root->endaddr
+	  && (bfd_section == NULL || bfd_section == root->the_bfd_section))
+	return root;
+
+      root = root->left;
+    }
+
+  return NULL;
 }
 
 /* This returns the obj_section corresponding to the pair ADDR and
-   BFD_SECTION (can be NULL) in the ordered sections array, or NULL
+   BFD_SECTION (can be NULL) in the ordered sections tree, or NULL
    if not found.  */
 
 struct obj_section *
 find_pc_sect_in_ordered_sections (CORE_ADDR addr, struct bfd_section *bfd_section)
 {
-  int index = find_in_ordered_sections_index (addr, bfd_section);
-  
-  if (index == -1)
+  struct ordered_obj_section *node;
+
+  node = ordered_section_lookup (ordered_sections, addr, bfd_section);
+  if (node == NULL)
     return NULL;
   else
-    return ordered_sections[index].obj_section;
+    return node->obj_section;
 }
 
 /* Initialize entry point information for this objfile. */
@@ -1016,6 +999,12 @@ free_objfile_internal (struct objfile *objfile)
   /* APPLE LOCAL: Delete the equivalence table dingus.  */
   equivalence_table_delete (objfile);
 
+  /* APPLE LOCAL psymtab name index  */
+  objfile_invalidate_psymtab_name_index (objfile);
+
+  /* APPLE LOCAL background symbol loading  */
+  background_load_dequeue (objfile, OBJF_SYM_ALL);
+
   /* If we are going to free the runtime common objfile, mark it
      as unallocated.  */
 
@@ -1052,6 +1041,8 @@ free_objfile_internal (struct objfile *objfile)
   /* END APPLE LOCAL */
   if (objfile->demangled_names_hash)
     htab_delete (objfile->demangled_names_hash);
+  /* APPLE LOCAL minsym address table  */
+  free_minimal_symbol_address_table (objfile);
   obstack_free (&objfile->objfile_obstack, 0);
   /* APPLE LOCAL begin dwarf repository  */
   if (objfile->uses_sql_repository)
@@ -1066,9 +1057,9 @@ free_objfile_internal (struct objfile *objfile)
   /* APPLE LOCAL end subroutine inlining  */
 
   /* Can't tell whether one of the sections in this objfile is
-     one of the one's we've cached over in symfile.c, so let's clear
-     it here to be safe.  */
-  symtab_clear_cached_lookup_values ();
+     one of the one's we've cached over in symfile.c, so let's
+     invalidate everything cached about the objfiles to be safe.  */
+  objfile_generation++;
 
 }
 
@@ -1205,6 +1196,8 @@ objfile_relocate (struct objfile *objfile, struct section_offsets *new_offsets)
       return;
   }
   
+  /* APPLE LOCAL cache lookup values for improved performance  */
+  objfile_generation++;
   breakpoints_relocate (objfile, delta);
   /* APPLE LOCAL begin subroutine inlining  */
   /* Update all the inlined subroutine data for this objfile.  */
@@ -1505,42 +1498,31 @@ find_pc_sect_section (CORE_ADDR pc, struct bfd_section *section)
 {
   struct obj_section *s;
   struct objfile *objfile;
-
   /* APPLE LOCAL begin cache lookup values for improved performance  */
-  if (pc == last_sect_section_lookup_pc
-      && pc == last_mapped_section_lookup_pc
-      && section == cached_mapped_section)
-    return cached_sect_section;
-
-  last_sect_section_lookup_pc = pc;
+  struct pc_lookup_entry *e;
 
+  e = pc_lookup_cache_find (pc, section, PC_LOOKUP_OBJ_SECTION);
+  if (e != NULL)
+    return e->obj_section;
   /* APPLE LOCAL end cache lookup values for improved performance  */
 
   /* APPLE LOCAL begin search in ordered sections */
   s = find_pc_sect_in_ordered_sections (pc, section);
   if (s != NULL)
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-    {
-      cached_sect_section = s;
-      return (s);
-    }
-  /* APPLE LOCAL end cache lookup values for improved performance  */
+    goto found;
   /* APPLE LOCAL end search in ordered sections */
   
   ALL_OBJSECTIONS (objfile, s)
     if (objfile->separate_debug_objfile_backlink == NULL
         && (section == 0 || section == s->the_bfd_section) 
 	&& s->addr <= pc && pc < s->endaddr)
-      /* APPLE LOCAL begin cache lookup values for improved performance  */
-      {
-	cached_sect_section = s;
-	return (s);
-      }
+      goto found;
+  s = NULL;
 
-  last_sect_section_lookup_pc = INVALID_ADDRESS;
-  cached_sect_section = NULL;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
-  return (NULL);
+  /* APPLE LOCAL cache lookup values for improved performance  */
+ found:
+  pc_lookup_cache_add (pc, section, PC_LOOKUP_OBJ_SECTION)->obj_section = s;
+  return (s);
 }
 
 /* Returns a section whose range includes PC or NULL if none found. 
@@ -2037,6 +2019,66 @@ objfile_get_next (struct objfile *in_objfile)
 
 static int should_auto_raise_load_state = 0;
 
+/* APPLE LOCAL begin background symbol loading  */
+
+int background_symbol_loading = 0;
+
+/* The objfiles waiting to have their load state raised when gdb is
+   idle, in the order they were queued.  */
+
+struct background_load_entry
+{
+  struct objfile *objfile;
+  int load_state;
+  struct background_load_entry *next;
+};
+
+static struct background_load_entry *background_load_queue = NULL;
+
+/* The idle handler that works through background_load_queue, or 0 if
+   there isn't one.  */
+
+static int background_load_idle_id = 0;
+
+/* Return the load state objfile O is waiting to be raised to in the
+   background, or OBJF_SYM_NONE if it isn't waiting.  */
+
+static int
+background_load_pending (struct objfile *o)
+{
+  struct background_load_entry *entry;
+
+  for (entry = background_load_queue; entry != NULL; entry = entry->next)
+    if (entry->objfile == o)
+      return entry->load_state;
+
+  return OBJF_SYM_NONE;
+}
+
+/* Take objfile O off the background load queue if raising it to
+   LOAD_STATE will do all that it was waiting for.  */
+
+static void
+background_load_dequeue (struct objfile *o, int load_state)
+{
+  struct background_load_entry **entryp;
+
+  for (entryp = &background_load_queue; *entryp != NULL;
+       entryp = &(*entryp)->next)
+    if ((*entryp)->objfile == o)
+      {
+	struct background_load_entry *entry = *entryp;
+
+	if (entry->load_state <= load_state)
+	  {
+	    *entryp = entry->next;
+	    xfree (entry);
+	  }
+	return;
+      }
+}
+/* APPLE LOCAL end background symbol loading  */
+
 /* FIXME: How to make this stuff platform independent???  
    Right now I just have a lame #ifdef MACOSX_DYLD.  I think
    the long term plan is to move the shared library handling
@@ -2056,9 +2098,16 @@ int
 objfile_set_load_state (struct objfile *o, int load_state, int force)
 {
 
-  if (!force && !should_auto_raise_load_state)
+  /* APPLE LOCAL background symbol loading: If O is only waiting for
+     gdb to be idle to read these symbols anyway, read them now.  */
+  if (!force && !should_auto_raise_load_state
+      && background_load_pending (o) < load_state)
     return -2;
 
+  /* APPLE LOCAL background symbol loading: Whatever happens next, this
+     takes care of any background load that was waiting.  */
+  background_load_dequeue (o, load_state);
+
   if (o->symflags & OBJF_SYM_DONT_CHANGE)
     return -2;
 
@@ -2086,7 +2135,9 @@ pc_set_load_state (CORE_ADDR pc, int load_state, int force)
 {
   struct obj_section *s;
 
-  if (!force && !should_auto_raise_load_state)
+  /* APPLE LOCAL background symbol loading  */
+  if (!force && !should_auto_raise_load_state
+      && background_load_queue == NULL)
     return -1;
 
   s = find_pc_section (pc);
@@ -2108,7 +2159,9 @@ objfile_name_set_load_state (char *name, int load_state, int force)
 {
   struct objfile *tmp_obj;
 
-  if (!force && !should_auto_raise_load_state)
+  /* APPLE LOCAL background symbol loading  */
+  if (!force && !should_auto_raise_load_state
+      && background_load_queue == NULL)
     return -2;
 
   if (name == NULL)
@@ -2125,6 +2178,129 @@ objfile_name_set_load_state (char *name, int load_state, int force)
   return -1;
 }
 
+/* APPLE LOCAL begin background symbol loading  */
+
+/* Raise the load state of objfile O to LOAD_STATE, turning any error
+   into a warning since nobody in particular asked for this.  */
+
+static void
+background_load_raise (struct objfile *o, int load_state)
+{
+  struct gdb_exception e;
+  char *name = xstrdup (o->name);
+  struct cleanup *back_to = make_cleanup (xfree, name);
+
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      objfile_set_load_state (o, load_state, 1);
+    }
+  if (e.reason != NO_ERROR)
+    warning (_("Could not read symbols for \"%s\": %s"), name, e.message);
+
+  do_cleanups (back_to);
+}
+
+/* The idle handler for background symbol loading.  Reads the symbols
+   for one objfile per call, and returns 0 when there are no more, or
+   when the inferior is running; background_load_normal_stop starts it
+   up again when it stops.  */
+
+static int
+background_load_idle (gdb_client_data unused)
+{
+  if (background_load_queue != NULL && !target_executing)
+    background_load_raise (background_load_queue->objfile,
+			   background_load_queue->load_state);
+
+  if (background_load_queue == NULL || target_executing)
+    {
+      background_load_idle_id = 0;
+      return 0;
+    }
+
+  return 1;
+}
+
+static void
+background_load_schedule (void)
+{
+  if (background_load_queue != NULL && background_load_idle_id == 0
+      && !target_executing)
+    background_load_idle_id = create_idle_handler (background_load_idle,
+						   NULL);
+}
+
+static void
+background_load_normal_stop (struct bpstats *bs)
+{
+  background_load_schedule ();
+}
+
+void
+objfile_queue_background_load (struct objfile *o, int load_state)
+{
+  struct background_load_entry **entryp;
+  struct background_load_entry *entry;
+
+  if (o->symflags >= load_state)
+    return;
+
+  for (entryp = &background_load_queue; *entryp != NULL;
+       entryp = &(*entryp)->next)
+    if ((*entryp)->objfile == o)
+      {
+	if ((*entryp)->load_state < load_state)
+	  (*entryp)->load_state = load_state;
+	return;
+      }
+
+  entry = (struct background_load_entry *)
+    xmalloc (sizeof (struct background_load_entry));
+  entry->objfile = o;
+  entry->load_state = load_state;
+  entry->next = NULL;
+  *entryp = entry;
+
+  background_load_schedule ();
+}
+
+int
+objfile_background_load_queued (void)
+{
+  return background_load_queue != NULL;
+}
+
+void
+objfile_background_load_all (void)
+{
+  /* Raising the load state takes the objfile off the queue, even if
+     reading its symbols fails.  */
+  while (background_load_queue != NULL)
+    background_load_raise (background_load_queue->objfile,
+			   background_load_queue->load_state);
+}
+
+void
+objfile_background_load_for_name (const char *name)
+{
+  struct background_load_entry *entry;
+
+  /* Raising the load state takes the objfile off the queue, and may
+     free and reallocate it, so start over from the head each time.  */
+  entry = background_load_queue;
+  while (entry != NULL)
+    {
+      if (lookup_minimal_symbol (name, NULL, entry->objfile) != NULL)
+	{
+	  background_load_raise (entry->objfile, entry->load_state);
+	  entry = background_load_queue;
+	}
+      else
+	entry = entry->next;
+    }
+}
+/* APPLE LOCAL end background symbol loading  */
+
 /* END APPLE LOCAL set_load_state  */
 
 /* Return the first objfile that isn't marked as 'obsolete' (i.e. has been
@@ -2206,6 +2382,259 @@ psymtab_get_next (struct partial_symtab *ps, int skip_obsolete)
 
 
 
+/* APPLE LOCAL begin psymtab name index  */
+/* Looking a name up in the psymtabs used to mean searching every
+   psymtab of every objfile, which with thousands of compilation units
+   made the first "print" of a global noticeably slow.  So we keep, for
+   each objfile, a hash table from the hash of each global and static
+   partial symbol name to the psymtabs defining a symbol with that
+   hash, and only look in those.  */
+
+struct psymtab_name_entry
+{
+  unsigned int hash;
+  struct partial_symtab *pst;
+  struct psymtab_name_entry *next;
+};
+
+struct psymtab_name_index
+{
+  /* Always a power of two.  */
+  unsigned int nbuckets;
+  struct psymtab_name_entry **buckets;
+
+  /* Holds the entries.  */
+  struct obstack obstack;
+};
+
+/* If zero, don't use the psymtab name indexes at all; lookups walk
+   every psymtab instead.  Set with "maint set psymtab-name-index".  */
+
+static int psymtab_name_index_enabled = 1;
+
+static void
+show_psymtab_name_index_enabled (struct ui_file *file, int from_tty,
+				 struct cmd_list_element *c,
+				 const char *value)
+{
+  fprintf_filtered (file, _("Use of the psymtab name index is %s.\n"),
+		    value);
+}
+
+/* Record in INDEX that PST holds a partial symbol whose name hashes
+   to HASH.  The entries for one psymtab are all added together, so
+   they are at the head of the bucket and that is all we need to look
+   at to avoid adding the same one twice.  */
+
+static void
+psymtab_name_index_add (struct psymtab_name_index *index,
+			struct partial_symtab *pst, unsigned int hash)
+{
+  struct psymtab_name_entry **bucket;
+  struct psymtab_name_entry *entry;
+
+  bucket = &index->buckets[hash & (index->nbuckets - 1)];
+  for (entry = *bucket; entry != NULL && entry->pst == pst;
+       entry = entry->next)
+    if (entry->hash == hash)
+      return;
+
+  entry = (struct psymtab_name_entry *)
+    obstack_alloc (&index->obstack, sizeof (struct psymtab_name_entry));
+  entry->hash = hash;
+  entry->pst = pst;
+  entry->next = *bucket;
+  *bucket = entry;
+}
+
+/* Add the natural and search names of the COUNT partial symbols at
+   PSYMS, which belong to PST, to INDEX.  */
+
+static void
+psymtab_name_index_add_psymbols (struct psymtab_name_index *index,
+				 struct partial_symtab *pst,
+				 struct partial_symbol **psyms, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    {
+      char *natural_name = SYMBOL_NATURAL_NAME (psyms[i]);
+      char *search_name = SYMBOL_SEARCH_NAME (psyms[i]);
+
+      psymtab_name_index_add (index, pst, msymbol_hash_iw (natural_name));
+      if (search_name != natural_name)
+	psymtab_name_index_add (index, pst, msymbol_hash_iw (search_name));
+    }
+}
+
+/* Build the psymtab name index for OBJFILE.  */
+
+static struct psymtab_name_index *
+build_psymtab_name_index (struct objfile *objfile)
+{
+  struct psymtab_name_index *index;
+  struct partial_symtab *ps;
+  struct partial_symtab **psymtabs;
+  int npsymtabs = 0;
+  int nsyms = 0;
+  int i;
+
+  ALL_OBJFILE_PSYMTABS_INCL_OBSOLETED (objfile, ps)
+    {
+      npsymtabs++;
+      nsyms += ps->n_global_syms + ps->n_static_syms;
+    }
+
+  index = (struct psymtab_name_index *)
+    xmalloc (sizeof (struct psymtab_name_index));
+  index->nbuckets = 64;
+  while (index->nbuckets < nsyms)
+    index->nbuckets <<= 1;
+  index->buckets = (struct psymtab_name_entry **)
+    xcalloc (index->nbuckets, sizeof (struct psymtab_name_entry *));
+  obstack_init (&index->obstack);
+
+  /* Entries are pushed on the front of their bucket, so add the
+     psymtabs last to first to leave each bucket in the same order as
+     the psymtab list.  Lookups depend on that to find the same symbol
+     a walk of every psymtab would.  */
+
+  psymtabs = (struct partial_symtab **)
+    xmalloc ((npsymtabs + 1) * sizeof (struct partial_symtab *));
+  i = 0;
+  ALL_OBJFILE_PSYMTABS_INCL_OBSOLETED (objfile, ps)
+    psymtabs[i++] = ps;
+
+  while (i-- > 0)
+    {
+      ps = psymtabs[i];
+      psymtab_name_index_add_psymbols
+	(index, ps, objfile->global_psymbols.list + ps->globals_offset,
+	 ps->n_global_syms);
+      psymtab_name_index_add_psymbols
+	(index, ps, objfile->static_psymbols.list + ps->statics_offset,
+	 ps->n_static_syms);
+    }
+
+  xfree (psymtabs);
+  return index;
+}
+
+/* Throw away OBJFILE's psymtab name index.  Anything that adds or
+   removes psymtabs, or changes their partial symbols, must call this;
+   the index will be rebuilt by the next lookup.  */
+
+void
+objfile_invalidate_psymtab_name_index (struct objfile *objfile)
+{
+  struct psymtab_name_index *index = objfile->psymtab_name_index;
+
+  objfile->psymtab_name_index_generation++;
+  if (index == NULL)
+    return;
+
+  obstack_free (&index->obstack, NULL);
+  xfree (index->buckets);
+  xfree (index);
+  objfile->psymtab_name_index = NULL;
+}
+
+/* Skip IT->entry forward to the first entry for IT->hash whose
+   psymtab isn't obsolete, and return that psymtab.  */
+
+static struct partial_symtab *
+psymtab_name_skip (struct psymtab_name_iterator *it)
+{
+  while (it->entry != NULL
+	 && (it->entry->hash != it->hash
+	     || PSYMTAB_OBSOLETED (it->entry->pst) == 51))
+    it->entry = it->entry->next;
+
+  return it->entry != NULL ? it->entry->pst : NULL;
+}
+
+/* Start walking the psymtabs in OBJFILE that may define NAME, using
+   IT to keep our place.  Return the first one, or NULL if there are
+   none.  If NAME is NULL, walk all of OBJFILE's psymtabs.  */
+
+struct partial_symtab *
+psymtab_name_first (struct objfile *objfile, const char *name,
+		    struct psymtab_name_iterator *it)
+{
+  struct psymtab_name_index *index;
+
+  it->objfile = objfile;
+  if (name == NULL)
+    {
+      it->entry = NULL;
+      it->pst = psymtab_get_first (objfile, 1);
+      return it->pst;
+    }
+
+  it->pst = NULL;
+  if (objfile->psymtabs == NULL)
+    {
+      it->entry = NULL;
+      return NULL;
+    }
+
+  /* Building the index hashes every partial symbol in OBJFILE, which
+     costs more than one walk over its psymtabs.  So only build it
+     once OBJFILE has been looked in before; lookups made once, such
+     as those for a name no objfile defines, stay as cheap as they
+     were without an index.  */
+  if (objfile->psymtab_name_lookups < 2)
+    objfile->psymtab_name_lookups++;
+  if (!psymtab_name_index_enabled
+      || (objfile->psymtab_name_index == NULL
+	  && objfile->psymtab_name_lookups < 2))
+    {
+      it->entry = NULL;
+      it->pst = psymtab_get_first (objfile, 1);
+      return it->pst;
+    }
+
+  if (objfile->psymtab_name_index == NULL)
+    objfile->psymtab_name_index = build_psymtab_name_index (objfile);
+  index = objfile->psymtab_name_index;
+
+  it->generation = objfile->psymtab_name_index_generation;
+  it->hash = msymbol_hash_iw (name);
+  it->entry = index->buckets[it->hash & (index->nbuckets - 1)];
+  return psymtab_name_skip (it);
+}
+
+/* Return the next psymtab in the walk IT, or NULL at the end.  */
+
+struct partial_symtab *
+psymtab_name_next (struct psymtab_name_iterator *it)
+{
+  if (it->pst != NULL)
+    {
+      it->pst = psymtab_get_next (it->pst, 1);
+      return it->pst;
+    }
+
+  if (it->entry == NULL)
+    return NULL;
+
+  /* If the index was thrown away while we were at one of its entries,
+     the entry is gone, and so may be its psymtab.  Fall back to
+     walking every psymtab from the start; the callers skip the ones
+     that are already read in.  */
+  if (it->generation != it->objfile->psymtab_name_index_generation)
+    {
+      it->entry = NULL;
+      it->pst = psymtab_get_first (it->objfile, 1);
+      return it->pst;
+    }
+
+  it->entry = it->entry->next;
+  return psymtab_name_skip (it);
+}
+/* APPLE LOCAL end psymtab name index  */
+
 /* Keep a registry of per-objfile data-pointers required by other GDB
    modules.  */
 
@@ -2675,4 +3104,30 @@ _initialize_objfiles (void)
 Set if GDB should raise the symbol loading level on all frames found in backtraces."), _("\
 Show if GDB should raise the symbol loading level on all frames found in backtraces."), NULL,
 			   NULL, NULL, &setlist, &showlist);
+
+  /* APPLE LOCAL begin background symbol loading  */
+  add_setshow_boolean_cmd ("background-symbol-loading", class_obscure,
+			   &background_symbol_loading, _("\
+Set if GDB should read shared library symbols in the background."), _("\
+Show if GDB should read shared library symbols in the background."), _("\
+When on, shared libraries are first read in with only their external\n\
+symbols, and the rest of their symbols are read while GDB is idle.\n\
+Looking up a global symbol in a library that hasn't been read yet reads it\n\
+first; types and statics are only found once the library has been read."),
+			   NULL, NULL, &setlist, &showlist);
+  observer_attach_normal_stop (background_load_normal_stop);
+  /* APPLE LOCAL end background symbol loading  */
+
+  /* APPLE LOCAL psymtab name index  */
+  add_setshow_boolean_cmd ("psymtab-name-index", class_maintenance,
+			   &psymtab_name_index_enabled, _("\
+Set use of the psymtab name index in symbol lookups."), _("\
+Show use of the psymtab name index in symbol lookups."), _("\
+When on, looking up a global or static symbol by name only searches the\n\
+partial symbol tables that may define it.  When off, every partial symbol\n\
+table is searched, as GDB did before the index existed."),
+			   NULL,
+			   show_psymtab_name_index_enabled,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
 }
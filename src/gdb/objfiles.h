@@ -272,6 +272,27 @@ struct objfile
 
     struct partial_symtab *free_psymtabs;
 
+    /* APPLE LOCAL: Index from the hash of a partial symbol name (as
+       computed by msymbol_hash_iw) to the psymtabs that may hold a
+       global or static partial symbol by that name.  Built on demand
+       by a lookup in this objfile, and thrown away whenever the
+       psymtab list or the psymtabs' symbols change.  NULL if not
+       built yet.  */
+
+    struct psymtab_name_index *psymtab_name_index;
+
+    /* APPLE LOCAL: Bumped each time the index above is thrown away, so
+       that a walk over it can tell its entries are gone.  */
+
+    unsigned int psymtab_name_index_generation;
+
+    /* APPLE LOCAL: How many lookups by name have looked in this
+       objfile's psymtabs, up to 2.  The first one just walks them all,
+       so that a single lookup doesn't pay for indexing symbols it will
+       never look at; the index is only built for the second.  */
+
+    unsigned int psymtab_name_lookups;
+
     /* The object file's BFD.  Can be null if the objfile contains only
        minimal symbols, e.g. the run time common symbols for SunOS4.  */
 
@@ -318,6 +339,16 @@ struct objfile
     struct minimal_symbol *msymbols;
     int minimal_symbol_count;
 
+    /* APPLE LOCAL: The addresses of the minimal symbols, in the same
+       order, so that looking up a symbol by PC can bisect a dense
+       array rather than stride through the symbols themselves.
+       xmalloc'd, and refilled in place each time the symbols are
+       sorted; MSYMBOL_ADDRESSES_SIZE is the number of slots it has.
+       NULL if it hasn't been built for the current msymbols.  */
+
+    CORE_ADDR *msymbol_addresses;
+    int msymbol_addresses_size;
+
     /* This is a hash table used to index the minimal symbols by name.  */
 
    struct minimal_symbol *msymbol_hash[MINIMAL_SYMBOL_HASH_SIZE];
@@ -616,6 +647,15 @@ extern struct objfile *current_objfile;
 
 extern struct objfile *object_files;
 
+/* APPLE LOCAL begin cache lookup values for improved performance  */
+/* Bumped whenever an objfile is added, removed, relocated or has
+   symbols read into it, so that anything cached about what the
+   objfiles say (such as the PC lookup cache in symtab.c) can tell
+   when it is stale.  */
+
+extern unsigned int objfile_generation;
+/* APPLE LOCAL end cache lookup values for improved performance  */
+
 /* Declarations for functions defined in objfiles.c */
 
 extern struct objfile *allocate_objfile (bfd *, int, int symflags, CORE_ADDR mapaddr, const char *prefix);
@@ -719,7 +759,7 @@ struct cleanup *make_cleanup_restrict_to_objfile_by_name (char *objfile_name);
 struct cleanup *make_cleanup_restrict_to_shlib (char *shlib);
 
 /* APPLE LOCAL: These manage & look up obj_sections in the ordered_sections
-   array.  */
+   tree.  */
 void objfile_add_to_ordered_sections (struct objfile *objfile);
 void objfile_delete_from_ordered_sections (struct objfile *objfile);
 struct obj_section *find_pc_sect_in_ordered_sections (CORE_ADDR addr, 
@@ -731,6 +771,40 @@ int objfile_set_load_state (struct objfile *, int, int);
 int pc_set_load_state (CORE_ADDR, int, int);
 int objfile_name_set_load_state (char *, int, int);
 
+/* APPLE LOCAL begin background symbol loading  */
+/* If set, shared libraries are first read in with only their external
+   symbols, and their remaining symbols are read later, one library at
+   a time, whenever gdb is idle.  */
+
+extern int background_symbol_loading;
+
+/* Arrange for the load state of objfile O to be raised to LOAD_STATE
+   later, when gdb is idle.  */
+
+extern void objfile_queue_background_load (struct objfile *o, int load_state);
+
+/* Return non-zero if any objfile is still waiting to be loaded in
+   the background.  */
+
+extern int objfile_background_load_queued (void);
+
+/* Raise now the load state of every objfile still waiting to be
+   loaded in the background.  Callers that walk minimal symbols and
+   look names up as they go must do this first, since reading an
+   objfile in frees its minimal symbols.  */
+
+extern void objfile_background_load_all (void);
+
+/* Raise now the load state of any objfile still waiting to be loaded
+   in the background which has a minimal symbol called NAME.  Doing so
+   may free the objfile's minimal symbols, so NAME must not point into
+   them.  Only names the objfile has read a minimal symbol for (at
+   OBJF_SYM_EXTERN, its external symbols) are found this way; types
+   and statics are not.  */
+
+extern void objfile_background_load_for_name (const char *name);
+/* APPLE LOCAL end background symbol loading  */
+
 /* APPLE LOCAL begin dwarf repository  */
 extern unsigned get_objfile_registry_num_registrations (void);
 /* APPLE LOCAL end dwarf repository  */
@@ -747,6 +821,33 @@ struct partial_symtab *psymtab_get_first (struct objfile *, int );
 struct partial_symtab *psymtab_get_next (struct partial_symtab *, int );
 /* APPLE LOCAL end fix-and-continue */
 
+/* APPLE LOCAL begin psymtab name index  */
+/* State for walking the psymtabs of an objfile that may define a
+   given name.  */
+
+struct psymtab_name_iterator
+{
+  /* The objfile being walked, and its psymtab_name_index_generation
+     when the walk started.  */
+  struct objfile *objfile;
+  unsigned int generation;
+
+  /* The name's hash, as computed by msymbol_hash_iw.  */
+  unsigned int hash;
+
+  /* The index entry we are at, or NULL when walking every psymtab.  */
+  struct psymtab_name_entry *entry;
+
+  /* The psymtab we are at, when walking every psymtab.  */
+  struct partial_symtab *pst;
+};
+
+struct partial_symtab *psymtab_name_first (struct objfile *, const char *,
+					   struct psymtab_name_iterator *);
+struct partial_symtab *psymtab_name_next (struct psymtab_name_iterator *);
+extern void objfile_invalidate_psymtab_name_index (struct objfile *);
+/* APPLE LOCAL end psymtab name index  */
+
 #define	ALL_OBJFILES(obj) \
   for ((obj) = objfile_get_first (); \
        (obj) != NULL; \
@@ -784,6 +885,22 @@ struct partial_symtab *psymtab_get_next (struct partial_symtab *, int );
          (p) != NULL; \
          (p) = psymtab_get_next (p, 0))
 
+/* APPLE LOCAL: Traverse the psymtabs in one objfile that may hold a
+   global or static partial symbol whose natural or search name
+   matches NAME by strcmp_iw.  Every psymtab that does is visited, in
+   the same order as ALL_OBJFILE_PSYMTABS, but others may be visited
+   too, so the caller must still check each one.  If NAME is NULL,
+   visit all of them.  IT is a struct psymtab_name_iterator.
+
+   If the body throws the index away (say, by reading in a psymtab
+   that adds more), the walk carries on over every psymtab in the
+   objfile from the start, so some may be visited twice.  */
+
+#define ALL_OBJFILE_PSYMTABS_FOR_NAME(objfile, name, it, p) \
+    for ((p) = psymtab_name_first ((objfile), (name), &(it)); \
+         (p) != NULL; \
+         (p) = psymtab_name_next (&(it)))
+
 /* Traverse all minimal symbols in one objfile.  */
 
 #define	ALL_OBJFILE_MSYMBOLS(objfile, m) \
@@ -807,6 +924,13 @@ struct partial_symtab *psymtab_get_next (struct partial_symtab *, int );
   ALL_OBJFILES (objfile)	 \
     ALL_OBJFILE_PSYMTABS (objfile, p)
 
+/* APPLE LOCAL: Traverse the psymtabs in all objfiles that may define
+   NAME.  See ALL_OBJFILE_PSYMTABS_FOR_NAME.  */
+
+#define	ALL_PSYMTABS_FOR_NAME(objfile, name, it, p) \
+  ALL_OBJFILES (objfile)	 \
+    ALL_OBJFILE_PSYMTABS_FOR_NAME (objfile, name, it, p)
+
 /* Traverse all minimal symbols in all objfiles.  */
 
 #define	ALL_MSYMBOLS(objfile, m) \
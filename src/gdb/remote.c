@@ -43,6 +43,8 @@
 #include "gdb_assert.h"
 #include "observer.h"
 #include "solib.h"
+#include "ax.h"
+#include "user-regs.h"
 
 #include <ctype.h>
 #include <sys/time.h>
@@ -777,6 +779,23 @@ get_memory_read_packet_size (void)
   return size;
 }
 
+/* The number of memory-read packets remote_read_bytes may have
+   outstanding at once.  Over a link with a long round trip, keeping
+   several requests in flight is what bounds the throughput of large
+   reads, rather than the latency.  This needs no-ack mode: with acks,
+   the stub would take our next request for the ack of its reply.  */
+
+static int remote_memory_read_window = 1;
+
+static void
+show_remote_memory_read_window (struct ui_file *file, int from_tty,
+				struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+The number of memory-read packets kept in flight is %s.\n"),
+		    value);
+}
+
 
 /* Generic configuration support for packets the stub optionally
    supports. Allows the user to specify the use of the packet as well
@@ -1375,6 +1394,286 @@ show_remote_protocol_qGetTLSAddr_packet_cmd (struct ui_file *file, int from_tty,
   show_packet_config_cmd (&remote_protocol_qGetTLSAddr);
 }
 
+/* Should we send breakpoint conditions, as agent expressions, along
+   with the 'Z0' packet?  */
+static struct packet_config remote_protocol_Z0_cond;
+
+static void
+set_remote_protocol_Z0_cond_packet_cmd (char *args, int from_tty,
+					struct cmd_list_element *c)
+{
+  update_packet_config (&remote_protocol_Z0_cond);
+}
+
+static void
+show_remote_protocol_Z0_cond_packet_cmd (struct ui_file *file, int from_tty,
+					 struct cmd_list_element *c,
+					 const char *value)
+{
+  show_packet_config_cmd (&remote_protocol_Z0_cond);
+}
+
+/* APPLE LOCAL begin search memory */
+/* Should we try the 'qSearch:memory' (search memory in the stub)
+   request?  */
+static struct packet_config remote_protocol_qSearch_memory;
+
+static void
+set_remote_protocol_qSearch_memory_packet_cmd (char *args, int from_tty,
+					       struct cmd_list_element *c)
+{
+  update_packet_config (&remote_protocol_qSearch_memory);
+}
+
+static void
+show_remote_protocol_qSearch_memory_packet_cmd (struct ui_file *file,
+						int from_tty,
+						struct cmd_list_element *c,
+						const char *value)
+{
+  show_packet_config_cmd (&remote_protocol_qSearch_memory);
+}
+/* APPLE LOCAL end search memory */
+
+/* APPLE LOCAL begin verify memory */
+/* Should we try the 'qCRC' (checksum memory in the stub) request to
+   compare memory with what we'd write there?  */
+static struct packet_config remote_protocol_qCRC;
+
+static void
+set_remote_protocol_qCRC_packet_cmd (char *args, int from_tty,
+				     struct cmd_list_element *c)
+{
+  update_packet_config (&remote_protocol_qCRC);
+}
+
+static void
+show_remote_protocol_qCRC_packet_cmd (struct ui_file *file, int from_tty,
+				      struct cmd_list_element *c,
+				      const char *value)
+{
+  show_packet_config_cmd (&remote_protocol_qCRC);
+}
+/* APPLE LOCAL end verify memory */
+
+/* Should we tell the stub which registers to send in its 'T' stop
+   replies?  */
+
+static struct packet_config remote_protocol_QExpedite;
+
+/* The registers the user wants expedited, as register names separated
+   by spaces or commas, or "all".  NULL or empty means the stub's own
+   choice.  */
+static char *remote_expedite_registers;
+
+static int remote_send_expedite_registers (void);
+
+static void
+set_remote_protocol_QExpedite_packet_cmd (char *args, int from_tty,
+					  struct cmd_list_element *c)
+{
+  update_packet_config (&remote_protocol_QExpedite);
+}
+
+static void
+show_remote_protocol_QExpedite_packet_cmd (struct ui_file *file, int from_tty,
+					   struct cmd_list_element *c,
+					   const char *value)
+{
+  show_packet_config_cmd (&remote_protocol_QExpedite);
+}
+
+static void
+set_remote_expedite_registers_command (char *args, int from_tty,
+				       struct cmd_list_element *c)
+{
+  /* If we aren't connected, we'll tell the stub when we are.  */
+  if (!target_has_registers || remote_desc == NULL)
+    return;
+
+  if (!remote_send_expedite_registers ())
+    warning (_("The remote stub did not accept the register list."));
+}
+
+static void
+show_remote_expedite_registers_command (struct ui_file *file, int from_tty,
+					struct cmd_list_element *c,
+					const char *value)
+{
+  if (value == NULL || *value == '\0')
+    fprintf_filtered (file, _("\
+The remote stub chooses the registers sent in stop replies.\n"));
+  else
+    fprintf_filtered (file, _("\
+The registers sent in stop replies are \"%s\".\n"),
+		      value);
+}
+
+/* Should we read all the registers with one 'g' packet, even when
+   only one of them is wanted?  Doing so means that the rest of the
+   registers GDB looks at while the target is stopped come from the
+   register cache, instead of costing a 'p' packet each.  */
+
+static int remote_prefetch_registers = 1;
+
+static void
+show_remote_prefetch_registers (struct ui_file *file, int from_tty,
+				struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+Reading all registers when one is wanted is %s.\n"),
+		    value);
+}
+
+/* Counts of the packets we send, so that "maint print remote-stats"
+   can show what each stop of the target costs.  Reset when we connect
+   to a target.  */
+
+static struct
+{
+  /* Packets sent in all, and of the register-reading kinds.  */
+  unsigned long packets;
+  unsigned long g_packets;
+  unsigned long p_packets;
+
+  /* Stops reported by the target.  */
+  unsigned long stops;
+
+  /* Packets sent since the last stop, and between the last two.  */
+  unsigned long packets_since_stop;
+  unsigned long packets_last_stop;
+} remote_packet_stats;
+
+static void
+count_remote_packet (const char *buf)
+{
+  remote_packet_stats.packets++;
+  remote_packet_stats.packets_since_stop++;
+  if (buf[0] == 'g' && buf[1] == '\0')
+    remote_packet_stats.g_packets++;
+  else if (buf[0] == 'p')
+    remote_packet_stats.p_packets++;
+}
+
+static void
+count_remote_stop (void)
+{
+  remote_packet_stats.stops++;
+  remote_packet_stats.packets_last_stop
+    = remote_packet_stats.packets_since_stop;
+  remote_packet_stats.packets_since_stop = 0;
+}
+
+static void
+maintenance_print_remote_stats (char *args, int from_tty)
+{
+  printf_filtered (_("Packets sent: %lu\n"), remote_packet_stats.packets);
+  printf_filtered (_("  'g' packets: %lu\n"), remote_packet_stats.g_packets);
+  printf_filtered (_("  'p' packets: %lu\n"), remote_packet_stats.p_packets);
+  printf_filtered (_("Stops: %lu\n"), remote_packet_stats.stops);
+  if (remote_packet_stats.stops > 0)
+    {
+      printf_filtered (_("Packets per stop: %.1f\n"),
+		       (double) (remote_packet_stats.packets
+				 - remote_packet_stats.packets_since_stop)
+		       / remote_packet_stats.stops);
+      printf_filtered (_("Packets between the last two stops: %lu\n"),
+		       remote_packet_stats.packets_last_stop);
+    }
+  printf_filtered (_("Packets since the last stop: %lu\n"),
+		   remote_packet_stats.packets_since_stop);
+}
+
+/* Tell the stub which registers to send in its 'T' stop replies, as
+   given by remote_expedite_registers, with a QExpedite packet.  Return
+   zero if the stub doesn't support it or rejected the list.  */
+
+static int
+remote_send_expedite_registers (void)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *buf = alloca (rs->remote_packet_size);
+  char *p, *end;
+  const char *names = remote_expedite_registers;
+  long reply_size = 64;
+
+  if (remote_protocol_QExpedite.support == PACKET_DISABLE)
+    return 0;
+
+  p = buf;
+  end = buf + rs->remote_packet_size - 1;
+  p += xsnprintf (p, end - p, "QExpedite:");
+
+  if (names != NULL && strcmp (names, "all") == 0)
+    {
+      int i;
+
+      for (i = 0; i < NUM_REGS + NUM_PSEUDO_REGS; i++)
+	{
+	  struct packet_reg *reg = &rs->regs[i];
+
+	  if (!reg->in_g_packet)
+	    continue;
+	  if (end - p < 20)
+	    error (_("Too many registers to expedite."));
+	  if (p[-1] != ':')
+	    *p++ = ';';
+	  p += hexnumstr (p, reg->pnum);
+	  reply_size += 2 * register_size (current_gdbarch, reg->regnum) + 8;
+	}
+    }
+  else if (names != NULL)
+    {
+      const char *start = names;
+
+      while (*start != '\0')
+	{
+	  const char *stop;
+	  struct packet_reg *reg;
+	  int regnum;
+
+	  while (*start == ' ' || *start == '\t' || *start == ',')
+	    start++;
+	  if (*start == '\0')
+	    break;
+	  for (stop = start;
+	       *stop != '\0' && *stop != ' ' && *stop != '\t' && *stop != ',';
+	       stop++)
+	    ;
+
+	  regnum = user_reg_map_name_to_regnum (current_gdbarch, start,
+						stop - start);
+	  reg = NULL;
+	  if (regnum >= 0 && regnum < NUM_REGS + NUM_PSEUDO_REGS)
+	    reg = packet_reg_from_regnum (rs, regnum);
+	  if (reg == NULL || !reg->in_g_packet)
+	    error (_("Register \"%.*s\" can't be expedited."),
+		   (int) (stop - start), start);
+
+	  if (end - p < 20)
+	    error (_("Too many registers to expedite."));
+	  if (p[-1] != ':')
+	    *p++ = ';';
+	  p += hexnumstr (p, reg->pnum);
+	  reply_size += 2 * register_size (current_gdbarch, reg->regnum) + 8;
+	  start = stop;
+	}
+    }
+  *p = '\0';
+
+  /* The stub only limits the reply to its own packet buffer; make
+     sure it fits in ours.  */
+  if (reply_size > rs->remote_packet_size)
+    error (_("The expedited registers won't fit in a %ld-byte packet."),
+	   rs->remote_packet_size);
+
+  putpkt (buf);
+  getpkt (buf, rs->remote_packet_size, 0);
+
+  return (packet_ok (buf, &remote_protocol_QExpedite) == PACKET_OK
+	  && buf[0] != '\0');
+}
+
 static struct packet_config remote_protocol_p;
 
 static void
@@ -2499,6 +2798,9 @@ remote_start_remote (struct ui_out *uiout, void *dummy)
       if (remote_debugflags != NULL)
         send_remote_debugflags_pkt (remote_debugflags);
       send_remote_max_payload_size ();
+      if (remote_expedite_registers != NULL
+	  && *remote_expedite_registers != '\0')
+	remote_send_expedite_registers ();
       
       putpkt ("?");		/* Initiate a query from remote machine.  */
       immediate_quit--;
@@ -2558,6 +2860,12 @@ init_all_packet_configs (void)
   update_packet_config (&remote_protocol_binary_download);
   update_packet_config (&remote_protocol_qPart_auxv);
   update_packet_config (&remote_protocol_qGetTLSAddr);
+  update_packet_config (&remote_protocol_Z0_cond);
+  update_packet_config (&remote_protocol_QExpedite);
+  /* APPLE LOCAL search memory */
+  update_packet_config (&remote_protocol_qSearch_memory);
+  /* APPLE LOCAL verify memory */
+  update_packet_config (&remote_protocol_qCRC);
 }
 
 /* Symbol look-up.  */
@@ -2673,6 +2981,7 @@ remote_open_1 (char *name, int from_tty, struct target_ops *target,
   push_target (target);		/* Switch to using remote target now.  */
 
   init_all_packet_configs ();
+  memset (&remote_packet_stats, 0, sizeof (remote_packet_stats));
 
   general_thread = -2;
   continue_thread = -2;
@@ -3519,6 +3828,8 @@ Packet: '%s'\n"),
 	}
     }
 got_status:
+  if (status->kind == TARGET_WAITKIND_STOPPED)
+    count_remote_stop ();
   if (thread_num != -1)
     {
       return ptid_build (thread_num, 0, thread_num);
@@ -3717,6 +4028,8 @@ Packet: '%s'\n"),
 	}
     }
 got_status:
+  if (status->kind == TARGET_WAITKIND_STOPPED)
+    count_remote_stop ();
   if (thread_num != -1)
     {
       return ptid_build (thread_num, 0, thread_num);
@@ -3796,6 +4109,11 @@ remote_fetch_registers (int regnum)
 			_("Attempt to fetch a non G-packet register when this "
 			"remote.c does not support the p-packet."));
     }
+
+  /* Unless told otherwise, fetch every register now: whatever else
+     GDB looks at before the target resumes is then already in the
+     register cache.  */
+  if (regnum >= 0 && !remote_prefetch_registers)
       switch (remote_protocol_p.support)
 	{
 	case PACKET_DISABLE:
@@ -4308,6 +4626,157 @@ remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr, int len)
    caller and its callers caller ;-) already contains code for
    handling partial reads.  */
 
+/* Send the memory-read request for the TODO bytes at MEMADDR, using
+   BUF to build the packet.  */
+
+static void
+remote_send_memory_read (char *buf, CORE_ADDR memaddr, int todo)
+{
+  char *p;
+
+  /* construct "m"<memaddr>","<len>" */
+  memaddr = remote_address_masked (memaddr);
+  p = buf;
+  *p++ = 'm';
+  p += hexnumstr (p, (ULONGEST) memaddr);
+  *p++ = ',';
+  p += hexnumstr (p, (ULONGEST) todo);
+  *p = '\0';
+
+  putpkt (buf);
+}
+
+/* The state of a pipelined memory read.  */
+
+struct remote_read_pipeline
+{
+  CORE_ADDR memaddr;
+  char *myaddr;
+  int len;
+  int chunk;
+  char *buf;
+  long sizeof_buf;
+
+  /* The number of requests whose reply we have yet to read.  */
+  int in_flight;
+
+  /* What to return, once known.  */
+  int result;
+};
+
+/* Send the requests and collect the replies for the pipelined read
+   PIPE.  Errors, including a reply that doesn't come, are thrown with
+   PIPE->in_flight still counting the replies not yet read.  */
+
+static void
+remote_read_bytes_window (struct remote_read_pipeline *pipe)
+{
+  int sent = 0;			/* Bytes requested so far.  */
+  int received = 0;		/* Bytes whose reply we have read.  */
+
+  while (pipe->in_flight > 0 || (pipe->result < 0 && sent < pipe->len))
+    {
+      int todo;
+      int i;
+
+      /* Top up the window, unless we have already seen an error or
+	 a short reply and are just collecting what's outstanding.  */
+      while (pipe->result < 0 && sent < pipe->len
+	     && pipe->in_flight < remote_memory_read_window)
+	{
+	  todo = min (pipe->len - sent, pipe->chunk);
+	  remote_send_memory_read (pipe->buf, pipe->memaddr + sent, todo);
+	  sent += todo;
+	  pipe->in_flight++;
+	}
+
+      if (getpkt_sane (pipe->buf, pipe->sizeof_buf, 0))
+	error (_("Timed out waiting for a memory read reply."));
+      pipe->in_flight--;
+      if (pipe->result >= 0)
+	continue;
+
+      todo = min (pipe->len - received, pipe->chunk);
+      if (pipe->buf[0] == 'E'
+	  && isxdigit (pipe->buf[1]) && isxdigit (pipe->buf[2])
+	  && pipe->buf[3] == '\0')
+	{
+	  /* See remote_read_bytes.  */
+	  errno = EIO;
+	  pipe->result = 0;
+	  continue;
+	}
+
+      if ((i = hex2bin (pipe->buf, pipe->myaddr + received, todo)) < todo)
+	{
+	  pipe->result = received + i;
+	  continue;
+	}
+      received += todo;
+      if (received == pipe->len)
+	pipe->result = pipe->len;
+    }
+}
+
+/* Read and throw away the replies to the IN_FLIGHT memory-read
+   requests still outstanding, so that the next packet we send isn't
+   matched with one of them.  If they don't all come, discard whatever
+   has arrived instead; a reply that turns up later than that will
+   still confuse us, but there's nothing more we can do.  */
+
+static void
+remote_drain_memory_reads (char *buf, long sizeof_buf, int in_flight)
+{
+  /* The connection may be what failed.  */
+  if (remote_desc == NULL)
+    return;
+
+  for (; in_flight > 0; in_flight--)
+    if (getpkt_sane (buf, sizeof_buf, 0))
+      {
+	serial_flush_input (remote_desc);
+	break;
+      }
+}
+
+/* Like remote_read_bytes, but keep up to remote_memory_read_window
+   requests of CHUNK bytes outstanding, and match the replies, which
+   the stub sends in order, to the requests as they arrive.  BUF is a
+   buffer of SIZEOF_BUF bytes for the packets.  */
+
+static int
+remote_read_bytes_pipelined (CORE_ADDR memaddr, char *myaddr, int len,
+			     int chunk, char *buf, long sizeof_buf)
+{
+  struct remote_read_pipeline pipe;
+  struct gdb_exception ex;
+
+  pipe.memaddr = memaddr;
+  pipe.myaddr = myaddr;
+  pipe.len = len;
+  pipe.chunk = chunk;
+  pipe.buf = buf;
+  pipe.sizeof_buf = sizeof_buf;
+  pipe.in_flight = 0;
+  pipe.result = -1;
+
+  /* If we give up part way through, because of an error or a quit,
+     the replies to the requests still in flight are on their way.
+     Collect them before passing the error on, or every later packet
+     would be matched with the reply to an earlier one.  */
+  TRY_CATCH (ex, RETURN_MASK_ALL)
+    {
+      remote_read_bytes_window (&pipe);
+    }
+  if (ex.reason < 0)
+    {
+      remote_drain_memory_reads (buf, sizeof_buf, pipe.in_flight);
+      throw_exception (ex);
+    }
+
+  return pipe.result;
+}
+
 int
 remote_read_bytes (CORE_ADDR memaddr, char *myaddr, int len)
 {
@@ -4321,6 +4790,11 @@ remote_read_bytes (CORE_ADDR memaddr, char *myaddr, int len)
   sizeof_buf = max_buf_size + 1; /* Space for trailing NULL.  */
   buf = alloca (sizeof_buf);
 
+  if (no_ack_mode && remote_memory_read_window > 1
+      && len > max_buf_size / 2)
+    return remote_read_bytes_pipelined (memaddr, myaddr, len,
+					max_buf_size / 2, buf, sizeof_buf);
+
   origlen = len;
   while (len > 0)
     {
@@ -4330,17 +4804,7 @@ remote_read_bytes (CORE_ADDR memaddr, char *myaddr, int len)
 
       todo = min (len, max_buf_size / 2);	/* num bytes that will fit */
 
-      /* construct "m"<memaddr>","<len>" */
-      /* sprintf (buf, "m%lx,%x", (unsigned long) memaddr, todo); */
-      memaddr = remote_address_masked (memaddr);
-      p = buf;
-      *p++ = 'm';
-      p += hexnumstr (p, (ULONGEST) memaddr);
-      *p++ = ',';
-      p += hexnumstr (p, (ULONGEST) todo);
-      *p = '\0';
-
-      putpkt (buf);
+      remote_send_memory_read (buf, memaddr, todo);
       getpkt (buf, sizeof_buf, 0);
 
       if (buf[0] == 'E'
@@ -4529,6 +4993,7 @@ putpkt_binary (char *buf, int cnt)
       if (current_remote_stats)
         current_remote_stats->pkt_sent++;
       total_packets_sent++;
+      count_remote_packet (buf);
       add_outgoing_pkt_to_protocol_log (buf);
 
       /* APPLE LOCAL: If this is a no acks version of the remote
@@ -5061,6 +5526,47 @@ static unsigned char little_break_insn[] = DEPRECATED_LITTLE_REMOTE_BREAKPOINT;
 
 #endif /* DEPRECATED_REMOTE_BREAKPOINT */
 
+/* Append the conditions of the breakpoints at ADDR to the Z0 packet
+   being built at P, as ";X<len>,<bytecode>" with the agent expression
+   bytecode in hex.  SIZE is the room left in the packet buffer.
+   Return non-zero if any conditions were added.  Nothing is added if
+   some breakpoint at ADDR is unconditional, or if the conditions
+   don't all fit; the stub then simply reports every hit.  */
+
+static int
+remote_add_breakpoint_conditions (CORE_ADDR addr, char *p, int size)
+{
+  struct agent_expr **conds;
+  char *start = p;
+  int count, i;
+  int fits = 1;
+
+  count = breakpoint_conditions_at (addr, &conds);
+  if (count <= 0)
+    return 0;
+
+  for (i = 0; i < count; i++)
+    {
+      /* ";X", the length, ",", the hex bytes, and the null.  */
+      int needed = 2 + 8 + 1 + 2 * conds[i]->len + 1;
+
+      if (fits && (p - start) + needed <= size)
+	{
+	  p += sprintf (p, ";X%x,", conds[i]->len);
+	  bin2hex ((char *) conds[i]->buf, p, conds[i]->len);
+	  p += 2 * conds[i]->len;
+	}
+      else
+	fits = 0;
+      free_agent_expr (conds[i]);
+    }
+  xfree (conds);
+
+  if (!fits)
+    *start = '\0';
+  return fits;
+}
+
 /* Insert a breakpoint on targets that don't have any better
    breakpoint support.  We read the contents of the target location
    and stash it, then overwrite it with a breakpoint instruction.
@@ -5086,15 +5592,29 @@ remote_insert_breakpoint (CORE_ADDR addr, bfd_byte *contents_cache)
   if (remote_protocol_Z[Z_PACKET_SOFTWARE_BP].support != PACKET_DISABLE)
     {
       char *buf = alloca (rs->remote_packet_size);
-      char *p = buf;
+      char *p;
+      CORE_ADDR bp_addr;
+      int with_conds;
+      int retrying_without_conds = 0;
 
-      addr = remote_address_masked (addr);
+    retry:
+      p = buf;
+      bp_addr = remote_address_masked (addr);
       *(p++) = 'Z';
       *(p++) = '0';
       *(p++) = ',';
-      p += hexnumstr (p, (ULONGEST) addr);
-      BREAKPOINT_FROM_PC (&addr, &bp_size);
-      sprintf (p, ",%d", bp_size);
+      p += hexnumstr (p, (ULONGEST) bp_addr);
+      BREAKPOINT_FROM_PC (&bp_addr, &bp_size);
+      p += sprintf (p, ",%d", bp_size);
+
+      /* Let the stub evaluate the breakpoint conditions, so that it
+	 only reports the hits we would stop for.  We still check the
+	 condition ourselves when a hit is reported.  */
+      with_conds = 0;
+      if (remote_protocol_Z0_cond.support != PACKET_DISABLE
+	  && !retrying_without_conds)
+	with_conds = remote_add_breakpoint_conditions
+	  (addr, p, rs->remote_packet_size - (p - buf));
 
       putpkt (buf);
       getpkt (buf, (rs->remote_packet_size), 0);
@@ -5102,8 +5622,26 @@ remote_insert_breakpoint (CORE_ADDR addr, bfd_byte *contents_cache)
       switch (packet_ok (buf, &remote_protocol_Z[Z_PACKET_SOFTWARE_BP]))
 	{
 	case PACKET_ERROR:
+	  /* A stub that doesn't understand conditions may reject the
+	     whole packet; try once more without them.  Only if that
+	     works was it the conditions it objected to; otherwise the
+	     breakpoint itself can't be inserted, and we still don't
+	     know.  */
+	  if (with_conds
+	      && remote_protocol_Z0_cond.support == PACKET_SUPPORT_UNKNOWN)
+	    {
+	      retrying_without_conds = 1;
+	      goto retry;
+	    }
 	  return -1;
 	case PACKET_OK:
+	  if (remote_protocol_Z0_cond.support == PACKET_SUPPORT_UNKNOWN)
+	    {
+	      if (with_conds)
+		remote_protocol_Z0_cond.support = PACKET_ENABLE;
+	      else if (retrying_without_conds)
+		remote_protocol_Z0_cond.support = PACKET_DISABLE;
+	    }
 	  return 0;
 	case PACKET_UNKNOWN:
 	  break;
@@ -5433,6 +5971,43 @@ crc32 (unsigned char *buf, int len, unsigned int crc)
   return crc;
 }
 
+/* APPLE LOCAL begin verify memory */
+/* Compare the SIZE bytes at MEMADDR with DATA by asking the stub for
+   their CRC with a 'qCRC' packet, so that the memory needn't be read.
+   Return 1 if they match, 0 if they don't, and -1 if the stub can't
+   tell us.  */
+
+static int
+remote_verify_memory (struct target_ops *ops, const gdb_byte *data,
+		      CORE_ADDR memaddr, ULONGEST size)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *buf = alloca (rs->remote_packet_size);
+  unsigned long host_crc, target_crc;
+  char *tmp;
+
+  if (remote_protocol_qCRC.support == PACKET_DISABLE)
+    return -1;
+
+  xsnprintf (buf, rs->remote_packet_size, "qCRC:%s,%s",
+	     paddr_nz (remote_address_masked (memaddr)), paddr_nz (size));
+  putpkt (buf);
+
+  /* Compute the host's CRC while the stub computes its own.  */
+  host_crc = crc32 ((unsigned char *) data, size, 0xffffffff);
+
+  getpkt (buf, rs->remote_packet_size, 0);
+  if (packet_ok (buf, &remote_protocol_qCRC) != PACKET_OK
+      || buf[0] != 'C')
+    return -1;
+
+  for (target_crc = 0, tmp = &buf[1]; *tmp; tmp++)
+    target_crc = target_crc * 16 + fromhex (*tmp);
+
+  return host_crc == target_crc;
+}
+/* APPLE LOCAL end verify memory */
+
 /* compare-sections command
 
    With no arguments, compares each loadable section in the exec bfd
@@ -5940,6 +6515,120 @@ remote_get_thread_local_address (ptid_t ptid, CORE_ADDR lm, CORE_ADDR offset)
   return 0;
 }
 
+/* APPLE LOCAL begin search memory */
+/* Copy the LEN bytes at BUFFER to OUT_BUF, escaping the characters
+   that can't appear as themselves in a packet, without writing more
+   than OUT_MAXLEN bytes.  Set *OUT_LEN to the number of bytes written
+   and return the number of bytes of BUFFER copied.  */
+
+static int
+remote_escape_output (const gdb_byte *buffer, int len,
+		      gdb_byte *out_buf, int *out_len, int out_maxlen)
+{
+  int input_index, output_index;
+
+  output_index = 0;
+  for (input_index = 0; input_index < len; input_index++)
+    {
+      gdb_byte b = buffer[input_index];
+
+      if (b == '$' || b == '#' || b == '}' || b == '*')
+	{
+	  if (output_index + 2 > out_maxlen)
+	    break;
+	  out_buf[output_index++] = '}';
+	  out_buf[output_index++] = b ^ 0x20;
+	}
+      else
+	{
+	  if (output_index + 1 > out_maxlen)
+	    break;
+	  out_buf[output_index++] = b;
+	}
+    }
+
+  *out_len = output_index;
+  return input_index;
+}
+
+/* Search memory in the stub with the 'qSearch:memory' packet, so that
+   the memory itself never has to come across the link.  Fall back to
+   reading it if the stub doesn't support the packet, or the pattern
+   won't fit in one.  */
+
+static int
+remote_search_memory (struct target_ops *ops,
+		      CORE_ADDR start_addr, ULONGEST search_space_len,
+		      const gdb_byte *pattern, ULONGEST pattern_len,
+		      CORE_ADDR *found_addrp)
+{
+  struct remote_state *rs = get_remote_state ();
+  long max_size = rs->remote_packet_size;
+  char *buf = alloca (max_size + 1);
+  char *p;
+  int escaped_pattern_len;
+  int used_pattern_len;
+  ULONGEST found_addr;
+
+  /* Don't go to the target if we don't have to.  */
+  if (pattern_len > search_space_len)
+    return 0;
+  if (pattern_len == 0)
+    {
+      *found_addrp = start_addr;
+      return 1;
+    }
+
+  if (remote_protocol_qSearch_memory.support == PACKET_DISABLE)
+    return simple_search_memory (ops, start_addr, search_space_len,
+				 pattern, pattern_len, found_addrp);
+
+  /* "qSearch:memory:<addr>;<length>;<pattern>".  */
+  p = buf;
+  strcpy (p, "qSearch:memory:");
+  p += strlen (p);
+  p += hexnumstr (p, (ULONGEST) remote_address_masked (start_addr));
+  *p++ = ';';
+  p += hexnumstr (p, search_space_len);
+  *p++ = ';';
+
+  /* Leave room for the "$", "#nn" and the trailing NUL.  */
+  used_pattern_len = remote_escape_output (pattern, pattern_len,
+					   (gdb_byte *) p,
+					   &escaped_pattern_len,
+					   max_size - (p - buf) - 4);
+  if (used_pattern_len != pattern_len)
+    return simple_search_memory (ops, start_addr, search_space_len,
+				 pattern, pattern_len, found_addrp);
+  p += escaped_pattern_len;
+
+  putpkt_binary (buf, p - buf);
+  getpkt (buf, max_size, 0);
+
+  switch (packet_ok (buf, &remote_protocol_qSearch_memory))
+    {
+    case PACKET_UNKNOWN:
+      return simple_search_memory (ops, start_addr, search_space_len,
+				   pattern, pattern_len, found_addrp);
+    case PACKET_ERROR:
+      error (_("Unable to search memory on the remote target."));
+    case PACKET_OK:
+      break;
+    }
+
+  if (buf[0] == '0' && buf[1] == '\0')
+    return 0;
+  if (buf[0] == '1' && buf[1] == ',')
+    {
+      unpack_varlen_hex (buf + 2, &found_addr);
+      *found_addrp = found_addr;
+      return 1;
+    }
+
+  error (_("Unknown qSearch:memory reply: %s"), buf);
+}
+/* APPLE LOCAL end search memory */
+
 static void
 init_remote_ops (void)
 {
@@ -5978,6 +6667,10 @@ Specify the serial device it is connected to\n\
   remote_ops.to_extra_thread_info = remote_threads_extra_info;
   remote_ops.to_stop = remote_stop;
   remote_ops.to_xfer_partial = remote_xfer_partial;
+  /* APPLE LOCAL search memory */
+  remote_ops.to_search_memory = remote_search_memory;
+  /* APPLE LOCAL verify memory */
+  remote_ops.to_verify_memory = remote_verify_memory;
   remote_ops.to_rcmd = remote_rcmd;
   remote_ops.to_get_thread_local_address = remote_get_thread_local_address;
   remote_ops.to_stratum = process_stratum;
@@ -6106,6 +6799,10 @@ Specify the serial device it is connected to (e.g. /dev/ttya).";
   remote_async_ops.to_extra_thread_info = remote_threads_extra_info;
   remote_async_ops.to_stop = remote_stop;
   remote_async_ops.to_xfer_partial = remote_xfer_partial;
+  /* APPLE LOCAL search memory */
+  remote_async_ops.to_search_memory = remote_search_memory;
+  /* APPLE LOCAL verify memory */
+  remote_async_ops.to_verify_memory = remote_verify_memory;
   remote_async_ops.to_rcmd = remote_rcmd;
   remote_async_ops.to_stratum = process_stratum;
   remote_async_ops.to_has_all_memory = 1;
@@ -6158,6 +6855,13 @@ show_remote_cmd (char *args, int from_tty)
   show_remote_protocol_binary_download_cmd (gdb_stdout, from_tty, NULL, NULL);
   show_remote_protocol_qPart_auxv_packet_cmd (gdb_stdout, from_tty, NULL, NULL);
   show_remote_protocol_qGetTLSAddr_packet_cmd (gdb_stdout, from_tty, NULL, NULL);
+  show_remote_protocol_Z0_cond_packet_cmd (gdb_stdout, from_tty, NULL, NULL);
+  show_remote_protocol_QExpedite_packet_cmd (gdb_stdout, from_tty, NULL, NULL);
+  /* APPLE LOCAL search memory */
+  show_remote_protocol_qSearch_memory_packet_cmd (gdb_stdout, from_tty,
+						  NULL, NULL);
+  /* APPLE LOCAL verify memory */
+  show_remote_protocol_qCRC_packet_cmd (gdb_stdout, from_tty, NULL, NULL);
   show_max_remote_packet_size (NULL, from_tty);
 }
 
@@ -6852,6 +7556,19 @@ further restriction and ``limit'' to enable that restriction."),
 	   _("Show the maximum number of bytes per memory-read packet."),
 	   &remote_show_cmdlist);
 
+  add_setshow_zinteger_cmd ("memory-read-window", no_class,
+			    &remote_memory_read_window, _("\
+Set the number of memory-read packets to keep in flight."), _("\
+Show the number of memory-read packets to keep in flight."), _("\
+Large memory reads are split into several packets.  When this is more\n\
+than one and the connection is in no-ack mode (see \"set remote\n\
+noack-mode\"), GDB sends this many requests before waiting for the\n\
+first reply, so that the round-trip time of the link is paid once\n\
+per window rather than once per packet."),
+			    NULL,
+			    show_remote_memory_read_window,
+			    &remote_set_cmdlist, &remote_show_cmdlist);
+
   add_setshow_zinteger_cmd ("hardware-watchpoint-limit", no_class,
 			    &remote_hw_watchpoint_limit, _("\
 Set the maximum number of target hardware watchpoints."), _("\
@@ -6959,6 +7676,59 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
 			 &remote_set_cmdlist, &remote_show_cmdlist,
 			 0);
 
+  add_packet_config_cmd (&remote_protocol_Z0_cond,
+			 "Z0;X", "conditional-breakpoints",
+			 set_remote_protocol_Z0_cond_packet_cmd,
+			 show_remote_protocol_Z0_cond_packet_cmd,
+			 &remote_set_cmdlist, &remote_show_cmdlist,
+			 0);
+
+  add_packet_config_cmd (&remote_protocol_QExpedite,
+			 "QExpedite", "expedite-registers",
+			 set_remote_protocol_QExpedite_packet_cmd,
+			 show_remote_protocol_QExpedite_packet_cmd,
+			 &remote_set_cmdlist, &remote_show_cmdlist,
+			 0);
+
+  /* APPLE LOCAL search memory */
+  add_packet_config_cmd (&remote_protocol_qSearch_memory,
+			 "qSearch:memory", "search-memory",
+			 set_remote_protocol_qSearch_memory_packet_cmd,
+			 show_remote_protocol_qSearch_memory_packet_cmd,
+			 &remote_set_cmdlist, &remote_show_cmdlist,
+			 0);
+
+  /* APPLE LOCAL verify memory */
+  add_packet_config_cmd (&remote_protocol_qCRC,
+			 "qCRC", "verify-memory",
+			 set_remote_protocol_qCRC_packet_cmd,
+			 show_remote_protocol_qCRC_packet_cmd,
+			 &remote_set_cmdlist, &remote_show_cmdlist,
+			 0);
+
+  add_setshow_string_noescape_cmd ("expedite-registers", class_obscure,
+				   &remote_expedite_registers, _("\
+Set the registers the remote stub should send when the target stops."), _("\
+Show the registers the remote stub should send when the target stops."), _("\
+A list of register names, or \"all\".  The values of these registers come\n\
+with each stop reply, so reading them costs no further packets.  An\n\
+empty list leaves the choice to the stub."),
+				   set_remote_expedite_registers_command,
+				   show_remote_expedite_registers_command,
+				   &remote_set_cmdlist, &remote_show_cmdlist);
+
+  add_setshow_boolean_cmd ("prefetch-registers", class_obscure,
+			   &remote_prefetch_registers, _("\
+Set whether to read all registers when one is wanted."), _("\
+Show whether to read all registers when one is wanted."), _("\
+When on, reading a register the stop reply didn't include fetches all\n\
+the registers with one `g' packet, so the others GDB reads while the\n\
+target is stopped cost no further packets.  When off, GDB reads single\n\
+registers with the `p' packet if the stub supports it."),
+			   NULL,
+			   show_remote_prefetch_registers,
+			   &remote_set_cmdlist, &remote_show_cmdlist);
+
   /* Keep the old ``set remote Z-packet ...'' working.  */
   add_setshow_auto_boolean_cmd ("Z-packet", class_obscure,
 				&remote_Z_packet_detect, _("\
@@ -7011,4 +7781,8 @@ with the same name as the exec-file, but in the location given by this variable.
   /* APPLE LOCAL */
   add_cmd ("dump-packets", class_maintenance, dump_packets_command,
            "Print the packet log buffer.", &maintenancelist);
+
+  add_cmd ("remote-stats", class_maintenance, maintenance_print_remote_stats,
+	   _("Print the number of remote packets sent per target stop."),
+	   &maintenanceprintlist);
 }
@@ -228,6 +228,8 @@ solib_add_common_symbols (CORE_ADDR rtc_symp)
       obstack_init (&rt_common_objfile->objfile_obstack);
       rt_common_objfile->minimal_symbol_count = 0;
       rt_common_objfile->msymbols = NULL;
+      /* APPLE LOCAL minsym address table  */
+      free_minimal_symbol_address_table (rt_common_objfile);
       terminate_minimal_symbol_table (rt_common_objfile);
     }
 
@@ -649,6 +649,25 @@ solib_add (char *pattern, int from_tty, struct target_ops *target, int readsyms)
   {
     int any_matches = 0;
     int loaded_any_symbols = 0;
+    /* APPLE LOCAL begin symbol prefetch */
+    struct cleanup *back_to;
+    bfd **bfds = NULL;
+    int n_bfds = 0;
+
+    if (readsyms)
+      {
+	for (gdb = so_list_head; gdb; gdb = gdb->next)
+	  n_bfds++;
+	bfds = xmalloc ((n_bfds + 1) * sizeof (bfd *));
+	n_bfds = 0;
+	for (gdb = so_list_head; gdb; gdb = gdb->next)
+	  if (!gdb->symbols_loaded && gdb->abfd != NULL
+	      && (! pattern || re_exec (gdb->so_name)))
+	    bfds[n_bfds++] = gdb->abfd;
+      }
+    back_to = make_cleanup (xfree, bfds);
+    symbol_prefetch_bfds (bfds, n_bfds);
+    /* APPLE LOCAL end symbol prefetch */
 
     for (gdb = so_list_head; gdb; gdb = gdb->next)
       if (! pattern || re_exec (gdb->so_name))
@@ -658,6 +677,9 @@ solib_add (char *pattern, int from_tty, struct target_ops *target, int readsyms)
 	    loaded_any_symbols = 1;
 	}
 
+    /* APPLE LOCAL symbol prefetch */
+    do_cleanups (back_to);
+
     if (from_tty && pattern && ! any_matches)
       printf_unfiltered
 	("No loaded shared libraries match the pattern `%s'.\n", pattern);
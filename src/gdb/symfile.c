@@ -70,6 +70,10 @@
 #include <libgen.h>
 
 #include <sys/mman.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <signal.h>
+#endif
 
 #ifndef TEXT_SECTION_NAME
 #define TEXT_SECTION_NAME ".text"
@@ -289,6 +293,10 @@ sort_pst_symbols (struct partial_symtab *pst)
   qsort (pst->objfile->global_psymbols.list + pst->globals_offset,
 	 pst->n_global_syms, sizeof (struct partial_symbol *),
 	 compare_psymbols);
+
+  /* APPLE LOCAL: PST's symbols are final now, so the objfile's
+     psymtab name index has to be rebuilt to include them.  */
+  objfile_invalidate_psymtab_name_index (pst->objfile);
 }
 
 /* Make a null terminated copy of the string at PTR with SIZE characters in
@@ -944,7 +952,7 @@ syms_from_objfile (struct objfile *objfile,
   
   /* APPLE LOCAL: Since we might be changing the section 
      offsets for the objfile, we need to delete it from the
-     ordered sections array & put it back in later.  */
+     ordered sections tree & put it back in later.  */
 
   objfile_delete_from_ordered_sections (objfile);
   if (addrs)
@@ -1051,6 +1059,8 @@ syms_from_objfile (struct objfile *objfile,
      symfile read fn.  */
   if ((objfile->symflags & ~OBJF_SYM_CONTAINER) & OBJF_SYM_LEVELS_MASK)
     (*objfile->sf->sym_read) (objfile, mainline);
+  /* APPLE LOCAL cache lookup values for improved performance  */
+  objfile_generation++;
 
   /* Don't allow char * to have a typename (else would get caddr_t).
      Ditto void *.  FIXME: Check whether this is now done by all the
@@ -1383,6 +1393,8 @@ replace_psymbols_with_correct_psymbols (struct objfile *exe_obj)
      provide a good example of what is possible to do.  */
 
   dsym_obj->psymtabs = NULL;
+  /* APPLE LOCAL psymtab name index  */
+  objfile_invalidate_psymtab_name_index (dsym_obj);
 
   ALL_OBJFILE_PSYMTABS (exe_obj, exe_pst)
     {
@@ -1465,11 +1477,14 @@ replace_psymbols_with_correct_psymbols (struct objfile *exe_obj)
 
   exe_obj->psymtabs = NULL;
   exe_obj->symtabs = NULL;
+  /* APPLE LOCAL psymtab name index  */
+  objfile_invalidate_psymtab_name_index (exe_obj);
+  objfile_invalidate_psymtab_name_index (dsym_obj);
 
   tell_breakpoints_objfile_changed (dsym_obj);
   tell_objc_msgsend_cacher_objfile_changed (dsym_obj);
   /* APPLE LOCAL cache lookup values for improved performance  */
-  symtab_clear_cached_lookup_values ();
+  objfile_generation++;
 }
 
 
@@ -1939,7 +1954,7 @@ symbol_file_clear (int from_tty)
   /* APPLE LOCAL end Darwin */
 
   /* APPLE LOCAL cache lookup values for improved performance  */
-  symtab_clear_cached_lookup_values ();
+  objfile_generation++;
 
     /* solib descriptors may have handles to objfiles.  Since their
        storage has just been released, we'd better wipe the solib
@@ -2419,6 +2434,29 @@ The write size used when downloading a program is %s.\n"),
 }
 static int validate_download = 0;
 
+/* APPLE LOCAL begin download delta */
+/* When set, "load" asks the target which parts of each section it
+   already holds, and only writes the blocks that differ.  */
+static int download_delta = 0;
+
+/* The size of the blocks "load" writes or skips in delta mode.  */
+static unsigned int download_delta_block_size = 4096;
+
+/* What "set download-delta-block-size" stores.  It is checked before
+   it is copied to download_delta_block_size.  */
+static int download_delta_block_size_setting = 4096;
+
+/* The largest range "load" asks the target about at once in delta
+   mode, in blocks, so the target isn't kept busy checksumming a huge
+   section for longer than the remote timeout.  */
+#define DOWNLOAD_DELTA_MAX_BLOCKS 256
+
+/* How many blocks of a range that differs "load" checks in delta mode
+   before it may decide that most of the range differs and write the
+   rest of it unchecked.  */
+#define DOWNLOAD_DELTA_MIN_CHECKED 4
+/* APPLE LOCAL end download delta */
+
 /* Callback service function for generic_load (bfd_map_over_sections).  */
 
 static void
@@ -2435,6 +2473,8 @@ struct load_section_data {
   unsigned long write_count;
   unsigned long data_count;
   bfd_size_type total_size;
+  /* APPLE LOCAL download delta */
+  unsigned long unchanged_count;
 
   /* Per-section data for load_progress.  */
   const char *section_name;
@@ -2490,6 +2530,102 @@ load_progress (ULONGEST bytes, void *untyped_arg)
 				   args->total_size);
 }
 
+/* APPLE LOCAL begin download delta */
+/* Write the SIZE bytes at BUFFER to the target at LMA.  */
+
+static void
+load_section_write (struct load_section_data *args, gdb_byte *buffer,
+		    CORE_ADDR lma, ULONGEST size)
+{
+  LONGEST transferred;
+
+  args->lma = lma;
+  args->buffer = buffer;
+  transferred = target_write_with_progress (&current_target,
+					    TARGET_OBJECT_MEMORY,
+					    NULL, buffer, lma,
+					    size, load_progress, args);
+  if (transferred < size)
+    error (_("Memory access error while loading section %s."),
+	   args->section_name);
+}
+
+/* Write the SIZE bytes at BUFFER to the target at LMA, skipping what
+   the target already holds.  The whole range is checked first; if it
+   differs, each block is checked in turn, and runs of blocks that
+   differ are written together.  Once more than half of the blocks
+   checked have differed, as when code has moved after a small
+   change, the rest of the range is written without checking it.  If
+   the target can't compare memory, the whole range is written.  */
+
+static void
+load_section_delta (struct load_section_data *args, gdb_byte *buffer,
+		    CORE_ADDR lma, ULONGEST size)
+{
+  ULONGEST block = download_delta_block_size;
+  ULONGEST offset;
+  ULONGEST run_start = 0;
+  ULONGEST run_len = 0;
+  unsigned int checked = 0;
+  unsigned int differed = 0;
+  int same;
+
+  QUIT;
+
+  same = target_verify_memory (buffer, lma, size);
+  if (same > 0)
+    {
+      args->unchanged_count += size;
+      args->section_sent += size;
+      return;
+    }
+
+  if (same < 0 || size <= block)
+    {
+      load_section_write (args, buffer, lma, size);
+      return;
+    }
+
+  for (offset = 0; offset < size; offset += block)
+    {
+      ULONGEST len = min (block, size - offset);
+
+      if (checked >= DOWNLOAD_DELTA_MIN_CHECKED && differed * 2 > checked)
+	{
+	  /* Most of what was checked differs; checking the rest would
+	     cost more than writing it.  */
+	  if (run_len == 0)
+	    run_start = offset;
+	  run_len += size - offset;
+	  break;
+	}
+
+      QUIT;
+      same = target_verify_memory (buffer + offset, lma + offset, len);
+      checked++;
+      if (same > 0)
+	{
+	  if (run_len != 0)
+	    load_section_write (args, buffer + run_start, lma + run_start,
+				run_len);
+	  run_len = 0;
+	  args->unchanged_count += len;
+	  args->section_sent += len;
+	}
+      else
+	{
+	  differed++;
+	  if (run_len == 0)
+	    run_start = offset;
+	  run_len += len;
+	}
+    }
+
+  if (run_len != 0)
+    load_section_write (args, buffer + run_start, lma + run_start, run_len);
+}
+/* APPLE LOCAL end download delta */
+
 /* Callback service function for generic_load (bfd_map_over_sections).  */
 
 static void
@@ -2500,7 +2636,7 @@ load_section_callback (bfd *abfd, asection *asec, void *data)
   gdb_byte *buffer;
   struct cleanup *old_chain;
   const char *sect_name = bfd_get_section_name (abfd, asec);
-  LONGEST transferred;
+  CORE_ADDR lma;
 
   if ((bfd_get_section_flags (abfd, asec) & SEC_LOAD) == 0)
     return;
@@ -2524,17 +2660,40 @@ load_section_callback (bfd *abfd, asection *asec, void *data)
 
   bfd_get_section_contents (abfd, asec, buffer, 0, size);
 
-  transferred = target_write_with_progress (&current_target,
-					    TARGET_OBJECT_MEMORY,
-					    NULL, buffer, args->lma,
-					    size, load_progress, args);
-  if (transferred < size)
-    error (_("Memory access error while loading section %s."),
-	   sect_name);
+  /* APPLE LOCAL begin download delta */
+  lma = args->lma;
+  if (download_delta)
+    {
+      ULONGEST max_piece = ((ULONGEST) download_delta_block_size
+			    * DOWNLOAD_DELTA_MAX_BLOCKS);
+      ULONGEST offset;
+
+      for (offset = 0; offset < size; offset += max_piece)
+	load_section_delta (args, buffer + offset, lma + offset,
+			    min (max_piece, size - offset));
+    }
+  else
+    load_section_write (args, buffer, lma, size);
+  /* APPLE LOCAL end download delta */
 
   do_cleanups (old_chain);
 }
 
+/* APPLE LOCAL begin download delta */
+static void
+set_download_delta_block_size (char *args, int from_tty,
+			       struct cmd_list_element *c)
+{
+  if (download_delta_block_size_setting < 1)
+    {
+      download_delta_block_size_setting = download_delta_block_size;
+      error (_("The download delta block size must be at least one byte."));
+    }
+
+  download_delta_block_size = download_delta_block_size_setting;
+}
+/* APPLE LOCAL end download delta */
+
 void
 generic_load (char *args, int from_tty)
 {
@@ -2550,6 +2709,8 @@ generic_load (char *args, int from_tty)
   cbdata.write_count = 0;	/* Number of writes needed. */
   cbdata.data_count = 0;	/* Number of bytes written to target memory. */
   cbdata.total_size = 0;	/* Total size of all bfd sectors. */
+  /* APPLE LOCAL download delta */
+  cbdata.unchanged_count = 0;	/* Bytes the target already held. */
 
   /* Parse the input argument - the user can specify a load offset as
      a second argument. */
@@ -2602,6 +2763,14 @@ generic_load (char *args, int from_tty)
   ui_out_field_fmt (uiout, "address", "0x%s", paddr_nz (entry));
   ui_out_text (uiout, ", load size ");
   ui_out_field_fmt (uiout, "load-size", "%lu", cbdata.data_count);
+  /* APPLE LOCAL begin download delta */
+  if (download_delta)
+    {
+      ui_out_text (uiout, ", unchanged size ");
+      ui_out_field_fmt (uiout, "unchanged-size", "%lu",
+			cbdata.unchanged_count);
+    }
+  /* APPLE LOCAL end download delta */
   ui_out_text (uiout, "\n");
   /* We were doing this in remote-mips.c, I suspect it is right
      for other targets too.  */
@@ -3473,7 +3642,7 @@ reread_symbols_for_objfile (struct objfile *objfile, long new_modtime,
   tell_objc_msgsend_cacher_objfile_changed (objfile);
 
   /* APPLE LOCAL cache lookup values for improved performance  */
-  symtab_clear_cached_lookup_values ();
+  objfile_generation++;
   /* APPLE LOCAL: Remove it's obj_sections from the 
      ordered_section list.  */
   objfile_delete_from_ordered_sections (objfile);
@@ -3597,8 +3766,12 @@ reread_symbols_for_objfile (struct objfile *objfile, long new_modtime,
   objfile->symtabs = NULL;
   objfile->psymtabs = NULL;
   objfile->free_psymtabs = NULL;
+  /* APPLE LOCAL psymtab name index  */
+  objfile_invalidate_psymtab_name_index (objfile);
   objfile->cp_namespace_symtab = NULL;
   objfile->msymbols = NULL;
+  /* APPLE LOCAL minsym address table  */
+  free_minimal_symbol_address_table (objfile);
   objfile->deprecated_sym_private = NULL;
   objfile->minimal_symbol_count = 0;
   memset (&objfile->msymbol_hash, 0,
@@ -3675,6 +3848,8 @@ reread_symbols_for_objfile (struct objfile *objfile, long new_modtime,
      objfile->global_psymbols.size is 0.  */
   if ((objfile->symflags & ~OBJF_SYM_CONTAINER) & OBJF_SYM_LEVELS_MASK)
     (*objfile->sf->sym_read) (objfile, 0);
+  /* APPLE LOCAL cache lookup values for improved performance  */
+  objfile_generation++;
   /* APPLE LOCAL don't complain about lack of symbols */
   objfile->flags |= OBJF_SYMS;
 
@@ -3855,7 +4030,7 @@ remove_symbol_file_command (args, from_tty)
   free_objfile (objfile);
 
   /* APPLE LOCAL cache lookup values for improved performance  */
-  symtab_clear_cached_lookup_values ();
+  objfile_generation++;
   clear_symtab_users ();
 
   /* changing symbols may change our opinion about what is frameless.  */
@@ -4223,6 +4398,8 @@ allocate_psymtab (char *filename, struct objfile *objfile)
   psymtab->objfile = objfile;
   psymtab->next = objfile->psymtabs;
   objfile->psymtabs = psymtab;
+  /* APPLE LOCAL psymtab name index  */
+  objfile_invalidate_psymtab_name_index (objfile);
 #if 0
   {
     struct partial_symtab **prev_pst;
@@ -4264,6 +4441,8 @@ discard_psymtab (struct partial_symtab *pst)
   while ((*prev_pst) != pst)
     prev_pst = &((*prev_pst)->next);
   (*prev_pst) = pst->next;
+  /* APPLE LOCAL psymtab name index  */
+  objfile_invalidate_psymtab_name_index (pst->objfile);
 
   /* Next, put it on a free list for recycling */
 
@@ -4370,6 +4549,8 @@ cashier_psymtab (struct partial_symtab *pst)
 	pst->objfile->psymtabs = ps->next;
       else
 	pprev->next = ps->next;
+      /* APPLE LOCAL psymtab name index  */
+      objfile_invalidate_psymtab_name_index (pst->objfile);
 
       /* FIXME, we can't conveniently deallocate the entries in the
          partial_symbol lists (global_psymbols/static_psymbols) that
@@ -4984,13 +5165,6 @@ find_pc_overlay (CORE_ADDR pc)
   struct objfile *objfile;
   struct obj_section *osect, *best_match = NULL;
 
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-  if (pc == last_overlay_section_lookup_pc)
-    return cached_overlay_section;
-
-  last_overlay_section_lookup_pc = pc;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
-
   if (overlay_debugging)
     ALL_OBJSECTIONS (objfile, osect)
       if (section_is_overlay (osect->the_bfd_section))
@@ -4998,13 +5172,7 @@ find_pc_overlay (CORE_ADDR pc)
 	if (pc_in_mapped_range (pc, osect->the_bfd_section))
 	  {
 	    if (overlay_is_mapped (osect))
-	      /* APPLE LOCAL begin cache lookup values for improved 
-		 performance  */
-	      {
-		cached_overlay_section = osect->the_bfd_section;
-		return osect->the_bfd_section;
-	      }
-	    /* APPLE LOCAL end cache lookup values for improved performance  */
+	      return osect->the_bfd_section;
 	    else
 	      best_match = osect;
 	  }
@@ -5012,10 +5180,8 @@ find_pc_overlay (CORE_ADDR pc)
 	  best_match = osect;
       }
 
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-  cached_overlay_section = best_match ? best_match->the_bfd_section : NULL;
   return best_match ? best_match->the_bfd_section : NULL;
-  /* APPLE LOCAL end cache lookup values for improved performance  */}
+}
 
 /* Function: find_pc_mapped_section (PC)
    If PC falls into the VMA address range of an overlay section that is
@@ -5027,26 +5193,12 @@ find_pc_mapped_section (CORE_ADDR pc)
   struct objfile *objfile;
   struct obj_section *osect;
 
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-  if (pc == last_mapped_section_lookup_pc)
-    return cached_mapped_section;
-
-  last_mapped_section_lookup_pc = pc;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
-
   if (overlay_debugging)
     ALL_OBJSECTIONS (objfile, osect)
       if (pc_in_mapped_range (pc, osect->the_bfd_section) &&
 	  overlay_is_mapped (osect))
-        /* APPLE LOCAL begin cache lookup values for improved performance  */
-	{
-	  cached_mapped_section = osect->the_bfd_section;
-	  return osect->the_bfd_section;
-	}
+	return osect->the_bfd_section;
 
-  last_mapped_section_lookup_pc = INVALID_ADDRESS;
-  cached_mapped_section = NULL;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
   return NULL;
 }
 
@@ -5824,6 +5976,260 @@ open_bfd_matching_arch (bfd *archive_bfd, bfd_format expected_format,
 #endif	/* defined (TARGET_ARM) && defined (TM_NEXTSTEP)  */
 }
 
+/* APPLE LOCAL begin symbol prefetch */
+
+/* Reading the symbols of a large number of shared libraries is
+   dominated by reading their debug and symbol sections off the disk,
+   one library after another.  The symbol readers themselves can't run
+   concurrently -- they share the objfile list, the demangler, the
+   complaint machinery, the psymbol bcache, and dwarf2read's file-scope
+   section and per-objfile pointers, and they report errors by longjmp
+   -- so building partial symtabs on several threads would mean
+   rewriting each of them.  The reads they are about to do are
+   independent of one another, though.  So when we are handed a batch of
+   libraries, we start a pool of worker threads that read the sections
+   of each library, in load order, into the host's file cache.  The
+   main thread then builds the partial symtabs for the libraries one
+   at a time and in order, as it always has, mostly without waiting
+   for the disk.  The workers only ever read files; they touch no GDB
+   state and their results are never consulted, so the symbols we end
+   up with don't depend on how the threads are scheduled.  */
+
+/* The number of prefetch threads to start for a batch of libraries.
+   Zero, the default, disables prefetching.  */
+static int symbol_prefetch_threads = 0;
+
+static void
+show_symbol_prefetch_threads (struct ui_file *file, int from_tty,
+			      struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("\
+The number of threads prefetching symbol files is %s.\n"),
+		    value);
+}
+
+#ifdef HAVE_PTHREAD_H
+
+/* One range of a file for the prefetch threads to read.  */
+
+struct symbol_prefetch_job
+{
+  char *filename;
+  file_ptr filepos;
+  bfd_size_type size;
+};
+
+/* The state shared between the main thread and the prefetch threads.
+   Everything but THREADS and N_THREADS is protected by LOCK.  */
+
+struct symbol_prefetch
+{
+  pthread_mutex_t lock;
+
+  /* The ranges to read, in the order the libraries will be loaded.  */
+  struct symbol_prefetch_job *jobs;
+  int n_jobs;
+
+  /* The next job to hand out.  */
+  int next_job;
+
+  /* Set when the main thread is done with the batch.  */
+  int cancelled;
+
+  pthread_t *threads;
+  int n_threads;
+};
+
+#define SYMBOL_PREFETCH_CHUNK (1024 * 1024)
+
+/* The body of a prefetch thread.  Take jobs off the queue in order,
+   and read each range into a scratch buffer.  Only libc calls here:
+   no xmalloc, no error.  */
+
+static void *
+symbol_prefetch_thread (void *arg)
+{
+  struct symbol_prefetch *pf = (struct symbol_prefetch *) arg;
+  char *buf;
+  char *open_name = NULL;
+  int fd = -1;
+
+  buf = malloc (SYMBOL_PREFETCH_CHUNK);
+  if (buf == NULL)
+    return NULL;
+
+  for (;;)
+    {
+      struct symbol_prefetch_job *job;
+      bfd_size_type done;
+      int cancelled;
+
+      pthread_mutex_lock (&pf->lock);
+      if (pf->cancelled || pf->next_job >= pf->n_jobs)
+	job = NULL;
+      else
+	job = &pf->jobs[pf->next_job++];
+      pthread_mutex_unlock (&pf->lock);
+
+      if (job == NULL)
+	break;
+
+      /* Consecutive jobs are usually sections of the same file.  */
+      if (open_name == NULL || strcmp (open_name, job->filename) != 0)
+	{
+	  if (fd >= 0)
+	    close (fd);
+	  fd = open (job->filename, O_RDONLY);
+	  open_name = job->filename;
+	}
+      if (fd < 0)
+	continue;
+
+      for (done = 0; done < job->size; )
+	{
+	  size_t len = SYMBOL_PREFETCH_CHUNK;
+	  ssize_t got;
+
+	  if (job->size - done < len)
+	    len = job->size - done;
+	  got = pread (fd, buf, len, job->filepos + done);
+	  if (got <= 0)
+	    break;
+	  done += got;
+
+	  pthread_mutex_lock (&pf->lock);
+	  cancelled = pf->cancelled;
+	  pthread_mutex_unlock (&pf->lock);
+	  if (cancelled)
+	    break;
+	}
+    }
+
+  if (fd >= 0)
+    close (fd);
+  free (buf);
+  return NULL;
+}
+
+/* Queue a job for each section of ABFD a symbol reader reads from
+   the file: the debug sections, and anything else that isn't loaded
+   into the inferior, such as the symbol table.  */
+
+static void
+symbol_prefetch_add_jobs (struct symbol_prefetch *pf, int *allocated,
+			  bfd *abfd)
+{
+  asection *sect;
+  char *filename;
+  file_ptr origin = abfd->origin;
+
+  /* Only plain files (or members of fat files) that we can open by
+     name.  */
+  if (abfd->flags & BFD_IN_MEMORY)
+    return;
+  if (abfd->my_archive != NULL)
+    {
+      if (abfd->my_archive->flags & BFD_IN_MEMORY)
+	return;
+      filename = (char *) bfd_get_filename (abfd->my_archive);
+    }
+  else
+    filename = (char *) bfd_get_filename (abfd);
+  if (filename == NULL)
+    return;
+
+  for (sect = abfd->sections; sect != NULL; sect = sect->next)
+    {
+      flagword flags = bfd_get_section_flags (abfd, sect);
+
+      if (!(flags & SEC_HAS_CONTENTS)
+	  || ((flags & SEC_LOAD) && !(flags & SEC_DEBUGGING))
+	  || bfd_get_section_size (sect) == 0)
+	continue;
+
+      if (pf->n_jobs == *allocated)
+	{
+	  *allocated = *allocated ? 2 * *allocated : 64;
+	  pf->jobs = xrealloc (pf->jobs, *allocated * sizeof (*pf->jobs));
+	}
+      pf->jobs[pf->n_jobs].filename = filename;
+      pf->jobs[pf->n_jobs].filepos = origin + sect->filepos;
+      pf->jobs[pf->n_jobs].size = bfd_get_section_size (sect);
+      pf->n_jobs++;
+    }
+}
+
+/* Stop the prefetch threads started by symbol_prefetch_bfds, wait for
+   them, and free everything.  */
+
+static void
+symbol_prefetch_cleanup (void *arg)
+{
+  struct symbol_prefetch *pf = (struct symbol_prefetch *) arg;
+  int i;
+
+  pthread_mutex_lock (&pf->lock);
+  pf->cancelled = 1;
+  pthread_mutex_unlock (&pf->lock);
+
+  for (i = 0; i < pf->n_threads; i++)
+    pthread_join (pf->threads[i], NULL);
+
+  pthread_mutex_destroy (&pf->lock);
+  xfree (pf->threads);
+  xfree (pf->jobs);
+  xfree (pf);
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+/* Start prefetching the symbol files of the COUNT bfds in BFDS, which
+   the caller is about to read symbols from, in that order.  Return a
+   cleanup which stops the prefetching; the caller should run it once
+   it has read the symbols.  The bfds must stay open until then.  */
+
+struct cleanup *
+symbol_prefetch_bfds (bfd **bfds, int count)
+{
+#ifdef HAVE_PTHREAD_H
+  struct symbol_prefetch *pf;
+  sigset_t all_signals, old_signals;
+  int allocated = 0;
+  int i;
+
+  /* With one library there's nothing to overlap the reads with.  */
+  if (symbol_prefetch_threads <= 0 || count < 2)
+    return make_cleanup (null_cleanup, NULL);
+
+  pf = XZALLOC (struct symbol_prefetch);
+  for (i = 0; i < count; i++)
+    if (bfds[i] != NULL)
+      symbol_prefetch_add_jobs (pf, &allocated, bfds[i]);
+
+  pthread_mutex_init (&pf->lock, NULL);
+  pf->threads = xmalloc (symbol_prefetch_threads * sizeof (pthread_t));
+
+  /* The threads inherit the signal mask.  Start them with every signal
+     blocked, so that SIGINT, SIGCHLD and the rest still go to GDB's
+     own thread and its handlers.  */
+  sigfillset (&all_signals);
+  pthread_sigmask (SIG_SETMASK, &all_signals, &old_signals);
+  for (i = 0; i < symbol_prefetch_threads && i < pf->n_jobs; i++)
+    {
+      if (pthread_create (&pf->threads[i], NULL,
+			  symbol_prefetch_thread, pf) != 0)
+	break;
+      pf->n_threads++;
+    }
+  pthread_sigmask (SIG_SETMASK, &old_signals, NULL);
+
+  return make_cleanup (symbol_prefetch_cleanup, pf);
+#else
+  return make_cleanup (null_cleanup, NULL);
+#endif
+}
+/* APPLE LOCAL end symbol prefetch */
+
 void
 _initialize_symfile (void)
 {
@@ -5896,6 +6302,17 @@ for access from GDB."), &cmdlist);
   set_cmd_completer (c, filename_completer);
   /* c->completer_word_break_characters = gdb_completer_filename_word_break_characters; */ /* FIXME */
 
+  add_setshow_zinteger_cmd ("symbol-prefetch-threads", class_support,
+			    &symbol_prefetch_threads, _("\
+Set the number of threads prefetching shared library symbol files."), _("\
+Show the number of threads prefetching shared library symbol files."), _("\
+When GDB reads the symbols of several shared libraries at once, this\n\
+many threads read the libraries' symbol and debug sections from disk\n\
+ahead of the symbol readers.  Zero, the default, disables prefetching."),
+			    NULL,
+			    show_symbol_prefetch_threads,
+			    &setlist, &showlist);
+
   add_setshow_boolean_cmd ("symbol-reloading", class_support,
 			   &symbol_reloading, _("\
 Set dynamic symbol table reloading multiple times in one run."), _("\
@@ -5956,6 +6373,31 @@ cache."),
 			   show_download_write_size,
 			   &setlist, &showlist);
 
+  /* APPLE LOCAL begin download delta */
+  add_setshow_boolean_cmd ("download-delta", class_obscure,
+			   &download_delta, _("\
+Set whether \"load\" only writes what the target doesn't already hold."), _("\
+Show whether \"load\" only writes what the target doesn't already hold."), _("\
+When on, \"load\" asks the target for checksums of the memory it is\n\
+about to write, a block at a time, and skips the blocks that already\n\
+hold the right contents.  This needs a target that can checksum its\n\
+memory, such as a remote stub that supports the qCRC packet; with\n\
+other targets everything is written."),
+			   NULL,
+			   NULL,
+			   &setlist, &showlist);
+
+  add_setshow_zinteger_cmd ("download-delta-block-size", class_obscure,
+			    &download_delta_block_size_setting, _("\
+Set the size of the blocks \"load\" compares in delta mode."), _("\
+Show the size of the blocks \"load\" compares in delta mode."), _("\
+A block that differs from the target's memory is written in full.\n\
+The size must be at least one byte."),
+			    set_download_delta_block_size,
+			    NULL,
+			    &setlist, &showlist);
+  /* APPLE LOCAL end download delta */
+
   /* APPLE LOCAL: For the add-kext command.  */
   add_setshow_optional_filename_cmd ("kext-symbol-file-path", class_support,
 				     &kext_symbol_file_path, _("\
@@ -414,6 +414,9 @@ struct objfile *symbol_file_add_with_addrs_or_offsets_using_objfile (struct objf
 
 struct objfile * symbol_file_add_name_with_addrs_or_offsets (const char *name, int from_tty, struct section_addr_info *addrs, struct section_offsets *offsets, int num_offsets, int mainline, int flags, int symflags, CORE_ADDR mapaddr, const char *prefix, char *kext_bundle);
 
+/* APPLE LOCAL symbol prefetch */
+extern struct cleanup *symbol_prefetch_bfds (bfd **bfds, int count);
+
 struct section_offsets * convert_sect_addrs_to_offsets_via_on_disk_file (struct section_addr_info *sect_addrs, const char *file, int *num_offsets);
 
 
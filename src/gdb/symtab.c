@@ -58,32 +58,43 @@
 #include <ctype.h>
 #include "cp-abi.h"
 #include "observer.h"
+/* APPLE LOCAL demangle cache  */
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
 
 /* APPLE LOCAL: So we can complain.  */
 #include "complaints.h"
 
 /* APPLE LOCAL begin cache lookup values for improved performance  */
 
-asection * cached_mapped_section = NULL;
-asection * cached_overlay_section = NULL;
-struct obj_section * cached_sect_section = NULL;
-struct symtab * cached_symtab = NULL;
-struct partial_symtab * cached_psymtab = NULL;
-struct symtab_and_line * cached_pc_line = NULL;
-struct symbol * cached_pc_function = NULL;
-struct blockvector * cached_blockvector = NULL;
-int cached_blockvector_index = -1;
-struct block * cached_block = NULL;
-
-CORE_ADDR last_block_lookup_pc = INVALID_ADDRESS;
-CORE_ADDR last_blockvector_lookup_pc = INVALID_ADDRESS;
-CORE_ADDR last_function_lookup_pc = INVALID_ADDRESS;
-CORE_ADDR last_pc_line_lookup_pc = INVALID_ADDRESS;
-CORE_ADDR last_psymtab_lookup_pc = INVALID_ADDRESS;
-CORE_ADDR last_symtab_lookup_pc = INVALID_ADDRESS;
-CORE_ADDR last_sect_section_lookup_pc = INVALID_ADDRESS;
-CORE_ADDR last_mapped_section_lookup_pc = INVALID_ADDRESS;
-CORE_ADDR last_overlay_section_lookup_pc = INVALID_ADDRESS;
+/* The PC lookup cache.  Backtraces of many threads, and disassembly
+   with source, alternate between many PCs, so we keep the results of
+   the PC -> psymtab, symtab, function, block and line lookups for a
+   good number of recent PCs rather than just the last one.  The cache
+   is set associative: a PC can live in any of the PC_LOOKUP_WAYS
+   entries of the set it hashes to, and we replace the least recently
+   used one.  Entries made before the objfiles last changed are
+   ignored.  */
+
+#define PC_LOOKUP_SETS 256
+#define PC_LOOKUP_WAYS 4
+
+static struct pc_lookup_entry pc_lookup_cache[PC_LOOKUP_SETS][PC_LOOKUP_WAYS];
+
+static unsigned long pc_lookup_clock;
+
+static struct
+{
+  unsigned long lookups[PC_LOOKUP_NKINDS];
+  unsigned long hits[PC_LOOKUP_NKINDS];
+  unsigned long evictions;
+  unsigned long flushes;
+} pc_lookup_stats;
 
 /* APPLE LOCAL end cache lookup values for improved performance  */
 
@@ -847,6 +858,869 @@ symbol_find_demangled_name (struct general_symbol_info *gsymbol,
   return NULL;
 }
 
+/* APPLE LOCAL begin demangle cache  */
+
+/* The demangle cache.
+
+   Demangling the names of the minimal and partial symbols of a large
+   C++ program is one of the bigger costs of loading it, and every
+   session demangles the same names over again.  When
+   demangle_cache_file is set, symbol_demangle looks names up in that
+   file before calling the demangler, remembers the names it did have
+   to demangle, and adds them to the file when GDB exits.  The file is
+   shared by all objfiles, and by every session that names it.
+
+   A name may demangle differently depending on the language of the
+   symbol and on "set demangle-style", so an entry is keyed by the
+   mangled name, the symbol's language and the demangling style, and
+   records the language symbol_find_demangled_name settled on as well
+   as the demangled name, if any.
+
+   Like the partial symbol table cache, the file is written in host
+   byte order and is only read by the host that wrote it.  We map it
+   and look names up in place.  Layout:
+
+     8 bytes  DEMANGLE_CACHE_MAGIC
+     u32      DEMANGLE_CACHE_VERSION
+     u32      DEMANGLE_CACHE_BYTE_ORDER
+     u32      number of buckets, a power of two
+     u32      number of indexed entries
+     u32      for each bucket, 1 + the number of the entry there,
+              or 0 if it is empty
+     u32      for each indexed entry, its offset in the file
+     the indexed entries
+     the journal: more entries, up to the end of the file
+
+   Each entry is: u32 hash of the mangled name, u32 demangling style,
+   u8 language, u8 resulting language, u8 non-zero if there is a
+   demangled name, u8 zero, the mangled name, and the demangled name
+   if any.
+
+   Indexed entries are found by probing the buckets linearly,
+   starting from the hash of the mangled name.  A session that only
+   has a few names to add appends them to the journal, which readers
+   load into a hash table, instead of rewriting the whole file.  Once
+   the journal grows large, or the file outgrows demangle_cache_size,
+   the next session to save rebuilds the file, dropping the oldest
+   entries if it has to.  */
+
+/* The cache file.  NULL or empty disables the cache.  */
+static char *demangle_cache_file = NULL;
+
+/* Upper bound, in megabytes, on the size of demangle_cache_file.  Zero
+   means no limit.  */
+static unsigned int demangle_cache_size = 64;
+
+#define DEMANGLE_CACHE_MAGIC "GDBDMGLC"
+#define DEMANGLE_CACHE_VERSION 2
+#define DEMANGLE_CACHE_BYTE_ORDER 0x01020304
+#define DEMANGLE_CACHE_HEADER_SIZE 24
+#define DEMANGLE_CACHE_ENTRY_HEADER_SIZE 12
+
+/* Rebuild the file rather than append to its journal once the journal
+   would hold more than this many entries beyond a quarter of the
+   indexed ones.  */
+#define DEMANGLE_CACHE_JOURNAL_SLACK 4096
+
+/* One name, either in a cache file or demangled during this
+   session.  */
+
+struct demangle_cache_entry
+{
+  unsigned int hash;
+  unsigned int style;
+  unsigned char language;
+  unsigned char result_language;
+  const char *mangled;
+  const char *demangled;
+};
+
+/* A cache file read into memory.  */
+
+struct demangle_cache_map
+{
+  char *data;
+  size_t size;
+  int mapped;
+  unsigned int n_buckets;
+  unsigned int n_entries;
+  const char *buckets;
+  const char *offsets;
+
+  /* The entries in the journal, and a hash table of them.  */
+  struct demangle_cache_entry *journal;
+  unsigned int n_journal;
+  htab_t journal_index;
+
+  /* The end of the last complete entry.  A session that crashed while
+     appending may have left part of one after it.  */
+  size_t valid_size;
+};
+
+/* The contents of demangle_cache_file, if we have read it.  DATA is
+   NULL if we haven't, or it didn't exist or was no good.  */
+static struct demangle_cache_map demangle_cache;
+
+/* Non-zero once we have tried to read demangle_cache_file.  */
+static int demangle_cache_read;
+
+/* The names demangled during this session that aren't in the file,
+   and the obstack holding them.  */
+static htab_t demangle_cache_new;
+static struct obstack demangle_cache_obstack;
+
+/* Counts reported by "maint print demangle-cache-stats".  */
+
+static struct
+{
+  unsigned long demangler_calls;
+  unsigned long file_hits;
+  unsigned long session_hits;
+  unsigned long saves;
+  unsigned long appends;
+  unsigned long saved_entries;
+} demangle_stats;
+
+static unsigned int
+demangle_cache_get_u32 (const char *p)
+{
+  unsigned int val;
+
+  memcpy (&val, p, sizeof (val));
+  return val;
+}
+
+/* Decode the entry at P, which must end by END, into ENTRY.  Return
+   the address just past it, or NULL if it doesn't fit.  */
+
+static const char *
+demangle_cache_parse_entry (const char *p, const char *end,
+			    struct demangle_cache_entry *entry)
+{
+  int n_names;
+
+  if (end - p < DEMANGLE_CACHE_ENTRY_HEADER_SIZE)
+    return NULL;
+
+  entry->hash = demangle_cache_get_u32 (p);
+  entry->style = demangle_cache_get_u32 (p + 4);
+  entry->language = p[8];
+  entry->result_language = p[9];
+  n_names = p[10] ? 2 : 1;
+  p += DEMANGLE_CACHE_ENTRY_HEADER_SIZE;
+
+  entry->mangled = p;
+  entry->demangled = NULL;
+  while (n_names-- > 0)
+    {
+      p = memchr (p, '\0', end - p);
+      if (p == NULL)
+	return NULL;
+      p++;
+      if (n_names > 0)
+	entry->demangled = p;
+    }
+
+  return p;
+}
+
+/* Fill in ENTRY from indexed entry number N of MAP.  */
+
+static void
+demangle_cache_map_entry (struct demangle_cache_map *map, unsigned int n,
+			  struct demangle_cache_entry *entry)
+{
+  const char *p;
+
+  p = map->data + demangle_cache_get_u32 (map->offsets + 4 * n);
+  demangle_cache_parse_entry (p, map->data + map->valid_size, entry);
+}
+
+/* The number of bytes ENTRY takes up in a cache file.  */
+
+static size_t
+demangle_cache_entry_size (const struct demangle_cache_entry *entry)
+{
+  size_t size = DEMANGLE_CACHE_ENTRY_HEADER_SIZE + strlen (entry->mangled) + 1;
+
+  if (entry->demangled != NULL)
+    size += strlen (entry->demangled) + 1;
+  return size;
+}
+
+static hashval_t
+demangle_cache_entry_hash (const void *p)
+{
+  const struct demangle_cache_entry *entry = p;
+
+  return entry->hash;
+}
+
+static int
+demangle_cache_entry_eq (const void *p1, const void *p2)
+{
+  const struct demangle_cache_entry *entry1 = p1;
+  const struct demangle_cache_entry *entry2 = p2;
+
+  return (entry1->hash == entry2->hash
+	  && entry1->style == entry2->style
+	  && entry1->language == entry2->language
+	  && strcmp (entry1->mangled, entry2->mangled) == 0);
+}
+
+/* Check that MAP, just read from a file, is a cache file written by
+   this host, so that looking names up in it can't go astray.  Fill in
+   the rest of MAP from the header, load the journal, and return
+   non-zero if it's good.  */
+
+static int
+demangle_cache_check_map (struct demangle_cache_map *map)
+{
+  const char *end = map->data + map->size;
+  struct demangle_cache_entry entry;
+  const char *p;
+  unsigned int i, n_allocated;
+
+  if (map->size < DEMANGLE_CACHE_HEADER_SIZE
+      || memcmp (map->data, DEMANGLE_CACHE_MAGIC, 8) != 0
+      || demangle_cache_get_u32 (map->data + 8) != DEMANGLE_CACHE_VERSION
+      || (demangle_cache_get_u32 (map->data + 12)
+	  != DEMANGLE_CACHE_BYTE_ORDER))
+    return 0;
+
+  map->n_buckets = demangle_cache_get_u32 (map->data + 16);
+  map->n_entries = demangle_cache_get_u32 (map->data + 20);
+
+  /* There must always be an empty bucket, or a probe would never
+     end.  */
+  if (map->n_buckets == 0
+      || (map->n_buckets & (map->n_buckets - 1)) != 0
+      || map->n_entries >= map->n_buckets
+      || ((map->size - DEMANGLE_CACHE_HEADER_SIZE) / 4
+	  < (size_t) map->n_buckets + map->n_entries))
+    return 0;
+
+  map->buckets = map->data + DEMANGLE_CACHE_HEADER_SIZE;
+  map->offsets = map->buckets + 4 * map->n_buckets;
+
+  for (i = 0; i < map->n_buckets; i++)
+    if (demangle_cache_get_u32 (map->buckets + 4 * i) > map->n_entries)
+      return 0;
+
+  /* The indexed entries must follow one another.  */
+  p = map->offsets + 4 * map->n_entries;
+  for (i = 0; i < map->n_entries; i++)
+    {
+      if (demangle_cache_get_u32 (map->offsets + 4 * i) != p - map->data)
+	return 0;
+      p = demangle_cache_parse_entry (p, end, &entry);
+      if (p == NULL)
+	return 0;
+    }
+
+  /* The journal runs from there to the end of the file, or to the
+     first entry that was only partly written.  */
+  n_allocated = 0;
+  while (p < end)
+    {
+      const char *next = demangle_cache_parse_entry (p, end, &entry);
+
+      if (next == NULL)
+	break;
+      if (map->n_journal == n_allocated)
+	{
+	  n_allocated = n_allocated ? 2 * n_allocated : 64;
+	  map->journal = xrealloc (map->journal,
+				   n_allocated * sizeof (*map->journal));
+	}
+      map->journal[map->n_journal++] = entry;
+      p = next;
+    }
+  map->valid_size = p - map->data;
+
+  if (map->n_journal > 0)
+    {
+      map->journal_index = htab_create_alloc (2 * map->n_journal,
+					      demangle_cache_entry_hash,
+					      demangle_cache_entry_eq, NULL,
+					      xcalloc, xfree);
+      for (i = 0; i < map->n_journal; i++)
+	{
+	  void **slot = htab_find_slot_with_hash (map->journal_index,
+						  &map->journal[i],
+						  map->journal[i].hash,
+						  INSERT);
+	  if (*slot == NULL)
+	    *slot = &map->journal[i];
+	}
+    }
+
+  return 1;
+}
+
+static void
+demangle_cache_unmap (struct demangle_cache_map *map)
+{
+  if (map->data != NULL)
+    {
+#ifdef HAVE_MMAP
+      if (map->mapped)
+	munmap (map->data, map->size);
+      else
+#endif
+	xfree (map->data);
+    }
+  if (map->journal_index != NULL)
+    htab_delete (map->journal_index);
+  xfree (map->journal);
+  memset (map, 0, sizeof (*map));
+}
+
+/* Read the cache file PATH into MAP.  Return non-zero if we did, and
+   it's good.  */
+
+static int
+demangle_cache_map_file (const char *path, struct demangle_cache_map *map)
+{
+  struct stat st;
+  int fd;
+
+  memset (map, 0, sizeof (*map));
+
+  fd = open (path, O_RDONLY | O_BINARY);
+  if (fd < 0)
+    return 0;
+
+  if (fstat (fd, &st) != 0 || st.st_size == 0)
+    {
+      close (fd);
+      return 0;
+    }
+  map->size = st.st_size;
+
+#ifdef HAVE_MMAP
+  map->data = mmap (NULL, map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map->data == (char *) MAP_FAILED)
+    map->data = NULL;
+  else
+    map->mapped = 1;
+#endif
+  if (map->data == NULL)
+    {
+      map->data = xmalloc (map->size);
+      if (read (fd, map->data, map->size) != map->size)
+	{
+	  xfree (map->data);
+	  map->data = NULL;
+	}
+    }
+  close (fd);
+
+  if (map->data != NULL && !demangle_cache_check_map (map))
+    demangle_cache_unmap (map);
+
+  return map->data != NULL;
+}
+
+/* Look for the entry matching KEY in MAP.  If it's there, fill in
+   ENTRY and return non-zero.  */
+
+static int
+demangle_cache_map_find (struct demangle_cache_map *map,
+			 const struct demangle_cache_entry *key,
+			 struct demangle_cache_entry *entry)
+{
+  unsigned int mask = map->n_buckets - 1;
+  struct demangle_cache_entry *found;
+  unsigned int i, n;
+
+  if (map->data == NULL)
+    return 0;
+
+  for (i = key->hash & mask;
+       (n = demangle_cache_get_u32 (map->buckets + 4 * i)) != 0;
+       i = (i + 1) & mask)
+    {
+      demangle_cache_map_entry (map, n - 1, entry);
+      if (demangle_cache_entry_eq (entry, key))
+	return 1;
+    }
+
+  if (map->journal_index == NULL)
+    return 0;
+
+  found = htab_find_with_hash (map->journal_index, key, key->hash);
+  if (found == NULL)
+    return 0;
+
+  *entry = *found;
+  return 1;
+}
+
+/* Look for MANGLED, with hash HASH, language LANGUAGE and the current
+   demangling style, in the cache file and among the names demangled
+   this session.  If it's there, fill in ENTRY and return non-zero.  */
+
+static int
+demangle_cache_find (unsigned int hash, const char *mangled,
+		     enum language language,
+		     struct demangle_cache_entry *entry)
+{
+  struct demangle_cache_entry key;
+  struct demangle_cache_entry *found;
+
+  if (!demangle_cache_read)
+    {
+      demangle_cache_read = 1;
+      demangle_cache_map_file (demangle_cache_file, &demangle_cache);
+    }
+
+  key.hash = hash;
+  key.style = current_demangling_style;
+  key.language = language;
+  key.mangled = mangled;
+
+  if (demangle_cache_map_find (&demangle_cache, &key, entry))
+    {
+      demangle_stats.file_hits++;
+      return 1;
+    }
+
+  if (demangle_cache_new == NULL)
+    return 0;
+
+  found = htab_find_with_hash (demangle_cache_new, &key, hash);
+  if (found == NULL)
+    return 0;
+
+  *entry = *found;
+  demangle_stats.session_hits++;
+  return 1;
+}
+
+/* Remember that MANGLED, with hash HASH and language LANGUAGE,
+   demangled to DEMANGLED (which may be NULL) in RESULT_LANGUAGE under
+   the current demangling style.  */
+
+static void
+demangle_cache_add (unsigned int hash, const char *mangled,
+		    enum language language, enum language result_language,
+		    const char *demangled)
+{
+  struct demangle_cache_entry *entry;
+  void **slot;
+
+  if (demangle_cache_new == NULL)
+    {
+      demangle_cache_new = htab_create_alloc (1024, demangle_cache_entry_hash,
+					      demangle_cache_entry_eq, NULL,
+					      xcalloc, xfree);
+      obstack_init (&demangle_cache_obstack);
+    }
+
+  entry = (struct demangle_cache_entry *)
+    obstack_alloc (&demangle_cache_obstack,
+		   sizeof (struct demangle_cache_entry));
+  entry->hash = hash;
+  entry->style = current_demangling_style;
+  entry->language = language;
+  entry->result_language = result_language;
+  entry->mangled = obsavestring (mangled, strlen (mangled),
+				 &demangle_cache_obstack);
+  if (demangled != NULL)
+    entry->demangled = obsavestring (demangled, strlen (demangled),
+				     &demangle_cache_obstack);
+  else
+    entry->demangled = NULL;
+
+  slot = htab_find_slot_with_hash (demangle_cache_new, entry, hash, INSERT);
+  if (*slot == NULL)
+    *slot = entry;
+}
+
+/* Add ENTRY, encoded as in a cache file, to OB.  */
+
+static void
+demangle_cache_put_entry (struct obstack *ob,
+			  const struct demangle_cache_entry *entry)
+{
+  unsigned char bytes[4];
+
+  bytes[0] = entry->language;
+  bytes[1] = entry->result_language;
+  bytes[2] = entry->demangled != NULL;
+  bytes[3] = 0;
+  obstack_grow (ob, &entry->hash, 4);
+  obstack_grow (ob, &entry->style, 4);
+  obstack_grow (ob, bytes, 4);
+  obstack_grow0 (ob, entry->mangled, strlen (entry->mangled));
+  if (entry->demangled != NULL)
+    obstack_grow0 (ob, entry->demangled, strlen (entry->demangled));
+}
+
+/* Write the COUNT entries at ENTRIES to the cache file, replacing
+   whatever is there.  */
+
+static void
+demangle_cache_write (struct demangle_cache_entry *entries,
+		      unsigned int count)
+{
+  unsigned int n_buckets, offset, mask, i, j;
+  unsigned int *buckets;
+  struct obstack ob;
+  char *tmp_path;
+  char *data;
+  size_t size;
+  FILE *file;
+  int ok;
+
+  n_buckets = 16;
+  while (n_buckets < 2 * count)
+    n_buckets <<= 1;
+  mask = n_buckets - 1;
+
+  buckets = (unsigned int *) xcalloc (n_buckets, sizeof (unsigned int));
+  for (i = 0; i < count; i++)
+    {
+      for (j = entries[i].hash & mask; buckets[j] != 0; j = (j + 1) & mask)
+	;
+      buckets[j] = i + 1;
+    }
+
+  obstack_init (&ob);
+  obstack_grow (&ob, DEMANGLE_CACHE_MAGIC, 8);
+  i = DEMANGLE_CACHE_VERSION;
+  obstack_grow (&ob, &i, 4);
+  i = DEMANGLE_CACHE_BYTE_ORDER;
+  obstack_grow (&ob, &i, 4);
+  obstack_grow (&ob, &n_buckets, 4);
+  obstack_grow (&ob, &count, 4);
+  obstack_grow (&ob, buckets, 4 * n_buckets);
+  xfree (buckets);
+
+  offset = DEMANGLE_CACHE_HEADER_SIZE + 4 * n_buckets + 4 * count;
+  for (i = 0; i < count; i++)
+    {
+      obstack_grow (&ob, &offset, 4);
+      offset += demangle_cache_entry_size (&entries[i]);
+    }
+
+  for (i = 0; i < count; i++)
+    demangle_cache_put_entry (&ob, &entries[i]);
+
+  size = obstack_object_size (&ob);
+  data = obstack_finish (&ob);
+
+  /* Write a temporary file and rename it into place, so a concurrent
+     session never sees a partial file.  */
+  tmp_path = xstrprintf ("%s.%d", demangle_cache_file, (int) getpid ());
+  file = fopen (tmp_path, FOPEN_WB);
+  ok = 0;
+  if (file != NULL)
+    {
+      ok = (fwrite (data, 1, size, file) == size);
+      ok &= (fclose (file) == 0);
+      if (ok)
+	ok = (rename (tmp_path, demangle_cache_file) == 0);
+      if (!ok)
+	unlink (tmp_path);
+    }
+
+  if (ok)
+    {
+      demangle_stats.saves++;
+      demangle_stats.saved_entries = count;
+    }
+
+  obstack_free (&ob, NULL);
+  xfree (tmp_path);
+}
+
+/* Append the COUNT entries at ENTRIES to the journal of the cache
+   file.  The entries go out in a single write, so that sessions
+   appending at the same time don't interleave them.  */
+
+static void
+demangle_cache_append (struct demangle_cache_entry *entries,
+		       unsigned int count)
+{
+  struct obstack ob;
+  unsigned int i;
+  char *data;
+  size_t size;
+  int fd;
+
+  obstack_init (&ob);
+  for (i = 0; i < count; i++)
+    demangle_cache_put_entry (&ob, &entries[i]);
+  size = obstack_object_size (&ob);
+  data = obstack_finish (&ob);
+
+  fd = open (demangle_cache_file, O_WRONLY | O_APPEND | O_BINARY);
+  if (fd >= 0)
+    {
+      if (write (fd, data, size) == size)
+	{
+	  demangle_stats.appends++;
+	  demangle_stats.saved_entries = count;
+	}
+      close (fd);
+    }
+
+  obstack_free (&ob, NULL);
+}
+
+/* State for demangle_cache_collect_new.  */
+
+struct demangle_cache_collect
+{
+  struct demangle_cache_map *map;
+  struct demangle_cache_entry *entries;
+  unsigned int count;
+  size_t size;
+};
+
+/* Add the entry at SLOT to the entries in DATA, a struct
+   demangle_cache_collect, unless its map already has it.  */
+
+static int
+demangle_cache_collect_new (void **slot, void *data)
+{
+  struct demangle_cache_collect *collect = data;
+  struct demangle_cache_entry *entry = *slot;
+  struct demangle_cache_entry found;
+
+  if (!demangle_cache_map_find (collect->map, entry, &found))
+    {
+      collect->entries[collect->count++] = *entry;
+      collect->size += demangle_cache_entry_size (entry);
+    }
+
+  return 1;
+}
+
+/* Rebuild the cache file from the COUNT new entries at NEW_ENTRIES
+   and the entries of MAP, newest first, keeping only as many as fit
+   in demangle_cache_size.  */
+
+static void
+demangle_cache_rebuild (struct demangle_cache_map *map,
+			struct demangle_cache_entry *new_entries,
+			unsigned int count)
+{
+  struct demangle_cache_entry *entries;
+  unsigned long long limit, size;
+  unsigned int n, i;
+  htab_t seen;
+
+  if (demangle_cache_size == 0 || demangle_cache_size == UINT_MAX)
+    limit = ~(unsigned long long) 0;
+  else
+    limit = (unsigned long long) demangle_cache_size * 1024 * 1024;
+
+  entries = (struct demangle_cache_entry *)
+    xmalloc ((count + map->n_journal + map->n_entries)
+	     * sizeof (struct demangle_cache_entry));
+  n = 0;
+  memcpy (entries, new_entries, count * sizeof (struct demangle_cache_entry));
+  n += count;
+  for (i = map->n_journal; i-- > 0; )
+    entries[n++] = map->journal[i];
+  for (i = 0; i < map->n_entries; i++)
+    demangle_cache_map_entry (map, i, &entries[n++]);
+
+  /* Drop duplicates (two sessions may have added the same name to the
+     journal), and the oldest entries beyond the size limit.  Each
+     entry costs its own bytes, its offset, and up to four buckets,
+     since demangle_cache_write rounds the number of buckets up to a
+     power of two at least twice the number of entries.  */
+  seen = htab_create_alloc (2 * n + 1, demangle_cache_entry_hash,
+			    demangle_cache_entry_eq, NULL, xcalloc, xfree);
+  size = DEMANGLE_CACHE_HEADER_SIZE;
+  count = 0;
+  for (i = 0; i < n; i++)
+    {
+      void **slot = htab_find_slot_with_hash (seen, &entries[i],
+					      entries[i].hash, INSERT);
+      unsigned long long entry_size;
+
+      if (*slot != NULL)
+	continue;
+      entry_size = demangle_cache_entry_size (&entries[i]) + 4 + 16;
+      if (size + entry_size > limit)
+	break;
+      size += entry_size;
+      entries[count] = entries[i];
+      *slot = &entries[count];
+      count++;
+    }
+  htab_delete (seen);
+
+  demangle_cache_write (entries, count);
+  xfree (entries);
+}
+
+/* Add the names demangled this session to the cache file.  Another
+   session may have changed the file since we read it, so start from
+   what is there now.  Append to the journal if it can take them,
+   otherwise rebuild the file.  */
+
+static void
+demangle_cache_save (void)
+{
+  struct demangle_cache_map map;
+  struct demangle_cache_collect collect;
+  unsigned long long limit;
+
+  if (demangle_cache_file == NULL || *demangle_cache_file == '\0'
+      || demangle_cache_new == NULL
+      || htab_elements (demangle_cache_new) == 0)
+    return;
+
+  demangle_cache_map_file (demangle_cache_file, &map);
+
+  collect.map = &map;
+  collect.entries = (struct demangle_cache_entry *)
+    xmalloc (htab_elements (demangle_cache_new)
+	     * sizeof (struct demangle_cache_entry));
+  collect.count = 0;
+  collect.size = 0;
+  htab_traverse_noresize (demangle_cache_new, demangle_cache_collect_new,
+			  &collect);
+
+  if (demangle_cache_size == 0 || demangle_cache_size == UINT_MAX)
+    limit = ~(unsigned long long) 0;
+  else
+    limit = (unsigned long long) demangle_cache_size * 1024 * 1024;
+
+  if (collect.count == 0)
+    ;
+  else if (map.data != NULL
+	   && map.valid_size == map.size
+	   && (map.n_journal + collect.count
+	       <= map.n_entries / 4 + DEMANGLE_CACHE_JOURNAL_SLACK)
+	   && map.size + collect.size <= limit)
+    demangle_cache_append (collect.entries, collect.count);
+  else
+    demangle_cache_rebuild (&map, collect.entries, collect.count);
+
+  xfree (collect.entries);
+  demangle_cache_unmap (&map);
+}
+
+static void
+demangle_cache_final_cleanup (void *unused)
+{
+  demangle_cache_save ();
+}
+
+/* Called when the cache file is changed: keep what we've demangled,
+   and write it to the new file when we're done.  */
+
+static void
+set_demangle_cache_file (char *args, int from_tty, struct cmd_list_element *c)
+{
+  demangle_cache_unmap (&demangle_cache);
+  demangle_cache_read = 0;
+}
+
+static void
+show_demangle_cache_file (struct ui_file *file, int from_tty,
+			  struct cmd_list_element *c, const char *value)
+{
+  if (value == NULL || *value == '\0')
+    fprintf_filtered (file, _("The demangle cache is disabled.\n"));
+  else
+    fprintf_filtered (file, _("The demangle cache file is \"%s\".\n"),
+		      value);
+}
+
+static void
+show_demangle_cache_size (struct ui_file *file, int from_tty,
+			  struct cmd_list_element *c, const char *value)
+{
+  if (demangle_cache_size == UINT_MAX)
+    fprintf_filtered (file, _("\
+The size limit of the demangle cache is unlimited.\n"));
+  else
+    fprintf_filtered (file, _("\
+The size limit of the demangle cache is %s megabytes.\n"),
+		      value);
+}
+
+static void
+maintenance_print_demangle_cache_stats (char *args, int from_tty)
+{
+  unsigned long hits = demangle_stats.file_hits + demangle_stats.session_hits;
+  unsigned long total = hits + demangle_stats.demangler_calls;
+
+  printf_filtered (_("Demangle cache statistics:\n"));
+  printf_filtered (_("  Cache file: %s\n"),
+		   (demangle_cache_file != NULL && *demangle_cache_file != '\0')
+		   ? demangle_cache_file : _("(none)"));
+  printf_filtered (_("  Entries in cache file: %u (%u in its journal)\n"),
+		   demangle_cache.n_entries + demangle_cache.n_journal,
+		   demangle_cache.n_journal);
+  printf_filtered (_("  Entries added this session: %lu\n"),
+		   demangle_cache_new != NULL
+		   ? (unsigned long) htab_elements (demangle_cache_new) : 0UL);
+  printf_filtered (_("  Demangler calls: %lu\n"),
+		   demangle_stats.demangler_calls);
+  printf_filtered (_("  Demangler calls avoided: %lu (%lu%%)\n"),
+		   hits, total ? (hits * 100) / total : 0UL);
+  printf_filtered (_("    found in cache file: %lu\n"),
+		   demangle_stats.file_hits);
+  printf_filtered (_("    found among this session's names: %lu\n"),
+		   demangle_stats.session_hits);
+  printf_filtered (_("  Cache file rebuilds: %lu, appends: %lu \
+(%lu entries last written)\n"),
+		   demangle_stats.saves, demangle_stats.appends,
+		   demangle_stats.saved_entries);
+}
+
+/* Like symbol_find_demangled_name, but use the demangle cache if it's
+   enabled.  */
+
+static char *
+symbol_demangle (struct general_symbol_info *gsymbol, const char *mangled)
+{
+  struct demangle_cache_entry entry;
+  enum language language;
+  unsigned int hash;
+  char *demangled;
+
+  language = gsymbol->language;
+  if (language == language_unknown)
+    language = language_auto;
+
+  /* symbol_find_demangled_name doesn't demangle anything else.  */
+  if (language != language_auto
+      && language != language_cplus
+      && language != language_java
+      && language != language_objc
+      && language != language_objcplus)
+    return symbol_find_demangled_name (gsymbol, mangled);
+
+  if (demangle_cache_file == NULL || *demangle_cache_file == '\0')
+    {
+      demangle_stats.demangler_calls++;
+      return symbol_find_demangled_name (gsymbol, mangled);
+    }
+
+  hash = htab_hash_string (mangled);
+  if (demangle_cache_find (hash, mangled, language, &entry))
+    {
+      gsymbol->language = entry.result_language;
+      return entry.demangled != NULL ? xstrdup (entry.demangled) : NULL;
+    }
+
+  demangle_stats.demangler_calls++;
+  demangled = symbol_find_demangled_name (gsymbol, mangled);
+  demangle_cache_add (hash, mangled, language, gsymbol->language, demangled);
+  return demangled;
+}
+/* APPLE LOCAL end demangle cache  */
+
 /* Set both the mangled and demangled (if any) names for GSYMBOL based
    on LINKAGE_NAME and LEN.  The hash table corresponding to OBJFILE
    is used, and the memory comes from that objfile's objfile_obstack.
@@ -929,8 +1803,8 @@ symbol_set_names (struct general_symbol_info *gsymbol,
   /* If this name is not in the hash table, add it.  */
   if (*slot == NULL)
     {
-      char *demangled_name = symbol_find_demangled_name (gsymbol,
-							 linkage_name_copy);
+      /* APPLE LOCAL demangle cache  */
+      char *demangled_name = symbol_demangle (gsymbol, linkage_name_copy);
       int demangled_len = demangled_name ? strlen (demangled_name) : 0;
 
       /* If there is a demangled name, place it right after the mangled name.
@@ -951,7 +1825,8 @@ symbol_set_names (struct general_symbol_info *gsymbol,
     {
       /* APPLE LOCAL: We already have this name in the demangled name hash
          but we still need to set the language in the minsym.  */
-      xfree (symbol_find_demangled_name (gsymbol, linkage_name_copy));
+      /* APPLE LOCAL demangle cache  */
+      xfree (symbol_demangle (gsymbol, linkage_name_copy));
     }
 
   gsymbol->name = *slot + lookup_len - len;
@@ -974,7 +1849,8 @@ symbol_init_demangled_name (struct general_symbol_info *gsymbol,
   char *mangled = gsymbol->name;
   char *demangled = NULL;
 
-  demangled = symbol_find_demangled_name (gsymbol, mangled);
+  /* APPLE LOCAL demangle cache  */
+  demangled = symbol_demangle (gsymbol, mangled);
   if (gsymbol->language == language_cplus
       || gsymbol->language == language_java
       /* APPLE LOCAL Objective-C++ */
@@ -1094,22 +1970,32 @@ init_address_context (struct address_context *addr_ctx)
    none.  We return the psymtab that contains a symbol whose address
    exactly matches PC, or, if we cannot find an exact match, the
    psymtab that contains a symbol whose address is closest to PC.  */
+/* APPLE LOCAL begin cache lookup values for improved performance  */
+static struct partial_symtab *find_pc_sect_psymtab_1 (CORE_ADDR,
+						      asection *);
+
 struct partial_symtab *
 find_pc_sect_psymtab (CORE_ADDR pc, asection *section)
 {
+  struct pc_lookup_entry *e;
   struct partial_symtab *pst;
-  struct objfile *objfile;
-  struct minimal_symbol *msymbol;
 
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-  if (pc == last_psymtab_lookup_pc
-      && pc == last_mapped_section_lookup_pc
-      && section == cached_mapped_section
-      && cached_psymtab)
-    return cached_psymtab;
+  e = pc_lookup_cache_find (pc, section, PC_LOOKUP_PSYMTAB);
+  if (e != NULL)
+    return e->psymtab;
 
-  last_psymtab_lookup_pc = pc;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
+  pst = find_pc_sect_psymtab_1 (pc, section);
+  pc_lookup_cache_add (pc, section, PC_LOOKUP_PSYMTAB)->psymtab = pst;
+  return pst;
+}
+/* APPLE LOCAL end cache lookup values for improved performance  */
+
+static struct partial_symtab *
+find_pc_sect_psymtab_1 (CORE_ADDR pc, asection *section)
+{
+  struct partial_symtab *pst;
+  struct objfile *objfile;
+  struct minimal_symbol *msymbol;
 
   /* If we know that this is not a text address, return failure.  This is
      necessary because we loop based on texthigh and textlow, which do
@@ -1121,12 +2007,7 @@ find_pc_sect_psymtab (CORE_ADDR pc, asection *section)
 	  || msymbol->type == mst_abs
 	  || msymbol->type == mst_file_data
 	  || msymbol->type == mst_file_bss))
-    /* APPLE LOCAL begin cache lookup values for improved performance  */
-    {
-      cached_psymtab = NULL;
-      return NULL;
-    }
-    /* APPLE LOCAL end cache lookup values for improved performance  */
+    return NULL;
 
   /* APPLE LOCAL: Change to ALL_OBJFILES from ALL_PSYMTABS so that
      we can hoist the psymtab-invariant sections check out.  */
@@ -1152,24 +2033,10 @@ find_pc_sect_psymtab (CORE_ADDR pc, asection *section)
 	       function containing the PC.  */
 	    if (!(objfile->flags & OBJF_REORDERED) &&
 		section == 0)	/* can't validate section this way */
-	      /* APPLE LOCAL begin cache lookup values for improved 
-		 performance  */
-	      {
-		cached_psymtab = pst;
-		return (pst);
-	      }
-	      /* APPLE LOCAL end cache lookup values for improved 
-		 performance  */
+	      return (pst);
 	    
 	    if (msymbol == NULL)
-	      /* APPLE LOCAL begin cache lookup values for improved 
-		 performance  */
-	      {
-		cached_psymtab = pst;
-		return (pst);
-	      }
-	      /* APPLE LOCAL end cache lookup values for improved 
-		 performance  */
+	      return (pst);
 	    
 	    /* The code range of partial symtabs sometimes overlap, so, in
 	       the loop below, we need to check all partial symtabs and
@@ -1188,14 +2055,7 @@ find_pc_sect_psymtab (CORE_ADDR pc, asection *section)
 		    if (p != NULL
 			&& SYMBOL_VALUE_ADDRESS (p)
 			== SYMBOL_VALUE_ADDRESS (msymbol))
-		      /* APPLE LOCAL begin cache lookup values for improved 
-			 performance  */
-		      {
-			cached_psymtab = tpst;
-			return (tpst);
-		      }
-		    /* APPLE LOCAL end cache lookup values for improved 
-		       performance  */
+		      return (tpst);
 		    if (p != NULL)
 		      {
 			/* We found a symbol in this partial symtab which
@@ -1221,14 +2081,10 @@ find_pc_sect_psymtab (CORE_ADDR pc, asection *section)
 		      }
 		  }
 	      }
-	    /* APPLE LOCAL cache lookup values for improved performance  */
-	    cached_psymtab = best_pst;
 	    return (best_pst);
 	  }
       }
   }
-  /* APPLE LOCAL cache lookup values for improved performance  */
-  cached_psymtab = NULL;
   return (NULL);
 }
 
@@ -1697,6 +2553,34 @@ lookup_symbol_aux (const char *name, const char *linkage_name,
   if (is_a_field_of_this != NULL)
     *is_a_field_of_this = 0;
 
+  /* APPLE LOCAL background symbol loading: If NAME is in a library
+     whose symbols haven't been read in yet, read them now, before we
+     are holding on to anything that doing so would free.  NAME or
+     LINKAGE_NAME may themselves be the name of a minimal symbol in
+     that library (the value printers pass those in), and reading the
+     library in frees those, so work from copies.  Callers that are
+     walking the minimal symbols themselves, as search_symbols does,
+     must read every waiting library in before they start.
+     Only a name the library exports can be found this way; a type,
+     or a static, is looked up in whatever symbols have been read so
+     far.  */
+  if (objfile_background_load_queued ())
+    {
+      char *copy;
+
+      copy = alloca (strlen (name) + 1);
+      strcpy (copy, name);
+      name = copy;
+      if (linkage_name != NULL)
+	{
+	  copy = alloca (strlen (linkage_name) + 1);
+	  strcpy (copy, linkage_name);
+	  linkage_name = copy;
+	}
+      objfile_background_load_for_name (linkage_name != NULL
+					? linkage_name : name);
+    }
+
   /* Search specified block and its superiors.  Don't search
      STATIC_BLOCK or GLOBAL_BLOCK.  */
 
@@ -2122,6 +3006,9 @@ lookup_symbol_aux_psymtabs (int block_index, const char *name,
   struct symbol_search *prev;
   struct symbol_search *current;
   /* APPLE LOCAL end return multiple symbols  */
+  /* APPLE LOCAL psymtab name index  */
+  struct psymtab_name_iterator it;
+  const char *index_name;
 
   /* If we're called with a null string for some bizarre reason, just bail.  */
   if (name == NULL || name[0] == '\0'
@@ -2134,7 +3021,12 @@ lookup_symbol_aux_psymtabs (int block_index, const char *name,
       return NULL;
     }
 
-  ALL_PSYMTABS (objfile, ps)
+  /* APPLE LOCAL: Only look in the psymtabs the name index says may
+     define NAME.  A match on LINKAGE_NAME or on a psym equivalence
+     doesn't have to share NAME's hash, so look everywhere for those.  */
+  index_name = (linkage_name == NULL && !psym_equivalences) ? name : NULL;
+
+  ALL_PSYMTABS_FOR_NAME (objfile, index_name, it, ps)
   {
     /* Check to see if there is either a direct match, or a
        psym equivalence match.  */
@@ -2604,6 +3496,8 @@ basic_lookup_transparent_type (const char *name)
   struct blockvector *bv;
   struct objfile *objfile;
   struct block *block;
+  /* APPLE LOCAL psymtab name index  */
+  struct psymtab_name_iterator it;
 
   /* Now search all the global symbols.  Do the symtab's first, then
      check the psymtab's. If a psymtab indicates the existence
@@ -2623,7 +3517,8 @@ basic_lookup_transparent_type (const char *name)
       }
   }
 
-  ALL_PSYMTABS (objfile, ps)
+  /* APPLE LOCAL psymtab name index  */
+  ALL_PSYMTABS_FOR_NAME (objfile, name, it, ps)
   {
     if (!ps->readin && lookup_partial_symbol (ps, name, NULL,
 					      1, STRUCT_DOMAIN))
@@ -2681,7 +3576,8 @@ basic_lookup_transparent_type (const char *name)
       }
   }
 
-  ALL_PSYMTABS (objfile, ps)
+  /* APPLE LOCAL psymtab name index  */
+  ALL_PSYMTABS_FOR_NAME (objfile, name, it, ps)
   {
     if (!ps->readin && lookup_partial_symbol (ps, name, NULL, 0, STRUCT_DOMAIN))
       {
@@ -2728,8 +3624,10 @@ find_main_psymtab (void)
 {
   struct partial_symtab *pst;
   struct objfile *objfile;
+  /* APPLE LOCAL psymtab name index  */
+  struct psymtab_name_iterator it;
 
-  ALL_PSYMTABS (objfile, pst)
+  ALL_PSYMTABS_FOR_NAME (objfile, main_name (), it, pst)
   {
     if (lookup_partial_symbol (pst, main_name (), NULL, 1, VAR_DOMAIN))
       {
@@ -2894,8 +3792,27 @@ block_size (struct block *bl)
 /* Find the symtab associated with PC and SECTION.  Look through the
    psymtabs and read in another symtab if necessary. */
 
+/* APPLE LOCAL begin cache lookup values for improved performance  */
+static struct symtab *find_pc_sect_symtab_1 (CORE_ADDR, asection *);
+
 struct symtab *
 find_pc_sect_symtab (CORE_ADDR pc, asection *section)
+{
+  struct pc_lookup_entry *e;
+  struct symtab *s;
+
+  e = pc_lookup_cache_find (pc, section, PC_LOOKUP_SYMTAB);
+  if (e != NULL)
+    return e->symtab;
+
+  s = find_pc_sect_symtab_1 (pc, section);
+  pc_lookup_cache_add (pc, section, PC_LOOKUP_SYMTAB)->symtab = s;
+  return s;
+}
+/* APPLE LOCAL end cache lookup values for improved performance  */
+
+static struct symtab *
+find_pc_sect_symtab_1 (CORE_ADDR pc, asection *section)
 {
   struct block *b;
   struct blockvector *bv;
@@ -2906,16 +3823,6 @@ find_pc_sect_symtab (CORE_ADDR pc, asection *section)
   CORE_ADDR distance = 0;
   struct minimal_symbol *msymbol;
 
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-  if (pc == last_symtab_lookup_pc
-      && pc == last_mapped_section_lookup_pc
-      && cached_mapped_section == section
-      && cached_symtab)
-    return cached_symtab;
-
-  last_symtab_lookup_pc = pc;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
-
   /* If we know that this is not a text address, return failure.  This is
      necessary because we loop based on the block's high and low code
      addresses, which do not include the data ranges, and because
@@ -2928,12 +3835,7 @@ find_pc_sect_symtab (CORE_ADDR pc, asection *section)
 	  || msymbol->type == mst_abs
 	  || msymbol->type == mst_file_data
 	  || msymbol->type == mst_file_bss))
-    /* APPLE LOCAL begin cache lookup values for improved performance  */
-    {
-      cached_symtab = NULL;
-      return NULL;
-    }
-    /* APPLE LOCAL end cache lookup values for improved performance  */
+    return NULL;
 
   /* Search all symtabs for the one whose file contains our address, and which
      is the smallest of all the ones containing the address.  This is designed
@@ -2979,14 +3881,7 @@ find_pc_sect_symtab (CORE_ADDR pc, asection *section)
 	  {
 	    ps = find_pc_sect_psymtab (pc, section);
 	    if (ps)
-	      /* APPLE LOCAL begin cache lookup values for improved 
-		 performance  */
-	      {
-		cached_symtab = PSYMTAB_TO_SYMTAB (ps);
-		return PSYMTAB_TO_SYMTAB (ps);
-	      }
-	      /* APPLE LOCAL end cache lookup values for improved 
-		 performance  */
+	      return PSYMTAB_TO_SYMTAB (ps);
 	  }
 	if (section != 0)
 	  {
@@ -3010,12 +3905,7 @@ find_pc_sect_symtab (CORE_ADDR pc, asection *section)
   }
 
   if (best_s != NULL)
-    /* APPLE LOCAL begin cache lookup values for improved performance  */
-    {
-      cached_symtab = best_s;
-      return (best_s);
-    }
-    /* APPLE LOCAL end cache lookup values for improved performance  */
+    return (best_s);
 
   s = NULL;
   ps = find_pc_sect_psymtab (pc, section);
@@ -3039,8 +3929,6 @@ find_pc_sect_symtab (CORE_ADDR pc, asection *section)
 		 paddr_nz (pc), ps->filename? ps->filename : "");
       s = PSYMTAB_TO_SYMTAB (ps);
     }
-  /* APPLE LOCAL cache lookup values for improved performance  */
-  cached_symtab = s;
   return (s);
 }
 
@@ -3054,7 +3942,7 @@ find_pc_symtab (CORE_ADDR pc)
 }
 
 /* APPLE LOCAL begin cache lookup values for improved performance  */
-struct symtab_and_line *
+static struct symtab_and_line *
 copy_sal (struct symtab_and_line *orig)
 {
   struct symtab_and_line *copy;
@@ -3127,9 +4015,39 @@ copy_sal (struct symtab_and_line *orig)
    find the one whose first PC is closer than that of the next line in this
    symtab.  */
 
-/* If it's worth the effort, we could be using a binary search.  */
+/* APPLE LOCAL begin cache lookup values for improved performance  */
+static struct symtab_and_line find_pc_sect_line_1 (CORE_ADDR,
+						   struct bfd_section *, int);
+
 struct symtab_and_line
 find_pc_sect_line (CORE_ADDR pc, struct bfd_section *section, int notcurrent)
+{
+  enum pc_lookup_kind kind;
+  struct pc_lookup_entry *e;
+  struct symtab_and_line val;
+
+  notcurrent = (notcurrent != 0);
+  kind = notcurrent ? PC_LOOKUP_LINE_NOTCURRENT : PC_LOOKUP_LINE;
+  e = pc_lookup_cache_find (pc, section, kind);
+  if (e != NULL)
+    {
+      /* The cache owns the inlined call site list, so hand out a
+	 copy of it.  The head itself is returned by value.  */
+      val = *e->line[notcurrent];
+      val.next = copy_sal (val.next);
+      return val;
+    }
+
+  val = find_pc_sect_line_1 (pc, section, notcurrent);
+  pc_lookup_cache_add (pc, section, kind)->line[notcurrent] = copy_sal (&val);
+  return val;
+}
+/* APPLE LOCAL end cache lookup values for improved performance  */
+
+/* If it's worth the effort, we could be using a binary search.  */
+static struct symtab_and_line
+find_pc_sect_line_1 (CORE_ADDR pc, struct bfd_section *section,
+		     int notcurrent)
 {
   struct symtab *s;
   struct linetable *l;
@@ -3164,16 +4082,6 @@ find_pc_sect_line (CORE_ADDR pc, struct bfd_section *section, int notcurrent)
 
   struct linetable_entry *prev;
 
-  /* APPLE LOCAL begin cache lookup values for improved performance  */
-  if (pc == last_pc_line_lookup_pc
-      && pc == last_overlay_section_lookup_pc
-      && section == cached_overlay_section
-      && cached_pc_line)
-    return (*cached_pc_line);
-
-  last_pc_line_lookup_pc = pc;
-  /* APPLE LOCAL end cache lookup values for improved performance  */
-
   /* If this pc is not from the current frame,
      it is the address of the end of a call instruction.
      Quite likely that is the start of the following statement.
@@ -3260,14 +4168,7 @@ find_pc_sect_line (CORE_ADDR pc, struct bfd_section *section, int notcurrent)
 	  /* warning ("In stub for %s; unable to find real function/line info", SYMBOL_LINKAGE_NAME (msymbol)) */ ;
 	/* fall through */
 	else
-	  /* APPLE LOCAL end cache lookup values for improved performance  */
-	  {
-	    struct symtab_and_line sal = find_pc_line 
-                                            (SYMBOL_VALUE_ADDRESS (mfunsym), 0);
-	    cached_pc_line = copy_sal (&sal);
-	    return find_pc_line (SYMBOL_VALUE_ADDRESS (mfunsym), 0);
-	  }
-	  /* APPLE LOCAL end cache lookup values for improved performance  */
+	  return find_pc_line (SYMBOL_VALUE_ADDRESS (mfunsym), 0);
       }
 
 
@@ -3281,8 +4182,6 @@ find_pc_sect_line (CORE_ADDR pc, struct bfd_section *section, int notcurrent)
       /* APPLE LOCAL convert from character position to
 	 line number if necessary.  */
       convert_sal (&val);
-      /* APPLE LOCAL cache lookup values for improved performance  */
-      cached_pc_line = copy_sal (&val);
       return val;
     }
 
@@ -3544,8 +4443,6 @@ find_pc_sect_line (CORE_ADDR pc, struct bfd_section *section, int notcurrent)
   if (!inlined_entries_found)
     {
       gdb_assert (val.entry_type == NORMAL_LT_ENTRY);
-      /* APPLE LOCAL cache lookup values for improved performance  */
-      cached_pc_line = copy_sal (&val);
       return val;
     }
   else    
@@ -3654,8 +4551,6 @@ find_pc_sect_line (CORE_ADDR pc, struct bfd_section *section, int notcurrent)
  
       if (final_val.symtab == NULL)
 	warning ("Returning an unfilled final_val");
-      /* APPLE LOCAL cache lookup values for improved performance  */
-      cached_pc_line = copy_sal (&final_val);
      return final_val;
     }
   /* APPLE LOCAL end subroutine inlining  */
@@ -4523,6 +5418,13 @@ search_symbols (char *regexp, domain_enum kind, int nfiles, char *files[],
 	error (_("Invalid regexp (%s): %s"), val, regexp);
     }
 
+  /* APPLE LOCAL background symbol loading: The loops below look up
+     minimal symbols by name while walking them, and such a lookup
+     reads in any library still waiting to be loaded in the background
+     that has the name, freeing the minimal symbols being walked.  So
+     read all of those libraries in now.  */
+  objfile_background_load_all ();
+
   /* Search through the partial symtabs *first* for all symbols
      matching the regexp.  That way we don't have to reproduce all of
      the machinery below. */
@@ -5976,6 +6878,38 @@ All global and static variable names, or those matching REGEXP."));
 				  "<unknown type>", (struct objfile *) NULL);
 
   observer_attach_executable_changed (symtab_observer_executable_changed);
+
+  /* APPLE LOCAL begin demangle cache  */
+  add_setshow_optional_filename_cmd ("demangle-cache-file", class_support,
+				     &demangle_cache_file, _("\
+Set the file of the demangled name cache."), _("\
+Show the file of the demangled name cache."), _("\
+When set, the names of symbols are looked up in this file before they are\n\
+demangled, and the names demangled during this session are added to it\n\
+when GDB exits.  The file can be shared by any number of sessions.\n\
+An empty file name disables the cache."),
+				     set_demangle_cache_file,
+				     show_demangle_cache_file,
+				     &setlist, &showlist);
+
+  add_setshow_uinteger_cmd ("demangle-cache-size", class_support,
+			    &demangle_cache_size, _("\
+Set the size limit of the demangled name cache, in megabytes."), _("\
+Show the size limit of the demangled name cache, in megabytes."), _("\
+When the cache file is rebuilt and would grow past this size, the names\n\
+that were added to it longest ago are left out.  Zero means no limit."),
+			    NULL,
+			    show_demangle_cache_size,
+			    &setlist, &showlist);
+
+  add_cmd ("demangle-cache-stats", class_maintenance,
+	   maintenance_print_demangle_cache_stats, _("\
+Print how many symbol names were demangled, and how many were found in\n\
+the demangled name cache instead."),
+	   &maintenanceprintlist);
+
+  make_final_cleanup (demangle_cache_final_cleanup, NULL);
+  /* APPLE LOCAL end demangle cache  */
 }
 
 /* APPLE LOCAL begin address ranges  */
@@ -6039,32 +6973,152 @@ update_inlined_function_line_table_entry (CORE_ADDR start_pc,
 
 /* APPLE LOCAL begin cache lookup values for improved performance  */
 
-/* Something in the objfiles has changed, so we need to throw away all
-   our cached lookup values and start again, to make sure we aren't
-   caching and returning stale data.  */
+/* Free the line results held by entry E and mark it empty.  */
+
+static void
+pc_lookup_entry_clear (struct pc_lookup_entry *e)
+{
+  int i;
+
+  for (i = 0; i < 2; i++)
+    while (e->line[i] != NULL)
+      {
+	struct symtab_and_line *next = e->line[i]->next;
+
+	xfree (e->line[i]);
+	e->line[i] = next;
+      }
+  e->valid = 0;
+}
+
+/* Return the index in pc_lookup_stats of KIND.  */
+
+static int
+pc_lookup_kind_index (enum pc_lookup_kind kind)
+{
+  int i = 0;
+
+  while ((1 << i) != kind)
+    i++;
+  return i;
+}
+
+static struct pc_lookup_entry *
+pc_lookup_set (CORE_ADDR pc, asection *section)
+{
+  unsigned long h;
+
+  h = (unsigned long) pc ^ ((unsigned long) pc >> 12)
+      ^ ((unsigned long) section >> 4);
+  return pc_lookup_cache[h % PC_LOOKUP_SETS];
+}
+
+struct pc_lookup_entry *
+pc_lookup_cache_find (CORE_ADDR pc, asection *section,
+		      enum pc_lookup_kind kind)
+{
+  struct pc_lookup_entry *set = pc_lookup_set (pc, section);
+  int kind_index = pc_lookup_kind_index (kind);
+  int i;
+
+  pc_lookup_stats.lookups[kind_index]++;
+  for (i = 0; i < PC_LOOKUP_WAYS; i++)
+    {
+      struct pc_lookup_entry *e = &set[i];
+
+      if ((e->valid & kind)
+	  && e->pc == pc
+	  && e->section == section
+	  && e->generation == objfile_generation)
+	{
+	  e->last_use = ++pc_lookup_clock;
+	  pc_lookup_stats.hits[kind_index]++;
+	  return e;
+	}
+    }
+  return NULL;
+}
+
+struct pc_lookup_entry *
+pc_lookup_cache_add (CORE_ADDR pc, asection *section,
+		     enum pc_lookup_kind kind)
+{
+  struct pc_lookup_entry *set = pc_lookup_set (pc, section);
+  struct pc_lookup_entry *e = NULL;
+  int i;
+
+  for (i = 0; i < PC_LOOKUP_WAYS; i++)
+    if (set[i].valid
+	&& set[i].pc == pc
+	&& set[i].section == section
+	&& set[i].generation == objfile_generation)
+      {
+	e = &set[i];
+	break;
+      }
+
+  if (e == NULL)
+    {
+      /* Prefer an empty or stale entry, else the least recently
+	 used.  */
+      for (i = 0; i < PC_LOOKUP_WAYS; i++)
+	{
+	  if (set[i].valid == 0 || set[i].generation != objfile_generation)
+	    {
+	      e = &set[i];
+	      break;
+	    }
+	  if (e == NULL || set[i].last_use < e->last_use)
+	    e = &set[i];
+	}
+      if (e->valid && e->generation == objfile_generation)
+	pc_lookup_stats.evictions++;
+      pc_lookup_entry_clear (e);
+      e->pc = pc;
+      e->section = section;
+      e->generation = objfile_generation;
+    }
+
+  e->valid |= kind;
+  e->last_use = ++pc_lookup_clock;
+  return e;
+}
 
 void
 symtab_clear_cached_lookup_values (void)
 {
-  cached_mapped_section = NULL;
-  cached_overlay_section = NULL;
-  cached_sect_section = NULL;
-  cached_symtab = NULL;
-  cached_psymtab = NULL;
-  cached_pc_line = NULL;
-  cached_pc_function = NULL;
-  cached_blockvector = NULL;
-  cached_blockvector_index = -1;
-  cached_block = NULL;
-  
-  last_block_lookup_pc = INVALID_ADDRESS;
-  last_blockvector_lookup_pc = INVALID_ADDRESS;
-  last_function_lookup_pc = INVALID_ADDRESS;
-  last_pc_line_lookup_pc = INVALID_ADDRESS;
-  last_psymtab_lookup_pc = INVALID_ADDRESS;
-  last_symtab_lookup_pc = INVALID_ADDRESS;
-  last_sect_section_lookup_pc = INVALID_ADDRESS;
-  last_mapped_section_lookup_pc = INVALID_ADDRESS;
-  last_overlay_section_lookup_pc = INVALID_ADDRESS;
+  int i, j;
+
+  for (i = 0; i < PC_LOOKUP_SETS; i++)
+    for (j = 0; j < PC_LOOKUP_WAYS; j++)
+      if (pc_lookup_cache[i][j].valid)
+	pc_lookup_entry_clear (&pc_lookup_cache[i][j]);
+  pc_lookup_stats.flushes++;
+}
+
+void
+print_pc_lookup_cache_statistics (void)
+{
+  static const char *names[] =
+    {
+      "psymtab", "symtab", "function", "block", "line",
+      "line (not current)", "section"
+    };
+  int i;
+
+  printf_filtered (_("PC lookup cache statistics:\n"));
+  printf_filtered (_("  Entries: %d (%d-way)\n"),
+		   PC_LOOKUP_SETS * PC_LOOKUP_WAYS, PC_LOOKUP_WAYS);
+  for (i = 0; i < PC_LOOKUP_NKINDS; i++)
+    {
+      unsigned long lookups = pc_lookup_stats.lookups[i];
+      unsigned long hits = pc_lookup_stats.hits[i];
+
+      printf_filtered (_("  %s lookups: %lu, hits: %lu (%lu%%)\n"),
+		       names[i], lookups, hits,
+		       lookups ? (hits * 100) / lookups : 0UL);
+    }
+  printf_filtered (_("  Evictions: %lu\n"), pc_lookup_stats.evictions);
+  printf_filtered (_("  Flushes: %lu\n"), pc_lookup_stats.flushes);
 }
 /* APPLE LOCAL end cache lookup values for improved performance  */
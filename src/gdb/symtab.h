@@ -1408,6 +1408,9 @@ extern void install_minimal_symbols (struct objfile *);
 
 extern void msymbols_sort (struct objfile *objfile);
 
+/* APPLE LOCAL minsym address table  */
+extern void free_minimal_symbol_address_table (struct objfile *objfile);
+
 struct symtab_and_line
 {
   struct symtab *symtab;
@@ -1670,28 +1673,69 @@ extern int psym_name_match (const char *, const char *);
 
 /* APPLE LOCAL begin cache lookup values for improved performance  */
 
-extern asection * cached_mapped_section;
-extern asection * cached_overlay_section;
-extern struct obj_section * cached_sect_section;
-extern struct symtab * cached_symtab;
-extern struct partial_symtab * cached_psymtab;
-extern struct symtab_and_line * cached_pc_line;
-extern struct symbol * cached_pc_function;
-extern struct blockvector * cached_blockvector;
-extern int cached_blockvector_index;
-extern struct block * cached_block;
-
-extern CORE_ADDR last_block_lookup_pc;
-extern CORE_ADDR last_blockvector_lookup_pc;
-extern CORE_ADDR last_function_lookup_pc;
-extern CORE_ADDR last_pc_line_lookup_pc;
-extern CORE_ADDR last_psymtab_lookup_pc;
-extern CORE_ADDR last_symtab_lookup_pc;
-extern CORE_ADDR last_sect_section_lookup_pc;
-extern CORE_ADDR last_mapped_section_lookup_pc;
-extern CORE_ADDR last_overlay_section_lookup_pc;
-
-void symtab_clear_cached_lookup_values (void);
+/* The kinds of PC lookup whose results the PC lookup cache keeps.  */
+
+enum pc_lookup_kind
+{
+  PC_LOOKUP_PSYMTAB = 1 << 0,
+  PC_LOOKUP_SYMTAB = 1 << 1,
+  PC_LOOKUP_FUNCTION = 1 << 2,
+  PC_LOOKUP_BLOCKVECTOR = 1 << 3,
+  PC_LOOKUP_LINE = 1 << 4,
+  PC_LOOKUP_LINE_NOTCURRENT = 1 << 5,
+  PC_LOOKUP_OBJ_SECTION = 1 << 6
+};
+
+#define PC_LOOKUP_NKINDS 7
+
+/* What we have found out about a PC in a section.  VALID holds the
+   pc_lookup_kind bits of the results below that have been filled in;
+   a NULL result is a valid result.  */
+
+struct pc_lookup_entry
+{
+  CORE_ADDR pc;
+  asection *section;
+
+  /* The objfile_generation this entry was made in.  */
+  unsigned int generation;
+
+  unsigned int valid;
+  unsigned long last_use;
+
+  struct partial_symtab *psymtab;
+  struct symtab *symtab;
+  struct symbol *function;
+  struct blockvector *blockvector;
+  int blockvector_index;
+  struct obj_section *obj_section;
+
+  /* Owned by the cache; indexed by find_pc_sect_line's NOTCURRENT.  */
+  struct symtab_and_line *line[2];
+};
+
+/* Return the cache entry for PC in SECTION if it holds a KIND result,
+   else NULL.  */
+
+extern struct pc_lookup_entry *pc_lookup_cache_find (CORE_ADDR pc,
+						     asection *section,
+						     enum pc_lookup_kind kind);
+
+/* Return the cache entry for PC in SECTION, making one if need be, and
+   mark its KIND result valid.  The caller must fill that result in
+   before doing any other lookup.  */
+
+extern struct pc_lookup_entry *pc_lookup_cache_add (CORE_ADDR pc,
+						    asection *section,
+						    enum pc_lookup_kind kind);
+
+/* Forget everything in the PC lookup cache.  Changes to the objfiles
+   invalidate the cache by themselves (see objfile_generation); this
+   is for lookups whose answer depends on other state.  */
+
+extern void symtab_clear_cached_lookup_values (void);
+
+extern void print_pc_lookup_cache_statistics (void);
 
 /* APPLE LOCAL end cache lookup values for improved performance  */
 
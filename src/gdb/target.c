@@ -47,6 +47,7 @@
 #include "gdbarch.h"
 #include "exceptions.h"
 #include "exec.h"
+#include "observer.h"
 
 static void target_info (char *, int);
 
@@ -304,6 +305,7 @@ void
 target_load (char *arg, int from_tty)
 {
   dcache_invalidate (target_dcache);
+  target_invalidate_read_coalescing ();
   (*current_target.to_load) (arg, from_tty);
 }
 
@@ -506,6 +508,8 @@ update_current_target (void)
       /* APPLE LOCAL remove to_async_mask_value */
       INHERIT (to_find_memory_regions, t);
       INHERIT (to_make_corefile_notes, t);
+      /* APPLE LOCAL gcore -z */
+      INHERIT (to_find_untouched_pages, t);
       /* APPLE LOCAL to_bind_function */
       INHERIT (to_bind_function, t);
       /* APPLE LOCAL to_get_thread_name */
@@ -728,6 +732,10 @@ update_current_target (void)
            return_zero);
   de_fault (to_bind_function,
            (int (*) (char *)) return_one);
+  /* APPLE LOCAL gcore -z */
+  de_fault (to_find_untouched_pages,
+           (int (*) (CORE_ADDR, int, unsigned long, unsigned char *))
+           return_zero);
   de_fault (to_check_safe_call,
            (int (*) (char *)) return_one);
   de_fault (to_setup_safe_print,
@@ -963,17 +971,272 @@ done:
 struct section_table *
 target_section_by_addr (struct target_ops *target, CORE_ADDR addr)
 {
-  struct section_table *secp;
-  for (secp = target->to_sections;
-       secp < target->to_sections_end;
-       secp++)
+  /* APPLE LOCAL section index */
+  return section_table_lookup (target, addr, NULL);
+}
+
+/* Transfer memory from the first of OPS and the targets beneath it
+   that can supply any of it.  The arguments and return value are just
+   as for target_xfer_partial.
+
+   Normally a single call to to_xfer_partial is enough; if it doesn't
+   recognize an object it will call the to_xfer_partial of the next
+   target down.  But for memory this won't do.  Memory is the only
+   target object which can be read from more than one valid target.
+   A core file, for instance, could have some of memory but delegate
+   other bits to the target below it.  So, we must manually try all
+   targets.  */
+
+static LONGEST
+memory_xfer_strata (struct target_ops *ops, void *readbuf,
+		    const void *writebuf, ULONGEST memaddr, LONGEST len)
+{
+  LONGEST res;
+
+  do
     {
-      if (addr >= secp->addr && addr < secp->endaddr)
-	return secp;
+      res = ops->to_xfer_partial (ops, TARGET_OBJECT_MEMORY, NULL,
+				  readbuf, writebuf, memaddr, len);
+      if (res > 0)
+	return res;
+
+      ops = ops->beneath;
     }
+  while (ops != NULL);
+
+  /* If we still haven't got anything, return the last error.  We
+     give up.  */
+  return res;
+}
+
+/* APPLE LOCAL begin read coalescing */
+/* While a command runs, small reads of memory that no "mem" region
+   describes are served from blocks of read_coalesce_size bytes,
+   aligned to their size.  Each run of missing blocks is fetched with
+   one transfer, so printing a large structure costs a transfer per
+   block it touches rather than one per member or pointer it follows.
+   The blocks are dropped when the command finishes, when the target
+   resumes, and when GDB writes to memory.
+
+   This reads memory the user never asked for, which may be device
+   registers or a guard page, so it is off unless asked for.  */
+
+#define READ_COALESCE_BLOCKS 32
+
+/* Size of a block, a power of 2; 0 turns coalescing off.  */
+static int read_coalesce_size = 0;
+
+/* Number of commands currently running with coalescing enabled.  */
+static int read_coalesce_depth;
+
+struct read_coalesce_block
+{
+  CORE_ADDR addr;
+  gdb_byte *data;
+
+  /* Value of read_coalesce_clock when the block was last used, or 0
+     if it holds nothing.  */
+  unsigned long last_use;
+};
+
+static struct read_coalesce_block read_coalesce_blocks[READ_COALESCE_BLOCKS];
+static unsigned long read_coalesce_clock;
+
+void
+target_invalidate_read_coalescing (void)
+{
+  int i;
+
+  for (i = 0; i < READ_COALESCE_BLOCKS; i++)
+    read_coalesce_blocks[i].last_use = 0;
+}
+
+static void
+end_read_coalescing (void *unused)
+{
+  if (--read_coalesce_depth == 0)
+    target_invalidate_read_coalescing ();
+}
+
+/* Coalesce memory reads until the returned cleanup is run.  */
+
+struct cleanup *
+make_cleanup_coalesce_memory_reads (void)
+{
+  read_coalesce_depth++;
+  return make_cleanup (end_read_coalescing, NULL);
+}
+
+static struct read_coalesce_block *
+read_coalesce_lookup (CORE_ADDR addr)
+{
+  int i;
+
+  for (i = 0; i < READ_COALESCE_BLOCKS; i++)
+    if (read_coalesce_blocks[i].last_use != 0
+	&& read_coalesce_blocks[i].addr == addr)
+      return &read_coalesce_blocks[i];
   return NULL;
 }
 
+/* Return an empty block, or else the least recently used one, to hold
+   the memory at ADDR.  */
+
+static struct read_coalesce_block *
+read_coalesce_alloc (CORE_ADDR addr)
+{
+  struct read_coalesce_block *blk = &read_coalesce_blocks[0];
+  int i;
+
+  for (i = 1; i < READ_COALESCE_BLOCKS && blk->last_use != 0; i++)
+    if (read_coalesce_blocks[i].last_use < blk->last_use)
+      blk = &read_coalesce_blocks[i];
+
+  if (blk->data == NULL)
+    blk->data = xmalloc (read_coalesce_size);
+  blk->addr = addr;
+  blk->last_use = ++read_coalesce_clock;
+  return blk;
+}
+
+/* Read the NBLOCKS blocks starting at ADDR with as few transfers as
+   the targets allow, and keep the ones we could read in full.  */
+
+static void
+read_coalesce_fill (struct target_ops *ops, CORE_ADDR addr, int nblocks)
+{
+  LONGEST want = (LONGEST) nblocks * read_coalesce_size;
+  LONGEST got = 0;
+  struct cleanup *old_chain;
+  gdb_byte *buf;
+  int i;
+
+  buf = xmalloc (want);
+  old_chain = make_cleanup (xfree, buf);
+
+  while (got < want)
+    {
+      LONGEST res = memory_xfer_strata (ops, buf + got, NULL,
+					addr + got, want - got);
+      if (res <= 0)
+	break;
+      got += res;
+    }
+
+  for (i = 0; i < got / read_coalesce_size; i++)
+    {
+      struct read_coalesce_block *blk;
+
+      blk = read_coalesce_alloc (addr + (CORE_ADDR) i * read_coalesce_size);
+      memcpy (blk->data, buf + i * read_coalesce_size, read_coalesce_size);
+    }
+
+  do_cleanups (old_chain);
+}
+
+/* Read LEN bytes at MEMADDR, which lie in REGION, through the
+   coalescing blocks.  Return the number of bytes read from the start
+   of the range, or -1 if the caller should read them itself.  */
+
+static LONGEST
+read_coalesced (struct target_ops *ops, gdb_byte *readbuf,
+		ULONGEST memaddr, LONGEST len, struct mem_region *region)
+{
+  CORE_ADDR mask = ~((CORE_ADDR) read_coalesce_size - 1);
+  CORE_ADDR first = memaddr & mask;
+  CORE_ADDR last = (memaddr + len - 1) & mask;
+  int nblocks;
+  LONGEST done;
+  int i;
+
+  if (last < first)
+    return -1;
+  /* Reads that span many blocks are big enough on their own.  */
+  nblocks = (last - first) / read_coalesce_size + 1;
+  if (nblocks > READ_COALESCE_BLOCKS / 2)
+    return -1;
+  /* Stay out of the memory regions around this one.  */
+  if (first < region->lo
+      || (region->hi != 0 && last + (read_coalesce_size - 1) >= region->hi))
+    return -1;
+
+  for (i = 0; i < nblocks; )
+    {
+      int start = i;
+
+      if (read_coalesce_lookup (first + (CORE_ADDR) i * read_coalesce_size))
+	{
+	  i++;
+	  continue;
+	}
+      while (i < nblocks
+	     && !read_coalesce_lookup (first + (CORE_ADDR) i * read_coalesce_size))
+	i++;
+      read_coalesce_fill (ops, first + (CORE_ADDR) start * read_coalesce_size,
+			  i - start);
+    }
+
+  for (done = 0; done < len; )
+    {
+      CORE_ADDR addr = memaddr + done;
+      struct read_coalesce_block *blk;
+      LONGEST offset;
+      LONGEST chunk;
+
+      blk = read_coalesce_lookup (addr & mask);
+      if (blk == NULL)
+	break;
+      offset = addr - blk->addr;
+      chunk = read_coalesce_size - offset;
+      if (chunk > len - done)
+	chunk = len - done;
+      memcpy ((gdb_byte *) readbuf + done, blk->data + offset, chunk);
+      blk->last_use = ++read_coalesce_clock;
+      done += chunk;
+    }
+
+  return done > 0 ? done : -1;
+}
+
+/* Round "set read-coalesce-size" up to a power of 2, and drop the
+   blocks, which were allocated at the old size.  */
+
+static void
+set_read_coalesce_size (char *args, int from_tty, struct cmd_list_element *c)
+{
+  int size;
+  int i;
+
+  if (read_coalesce_size < 0)
+    read_coalesce_size = 0;
+  if (read_coalesce_size > 0)
+    {
+      for (size = 64; size < read_coalesce_size && size < 0x100000; size <<= 1)
+	;
+      read_coalesce_size = size;
+    }
+
+  for (i = 0; i < READ_COALESCE_BLOCKS; i++)
+    {
+      xfree (read_coalesce_blocks[i].data);
+      read_coalesce_blocks[i].data = NULL;
+      read_coalesce_blocks[i].last_use = 0;
+    }
+}
+
+static void
+show_read_coalesce_size (struct ui_file *file, int from_tty,
+			 struct cmd_list_element *c, const char *value)
+{
+  if (read_coalesce_size == 0)
+    fprintf_filtered (file, _("Coalescing of memory reads is off.\n"));
+  else
+    fprintf_filtered (file, _("\
+Small memory reads are coalesced into blocks of %s bytes.\n"),
+		      value);
+}
+/* APPLE LOCAL end read coalescing */
+
 /* Perform a partial memory transfer.  The arguments and return
    value are just as for target_xfer_partial.  */
 
@@ -1039,6 +1302,18 @@ memory_xfer_partial (struct target_ops *ops, void *readbuf,
       break;
     }
 
+  /* APPLE LOCAL: Gather small reads into larger transfers while a
+     command runs.  Only do this where the user hasn't described the
+     memory, since a "mem" region may cover device registers.  */
+  if (readbuf != NULL && region->number == 0
+      && read_coalesce_depth > 0 && read_coalesce_size > 0
+      && !only_read_from_live_memory)
+    {
+      res = read_coalesced (ops, readbuf, memaddr, reg_len, region);
+      if (res > 0)
+	return res;
+    }
+
   /* APPLE LOCAL: We use -1 to mean "caching temporarily disabled.  */
   if (region->attrib.cache == 1 && !only_read_from_live_memory)
     {
@@ -1061,29 +1336,8 @@ memory_xfer_partial (struct target_ops *ops, void *readbuf,
     }
 
   /* If none of those methods found the memory we wanted, fall back
-     to a target partial transfer.  Normally a single call to
-     to_xfer_partial is enough; if it doesn't recognize an object
-     it will call the to_xfer_partial of the next target down.
-     But for memory this won't do.  Memory is the only target
-     object which can be read from more than one valid target.
-     A core file, for instance, could have some of memory but
-     delegate other bits to the target below it.  So, we must
-     manually try all targets.  */
-
-  do
-    {
-      res = ops->to_xfer_partial (ops, TARGET_OBJECT_MEMORY, NULL,
-				  readbuf, writebuf, memaddr, len);
-      if (res > 0)
-	return res;
-
-      ops = ops->beneath;
-    }
-  while (ops != NULL);
-
-  /* If we still haven't got anything, return the last error.  We
-     give up.  */
-  return res;
+     to a target partial transfer.  */
+  return memory_xfer_strata (ops, readbuf, writebuf, memaddr, len);
 }
 
 static LONGEST
@@ -1096,11 +1350,22 @@ target_xfer_partial (struct target_ops *ops,
 
   gdb_assert (ops->to_xfer_partial != NULL);
 
+  /* APPLE LOCAL: Coalesced reads mustn't outlive a write.  */
+  if (writebuf != NULL
+      && (object == TARGET_OBJECT_MEMORY
+	  || object == TARGET_OBJECT_RAW_MEMORY))
+    target_invalidate_read_coalescing ();
+
   /* If this is a memory transfer, let the memory-specific code
      have a look at it instead.  Memory transfers are more
      complicated.  */
   if (object == TARGET_OBJECT_MEMORY)
-    retval = memory_xfer_partial (ops, readbuf, writebuf, offset, len);
+    {
+      retval = memory_xfer_partial (ops, readbuf, writebuf, offset, len);
+      /* APPLE LOCAL: Let anyone caching inferior memory know.  */
+      if (writebuf != NULL && retval > 0)
+	observer_notify_memory_changed (offset, (int) retval);
+    }
   else
     {
       enum target_object raw_object = object;
@@ -1202,6 +1467,176 @@ target_write_memory (CORE_ADDR memaddr, const gdb_byte *myaddr, int len)
     return EIO;
 }
 
+/* APPLE LOCAL begin search memory */
+/* The amount of memory simple_search_memory reads at a time.  */
+
+#define SEARCH_CHUNK_SIZE (64 * 1024)
+
+const gdb_byte *
+find_pattern_in_buffer (const gdb_byte *buf, ULONGEST buf_len,
+			const gdb_byte *pattern, ULONGEST pattern_len)
+{
+  const gdb_byte *p, *end;
+
+  if (pattern_len == 0)
+    return buf;
+  if (buf_len < pattern_len)
+    return NULL;
+
+  /* Let memchr, which the C library makes fast, skip to each place the
+     first byte of the pattern occurs, and only compare the rest of
+     the pattern there.  */
+  p = buf;
+  end = buf + (buf_len - pattern_len) + 1;
+  while (p < end)
+    {
+      p = memchr (p, pattern[0], end - p);
+      if (p == NULL)
+	return NULL;
+      if (memcmp (p + 1, pattern + 1, pattern_len - 1) == 0)
+	return p;
+      p++;
+    }
+
+  return NULL;
+}
+
+int
+simple_search_memory (struct target_ops *ops,
+		      CORE_ADDR start_addr, ULONGEST search_space_len,
+		      const gdb_byte *pattern, ULONGEST pattern_len,
+		      CORE_ADDR *found_addrp)
+{
+  /* Each chunk we search overlaps the next by PATTERN_LEN - 1 bytes,
+     so that a match straddling the two is still found.  */
+  ULONGEST chunk_size = SEARCH_CHUNK_SIZE;
+  ULONGEST search_buf_size;
+  gdb_byte *search_buf;
+  struct cleanup *old_cleanups;
+
+  search_buf_size = chunk_size + pattern_len - 1;
+  if (search_buf_size > search_space_len)
+    search_buf_size = search_space_len;
+
+  search_buf = xmalloc (search_buf_size);
+  old_cleanups = make_cleanup (xfree, search_buf);
+
+  if (target_read (ops, TARGET_OBJECT_MEMORY, NULL, search_buf,
+		   start_addr, search_buf_size) != search_buf_size)
+    {
+      warning (_("Unable to access target memory at %s, halting search."),
+	       paddr_nz (start_addr));
+      do_cleanups (old_cleanups);
+      return -1;
+    }
+
+  while (search_space_len >= pattern_len)
+    {
+      ULONGEST nr_search_bytes = min (search_space_len, search_buf_size);
+      const gdb_byte *found_ptr;
+
+      QUIT;
+
+      found_ptr = find_pattern_in_buffer (search_buf, nr_search_bytes,
+					  pattern, pattern_len);
+      if (found_ptr != NULL)
+	{
+	  *found_addrp = start_addr + (found_ptr - search_buf);
+	  do_cleanups (old_cleanups);
+	  return 1;
+	}
+
+      if (search_space_len >= chunk_size)
+	search_space_len -= chunk_size;
+      else
+	search_space_len = 0;
+
+      if (search_space_len >= pattern_len)
+	{
+	  ULONGEST keep_len = search_buf_size - chunk_size;
+	  CORE_ADDR read_addr = start_addr + chunk_size + keep_len;
+	  ULONGEST nr_to_read;
+
+	  /* Keep the tail of this chunk, which a match may start in, and
+	     read in the rest of the next one after it.  */
+	  gdb_assert (keep_len == pattern_len - 1);
+	  memcpy (search_buf, search_buf + chunk_size, keep_len);
+
+	  nr_to_read = min (search_space_len - keep_len, chunk_size);
+	  if (target_read (ops, TARGET_OBJECT_MEMORY, NULL,
+			   search_buf + keep_len, read_addr,
+			   nr_to_read) != nr_to_read)
+	    {
+	      warning (_("Unable to access target memory at %s, halting search."),
+		       paddr_nz (read_addr));
+	      do_cleanups (old_cleanups);
+	      return -1;
+	    }
+
+	  start_addr += chunk_size;
+	}
+    }
+
+  do_cleanups (old_cleanups);
+  return 0;
+}
+
+int
+target_search_memory (CORE_ADDR start_addr, ULONGEST search_space_len,
+		      const gdb_byte *pattern, ULONGEST pattern_len,
+		      CORE_ADDR *found_addrp)
+{
+  struct target_ops *t;
+  int found;
+
+  if (targetdebug)
+    fprintf_unfiltered (gdb_stdlog, "target_search_memory (%s, ...)\n",
+			paddr_nz (start_addr));
+
+  /* Use the first target on the stack that can search for itself.  */
+  for (t = current_target.beneath; t != NULL; t = t->beneath)
+    if (t->to_search_memory != NULL)
+      break;
+
+  if (t != NULL)
+    found = t->to_search_memory (t, start_addr, search_space_len,
+				 pattern, pattern_len, found_addrp);
+  else
+    found = simple_search_memory (&current_target, start_addr,
+				  search_space_len, pattern, pattern_len,
+				  found_addrp);
+
+  if (targetdebug)
+    fprintf_unfiltered (gdb_stdlog, "  = %d\n", found);
+
+  return found;
+}
+/* APPLE LOCAL end search memory */
+
+/* APPLE LOCAL begin verify memory */
+int
+target_verify_memory (const gdb_byte *data, CORE_ADDR memaddr,
+		      ULONGEST size)
+{
+  struct target_ops *t;
+  int result = -1;
+
+  for (t = current_target.beneath; t != NULL; t = t->beneath)
+    if (t->to_verify_memory != NULL)
+      {
+	result = t->to_verify_memory (t, data, memaddr, size);
+	break;
+      }
+
+  if (targetdebug)
+    fprintf_unfiltered (gdb_stdlog,
+			"target_verify_memory (0x%s, %s) = %d\n",
+			paddr_nz (memaddr), paddr_u (size), result);
+
+  return result;
+}
+/* APPLE LOCAL end verify memory */
+
 #ifndef target_stopped_data_address_p
 int
 target_stopped_data_address_p (struct target_ops *target)
@@ -1578,6 +2013,9 @@ return_minus_one (void)
   return -1;
 }
 
+/* APPLE LOCAL section index */
+unsigned int target_sections_generation;
+
 /*
  * Resize the to_sections pointer.  Also make sure that anyone that
  * was holding on to an old value of it gets updated.
@@ -1607,6 +2045,8 @@ target_resize_to_sections (struct target_ops *target, int num_added)
 	xmalloc ((sizeof (struct section_table)) * num_added);
     }
   target->to_sections_end = target->to_sections + (num_added + old_count);
+  /* APPLE LOCAL section index */
+  target_sections_generation++;
 
   /* Check to see if anyone else was pointing to this structure.
      If old_value was null, then no one was. */
@@ -2815,6 +3255,22 @@ result in significant performance improvement for remote targets."),
 			   show_trust_readonly,
 			   &setlist, &showlist);
 
+  /* APPLE LOCAL read coalescing */
+  add_setshow_zinteger_cmd ("read-coalesce-size", class_support,
+			    &read_coalesce_size, _("\
+Set the size of the blocks small memory reads are coalesced into."), _("\
+Show the size of the blocks small memory reads are coalesced into."), _("\
+While a command runs, small reads of target memory are served from blocks\n\
+of this many bytes, each run of them fetched with a single transfer, so\n\
+that printing a large structure costs fewer round trips to a remote target.\n\
+The size is rounded up to a power of 2.  Memory described by \"mem\" regions\n\
+is never coalesced.  Since the blocks take in bytes around the ones asked\n\
+for, only turn this on where reading any unmapped memory is harmless.\n\
+Zero, the default, turns coalescing off."),
+			    set_read_coalesce_size,
+			    show_read_coalesce_size,
+			    &setlist, &showlist);
+
   add_com ("monitor", class_obscure, do_monitor_command,
 	   _("Send a command to the remote monitor (remote targets only)."));
 
@@ -433,6 +433,13 @@ struct target_ops
 					    void *),
 				   void *);
     char * (*to_make_corefile_notes) (bfd *, int *);
+    /* APPLE LOCAL: Set UNTOUCHED[I] non-zero for each of the NPAGES
+       pages of PAGE_SIZE bytes starting at ADDR that the inferior has
+       never touched, and so read as zeros.  Return non-zero, or zero
+       if the target can't tell.  */
+    int (*to_find_untouched_pages) (CORE_ADDR addr, int page_size,
+				    unsigned long npages,
+				    unsigned char *untouched);
     int (*to_bind_function) (char *);
     
     /* Return the thread-local address at OFFSET in the
@@ -504,6 +511,28 @@ struct target_ops
     void (*to_restore_thread_inferior_status) (void *);
     void (*to_free_thread_inferior_status) (void *);
 
+    /* APPLE LOCAL begin search memory */
+    /* Search SEARCH_SPACE_LEN bytes beginning at START_ADDR for the
+       PATTERN_LEN bytes in PATTERN.  Return 1 and set *FOUND_ADDRP
+       if found, 0 if not found, or -1 if there was an error.  This
+       method is not inherited; target_search_memory looks for the
+       first target on the stack which has one.  */
+    int (*to_search_memory) (struct target_ops *ops,
+			     CORE_ADDR start_addr, ULONGEST search_space_len,
+			     const gdb_byte *pattern, ULONGEST pattern_len,
+			     CORE_ADDR *found_addrp);
+    /* APPLE LOCAL end search memory */
+
+    /* APPLE LOCAL begin verify memory */
+    /* Compare the SIZE bytes of target memory at MEMADDR with the SIZE
+       bytes in DATA, without reading the memory into gdb.  Return 1
+       if they are the same, 0 if they differ, or -1 if the target
+       can't tell.  Like to_search_memory, this method is not
+       inherited.  */
+    int (*to_verify_memory) (struct target_ops *ops, const gdb_byte *data,
+			     CORE_ADDR memaddr, ULONGEST size);
+    /* APPLE LOCAL end verify memory */
+
     int to_magic;
     /* Need sub-structure for target machine related rather than comm related?
      */
@@ -577,6 +606,7 @@ extern void target_disconnect (char *, int);
 #define	target_resume(ptid, step, siggnal)				\
   do {									\
     dcache_invalidate(target_dcache);					\
+    target_invalidate_read_coalescing ();				\
     (*current_target.to_resume) (ptid, step, siggnal);			\
   } while (0)
 
@@ -627,6 +657,12 @@ extern void target_disconnect (char *, int);
 
 extern DCACHE *target_dcache;
 
+/* APPLE LOCAL begin read coalescing */
+extern struct cleanup *make_cleanup_coalesce_memory_reads (void);
+
+extern void target_invalidate_read_coalescing (void);
+/* APPLE LOCAL end read coalescing */
+
 extern int target_read_string (CORE_ADDR, char **, int, int *);
 
 extern int target_read_memory (CORE_ADDR memaddr, gdb_byte *myaddr, int len);
@@ -634,6 +670,49 @@ extern int target_read_memory (CORE_ADDR memaddr, gdb_byte *myaddr, int len);
 extern int target_write_memory (CORE_ADDR memaddr, const gdb_byte *myaddr,
 				int len);
 
+/* APPLE LOCAL begin search memory */
+/* Search SEARCH_SPACE_LEN bytes of target memory beginning at
+   START_ADDR for the PATTERN_LEN bytes in PATTERN.  Return 1 and set
+   *FOUND_ADDRP to the address of the first match if found, 0 if not
+   found, or -1 if some of the memory couldn't be read.  */
+
+extern int target_search_memory (CORE_ADDR start_addr,
+				 ULONGEST search_space_len,
+				 const gdb_byte *pattern,
+				 ULONGEST pattern_len,
+				 CORE_ADDR *found_addrp);
+
+/* Search memory like target_search_memory, by reading it through OPS
+   and looking for PATTERN in gdb.  Targets with no faster way to do
+   the search can use this.  */
+
+extern int simple_search_memory (struct target_ops *ops,
+				 CORE_ADDR start_addr,
+				 ULONGEST search_space_len,
+				 const gdb_byte *pattern,
+				 ULONGEST pattern_len,
+				 CORE_ADDR *found_addrp);
+
+/* Return a pointer to the first occurrence of the PATTERN_LEN bytes
+   in PATTERN within the BUF_LEN bytes at BUF, or NULL if there is
+   none.  */
+
+extern const gdb_byte *find_pattern_in_buffer (const gdb_byte *buf,
+					       ULONGEST buf_len,
+					       const gdb_byte *pattern,
+					       ULONGEST pattern_len);
+/* APPLE LOCAL end search memory */
+
+/* APPLE LOCAL begin verify memory */
+/* Compare the SIZE bytes of target memory at MEMADDR with DATA, using
+   the first target on the stack that can do so cheaply.  Return 1 if
+   they are the same, 0 if they differ, or -1 if no target can tell
+   without reading the memory.  */
+
+extern int target_verify_memory (const gdb_byte *data, CORE_ADDR memaddr,
+				 ULONGEST size);
+/* APPLE LOCAL end verify memory */
+
 extern int xfer_memory (CORE_ADDR, gdb_byte *, int, int,
 			struct mem_attrib *, struct target_ops *);
 
@@ -1084,6 +1163,14 @@ extern void (*deprecated_target_new_objfile_hook) (struct objfile *);
 #define target_make_corefile_notes(BFD, SIZE_P) \
      (current_target.to_make_corefile_notes) (BFD, SIZE_P)
 
+/*
+ * APPLE LOCAL: Find the pages of the inferior that were never touched.
+ */
+
+#define target_find_untouched_pages(ADDR, PAGE_SIZE, NPAGES, UNTOUCHED) \
+     (current_target.to_find_untouched_pages) (ADDR, PAGE_SIZE, NPAGES, \
+					       UNTOUCHED)
+
 /*
  * Bind function NAME into the target process
  */
@@ -1339,6 +1426,11 @@ extern struct target_ops *find_target_beneath (struct target_ops *);
 extern int target_resize_to_sections (struct target_ops *target,
 				      int num_added);
 
+/* APPLE LOCAL: Bumped whenever a section table is resized or its
+   addresses are changed, so that indexes built over a table (see
+   section_table_lookup) know to rebuild themselves.  */
+extern unsigned int target_sections_generation;
+
 extern void remove_target_sections (bfd *abfd);
 
 
@@ -0,0 +1,57 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+/* Each section gets its own sequence in the line number program, so
+   the function in __dead_text has a sequence to itself, which the
+   debug map says the linker discarded.  */
+
+int counter;
+
+void
+live_before (void)
+{
+  counter += 1; /* live before body */
+}
+
+__attribute__ ((section ("__TEXT,__dead_text"), noinline)) void
+dead_func (void)
+{
+  counter += 100; /* dead body */
+}
+
+__attribute__ ((section ("__TEXT,__live_text"), noinline)) void
+live_other (void)
+{
+  counter += 2; /* live other body */
+}
+
+void
+live_after (void)
+{
+  counter += 4; /* live after body */
+}
+
+int
+main (void)
+{
+  live_before ();
+  live_other (); /* call live_other */
+  live_after ();
+  return 0;
+}
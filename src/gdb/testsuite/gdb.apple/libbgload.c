@@ -0,0 +1,32 @@
+/* Library for background-load.exp.
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+struct bg_pair
+{
+  int first;
+  int second;
+};
+
+int bg_global = 42;
+static int bg_static = 7;
+struct bg_pair bg_pairs[2] = { { 1, 2 }, { 3, 4 } };
+
+int
+bg_func (int x)
+{
+  return x + bg_static + bg_global + bg_pairs[1].second;
+}
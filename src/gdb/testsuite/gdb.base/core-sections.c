@@ -0,0 +1,66 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/* A block of NPAGES pages, every other one made read-only, so that
+   it becomes NPAGES separate, adjacent sections of a core file.  Each
+   int in page I holds I * 1000 plus its index in the page.  */
+#define NPAGES 128
+
+char *block;
+long page_size;
+
+void
+stop_here (void)
+{
+}
+
+int
+main (void)
+{
+  int i, j;
+
+  page_size = sysconf (_SC_PAGESIZE);
+  block = mmap (NULL, NPAGES * page_size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (block == (char *) MAP_FAILED)
+    return 1;
+
+  for (i = 0; i < NPAGES; i++)
+    {
+      int *page = (int *) (block + i * page_size);
+
+      for (j = 0; j < page_size / sizeof (int); j++)
+	page[j] = i * 1000 + j;
+    }
+
+  for (i = 1; i < NPAGES; i += 2)
+    mprotect (block + i * page_size, page_size, PROT_READ);
+
+  stop_here ();
+
+  return 0;
+}
@@ -0,0 +1,46 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+/* 64 lines of GDB's default 64-byte dcache line.  Byte I of buf
+   holds I * 7, truncated.  */
+#define BUF_SIZE 4096
+
+unsigned char buf[BUF_SIZE] __attribute__ ((aligned (64)));
+unsigned char other[BUF_SIZE] __attribute__ ((aligned (64)));
+
+void
+stop_here (void)
+{
+}
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < BUF_SIZE; i++)
+    {
+      buf[i] = i * 7;
+      other[i] = i;
+    }
+
+  stop_here ();
+
+  return 0;
+}
@@ -16,6 +16,12 @@ static struct teststruct {
   int g;
 } intstruct, intstruct2;
 
+/* APPLE LOCAL begin streaming dump and restore */
+/* Bigger than the chunks dump and restore move at a time.  */
+#define BIGSIZE (3 * 1024 * 1024 + 1000)
+unsigned char bigarray[BIGSIZE];
+/* APPLE LOCAL end streaming dump and restore */
+
 void checkpoint1 ()
 {
   /* intarray and teststruct have been initialized. */
@@ -30,6 +36,14 @@ zero_all ()
   memset ((char *) &intstruct2, 0, sizeof (intstruct2));
 }
 
+/* APPLE LOCAL begin streaming dump and restore */
+void
+zero_big ()
+{
+  memset ((char *) bigarray, 0, sizeof (bigarray));
+}
+/* APPLE LOCAL end streaming dump and restore */
+
 main()
 {
   int i;
@@ -45,5 +59,9 @@ main()
   intstruct.f = 12 * 6;
   intstruct.g = 12 * 7;
 
+  /* APPLE LOCAL streaming dump and restore */
+  for (i = 0; i < BIGSIZE; i++)
+    bigarray[i] = i % 251;
+
   checkpoint1 ();
 }
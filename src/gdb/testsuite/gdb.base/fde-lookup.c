@@ -0,0 +1,82 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+/* A chain of calls through many functions, each with its own FDE
+   and frame size.  Built without a frame pointer, unwinding through
+   them needs the right FDE for every PC.  */
+
+void
+stop_here (void)
+{
+}
+
+int
+chain_32 (int x)
+{
+  stop_here ();
+  return x;
+}
+
+#define FUNC(N, NEXT) \
+  int \
+  chain_##N (int x) \
+  { \
+    volatile char pad[(N % 5 + 1) * 16]; \
+    pad[0] = x; \
+    return chain_##NEXT (pad[0] + 1) + 1; \
+  }
+
+FUNC (31, 32)
+FUNC (30, 31)
+FUNC (29, 30)
+FUNC (28, 29)
+FUNC (27, 28)
+FUNC (26, 27)
+FUNC (25, 26)
+FUNC (24, 25)
+FUNC (23, 24)
+FUNC (22, 23)
+FUNC (21, 22)
+FUNC (20, 21)
+FUNC (19, 20)
+FUNC (18, 19)
+FUNC (17, 18)
+FUNC (16, 17)
+FUNC (15, 16)
+FUNC (14, 15)
+FUNC (13, 14)
+FUNC (12, 13)
+FUNC (11, 12)
+FUNC (10, 11)
+FUNC (9, 10)
+FUNC (8, 9)
+FUNC (7, 8)
+FUNC (6, 7)
+FUNC (5, 6)
+FUNC (4, 5)
+FUNC (3, 4)
+FUNC (2, 3)
+FUNC (1, 2)
+FUNC (0, 1)
+
+int
+main (void)
+{
+  return chain_0 (0) == 64 ? 0 : 1;
+}
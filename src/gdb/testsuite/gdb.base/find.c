@@ -0,0 +1,64 @@
+/* Testcase for the find command.
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+/* The sizes of the chunks gdbserver and GDB search at a time.  */
+#define STUB_CHUNK_SIZE 16000
+#define CHUNK_SIZE (64 * 1024)
+#define BUF_SIZE (2 * CHUNK_SIZE) /* at least two chunks */
+
+static unsigned char int8_search_buf[100];
+static short int16_search_buf[100];
+static int int32_search_buf[100];
+static long long int64_search_buf[100];
+
+static char *search_buf;
+static int search_buf_size;
+
+static void
+init_bufs (void)
+{
+  memset (int8_search_buf, 0, sizeof (int8_search_buf));
+  memset (int16_search_buf, 0, sizeof (int16_search_buf));
+  memset (int32_search_buf, 0, sizeof (int32_search_buf));
+  memset (int64_search_buf, 0, sizeof (int64_search_buf));
+
+  /* The test puts patterns here that straddle the boundaries between
+     the chunks searches read.  */
+  search_buf_size = BUF_SIZE + 100;
+  search_buf = malloc (search_buf_size);
+  if (search_buf == NULL)
+    exit (1);
+  memset (search_buf, 'x', search_buf_size);
+}
+
+static void
+stop_here (void)
+{
+}
+
+int
+main (void)
+{
+  init_bufs ();
+
+  stop_here ();
+
+  return 0;
+}
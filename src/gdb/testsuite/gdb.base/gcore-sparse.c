@@ -0,0 +1,51 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Big enough that malloc gets it with its own anonymous mapping;
+   only a few of its pages are ever touched.  */
+#define BIG_SIZE (16 * 1024 * 1024)
+
+char *big_buf;
+
+/* A small block, which comes from the brk heap.  */
+char *heap_string;
+
+void
+stop_here (void)
+{
+}
+
+int
+main (void)
+{
+  big_buf = malloc (BIG_SIZE);
+  big_buf[0] = 1;
+  big_buf[BIG_SIZE / 2] = 2;
+  big_buf[BIG_SIZE - 1] = 3;
+
+  heap_string = malloc (64);
+  strcpy (heap_string, "in the brk heap");
+
+  stop_here ();
+
+  return 0;
+}
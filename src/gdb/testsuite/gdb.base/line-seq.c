@@ -0,0 +1,51 @@
+/* Testcase for "maint set dwarf2 skip-dead-line-sequences".
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+/* Built with -ffunction-sections, so that each function gets its own
+   sequence in the line number program.  */
+
+int counter;
+
+int
+first (int x)
+{
+  counter += x;				/* first body */
+  return counter;
+}
+
+int
+second (int x)
+{
+  counter -= x;				/* second body */
+  return counter;
+}
+
+int
+third (int x)
+{
+  counter *= x;				/* third body */
+  return counter;
+}
+
+int
+main (void)
+{
+  first (3);
+  second (1);
+  third (5);				/* call third */
+  return 0;
+}
@@ -0,0 +1,64 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+ 
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <dlfcn.h>
+
+#define SHLIB_NAME SHLIB_DIR "/many-unloads-shr.sl"
+
+#define NLOADS 500
+
+int total = 0;
+
+void
+loads_done (void)
+{
+}
+
+int main()
+{
+  void *handle;
+  int (*shrfunc) (int);
+  int i;
+
+  for (i = 0; i < NLOADS; i++)
+    {
+      handle = dlopen (SHLIB_NAME, RTLD_LAZY);
+      if (!handle)
+	{
+	  fprintf (stderr, "%s", dlerror ());
+	  exit (1);
+	}
+
+      shrfunc = (int (*)(int)) dlsym (handle, "many_unloads_shrfunc");
+      if (!shrfunc)
+	{
+	  fprintf (stderr, "%s", dlerror ());
+	  exit (1);
+	}
+
+      total += (*shrfunc) (i);
+      dlclose (handle);
+    }
+
+  loads_done ();
+
+  printf ("total is %d\n", total);
+  return 0;
+}
@@ -0,0 +1,48 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+/* Enough functions that their addresses differ in more than the
+   lowest byte, defined in an order unrelated to their names.  */
+
+#define FUNC(N) \
+  int \
+  minsym_func_##N (int x) \
+  { \
+    int i, sum = 0; \
+    for (i = 0; i < x * N; i++) \
+      sum += i ^ N; \
+    return sum; \
+  }
+
+FUNC (0)
+FUNC (9)
+FUNC (3)
+FUNC (12)
+FUNC (1)
+FUNC (7)
+FUNC (15)
+FUNC (4)
+FUNC (2)
+FUNC (10)
+FUNC (13)
+FUNC (6)
+FUNC (14)
+FUNC (8)
+FUNC (11)
+FUNC (5)
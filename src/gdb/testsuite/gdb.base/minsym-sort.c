@@ -0,0 +1,68 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <dlfcn.h>
+
+#define LIB SHLIB_DIR "/minsym-sort-lib.sl"
+
+void
+loaded (void)
+{
+}
+
+void
+unloaded (void)
+{
+}
+
+static void
+load_and_unload (void)
+{
+  void *handle;
+  int (*func) (int);
+
+  handle = dlopen (LIB, RTLD_NOW);
+  if (handle == NULL)
+    {
+      fprintf (stderr, "%s\n", dlerror ());
+      exit (1);
+    }
+  func = (int (*) (int)) dlsym (handle, "minsym_func_0");
+  if (func == NULL)
+    {
+      fprintf (stderr, "%s\n", dlerror ());
+      exit (1);
+    }
+  func (1);
+  loaded ();
+
+  dlclose (handle);
+  unloaded ();
+}
+
+int
+main (void)
+{
+  load_and_unload ();
+  load_and_unload ();
+
+  return 0;
+}
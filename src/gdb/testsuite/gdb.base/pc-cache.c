@@ -0,0 +1,70 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <dlfcn.h>
+
+/* Two libraries of the same shape, loaded one after the other, so
+   the second is likely to land where the first one was.  */
+#define LIB_A SHLIB_DIR "/pc-cache-a.sl"
+#define LIB_B SHLIB_DIR "/pc-cache-b.sl"
+
+void *first_func;
+
+void
+loaded (void *func)
+{
+}
+
+static void *
+load_and_call (const char *lib, const char *name, void **handle)
+{
+  int (*func) (int);
+
+  *handle = dlopen (lib, RTLD_NOW);
+  if (*handle == NULL)
+    {
+      fprintf (stderr, "%s\n", dlerror ());
+      exit (1);
+    }
+  func = (int (*) (int)) dlsym (*handle, name);
+  if (func == NULL)
+    {
+      fprintf (stderr, "%s\n", dlerror ());
+      exit (1);
+    }
+  func (1);
+  loaded ((void *) func);
+  return (void *) func;
+}
+
+int
+main (void)
+{
+  void *handle;
+
+  first_func = load_and_call (LIB_A, "pc_cache_a_func", &handle);
+  dlclose (handle);
+
+  load_and_call (LIB_B, "pc_cache_b_func", &handle);
+  dlclose (handle);
+
+  return 0;
+}
@@ -0,0 +1,37 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+/* Built twice, with VARIANT_FUNC named variant_a and variant_b: the
+   two programs differ only in the name, so they are the same size.  */
+
+#ifndef VARIANT_FUNC
+#define VARIANT_FUNC variant_a
+#endif
+
+int
+VARIANT_FUNC (int x)
+{
+  return x + 1; /* variant body */
+}
+
+int
+main (void)
+{
+  return VARIANT_FUNC (0) - 1;
+}
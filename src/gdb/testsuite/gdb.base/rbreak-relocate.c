@@ -0,0 +1,72 @@
+/* Testcase for breakpoints that move when the executable is relocated.
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+/* Built as a position independent executable, so that the breakpoints
+   "rbreak ^rb_func_" sets before the program runs all have to be
+   moved when it is loaded.  */
+
+int total;
+
+#define RB_FUNC(n) \
+  int rb_func_##n (int x) { total += x + n; return total; }
+
+RB_FUNC (0)  RB_FUNC (1)  RB_FUNC (2)  RB_FUNC (3)
+RB_FUNC (4)  RB_FUNC (5)  RB_FUNC (6)  RB_FUNC (7)
+RB_FUNC (8)  RB_FUNC (9)  RB_FUNC (10) RB_FUNC (11)
+RB_FUNC (12) RB_FUNC (13) RB_FUNC (14) RB_FUNC (15)
+RB_FUNC (16) RB_FUNC (17) RB_FUNC (18) RB_FUNC (19)
+RB_FUNC (20) RB_FUNC (21) RB_FUNC (22) RB_FUNC (23)
+RB_FUNC (24) RB_FUNC (25) RB_FUNC (26) RB_FUNC (27)
+RB_FUNC (28) RB_FUNC (29) RB_FUNC (30) RB_FUNC (31)
+
+int
+main ()
+{
+  rb_func_0 (1);
+  rb_func_1 (1);
+  rb_func_2 (1);
+  rb_func_3 (1);
+  rb_func_4 (1);
+  rb_func_5 (1);
+  rb_func_6 (1);
+  rb_func_7 (1);
+  rb_func_8 (1);
+  rb_func_9 (1);
+  rb_func_10 (1);
+  rb_func_11 (1);
+  rb_func_12 (1);
+  rb_func_13 (1);
+  rb_func_14 (1);
+  rb_func_15 (1);
+  rb_func_16 (1);
+  rb_func_17 (1);
+  rb_func_18 (1);
+  rb_func_19 (1);
+  rb_func_20 (1);
+  rb_func_21 (1);
+  rb_func_22 (1);
+  rb_func_23 (1);
+  rb_func_24 (1);
+  rb_func_25 (1);
+  rb_func_26 (1);
+  rb_func_27 (1);
+  rb_func_28 (1);
+  rb_func_29 (1);
+  rb_func_30 (1);
+  rb_func_31 (1);
+  return 0;
+}
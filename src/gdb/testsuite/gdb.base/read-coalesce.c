@@ -0,0 +1,49 @@
+/* Testcase for "set read-coalesce-size".
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+int arr[64];
+
+/* Called from GDB, which should see the change it makes to ARR
+   within the same command.  */
+
+int
+bump (int i)
+{
+  arr[i]++;
+  return 0;
+}
+
+void
+stop_here (void)
+{
+}
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < 64; i++)
+    arr[i] = i;
+  stop_here ();
+
+  for (i = 0; i < 64; i++)
+    arr[i] *= 10;
+  stop_here ();
+
+  return 0;
+}
@@ -0,0 +1,38 @@
+/* Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  */
+
+#include <string.h>
+
+static char bytes[256];
+
+static int ints[64];
+
+static void
+initialize (void)
+{
+  memset (bytes, 'x', sizeof (bytes));
+  memcpy (bytes + 16, "needle", 6);
+  memcpy (bytes + 200, "needle", 6);
+
+  ints[10] = 0x12345678;
+}
+
+int
+main ()
+{
+  initialize ();
+  return 0;
+}
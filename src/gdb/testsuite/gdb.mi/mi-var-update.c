@@ -0,0 +1,40 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+/* H's contents never change once it is set up, but what H.P points
+   to does.  */
+
+struct holder
+{
+  int *p;
+  int arr[4];
+};
+
+int target = 1;
+struct holder h;
+
+int
+main (void)
+{
+  h.p = &target;
+  h.arr[0] = 10; /* set up */
+  target = 2; /* change target */
+  h.arr[1] = 20; /* change arr */
+  return 0; /* done */
+}
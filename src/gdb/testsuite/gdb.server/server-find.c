@@ -0,0 +1,46 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+#include <string.h>
+
+/* gdbserver searches 16000 bytes at a time; make the buffer span
+   several of those.  */
+#define BUF_SIZE (4 * 16000)
+
+static char search_buf[BUF_SIZE];
+
+void
+stop_here (void)
+{
+}
+
+int
+main (void)
+{
+  memset (search_buf, 'x', sizeof (search_buf));
+  memcpy (search_buf + 100, "needle", 6);
+  /* One that straddles the boundary between two of gdbserver's
+     chunks, and one at the very end.  */
+  memcpy (search_buf + 16000 - 3, "needle", 6);
+  memcpy (search_buf + BUF_SIZE - 6, "needle", 6);
+
+  stop_here ();
+
+  return 0;
+}
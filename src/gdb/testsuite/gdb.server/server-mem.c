@@ -0,0 +1,64 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+#include <string.h>
+
+/* Large enough that GDB moves it in many packets, each one well over
+   the few words gdbserver still transfers with ptrace.  */
+#define BLOB_SIZE 20000
+
+struct blob
+{
+  unsigned char data[BLOB_SIZE];
+};
+
+struct blob src_blob;
+struct blob dst_blob;
+
+/* Writes too short for /proc/PID/mem, and a write to a read-only
+   page.  */
+unsigned char small[3];
+const volatile unsigned char ro_data[16] = { 1, 2, 3, 4 };
+
+void
+stop_here (void)
+{
+}
+
+void
+report (int same, int small_ok, int ro_ok)
+{
+}
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < BLOB_SIZE; i++)
+    src_blob.data[i] = i * 13 + 1;
+
+  stop_here ();
+
+  report (memcmp (&src_blob, &dst_blob, sizeof (struct blob)) == 0,
+	  small[0] == 0 && small[1] == 0x5a && small[2] == 0,
+	  ro_data[2] == 0x77);
+
+  return 0;
+}
@@ -0,0 +1,55 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2006 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+ 
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307,
+   USA.  */
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+unsigned char buf[65536];
+
+/* A page of 'x's, followed by a page that isn't mapped.  */
+char *edge;
+
+void
+stop_here (void)
+{
+}
+
+int
+main (int argc, char **argv)
+{
+  long pagesize = sysconf (_SC_PAGESIZE);
+  char *p;
+  int i;
+
+  for (i = 0; i < sizeof (buf); i++)
+    buf[i] = (i * 7) & 0xff;
+
+  p = mmap (0, 2 * pagesize, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p != MAP_FAILED)
+    {
+      munmap (p + pagesize, pagesize);
+      memset (p, 'x', pagesize);
+      edge = p;
+    }
+
+  stop_here ();
+  return 0;
+}
@@ -0,0 +1,70 @@
+/* Test program for stopping and resuming a process with many threads.
+   Copyright 2006
+   Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+   
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330,
+   Boston, MA 02111-1307, USA.  */
+
+#include <pthread.h>
+#include <limits.h>
+
+#define NTHREADS 1000
+#define NSTOPS 20
+
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void *
+thread_function (void *arg)
+{
+  /* Block until main is done, so that every thread is alive (and has
+     to be stopped) each time main hits the breakpoint.  */
+  pthread_mutex_lock (&mutex);
+  pthread_mutex_unlock (&mutex);
+
+  return NULL;
+}
+
+void
+stop_here (int i)
+{
+}
+
+int 
+main (int argc, char **argv)
+{
+  pthread_attr_t attr;
+  pthread_t threads[NTHREADS];
+  int i;
+
+  pthread_attr_init (&attr);
+  pthread_attr_setstacksize (&attr, PTHREAD_STACK_MIN);
+
+  pthread_mutex_lock (&mutex);
+  for (i = 0; i < NTHREADS; ++i) 
+    pthread_create (&threads[i], &attr, thread_function, NULL);
+
+  for (i = 0; i < NSTOPS; ++i)
+    stop_here (i);
+
+  pthread_mutex_unlock (&mutex);
+  for (i = 0; i < NTHREADS; ++i)
+    pthread_join (threads[i], NULL);
+
+  pthread_attr_destroy (&attr);
+
+  return 0;
+}
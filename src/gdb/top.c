@@ -474,6 +474,8 @@ execute_command (char *p, int from_tty)
   if (*p)
     {
       char *arg;
+      /* APPLE LOCAL read coalescing */
+      struct cleanup *old_chain;
       tmp_line = p;
 
       c = lookup_cmd (&p, cmdlist, "", 0, 1);
@@ -510,6 +512,10 @@ execute_command (char *p, int from_tty)
 	  *(p + 1) = '\0';
 	}
 
+      /* APPLE LOCAL: Let the command's small memory reads share
+	 transfers.  */
+      old_chain = make_cleanup_coalesce_memory_reads ();
+
       /* If this command has been pre-hooked, run the hook first. */
       execute_cmd_pre_hook (c);
 
@@ -530,6 +536,8 @@ execute_command (char *p, int from_tty)
       /* If this command has been post-hooked, run the hook last. */
       execute_cmd_post_hook (c);
 
+      /* APPLE LOCAL read coalescing */
+      do_cleanups (old_chain);
     }
 
   /* Tell the user if the language has changed (except first time).  */
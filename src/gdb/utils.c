@@ -2354,12 +2354,32 @@ fputs_maybe_filtered (const char *linebuffer, struct ui_file *stream,
 	    }
 	  else
 	    {
+	      /* APPLE LOCAL begin fputs_maybe_filtered runs */
+	      /* Copy the run of ordinary characters up to the next tab,
+		 newline or the end of the line in one go, rather than a
+		 character at a time.  Always take at least one, since
+		 CHARS_PRINTED may already be past the end of the line.  */
+	      const char *run_end = lineptr + 1;
+	      unsigned int room = 1;
+	      size_t len;
+
+	      if (chars_printed < chars_per_line)
+		room = chars_per_line - chars_printed;
+	      while ((unsigned int) (run_end - lineptr) < room
+		     && *run_end && *run_end != '\n' && *run_end != '\t')
+		run_end++;
+	      len = run_end - lineptr;
+
 	      if (wrap_column)
-		*wrap_pointer++ = *lineptr;
+		{
+		  memcpy (wrap_pointer, lineptr, len);
+		  wrap_pointer += len;
+		}
 	      else
-		fputc_unfiltered (*lineptr, stream);
-	      chars_printed++;
-	      lineptr++;
+		ui_file_write (stream, lineptr, len);
+	      chars_printed += len;
+	      lineptr = run_end;
+	      /* APPLE LOCAL end fputs_maybe_filtered runs */
 	    }
 
 	  if (chars_printed >= chars_per_line)
@@ -35,6 +35,8 @@
 #include "block.h"
 #include "target.h"
 #include "objfiles.h"
+#include "observer.h"
+#include "hashtab.h"
 
 #include <math.h>
 
@@ -97,6 +99,10 @@ struct varobj_root
      the variable has gone from in scope to out of scope
      or vice versa. */
   int in_scope;
+
+  /* The value of varobj_memory_generation when the children of this
+     root were last brought up to date, or 0 if they never were.  */
+  unsigned int generation;
   /* APPLE LOCAL end */
 
   /* Language info for this variable and its children */
@@ -262,14 +268,6 @@ struct cpstack
   struct cpstack *next;
 };
 
-/* A list of varobjs */
-
-struct vlist
-{
-  struct varobj *var;
-  struct vlist *next;
-};
-
 /* APPLE LOCAL begin */
 /* This is the list varobj_update builds up */
 
@@ -327,6 +325,12 @@ static enum varobj_display_formats variable_default_display (struct varobj *);
 
 static int my_value_equal (struct value *, struct value *, int *);
 
+/* APPLE LOCAL begin incremental update */
+static int varobj_value_unchanged_p (struct value *, struct value *);
+
+static void varobj_push_children (struct vstack **, struct varobj *, int);
+/* APPLE LOCAL end incremental update */
+
 static struct varobj_changelist *varobj_changelist_init ();
 
 static void varobj_add_to_changelist(struct varobj_changelist *changelist, 
@@ -538,12 +542,42 @@ static int format_code[] = { 0, 't', 'd', 'x', 'o', 'u', 'T' };
 static struct varobj_root *rootlist;
 static int rootcount = 0;	/* number of root varobjs in the list */
 
-/* Prime number indicating the number of buckets in the hash table */
-/* A prime large enough to avoid too many colisions */
+/* Initial number of buckets in the hash table; libiberty's hashtab
+   grows it as varobjs are created.  */
 #define VAROBJ_TABLE_SIZE 227
 
-/* Pointer to the varobj hash table (built at run time) */
-static struct vlist **varobj_table;
+/* Hash table of all installed varobjs, keyed by object name (built at
+   run time) */
+static htab_t varobj_table;
+
+/* APPLE LOCAL begin incremental update */
+/* Bumped whenever the inferior stops, and whenever GDB changes its
+   memory or registers.  If it hasn't moved since a root's children
+   were last updated, and the root still has the same contents at the
+   same place, the children can't have changed either.  */
+static unsigned int varobj_memory_generation = 1;
+
+/* If non-zero, varobj_update uses varobj_memory_generation to skip
+   the children of unchanged roots.  */
+static int varobj_incremental_update = 1;
+
+/* Counts for "maint print varobj-stats".  */
+static struct
+{
+  /* Calls to varobj_update.  */
+  unsigned long updates;
+
+  /* Updates whose children were skipped because nothing had changed.  */
+  unsigned long updates_skipped;
+
+  /* Children whose values were recomputed.  */
+  unsigned long children_evaluated;
+
+  /* Children left alone, with everything below them, because they are
+     stored in an unchanged parent and hold no pointers.  */
+  unsigned long subtrees_skipped;
+} varobj_stats;
+/* APPLE LOCAL end incremental update */
 
 /* APPLE LOCAL begin */
 /* Switch to determine whether to try to freeze the other threads in the 
@@ -1180,24 +1214,14 @@ varobj_gen_name (void)
 struct varobj *
 varobj_get_handle (char *objname)
 {
-  struct vlist *cv;
-  const char *chp;
-  unsigned int index = 0;
-  unsigned int i = 1;
-
-  for (chp = objname; *chp; chp++)
-    {
-      index = (index + (i++ * (unsigned int) *chp)) % VAROBJ_TABLE_SIZE;
-    }
-
-  cv = *(varobj_table + index);
-  while ((cv != NULL) && (strcmp (cv->var->obj_name, objname) != 0))
-    cv = cv->next;
+  struct varobj *var;
 
-  if (cv == NULL)
+  var = htab_find_with_hash (varobj_table, objname,
+			     htab_hash_string (objname));
+  if (var == NULL)
     error (_("Variable object not found"));
 
-  return cv->var;
+  return var;
 }
 
 /* Given the handle, return the name of the object */
@@ -1540,6 +1564,8 @@ varobj_set_value (struct varobj *var, char *expression)
 
       if (!my_value_equal (var->value, value, &error))
 	var->updated = 1;
+      /* APPLE LOCAL: Make the next update look at every child.  */
+      var->root->generation = 0;
       if (!gdb_value_assign (var->value, value, &val))
 	{
 	  ret_val = 0;
@@ -1621,6 +1647,10 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
   struct frame_id old_fid;
   struct frame_info *fi;
   int came_in_scope = 0;
+  unsigned int generation = varobj_memory_generation;
+  int skip_children;
+  int incremental;
+  int unchanged;
 
   /* sanity check: have we been passed a pointer? */
   if (changelist == NULL)
@@ -1631,6 +1661,8 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
     /* Not a root var */
     return -1;
 
+  varobj_stats.updates++;
+
   /* Save the selected stack frame, since we will need to change it
      in order to evaluate expressions. */
   old_fid = get_frame_id (deprecated_selected_frame);
@@ -1726,6 +1758,24 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
       (*varp)->error = error;
     }
 
+  /* APPLE LOCAL begin incremental update */
+  /* Children can only be skipped if the last update finished cleanly
+     and none of them has been assigned to since.  */
+  incremental = (varobj_incremental_update
+		 && (*varp)->root->generation != 0
+		 && type_changed == VAROBJ_TYPE_UNCHANGED
+		 && !came_in_scope);
+  unchanged = incremental && varobj_value_unchanged_p ((*varp)->value, new);
+
+  /* If nothing in the inferior has changed since the children were
+     last updated (evaluating the root expression didn't call a
+     function, either), and the root is the same object with the same
+     contents, every child would evaluate to what it holds now.  */
+  skip_children = (unchanged
+		   && (*varp)->root->generation == generation
+		   && varobj_memory_generation == generation);
+  /* APPLE LOCAL end incremental update */
+
   /* We must always keep around the new value for this root
      variable expression, or we lose the updated children! */
   value_free ((*varp)->value);
@@ -1735,12 +1785,14 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
   vpush (&stack, NULL);
 
   /* Push the root's children */
-  if ((*varp)->children != NULL)
+  if (skip_children)
     {
-      struct varobj_child *c;
-      for (c = (*varp)->children; c != NULL; c = c->next)
-	vpush (&stack, c->child);
+      if (varobjdebug)
+	fprintf_unfiltered (gdb_stdlog, "Updating variable: %s (%s) children unchanged.\n", (*varp)->name, (*varp)->obj_name);
+      varobj_stats.updates_skipped++;
     }
+  else
+    varobj_push_children (&stack, *varp, unchanged);
 
   /* Walk through the children, reconstructing them all. */
   v = vpop (&stack);
@@ -1753,6 +1805,7 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
 
       /* Update this variable */
       new = value_of_child (v->parent, v->index, &child_type_changed);
+      varobj_stats.children_evaluated++;
       if (varobjdebug)
         {
           if (new != NULL)
@@ -1776,6 +1829,11 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
       /* Its value is going to be updated to NEW.  */
       v->error = error;
 
+      /* APPLE LOCAL incremental update */
+      unchanged = (incremental
+		   && child_type_changed == VAROBJ_TYPE_UNCHANGED
+		   && varobj_value_unchanged_p (v->value, new));
+
       /* We must always keep new values, since children depend on it. */
       if (v->value != NULL)
 	value_free (v->value);
@@ -1784,14 +1842,7 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
       /* If the type has changed, delete the children, 
 	 otherwise push any children */
       if (child_type_changed == VAROBJ_TYPE_UNCHANGED)
-	{
-	  if (v->children != NULL)
-	    {
-	      struct varobj_child *c;
-	      for (c = v->children; c != NULL; c = c->next)
-		vpush (&stack, c->child);
-	    }
-	}
+	varobj_push_children (&stack, v, unchanged);
       else
 	{
 	  varobj_delete (v, NULL, 1);
@@ -1802,6 +1853,15 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
       v = vpop (&stack);
     }
 
+  /* APPLE LOCAL begin incremental update */
+  /* If a child's expression called a function, the children may
+     already be stale.  */
+  if (varobj_memory_generation == generation)
+    (*varp)->root->generation = generation;
+  else
+    (*varp)->root->generation = 0;
+  /* APPLE LOCAL end incremental update */
+
   /* Restore selected frame */
   fi = frame_find_by_id (old_fid);
   if (fi)
@@ -1816,6 +1876,178 @@ varobj_update (struct varobj **varp, struct varobj_changelist **changelist)
 }
 
 
+/* APPLE LOCAL begin incremental update */
+/* Return non-zero if NEW is the same object as OLD, holding the same
+   contents, so that anything computed from OLD can be reused.  */
+
+static int
+varobj_value_unchanged_p (struct value *old, struct value *new)
+{
+  struct type *type;
+
+  if (old == NULL || new == NULL)
+    return 0;
+  if (value_lazy (old) || value_lazy (new))
+    return 0;
+
+  type = value_type (old);
+  if (type != value_type (new)
+      || VALUE_LVAL (old) != VALUE_LVAL (new))
+    return 0;
+
+  switch (VALUE_LVAL (old))
+    {
+    case lval_memory:
+      if (VALUE_ADDRESS (old) + value_offset (old)
+	  != VALUE_ADDRESS (new) + value_offset (new))
+	return 0;
+      break;
+    case lval_register:
+    case lval_register_literal:
+      if (VALUE_REGNUM (old) != VALUE_REGNUM (new)
+	  || value_offset (old) != value_offset (new)
+	  || !frame_id_eq (VALUE_FRAME_ID (old), VALUE_FRAME_ID (new)))
+	return 0;
+      break;
+    case not_lval:
+      break;
+    default:
+      /* Don't try to reason about internalvars and the like.  */
+      return 0;
+    }
+
+  return memcmp (value_contents (old), value_contents (new),
+		 TYPE_LENGTH (check_typedef (type))) == 0;
+}
+
+/* Return non-zero if no value of type TYPE can refer to memory
+   outside of itself, so that its contents determine everything below
+   it in the varobj tree.  */
+
+static int
+varobj_type_self_contained_p (struct type *type)
+{
+  int result;
+  int i;
+
+  type = check_typedef (type);
+  switch (TYPE_CODE (type))
+    {
+    case TYPE_CODE_INT:
+    case TYPE_CODE_CHAR:
+    case TYPE_CODE_BOOL:
+    case TYPE_CODE_ENUM:
+    case TYPE_CODE_FLT:
+    case TYPE_CODE_COMPLEX:
+    case TYPE_CODE_RANGE:
+      result = 1;
+      break;
+
+    case TYPE_CODE_ARRAY:
+      result = (TYPE_LENGTH (type) > 0
+		&& varobj_type_self_contained_p (TYPE_TARGET_TYPE (type)));
+      break;
+
+    case TYPE_CODE_STRUCT:
+    case TYPE_CODE_UNION:
+      result = !TYPE_STUB (type);
+      for (i = 0; result && i < TYPE_NFIELDS (type); i++)
+	if (!TYPE_FIELD_STATIC (type, i))
+	  result = varobj_type_self_contained_p (TYPE_FIELD_TYPE (type, i));
+      break;
+
+    default:
+      /* Pointers and references, and anything we aren't sure of.  */
+      result = 0;
+      break;
+    }
+
+  return result;
+}
+
+/* Push the children of VAR onto STACK for varobj_update to
+   reconstruct.  If UNCHANGED, VAR's value is the same object with the
+   same contents as at the last update, so children that are stored
+   inside it and can't refer to anything outside it are unchanged too,
+   and are left off.  */
+
+static void
+varobj_push_children (struct vstack **stack, struct varobj *var,
+		      int unchanged)
+{
+  struct varobj_child *c;
+  int embedded = 0;
+
+  if (unchanged)
+    {
+      struct type *type = check_typedef (value_type (var->value));
+      embedded = (TYPE_CODE (type) == TYPE_CODE_STRUCT
+		  || TYPE_CODE (type) == TYPE_CODE_UNION
+		  || TYPE_CODE (type) == TYPE_CODE_ARRAY);
+    }
+
+  for (c = var->children; c != NULL; c = c->next)
+    {
+      struct varobj *child = c->child;
+
+      if (embedded
+	  && !CPLUS_FAKE_CHILD (child)
+	  && !child->updated
+	  && child->value != NULL
+	  && !value_lazy (child->value)
+	  && child->type != NULL
+	  && varobj_type_self_contained_p (child->type))
+	{
+	  varobj_stats.subtrees_skipped++;
+	  continue;
+	}
+      vpush (stack, child);
+    }
+}
+
+/* Anything that can change the inferior's memory or registers starts
+   a new generation.  */
+
+static void
+varobj_normal_stop (struct bpstats *bs)
+{
+  varobj_memory_generation++;
+}
+
+static void
+varobj_target_changed (struct target_ops *target)
+{
+  varobj_memory_generation++;
+}
+
+static void
+varobj_memory_changed (CORE_ADDR addr, int len)
+{
+  varobj_memory_generation++;
+}
+
+static void
+varobj_inferior_created (struct target_ops *target, int from_tty)
+{
+  varobj_memory_generation++;
+}
+
+static void
+maintenance_print_varobj_stats (char *args, int from_tty)
+{
+  printf_filtered (_("Variable objects: %lu\n"),
+		   (unsigned long) htab_elements (varobj_table));
+  printf_filtered (_("Root variable objects: %d\n"), rootcount);
+  printf_filtered (_("Updates: %lu\n"), varobj_stats.updates);
+  printf_filtered (_("Updates with unchanged children: %lu\n"),
+		   varobj_stats.updates_skipped);
+  printf_filtered (_("Children re-evaluated: %lu\n"),
+		   varobj_stats.children_evaluated);
+  printf_filtered (_("Unchanged subtrees skipped: %lu\n"),
+		   varobj_stats.subtrees_skipped);
+}
+/* APPLE LOCAL end incremental update */
+
 /* Helper functions */
 
 /*
@@ -1890,32 +2122,18 @@ delete_variable_1 (struct cpstack **resultp, int *delcountp,
 static int
 install_variable (struct varobj *var)
 {
-  struct vlist *cv;
-  struct vlist *newvl;
-  const char *chp;
-  unsigned int index = 0;
-  unsigned int i = 1;
+  void **slot;
 
   if (var->obj_name == NULL)
     return 0;
 
-  for (chp = var->obj_name; *chp; chp++)
-    {
-      index = (index + (i++ * (unsigned int) *chp)) % VAROBJ_TABLE_SIZE;
-    }
-
-  cv = *(varobj_table + index);
-  while ((cv != NULL) && (strcmp (cv->var->obj_name, var->obj_name) != 0))
-    cv = cv->next;
-
-  if (cv != NULL)
+  slot = htab_find_slot_with_hash (varobj_table, var->obj_name,
+				   htab_hash_string (var->obj_name), INSERT);
+  if (*slot != NULL)
     error (_("Duplicate variable object name"));
 
   /* Add varobj to hash table */
-  newvl = xmalloc (sizeof (struct vlist));
-  newvl->next = *(varobj_table + index);
-  newvl->var = var;
-  *(varobj_table + index) = newvl;
+  *slot = var;
 
   /* If root, add varobj to root list */
   /* APPLE LOCAL is_root_p */
@@ -1937,35 +2155,22 @@ install_variable (struct varobj *var)
 static void
 uninstall_variable (struct varobj *var)
 {
-  struct vlist *cv;
-  struct vlist *prev;
+  void **slot;
   struct varobj_root *cr;
   struct varobj_root *prer;
-  const char *chp;
-  unsigned int index = 0;
-  unsigned int i = 1;
 
   if (var->obj_name == NULL)
     return;
 
   /* Remove varobj from hash table */
-  for (chp = var->obj_name; *chp; chp++)
-    {
-      index = (index + (i++ * (unsigned int) *chp)) % VAROBJ_TABLE_SIZE;
-    }
-
-  cv = *(varobj_table + index);
-  prev = NULL;
-  while ((cv != NULL) && (strcmp (cv->var->obj_name, var->obj_name) != 0))
-    {
-      prev = cv;
-      cv = cv->next;
-    }
+  slot = htab_find_slot_with_hash (varobj_table, var->obj_name,
+				   htab_hash_string (var->obj_name),
+				   NO_INSERT);
 
   if (varobjdebug)
     fprintf_unfiltered (gdb_stdlog, "Deleting %s\n", var->obj_name);
 
-  if (cv == NULL)
+  if (slot == NULL || *slot != var)
     {
       warning
 	("Assertion failed: Could not find variable object \"%s\" to delete",
@@ -1973,12 +2178,7 @@ uninstall_variable (struct varobj *var)
       return;
     }
 
-  if (prev == NULL)
-    *(varobj_table + index) = cv->next;
-  else
-    prev->next = cv->next;
-
-  xfree (cv);
+  htab_clear_slot (varobj_table, slot);
 
   /* If root, remove varobj from root list */
   /* APPLE LOCAL is_root_p */
@@ -2218,6 +2418,7 @@ new_root_variable (void)
   var->root->frame = null_frame_id;
   var->root->use_selected_frame = 0;
   var->root->in_scope = 0;
+  var->root->generation = 0;
   var->root->rootvar = NULL;
 
   return var;
@@ -4590,14 +4791,50 @@ java_path_expr_of_child (struct varobj *parent, int index)
   return cplus_path_expr_of_child (parent, index);
 }
 
+/* Hash table support for varobj_table.  Entries are varobjs; lookups
+   are done by object name.  */
+
+static hashval_t
+hash_varobj (const void *p)
+{
+  const struct varobj *var = p;
+  return htab_hash_string (var->obj_name);
+}
+
+static int
+eq_varobj_name (const void *p, const void *name)
+{
+  const struct varobj *var = p;
+  return strcmp (var->obj_name, name) == 0;
+}
+
 extern void _initialize_varobj (void);
 void
 _initialize_varobj (void)
 {
-  int sizeof_table = sizeof (struct vlist *) * VAROBJ_TABLE_SIZE;
+  varobj_table = htab_create_alloc (VAROBJ_TABLE_SIZE, hash_varobj,
+				    eq_varobj_name, NULL, xcalloc, xfree);
+
+  /* APPLE LOCAL begin incremental update */
+  observer_attach_normal_stop (varobj_normal_stop);
+  observer_attach_target_changed (varobj_target_changed);
+  observer_attach_memory_changed (varobj_memory_changed);
+  observer_attach_inferior_created (varobj_inferior_created);
+
+  add_setshow_boolean_cmd ("varobj-incremental-update", class_obscure,
+			   &varobj_incremental_update, _("\
+Set whether varobj updates skip the children of unchanged variables."), _("\
+Show whether varobj updates skip the children of unchanged variables."), _("\
+When on, updating a root variable object whose value is unchanged, while\n\
+the program has neither run nor had its memory or registers changed since\n\
+the last update, does not re-evaluate its children."),
+			   NULL, NULL,
+			   &setlist, &showlist);
 
-  varobj_table = xmalloc (sizeof_table);
-  memset (varobj_table, 0, sizeof_table);
+  add_cmd ("varobj-stats", class_maintenance, maintenance_print_varobj_stats,
+	   _("Print how much work variable object updates have done."),
+	   &maintenanceprintlist);
+  /* APPLE LOCAL end incremental update */
 
   /* APPLE LOCAL begin varobj */
   add_setshow_boolean_cmd ("varobj-print-object", class_obscure,